@@ -0,0 +1,81 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 20:00:00
+ * @Description  : Sparse brick-map bake of a static signed distance field
+ * @FilePath     : BrickMap.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "SDFMath.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief A distance field sampled into a sparse brick map (layout must match
+ * brickMapDistance() in shaders/sdf3d.frag).
+ *
+ * The bounds are split into cells of kBrickCells^3 voxels. Cells the surface
+ * may pass through (|distance at the centre| <= half diagonal + band) get a
+ * brick of kBrickSamples^3 samples on the voxel corners. Neighbouring bricks
+ * duplicate their shared face, so trilinear filtering never leaves a brick.
+ * Every other cell is empty and is answered from a coarse grid that holds one
+ * sample per cell corner, clamped to the corners' Lipschitz bound so it never
+ * overestimates the distance.
+ *
+ * - indirection: one uint per cell, x fastest; a brick slot or kBrickEmpty
+ * - coarse: (cells + 1) per axis floats, x fastest
+ * - atlas: half floats in a 2D texture. Brick slot s starts at texel
+ *   ((s % atlasColumns) * kBrickSamples^2, (s / atlasColumns) * kBrickSamples).
+ *   Its z slices sit side by side, kBrickSamples texels wide each, so one
+ *   hardware bilinear fetch filters x/y and two fetches are blended in z.
+ */
+struct BrickMap {
+    static constexpr uint32_t kBrickCells = 8;
+    static constexpr uint32_t kBrickSamples = kBrickCells + 1;
+    static constexpr uint32_t kBrickEmpty = 0xFFFFFFFFu;
+
+    sdf::Vec3 origin;          // min corner of cell (0, 0, 0)
+    float voxelSize = 0.0f;    // distance between neighbouring brick samples
+    uint32_t cells[3] = {};    // grid size in cells
+    uint32_t brickCount = 0;
+    uint32_t atlasColumns = 0; // bricks per atlas row
+    uint32_t atlasWidth = 0;   // texels
+    uint32_t atlasHeight = 0;
+
+    std::vector<uint32_t> indirection;
+    std::vector<float> coarse;
+    std::vector<uint16_t> atlas; // IEEE half floats
+
+    float getCellSize() const { return voxelSize * kBrickCells; }
+    size_t getCellCount() const { return static_cast<size_t>(cells[0]) * cells[1] * cells[2]; }
+
+    /**
+     * @brief Same lookup as the shader (bricks trilinear, empty cells from the coarse
+     * grid, outside the bounds a lower bound); for validation and CPU use.
+     */
+    float sample(sdf::Vec3 p) const;
+};
+
+struct BrickMapDesc {
+    sdf::Vec3 boundsMin;
+    sdf::Vec3 boundsMax;
+    float voxelSize = 1.0f / 64.0f;
+    float band = 2.0f / 64.0f; // extra distance around the surface that still gets bricks
+};
+
+/**
+ * @brief Sample `field` into a brick map, cells and bricks spread over `pool`.
+ * The field must be 1-Lipschitz (a true distance or a bound) for the occupancy test
+ * to be conservative. Throws std::runtime_error if the atlas would not fit in a
+ * 4096x4096 texture (the smallest maxImageDimension2D Vulkan allows).
+ */
+BrickMap bakeBrickMap(WorkStealingPool& pool, const std::function<float(sdf::Vec3)>& field,
+                      const BrickMapDesc& desc);
+
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
@@ -0,0 +1,44 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : Compute pipeline factory sharing the persistent pipeline cache
+ * @FilePath     : ComputePipeline.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <EasyVulkan/DataStructures.hpp>
+
+#include <vector>
+
+struct ComputePipelineDesc {
+    VkShaderModule computeShader = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    std::vector<VkPushConstantRange> pushConstantRanges;
+};
+
+/**
+ * @brief Build a compute pipeline through `cache` (may be VK_NULL_HANDLE).
+ * The caller owns the returned pipeline and `*outLayout`, like createFullscreenPipeline().
+ */
+VkPipeline createComputePipeline(VkDevice device,
+                                 VkPipelineCache cache,
+                                 const ComputePipelineDesc& desc,
+                                 VkPipelineLayout* outLayout);
+
+/**
+ * @brief Workgroups needed to cover `size` invocations with groups of `groupSize`.
+ */
+inline uint32_t dispatchGroupCount(uint32_t size, uint32_t groupSize) {
+    return (size + groupSize - 1) / groupSize;
+}
+
+/**
+ * @brief Layout transition plus execution dependency for a single-mip colour
+ * image that a compute pass writes (or a later pass reads).
+ */
+void imageBarrier(VkCommandBuffer cmd, VkImage image,
+                  VkImageLayout oldLayout, VkImageLayout newLayout,
+                  VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                  VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
@@ -0,0 +1,198 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : SIMD packet port of the 2D scene's sceneDist() and soft-shadow cone march
+ * @FilePath     : ConeShadow2D.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "PacketRayMarcher.hpp"
+#include "SDF2DScene.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+/**
+ * @brief Uniform-only geometry of sceneDist() in sdf2d_scene.glsl: a circle and a
+ * rounded box, smooth-merged when their surfaces come close.
+ * flamePerturbation() is the identity in the shader and is omitted.
+ */
+struct ShadowScene2D {
+    float circleCenter[2] = {};
+    float circleRadius = 35.0f;
+    float rectCenter[2] = {};
+    float rectHalfSize[2] = {80.0f, 250.0f};
+    float rectCornerRadius = 5.0f;
+};
+
+ShadowScene2D makeShadowScene2D(const ShaderToyUniforms& uniforms);
+
+/**
+ * @brief Pixels (structure of arrays) shaded against one light; `visibility`
+ * receives shadow() of sdf2dCircleRect.frag for each.
+ */
+struct ShadowBatch2D {
+    const float* px = nullptr;
+    const float* py = nullptr;
+    float* visibility = nullptr;
+    size_t count = 0;
+    float lightX = 0.0f;
+    float lightY = 0.0f;
+    float lightRadius = 0.0f;
+};
+
+/**
+ * @brief Run shadow() for every pixel of `batch`, `getSimdLaneCount(level)` at a time.
+ * All kernels evaluate the same operation sequence (cone_shadow::shadowPacket), so
+ * with FP contraction disabled (see CMakeLists.txt) they agree bit for bit.
+ */
+void coneShadows(SimdLevel level, const ShadowScene2D& scene, const ShadowBatch2D& batch);
+
+// Per-ISA kernels, one translation unit each under src/simd/. A kernel whose
+// instruction set was not enabled at compile time does nothing and returns false.
+bool coneShadowsScalar(const ShadowScene2D& scene, const ShadowBatch2D& batch);
+bool coneShadowsSSE4(const ShadowScene2D& scene, const ShadowBatch2D& batch);
+bool coneShadowsAVX2(const ShadowScene2D& scene, const ShadowBatch2D& batch);
+bool coneShadowsAVX512(const ShadowScene2D& scene, const ShadowBatch2D& batch);
+
+namespace cone_shadow {
+
+// Constants of shadow() in sdf2dCircleRect.frag and sceneDist() in sdf2d_scene.glsl
+constexpr int MAX_STEPS = 64;
+constexpr float START_DT = 0.01f;
+constexpr float BLEND_RADIUS = 200.0f;
+
+/**
+ * @brief Lane operations the kernels are written against; one struct per ISA
+ * (V = float vector, M = lane mask). min/max follow the x86 operand order
+ * (a < b ? a : b), so the scalar lanes match the vector ones exactly.
+ */
+struct ScalarLanes {
+    using V = float;
+    using M = bool;
+    static constexpr size_t kLanes = 1;
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V v) { *p = v; }
+    static V set1(float x) { return x; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V min(V a, V b) { return a < b ? a : b; }
+    static V max(V a, V b) { return a > b ? a : b; }
+    static V sqrt(V a) { return std::sqrt(a); }
+    static V abs(V a) { return std::fabs(a); }
+    static M lt(V a, V b) { return a < b; }
+    static M gt(V a, V b) { return a > b; }
+    static M all() { return true; }
+    static M none() { return false; }
+    static M maskAnd(M a, M b) { return a && b; }
+    static M maskOr(M a, M b) { return a || b; }
+    static M maskAndNot(M a, M b) { return !a && b; }
+    static bool any(M m) { return m; }
+    static V select(M m, V a, V b) { return m ? a : b; }
+};
+
+/**
+ * @brief sceneDist() of sdf2d_scene.glsl, operation for operation.
+ */
+template <typename L>
+typename L::V sceneDistance(const ShadowScene2D& s, typename L::V px, typename L::V py) {
+    using V = typename L::V;
+    const V zero = L::set1(0.0f);
+
+    V cx = L::sub(px, L::set1(s.circleCenter[0]));
+    V cy = L::sub(py, L::set1(s.circleCenter[1]));
+    V circle = L::sub(L::sqrt(L::add(L::mul(cx, cx), L::mul(cy, cy))), L::set1(s.circleRadius));
+
+    // boxDist(): size -= radius; d = abs(p) - size; min(max(d.x, d.y), 0) + length(max(d, 0)) - radius
+    V qx = L::sub(L::abs(L::sub(px, L::set1(s.rectCenter[0]))), L::set1(s.rectHalfSize[0] - s.rectCornerRadius));
+    V qy = L::sub(L::abs(L::sub(py, L::set1(s.rectCenter[1]))), L::set1(s.rectHalfSize[1] - s.rectCornerRadius));
+    V ox = L::max(qx, zero);
+    V oy = L::max(qy, zero);
+    V rect = L::sub(L::add(L::min(L::max(qx, qy), zero), L::sqrt(L::add(L::mul(ox, ox), L::mul(oy, oy)))),
+                    L::set1(s.rectCornerRadius));
+
+    // smoothMerge(circle, rect, k) while the surfaces are within BLEND_RADIUS, else min()
+    V surfaceDistance = L::add(circle, rect);
+    V k = L::mul(L::set1(100.0f), L::sub(L::set1(1.0f), L::div(surfaceDistance, L::set1(BLEND_RADIUS))));
+    V h = L::div(L::mul(L::set1(0.5f), L::sub(rect, circle)), k);
+    h = L::min(L::max(L::add(L::set1(0.5f), h), zero), L::set1(1.0f));
+    V oneMinusH = L::sub(L::set1(1.0f), h);
+    V smooth = L::sub(L::add(L::mul(rect, oneMinusH), L::mul(circle, h)), L::mul(L::mul(k, h), oneMinusH));
+    return L::select(L::lt(surfaceDistance, L::set1(BLEND_RADIUS)), smooth, L::min(circle, rect));
+}
+
+/**
+ * @brief shadow(p, pos, radius) for L::kLanes pixels. Lanes that are fully
+ * blocked or reach the light are masked off; the packet stops once none is left.
+ */
+template <typename L>
+void shadowPacket(const ShadowScene2D& s, const ShadowBatch2D& batch, const float* pxIn, const float* pyIn, float* out) {
+    using V = typename L::V;
+    using M = typename L::M;
+    const V zero = L::set1(0.0f);
+    const V one = L::set1(1.0f);
+    const V px = L::load(pxIn);
+    const V py = L::load(pyIn);
+    const V radius = L::set1(batch.lightRadius);
+    const V negRadius = L::set1(-batch.lightRadius);
+
+    V tx = L::sub(L::set1(batch.lightX), px);
+    V ty = L::sub(L::set1(batch.lightY), py);
+    V dl = L::sqrt(L::add(L::mul(tx, tx), L::mul(ty, ty)));
+    V dirX = L::div(tx, dl);
+    V dirY = L::div(ty, dl);
+
+    V lf = L::mul(radius, dl);
+    V dt = L::set1(START_DT);
+    M active = L::all();
+    M blocked = L::none();
+    for (int i = 0; i < MAX_STEPS; ++i) {
+        V sd = sceneDistance<L>(s, L::add(px, L::mul(dirX, dt)), L::add(py, L::mul(dirY, dt)));
+        M full = L::maskAnd(active, L::lt(sd, negRadius));
+        blocked = L::maskOr(blocked, full);
+        active = L::maskAndNot(full, active);
+        lf = L::select(active, L::min(L::div(sd, dt), lf), lf);
+        dt = L::select(active, L::add(dt, L::max(L::abs(sd), one)), dt);
+        active = L::maskAndNot(L::gt(dt, dl), active);
+        if (!L::any(active)) {
+            break;
+        }
+    }
+
+    lf = L::div(L::add(L::mul(lf, dl), radius), L::mul(L::set1(2.0f), radius));
+    lf = L::min(L::max(lf, zero), one);
+    V visibility = L::mul(L::mul(lf, lf), L::sub(L::set1(3.0f), L::mul(L::set1(2.0f), lf)));
+    L::store(out, L::select(blocked, zero, visibility));
+}
+
+/**
+ * @brief shadowPacket() over a whole batch; the last partial packet is padded
+ * by repeating the last pixel.
+ */
+template <typename L>
+void shadeBatch(const ShadowScene2D& scene, const ShadowBatch2D& batch) {
+    constexpr size_t Lanes = L::kLanes;
+    size_t i = 0;
+    for (; i + Lanes <= batch.count; i += Lanes) {
+        shadowPacket<L>(scene, batch, batch.px + i, batch.py + i, batch.visibility + i);
+    }
+    if (i == batch.count) {
+        return;
+    }
+    alignas(64) float tail[3][Lanes];
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+        size_t src = i + lane < batch.count ? i + lane : batch.count - 1;
+        tail[0][lane] = batch.px[src];
+        tail[1][lane] = batch.py[src];
+    }
+    shadowPacket<L>(scene, batch, tail[0], tail[1], tail[2]);
+    for (size_t lane = 0; i + lane < batch.count; ++lane) {
+        batch.visibility[i + lane] = tail[2][lane];
+    }
+}
+
+} // namespace cone_shadow
@@ -0,0 +1,189 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Multithreaded CPU port of the Cornell scene shaders (reference renderer)
+ * @FilePath     : CpuCornellRenderer.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "PacketRayMarcher.hpp"
+#include "PPMImage.hpp"
+#include "RSMPyramid.hpp"
+#include "RSMUpdateScheduler.hpp"
+#include "RunOptions.hpp"
+#include "SDFCornellScene.hpp"
+#include "SDFMath.hpp"
+#include "VplClusters.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Linear-space RGB texture sampled like a VK_FILTER_LINEAR sampler.
+ */
+class CpuTexture {
+public:
+    /**
+     * @brief Load an 8-bit sRGB image and decode it to linear, as an _SRGB format would.
+     * Falls back to a grey checkerboard (with a warning) when the file cannot be decoded.
+     */
+    static CpuTexture loadSRGB(const std::string& path);
+
+    void resize(uint32_t width, uint32_t height);
+    sdf::Vec3& at(uint32_t x, uint32_t y) { return texels[static_cast<size_t>(y) * width + x]; }
+    const sdf::Vec3& at(uint32_t x, uint32_t y) const { return texels[static_cast<size_t>(y) * width + x]; }
+
+    sdf::Vec3 sampleRepeat(sdf::Vec2 uv) const { return sample(uv, true); }
+    sdf::Vec3 sampleClamp(sdf::Vec2 uv) const { return sample(uv, false); }
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+
+private:
+    sdf::Vec3 sample(sdf::Vec2 uv, bool repeat) const;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<sdf::Vec3> texels;
+};
+
+/**
+ * @brief CPU copy of what rsm_pyramid.comp builds from the RSM: the flux
+ * luminance pyramid and the per-cluster normal cones and bounding spheres
+ * (see RSMPyramidLayout).
+ */
+struct CpuRSMPyramid {
+    struct Cluster {
+        sdf::Vec3 axis{0.0f, 0.0f, 1.0f};
+        float cosAngle = -1.0f; // every VPL normal n has dot(axis, n) >= cosAngle
+        sdf::Vec3 center{0.0f};
+        float radius = -1.0f;   // bounding sphere of the VPL positions; < 0: no VPLs
+    };
+
+    RSMPyramidLayout layout;
+    std::vector<float> atlas; // layout.atlasWidth x layout.atlasHeight, as the R32F image
+    std::vector<Cluster> clusters;
+
+    void build(WorkStealingPool& pool, const CpuTexture& position, const CpuTexture& normal, const CpuTexture& flux);
+    void clear() { layout = RSMPyramidLayout{}; atlas.clear(); clusters.clear(); }
+
+    float node(uint32_t level, uint32_t x, uint32_t y) const {
+        return atlas[static_cast<size_t>(layout.getLevelOriginY(level) + y) * layout.atlasWidth +
+                     layout.getLevelOriginX(level) + x];
+    }
+    const Cluster& cluster(uint32_t x, uint32_t y) const {
+        return clusters[static_cast<size_t>(y) * layout.clusterCount + x];
+    }
+};
+
+/**
+ * @brief CPU copy of the clustered VPL list vpl_cluster.comp keeps (see
+ * VplClusters.hpp); centroids persist between builds like the GPU buffer.
+ */
+struct CpuVplClusters {
+    struct Cluster {
+        sdf::Vec3 position{0.0f}; // flux-weighted centroid
+        float members = 0.0f;     // grid cells assigned (cells: 1, or 0 without flux); 0: empty
+        sdf::Vec3 normal{0.0f, 0.0f, 1.0f};
+        sdf::Vec3 flux{0.0f};     // summed flux of the member texels
+    };
+
+    std::vector<Cluster> clusters;
+    std::vector<Cluster> cells;       // the RSM summed into kVplClusterGridSize^2 cells
+    std::vector<uint32_t> assignment; // per cell, ~0u: no flux or no live cluster
+    uint32_t seededCount = 0;          // cluster count of the last seed; 0: never seeded
+
+    /**
+     * @brief kVplClusterIterations k-means steps from the previous centroids,
+     * reseeding first (through `pyramid`, built from the same RSM) when `count`
+     * differs from the last build.
+     */
+    void build(WorkStealingPool& pool, const CpuRSMPyramid& pyramid, const CpuTexture& position,
+               const CpuTexture& normal, const CpuTexture& flux, uint32_t count);
+    void clear() { clusters.clear(); cells.clear(); assignment.clear(); seededCount = 0; }
+};
+
+/**
+ * @brief Renders the image of sdf_practice.frag (plus the rsm_light.frag pre-pass)
+ * from the same SDFCornellUniforms block the GPU reads.
+ *
+ * The image is split into 16x16 tiles that are scheduled on a WorkStealingPool.
+ * Each tile's primary (and RSM) rays are sphere-traced together by the packet
+ * ray marcher; shading then runs per pixel. Shader functions are ported one to
+ * one in float precision; only uniform-only expressions are hoisted out of the
+ * per-pixel code. Output is sRGB-encoded RGB8
+ * with row 0 at the top, i.e. byte-comparable with a headless --output dump of
+ * the R8G8B8A8_SRGB target.
+ */
+class CpuCornellRenderer {
+public:
+    explicit CpuCornellRenderer(WorkStealingPool& pool);
+
+    void setFlowerTexture(CpuTexture texture) { flowerTexture = std::move(texture); }
+
+    /**
+     * @brief Packet kernel used for primary and RSM rays (default: detectSimdLevel()).
+     */
+    void setSimdLevel(SimdLevel level) { simdLevel = level; }
+    SimdLevel getSimdLevel() const { return simdLevel; }
+
+    /**
+     * @brief Decides when the RSM pre-pass re-runs; by default only when its inputs change.
+     */
+    RSMUpdateScheduler& getRSMScheduler() { return rsmScheduler; }
+
+    void render(const SDFCornellUniforms& uniforms, uint32_t width, uint32_t height, ImageRGB8& out);
+
+private:
+    void renderRSM(const SDFCornellUniforms& uniforms);
+    /**
+     * @brief indirect_temporal.comp: blend indirectRaw into the reprojected history,
+     * dropped unless it was made with the same sampling pattern `key`.
+     */
+    void resolveTemporalIndirect(const SDFCornellUniforms& uniforms, uint32_t key);
+
+    WorkStealingPool& pool;
+    SimdLevel simdLevel;
+    CpuTexture flowerTexture;
+
+    // RSM G-buffer; cleared to zero like the GPU attachments when the pass is disabled,
+    // kept as is while the scheduler reuses it (outside its render rect on partial refreshes)
+    CpuTexture rsmPosition;
+    CpuTexture rsmNormal;
+    CpuTexture rsmFlux;
+    CpuRSMPyramid rsmPyramid;
+    CpuVplClusters vplClusters;
+    bool vplClustersStale = true; // the RSM changed since the last cluster build
+    RSMUpdateScheduler rsmScheduler;
+    double lastRSMMs = 0.0;
+
+    // Indirect pass at 1/divisor of the target, when temporal or reduced: this
+    // frame's taps or gather and hit distances, the resolved irradiance (without
+    // albedo) and the frames behind each texel, which are filtered like the
+    // irradiance when reprojecting
+    CpuTexture indirectRaw;
+    std::vector<float> indirectDepth;
+    CpuTexture indirectAccum;
+    CpuTexture indirectAccumFrames;
+    CpuTexture indirectHistory;
+    CpuTexture indirectHistoryFrames;
+    uint32_t indirectHistoryKey = 0; // sampling pattern the history was made with; 0: none
+    float indirectHistorySphereCenters[2][4] = {};
+
+    // ReSTIR reservoirs per pass texel: this frame's, after temporal reuse, and the last frame's
+    std::vector<GpuRestirReservoir> restirReservoirs;
+    std::vector<GpuRestirReservoir> restirPrevious;
+    bool restirValid = false;      // restirReservoirs were written last frame
+    uint32_t restirRSMSize = 0;    // RSM width their texel indices refer to
+    float restirSphereCenters[2][4] = {};
+};
+
+/**
+ * @brief --cpu-reference entry point: render, time, optionally save and compare.
+ * Returns the process exit code.
+ */
+int runCornellCpuReference(const RunOptions& options);
@@ -0,0 +1,53 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : Multithreaded CPU port of the 2D scene shader (reference renderer)
+ * @FilePath     : CpuSDF2DRenderer.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "PacketRayMarcher.hpp"
+#include "PPMImage.hpp"
+#include "RunOptions.hpp"
+#include "SDF2DScene.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <vector>
+
+/**
+ * @brief Renders the image of sdf2dCircleRect.frag from the same uniform block and
+ * light list the GPU reads.
+ *
+ * This is the exact path of the shader: analytic sceneDist() and the 64-step cone
+ * march, i.e. the GPU with "Baked Distance Texture" and "Polar Shadow Maps" off.
+ * The image is split into 16x16 tiles scheduled on a WorkStealingPool. Per light,
+ * a tile gathers the pixels within the light's range and runs the cone march on
+ * them with the SIMD kernel; everything else is per pixel. Lights are summed in
+ * list order like the shader. Output is UNORM RGB8 with row 0 at the top, i.e.
+ * comparable with a headless --output dump of the 2D scene.
+ */
+class CpuSDF2DRenderer {
+public:
+    explicit CpuSDF2DRenderer(WorkStealingPool& pool);
+
+    /**
+     * @brief Cone shadow kernel (default: detectSimdLevel()).
+     */
+    void setSimdLevel(SimdLevel level) { simdLevel = level; }
+    SimdLevel getSimdLevel() const { return simdLevel; }
+
+    void render(const ShaderToyUniforms& uniforms, const std::vector<Light2DGpu>& lights,
+                uint32_t width, uint32_t height, ImageRGB8& out);
+
+private:
+    WorkStealingPool& pool;
+    SimdLevel simdLevel;
+};
+
+/**
+ * @brief --cpu-reference entry point for the 2D scene: render, time, optionally
+ * save and compare. Returns the process exit code.
+ */
+int runSDF2DCpuReference(const RunOptions& options);
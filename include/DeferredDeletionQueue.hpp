@@ -0,0 +1,63 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 18:00:00
+ * @Description  : Destroys GPU resources once the last frame that may use them has retired
+ * @FilePath     : DeferredDeletionQueue.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Fence-tracked replacement for vkDeviceWaitIdle() before freeing resources.
+ *
+ * Every submitted frame gets a serial. A deleter queued with defer() belongs to
+ * the latest submitted serial, since any frame up to that one may still reference
+ * the resource. The deleter runs once that frame's in-flight fence has been waited on.
+ * Frames retire in submission order on the single graphics queue, so waiting on
+ * one slot's fence also retires every earlier serial.
+ *
+ * Usage per frame:
+ *   vkWaitForFences(..., inFlight[frame], ...);
+ *   deletionQueue.onFenceWaited(frame);   // runs deleters that are now safe
+ *   ... replace resources, deletionQueue.defer([=]{ destroy old ones; }) ...
+ *   vkQueueSubmit(..., inFlight[frame]);
+ *   deletionQueue.onSubmit(frame);
+ */
+class DeferredDeletionQueue {
+public:
+    void create(uint32_t framesInFlight);
+
+    /**
+     * @brief Queue `deleter` until every frame submitted so far has retired.
+     */
+    void defer(std::function<void()> deleter);
+
+    void onSubmit(uint32_t frameIndex);
+    void onFenceWaited(uint32_t frameIndex);
+
+    /**
+     * @brief Run every pending deleter. Only call once the device is idle.
+     */
+    void flush();
+
+    size_t getPendingCount() const { return pending.size(); }
+
+private:
+    struct Entry {
+        uint64_t lastUseSerial;
+        std::function<void()> deleter;
+    };
+
+    void collect();
+
+    std::vector<uint64_t> slotSerials; // serial last submitted with each frame slot's fence
+    uint64_t submittedSerial = 0;
+    uint64_t completedSerial = 0;
+    std::deque<Entry> pending; // sorted by lastUseSerial
+};
@@ -0,0 +1,73 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 13:00:00
+ * @Description  : Bounded frame-time statistics with percentiles and background reporting
+ * @FilePath     : FrameStats.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size ring buffer of frame times (ms).
+ *
+ * addSample() is O(1) and never allocates, so it is safe to call every frame for
+ * arbitrarily long runs. Percentiles are computed over the most recent
+ * `capacity` samples, on a copy, outside the render thread's critical path.
+ */
+class FrameStats {
+public:
+    struct Summary {
+        uint64_t totalFrames = 0; // all frames seen (including warm-up)
+        size_t windowSize = 0;    // samples the statistics below are computed from
+        double minMs = 0.0;
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    explicit FrameStats(size_t capacity = 4096, uint32_t warmupFrames = 2);
+    ~FrameStats();
+
+    FrameStats(const FrameStats&) = delete;
+    FrameStats& operator=(const FrameStats&) = delete;
+
+    void addSample(double frameMs);
+    Summary summarize() const;
+
+    /**
+     * @brief Print a summary every `interval` from a background thread.
+     */
+    void startReporter(std::chrono::milliseconds interval, std::ostream& os);
+    void stopReporter();
+
+    void writeJson(const std::string& path) const;
+
+    static void printSummary(std::ostream& os, const Summary& summary);
+
+private:
+    void reporterLoop(std::chrono::milliseconds interval, std::ostream* os);
+
+    mutable std::mutex mutex;
+    std::vector<double> samples; // ring storage, fixed capacity
+    size_t next = 0;
+    size_t count = 0;
+    uint64_t totalFrames = 0;
+    uint32_t warmupFrames = 0;
+
+    std::thread reporter;
+    std::mutex reporterMutex;
+    std::condition_variable reporterWake;
+    bool reporterStop = false;
+};
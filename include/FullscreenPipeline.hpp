@@ -0,0 +1,44 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 14:00:00
+ * @Description  : Graphics pipeline factory for the fullscreen-quad passes
+ * @FilePath     : FullscreenPipeline.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <EasyVulkan/DataStructures.hpp>
+
+#include <vector>
+
+/**
+ * @brief Everything that differs between the fullscreen passes of the scenes.
+ *
+ * The fixed state matches what the scenes used to configure on
+ * ev::GraphicsPipelineBuilder: triangle strip, dynamic viewport/scissor,
+ * no culling, no depth test and no blending on every color attachment.
+ */
+struct FullscreenPipelineDesc {
+    VkShaderModule vertexShader = VK_NULL_HANDLE;
+    VkShaderModule fragmentShader = VK_NULL_HANDLE;
+    VkVertexInputBindingDescription vertexBinding{};
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+    uint32_t colorAttachmentCount = 1;
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    const VkSpecializationInfo* fragmentSpecialization = nullptr; // must outlive the call
+};
+
+/**
+ * @brief Build a fullscreen pipeline through `cache` (may be VK_NULL_HANDLE).
+ *
+ * EasyVulkan's builder always passes a null VkPipelineCache, so pipelines that
+ * should benefit from the on-disk cache are created here instead. The caller owns
+ * the returned pipeline and `*outLayout` and destroys them with the device.
+ */
+VkPipeline createFullscreenPipeline(VkDevice device,
+                                    VkPipelineCache cache,
+                                    const FullscreenPipelineDesc& desc,
+                                    VkPipelineLayout* outLayout);
@@ -0,0 +1,113 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 12:00:00
+ * @Description  : Timestamp-query GPU profiler with named scopes
+ * @FilePath     : GpuProfiler.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <EasyVulkan/Core/VulkanDevice.hpp>
+#include <EasyVulkan/DataStructures.hpp>
+
+#include <array>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Measures GPU time of named command buffer scopes with timestamp queries.
+ *
+ * There is one query pool per frame in flight. beginFrame() is called at the
+ * start of a frame's command buffer, after that frame's fence was waited on, so
+ * the results written the last time this slot was used are already available
+ * and are read without VK_QUERY_RESULT_WAIT_BIT: the profiler never stalls.
+ *
+ *   gpuProfiler.beginFrame(cmd, currentFrame);
+ *   gpuProfiler.beginScope(cmd, "Main");
+ *   ... draw ...
+ *   gpuProfiler.endScope(cmd);
+ */
+class GpuProfiler {
+public:
+    struct ScopeStats {
+        std::string name;
+        double lastMs = 0.0;
+        double averageMs = 0.0; // mean over the last kHistorySize samples
+    };
+
+    void create(ev::VulkanDevice* device, uint32_t framesInFlight, uint32_t maxScopesPerFrame = 16);
+    void destroy();
+
+    /**
+     * @brief Stream every resolved scope as "frame,scope,gpu_ms" rows.
+     */
+    void openCsv(const std::string& path);
+
+    void beginFrame(VkCommandBuffer cmd, uint32_t frameIndex);
+    void beginScope(VkCommandBuffer cmd, const char* name);
+    void endScope(VkCommandBuffer cmd);
+
+    /**
+     * @brief Read back every outstanding frame. Only call once the device is idle.
+     */
+    void resolveAll();
+
+    bool isEnabled() const { return enabled; }
+    const std::vector<ScopeStats>& getStats() const { return stats; }
+
+    /**
+     * @brief Draw per-scope GPU times into the current ImGui window.
+     */
+    void drawImGui() const;
+
+    /**
+     * @brief Print average per-scope GPU times, e.g. at the end of a headless run.
+     */
+    void printSummary(std::ostream& os) const;
+
+private:
+    static constexpr size_t kHistorySize = 64;
+
+    struct PendingScope {
+        uint32_t statIndex = 0;
+        uint32_t beginQuery = 0;
+        uint32_t endQuery = 0;
+    };
+
+    struct FrameSlot {
+        VkQueryPool pool = VK_NULL_HANDLE;
+        std::vector<PendingScope> scopes;
+        std::vector<uint32_t> openScopes; // stack of indices into scopes
+        uint32_t queryCount = 0;
+        uint64_t frameSerial = 0;
+        bool submitted = false;
+    };
+
+    struct History {
+        std::array<double, kHistorySize> samples{};
+        size_t count = 0;
+        size_t next = 0;
+        double sum = 0.0;
+    };
+
+    void collect(FrameSlot& slot);
+    uint32_t findOrAddScope(const char* name);
+
+    ev::VulkanDevice* device = nullptr;
+    bool enabled = false;
+    double timestampPeriodNs = 1.0;
+    uint64_t timestampMask = ~0ull;
+    uint32_t maxQueries = 0;
+
+    std::vector<FrameSlot> slots;
+    FrameSlot* currentSlot = nullptr;
+    uint64_t frameSerial = 0;
+
+    std::vector<ScopeStats> stats;
+    std::vector<History> histories;
+
+    std::ofstream csv;
+};
@@ -0,0 +1,58 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 10:00:00
+ * @Description  : Offscreen color targets used instead of the swapchain in headless mode
+ * @FilePath     : OffscreenTarget.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <EasyVulkan/Core/VulkanDevice.hpp>
+#include <EasyVulkan/Core/ResourceManager.hpp>
+#include <EasyVulkan/DataStructures.hpp>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief A small set of color images that stand in for swapchain images.
+ *
+ * Images are created through the ResourceManager so they are released together
+ * with the rest of the context. The render pass that draws into them is expected
+ * to leave them in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL so they can be read back.
+ */
+class OffscreenTarget {
+public:
+    void create(ev::ResourceManager* resourceManager,
+                const std::string& name,
+                uint32_t count,
+                uint32_t width,
+                uint32_t height,
+                VkFormat format);
+
+    /**
+     * @brief Ask GLFW for its null platform so EasyVulkan can create its window
+     * without a display server. Must be called before the context initializes GLFW.
+     */
+    static void selectHeadlessPlatform();
+
+    const std::vector<VkImage>& getImages() const { return images; }
+    const std::vector<VkImageView>& getImageViews() const { return imageViews; }
+    VkExtent2D getExtent() const { return extent; }
+    VkFormat getFormat() const { return format; }
+
+    /**
+     * @brief Copy image `index` to host memory and write it as a binary PPM (P6).
+     * Blocks until the copy has finished; only meant for the end of a headless run.
+     */
+    void writePPM(ev::VulkanDevice* device, VkCommandPool commandPool,
+                  uint32_t index, const std::string& path) const;
+
+private:
+    std::vector<VkImage> images;
+    std::vector<VkImageView> imageViews;
+    std::vector<VmaAllocation> allocations;
+    VkExtent2D extent{0, 0};
+    VkFormat format = VK_FORMAT_UNDEFINED;
+};
@@ -0,0 +1,40 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Binary PPM (P6) read/write and image comparison for golden-image checks
+ * @FilePath     : PPMImage.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Tightly packed 8-bit RGB image, row 0 at the top.
+ */
+struct ImageRGB8 {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+struct ImageDiff {
+    double rmse = 0.0;       // over all channels, in 8-bit units
+    double psnrDb = 0.0;     // infinity when identical
+    int maxAbsDiff = 0;      // largest per-channel difference
+};
+
+void writePPM(const std::string& path, const ImageRGB8& image);
+
+/**
+ * @brief Read a P6 file with maxval 255. Throws std::runtime_error on anything else.
+ */
+ImageRGB8 readPPM(const std::string& path);
+
+/**
+ * @brief Compare two images of the same size. Throws if the sizes differ.
+ */
+ImageDiff compareImages(const ImageRGB8& a, const ImageRGB8& b);
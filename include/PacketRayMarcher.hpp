@@ -0,0 +1,129 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 16:00:00
+ * @Description  : SIMD packet sphere tracing of the Cornell scene with runtime ISA dispatch
+ * @FilePath     : PacketRayMarcher.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "RunOptions.hpp"
+#include "SDFCornellScene.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+/**
+ * @brief Instruction sets with a packet kernel, in increasing preference.
+ * Scalar is always available; the others need both a kernel compiled with the
+ * matching flags (see CMakeLists.txt) and a CPU/OS that supports them.
+ */
+enum class SimdLevel { Scalar, SSE4, AVX2, AVX512 };
+
+const char* toString(SimdLevel level);
+
+/**
+ * @brief Parse "auto", "scalar", "sse4", "avx2" or "avx512". "auto" picks
+ * detectSimdLevel(); an explicit level that is unavailable throws std::runtime_error.
+ */
+SimdLevel parseSimdLevel(std::string_view name);
+
+/**
+ * @brief Rays stepped together: 1, 4, 8 or 16.
+ */
+unsigned getSimdLaneCount(SimdLevel level);
+
+bool isSimdLevelAvailable(SimdLevel level);
+
+/**
+ * @brief Best level this build and this machine can run.
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * @brief Uniform-only geometry of sceneSDF(): two unit spheres orbiting the
+ * z axis plus the five fixed planes of the box.
+ *
+ * The per-sphere local rotation of the shaders is dropped: a rotation cannot
+ * change |p - c|, so the distance field is the same up to rounding.
+ */
+struct PacketMarchScene {
+    float sphereCenters[2][3] = {};
+    float sphereRadius = 1.0f;
+};
+
+PacketMarchScene makePacketMarchScene(const SDFCornellUniforms& uniforms);
+
+/**
+ * @brief Structure-of-arrays ray input; `t` receives the marched distance
+ * (>= MAX_DIST means a miss), exactly like rayMarch() in the shaders.
+ */
+struct RayBatch {
+    const float* originX = nullptr;
+    const float* originY = nullptr;
+    const float* originZ = nullptr;
+    const float* dirX = nullptr;
+    const float* dirY = nullptr;
+    const float* dirZ = nullptr;
+    float* t = nullptr;
+    size_t count = 0;
+};
+
+// Constants of rayMarch() in sdf_practice.frag / rsm_light.frag
+namespace packet_march {
+constexpr float MAX_DIST = 100.0f;
+constexpr int MAX_STEPS = 128;
+constexpr float SURF_DIST = 0.006f;
+constexpr float MIN_STEP = 0.003f;
+
+/**
+ * @brief Call marchPacket(ox, oy, oz, dx, dy, dz, t) on every run of `Lanes` rays.
+ * The final partial run goes through a local buffer padded by repeating the
+ * last ray, so kernels only ever see full packets (with unaligned pointers).
+ */
+template <size_t Lanes, typename PacketFn>
+void forEachPacket(const RayBatch& rays, PacketFn&& marchPacket) {
+    size_t i = 0;
+    for (; i + Lanes <= rays.count; i += Lanes) {
+        marchPacket(rays.originX + i, rays.originY + i, rays.originZ + i,
+                    rays.dirX + i, rays.dirY + i, rays.dirZ + i, rays.t + i);
+    }
+    if (i == rays.count) {
+        return;
+    }
+    alignas(64) float tail[7][Lanes];
+    const float* inputs[6] = {rays.originX, rays.originY, rays.originZ, rays.dirX, rays.dirY, rays.dirZ};
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+        size_t src = i + lane < rays.count ? i + lane : rays.count - 1;
+        for (int c = 0; c < 6; ++c) {
+            tail[c][lane] = inputs[c][src];
+        }
+    }
+    marchPacket(tail[0], tail[1], tail[2], tail[3], tail[4], tail[5], tail[6]);
+    for (size_t lane = 0; i + lane < rays.count; ++lane) {
+        rays.t[i + lane] = tail[6][lane];
+    }
+}
+} // namespace packet_march
+
+/**
+ * @brief Sphere-trace every ray of `rays`, `getSimdLaneCount(level)` at a time.
+ * Lanes that hit or leave the scene are masked off; a packet stops as soon as
+ * no lane is active. Any count is accepted: the last partial packet is padded.
+ */
+void marchRays(SimdLevel level, const PacketMarchScene& scene, const RayBatch& rays);
+
+/**
+ * @brief --bench-raymarch entry point: primary rays of the Cornell camera at
+ * --width x --height, marched by every available level, single-threaded and on
+ * all cores. Prints rays per second (per core) and the speedup over scalar.
+ */
+int runRayMarchBenchmark(const RunOptions& options);
+
+// Per-ISA kernels, one translation unit each under src/simd/. A kernel whose
+// instruction set was not enabled at compile time does nothing and returns false.
+bool marchRaysScalar(const PacketMarchScene& scene, const RayBatch& rays);
+bool marchRaysSSE4(const PacketMarchScene& scene, const RayBatch& rays);
+bool marchRaysAVX2(const PacketMarchScene& scene, const RayBatch& rays);
+bool marchRaysAVX512(const PacketMarchScene& scene, const RayBatch& rays);
@@ -0,0 +1,89 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 22:00:00
+ * @Description  : Worker threads that build pipelines off the render thread
+ * @FilePath     : PipelineBuildService.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <EasyVulkan/DataStructures.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A pipeline and its layout as built by a PipelineBuildService job.
+ */
+struct BuiltPipeline {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    double buildMs = 0.0; // time the job ran on its worker
+};
+
+/**
+ * @brief Runs pipeline builds (createFullscreenPipeline / createComputePipeline
+ * calls) on a few worker threads so the driver compile never blocks a frame.
+ *
+ * Jobs must only read state that stays fixed while they run (shader modules,
+ * layouts, render passes). VkPipelineCache is internally synchronized, so all
+ * jobs may share the scene's cache. Shader modules come from the
+ * ResourceManager, which is not thread-safe: load them before submitting.
+ */
+class PipelineBuildService {
+public:
+    using BuildFunction = std::function<BuiltPipeline()>;
+
+    PipelineBuildService() = default;
+    ~PipelineBuildService() { destroy(); }
+
+    PipelineBuildService(const PipelineBuildService&) = delete;
+    PipelineBuildService& operator=(const PipelineBuildService&) = delete;
+
+    /**
+     * @brief Start `threadCount` workers; 0 picks half the cores, between 1 and 4.
+     */
+    void create(unsigned threadCount = 0);
+
+    /**
+     * @brief Wait for the running jobs and stop the workers. Jobs that never
+     * started resolve to null handles, so every future can still be collected.
+     * Safe to call twice; the destructor calls it too.
+     */
+    void destroy();
+
+    /**
+     * @brief Queue a build. `urgent` jobs (a pipeline the next frame wants) go ahead
+     * of precompilation. A job that throws rethrows from the future's get().
+     */
+    std::future<BuiltPipeline> submit(BuildFunction build, bool urgent = false);
+
+    /** @brief Non-blocking: true when get() on `build` will not wait. */
+    static bool isReady(const std::future<BuiltPipeline>& build) {
+        return build.valid() && build.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    size_t getQueuedCount() const;
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct Job {
+        BuildFunction build;
+        std::promise<BuiltPipeline> result;
+    };
+
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> queue;
+    bool stopping = false;
+};
@@ -0,0 +1,52 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 14:00:00
+ * @Description  : VkPipelineCache persisted to disk between launches
+ * @FilePath     : PipelineCache.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <EasyVulkan/Core/VulkanDevice.hpp>
+#include <EasyVulkan/DataStructures.hpp>
+
+#include <string>
+
+/**
+ * @brief A VkPipelineCache that is loaded from a file at startup and written back at shutdown.
+ *
+ * The file starts with our own header (vendor/device ID, driver version, cache UUID,
+ * payload size and FNV-1a hash) followed by the blob from vkGetPipelineCacheData.
+ * Anything that does not match the current device and driver, or fails the hash,
+ * is ignored and the cache starts empty: a stale file only costs a cold start.
+ * Saving writes a temporary file and renames it, so a crash never leaves a torn cache.
+ */
+class PipelineCache {
+public:
+    /**
+     * @brief Create the cache, seeded from `path` when that file is valid.
+     * An empty path gives an in-memory cache that is never saved.
+     */
+    void create(ev::VulkanDevice* device, const std::string& path);
+    void destroy();
+
+    /**
+     * @brief Write the current cache contents to disk. Never throws; failures are logged.
+     */
+    void save() const;
+
+    VkPipelineCache get() const { return cache; }
+
+    /**
+     * @brief True when the cache was seeded from a valid file (warm launch).
+     */
+    bool isWarm() const { return warm; }
+
+private:
+    ev::VulkanDevice* device = nullptr;
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties properties{};
+    std::string path;
+    bool warm = false;
+};
@@ -0,0 +1,108 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 21:00:00
+ * @Description  : SAH bounding volume hierarchy over SDF primitive bounds
+ * @FilePath     : PrimitiveBVH.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "SDFMath.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+struct Aabb3 {
+    sdf::Vec3 min{std::numeric_limits<float>::max()};
+    sdf::Vec3 max{-std::numeric_limits<float>::max()};
+
+    void grow(const Aabb3& other) {
+        min = sdf::min(min, other.min);
+        max = sdf::max(max, other.max);
+    }
+    bool isEmpty() const { return min.x > max.x; }
+    sdf::Vec3 getCenter() const { return (min + max) * 0.5f; }
+    float getSurfaceArea() const;
+    /** @brief Distance from p to the box, 0 inside. A lower bound for anything it contains. */
+    float distanceTo(sdf::Vec3 p) const;
+};
+
+/**
+ * @brief One node as the shader reads it (std430, 32 bytes). Interior nodes
+ * (count == 0) have their children at leftOrFirst and leftOrFirst + 1; leaves
+ * cover getPrimitiveOrder()[leftOrFirst, leftOrFirst + count).
+ */
+struct BvhNodeGpu {
+    float boundsMin[3];
+    uint32_t leftOrFirst;
+    float boundsMax[3];
+    uint32_t count;
+};
+
+/**
+ * @brief Binary BVH built with the surface area heuristic over per-primitive
+ * bounds. Node 0 is the root and children always follow their parent, so a
+ * reverse sweep refits the tree bottom-up when primitives move.
+ */
+class PrimitiveBVH {
+public:
+    static constexpr uint32_t kMaxLeafSize = 4;
+    static constexpr uint32_t kMaxDepth = 32; // traversal stack size in sdf3d.frag
+
+    /** @brief Rebuild from scratch. Throws std::runtime_error if the tree would exceed kMaxDepth. */
+    void build(const std::vector<Aabb3>& primitiveBounds);
+
+    /**
+     * @brief Keep the topology and recompute every node's bounds. Cheap, but the
+     * tree degrades if primitives move far from where it was built.
+     */
+    void refit(const std::vector<Aabb3>& primitiveBounds);
+
+    const std::vector<BvhNodeGpu>& getNodes() const { return nodes; }
+    /** @brief Primitive indices in leaf order; the GPU primitive buffer is uploaded in this order. */
+    const std::vector<uint32_t>& getPrimitiveOrder() const { return order; }
+    Aabb3 getBounds() const;
+    uint32_t getDepth() const { return depth; }
+
+    /**
+     * @brief Calls visit(primitiveIndex) for the primitives of every leaf whose bounds
+     * are closer to p than `bestDistance`, nearer children first. visit() is expected
+     * to lower bestDistance, which prunes the rest of the walk.
+     */
+    template <typename Visit>
+    void traverse(sdf::Vec3 p, const float& bestDistance, Visit&& visit) const {
+        if (nodes.empty()) {
+            return;
+        }
+        uint32_t stack[kMaxDepth + 1];
+        uint32_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const BvhNodeGpu& node = nodes[stack[--top]];
+            if (nodeBounds(node).distanceTo(p) >= bestDistance) {
+                continue;
+            }
+            if (node.count > 0) {
+                for (uint32_t i = 0; i < node.count; ++i) {
+                    visit(order[node.leftOrFirst + i]);
+                }
+                continue;
+            }
+            const uint32_t left = node.leftOrFirst;
+            const bool leftFirst = nodeBounds(nodes[left]).distanceTo(p) <= nodeBounds(nodes[left + 1]).distanceTo(p);
+            stack[top++] = leftFirst ? left + 1 : left;
+            stack[top++] = leftFirst ? left : left + 1;
+        }
+    }
+
+private:
+    static Aabb3 nodeBounds(const BvhNodeGpu& node);
+    static void setNodeBounds(BvhNodeGpu& node, const Aabb3& bounds);
+    void subdivide(uint32_t nodeIndex, const std::vector<Aabb3>& primitiveBounds, uint32_t level);
+
+    std::vector<BvhNodeGpu> nodes;
+    std::vector<uint32_t> order;
+    uint32_t depth = 0;
+};
@@ -0,0 +1,71 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 23:55:00
+ * @Description  : Storage formats of the reflective shadow map attachments
+ * @FilePath     : RSMEncoding.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "SDFMath.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+struct SDFCornellUniforms;
+
+/**
+ * @brief How the three RSM attachments store a texel (shaders/rsm_encoding.glsl
+ * holds the GLSL side; CpuCornellRenderer mirrors the precision loss).
+ *
+ * Full:    RGBA16F world position, RGBA16F normal, RGBA16F flux (24 bytes).
+ * Compact: R16_UNORM depth along the light from its image plane over
+ *          kRSMDepthRange, RG16_SNORM octahedral normal, B10G11R11_UFLOAT flux
+ *          (10 bytes). The position is rebuilt from the texel's place on the
+ *          light's image plane and that depth.
+ *
+ * Depth 0 marks texels whose ray left the scene; they decode to a zero position,
+ * like the cleared Full attachment. Linear filtering of depth yields exactly the
+ * filtered position (the rebuild is affine), except across such silhouettes.
+ */
+enum class RSMEncoding { Full, Compact };
+
+constexpr uint32_t kRSMEncodingCount = 2;
+
+/** @brief Farthest hit the Compact depth can hold; farther hits are stored as misses. */
+constexpr float kRSMDepthRange = 32.0f;
+
+const char* toString(RSMEncoding encoding);
+
+/**
+ * @brief Parse "full" or "compact"; throws std::runtime_error otherwise.
+ */
+RSMEncoding parseRSMEncoding(std::string_view name);
+
+/** @brief Bytes of all three attachments per RSM texel. */
+uint32_t getRSMBytesPerTexel(RSMEncoding encoding);
+
+/**
+ * @brief Light camera the RSM is rendered with, as rsm_encoding.glsl decodes
+ * it; also the push constant header of rsm_pyramid.comp and vpl_cluster.comp.
+ */
+struct RSMLightFrame {
+    float origin[4] = {}; // xyz image plane centre, w 1 for the Compact encoding
+    float right[4] = {};  // xyz, w ortho half width
+    float up[4] = {};     // xyz, w ortho half height
+    float dir[4] = {};    // xyz unit direction the light travels
+
+    static RSMLightFrame fromUniforms(const SDFCornellUniforms& u);
+
+    /** @brief World position of RSM coordinate `uv` at `depth` along the light. */
+    sdf::Vec3 positionAt(sdf::Vec2 uv, float depth) const;
+};
+static_assert(sizeof(RSMLightFrame) == 64, "RSMLightFrame must match rsm_encoding.glsl");
+
+/**
+ * @brief Replace one rendered texel by what the shaders read back from the
+ * Compact attachments (a no-op for Full). `uv` is the texel centre.
+ */
+void roundTripRSMTexel(const RSMLightFrame& frame, sdf::Vec2 uv,
+                       sdf::Vec3& position, sdf::Vec3& normal, sdf::Vec3& flux);
@@ -0,0 +1,49 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 23:00:00
+ * @Description  : Layout of the RSM flux pyramid used for hierarchical VPL sampling
+ * @FilePath     : RSMPyramid.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Geometry of the RSM flux pyramid that rsm_pyramid.comp builds and the
+ * hierarchical gather of sdf_practice.frag descends (CpuCornellRenderer mirrors
+ * both; shaders/rsm_pyramid.glsl holds the GLSL side of this layout).
+ *
+ * Level 0 stores the mean flux luminance of each 2x2 block of RSM texels and
+ * every further level the mean of 2x2 nodes of the level below, down to a single
+ * node. Means rather than sums keep the values in range; the descent only needs
+ * the ratios between siblings. All levels share one R32F atlas: level 0 fills the
+ * left square, the smaller levels stack top to bottom in the column to its right.
+ *
+ * A node of kClusterLevel covers kClusterSize x kClusterSize RSM texels. The
+ * cluster images hold a normal cone and a bounding sphere for each of them, so
+ * the descent can give up on clusters that cannot light the receiver.
+ */
+struct RSMPyramidLayout {
+    static constexpr uint32_t kClusterLevel = 3;
+    static constexpr uint32_t kClusterSize = 2u << kClusterLevel;
+
+    uint32_t rsmSize = 0;      // RSM width (== height)
+    uint32_t baseSize = 0;     // level 0 width (== height), rsmSize / 2
+    uint32_t levelCount = 0;   // level levelCount - 1 is a single node
+    uint32_t atlasWidth = 0;
+    uint32_t atlasHeight = 0;
+    uint32_t clusterCount = 0; // cluster images are clusterCount x clusterCount
+
+    /**
+     * @brief Layout for a square power-of-two RSM of at least 2 * kClusterSize
+     * texels; throws std::runtime_error otherwise.
+     */
+    static RSMPyramidLayout make(uint32_t rsmWidth, uint32_t rsmHeight);
+
+    uint32_t getLevelSize(uint32_t level) const { return baseSize >> level; }
+    /** @brief Atlas texel of the level's top-left node. */
+    uint32_t getLevelOriginX(uint32_t level) const { return level == 0 ? 0 : baseSize; }
+    uint32_t getLevelOriginY(uint32_t level) const { return level == 0 ? 0 : baseSize - (baseSize >> (level - 1)); }
+};
@@ -0,0 +1,164 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 17:00:00
+ * @Description  : Dirty tracking and amortized refresh of the reflective shadow map
+ * @FilePath     : RSMUpdateScheduler.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "SDFCornellScene.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief When the RSM pass re-renders its attachments.
+ *
+ * EveryFrame: unconditionally, as before.
+ * OnChange:   only when an input of rsm_light.frag changed; otherwise the previous
+ *             RSM is reused. Lossless (partial refreshes: see getRSMSphereFootprint()).
+ * Interval:   like OnChange, but at most once every `interval` frames.
+ * Budget:     like OnChange, but refreshes are spaced so the RSM costs at most
+ *             `budgetMs` per frame on average (measured cost / budget frames apart).
+ *
+ * Interval and Budget trade shadow/indirect latency for time: while the light or
+ * spheres move, the main pass samples an RSM that is a few frames old.
+ *
+ * In every mode but EveryFrame, a refresh where only the spheres changed is
+ * restricted to their light-space footprints (see getRenderRects()).
+ */
+enum class RSMUpdateMode { EveryFrame, OnChange, Interval, Budget };
+
+const char* toString(RSMUpdateMode mode);
+
+/**
+ * @brief Parse "every", "change", "interval" or "budget"; throws std::runtime_error otherwise.
+ */
+RSMUpdateMode parseRSMUpdateMode(std::string_view name);
+
+/**
+ * @brief Everything rsm_light.frag reads from SDFCornellUniforms, plus the target size.
+ * Animation time enters through the sphere centres; the per-sphere rotation does
+ * not affect the RSM at all (it cannot change the distance field).
+ */
+struct RSMInputs {
+    float lightDir[4] = {};
+    float lightColor[4] = {};
+    float lightRight[4] = {};
+    float lightUp[4] = {};
+    float lightOrigin[4] = {};
+    float lightOrthoHalfSize[3] = {}; // z: RSM encoding, which changes what the pass writes
+    float sphereCenters[2][4] = {};
+    float sphereColor[3] = {};
+    float resolution[2] = {};
+
+    static RSMInputs fromUniforms(const SDFCornellUniforms& u);
+    bool operator==(const RSMInputs& other) const;
+    bool operator!=(const RSMInputs& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Texel rectangle of the RSM; (0, 0) is the texel at fragTexCoord (0, 0).
+ */
+struct RSMRect {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bool isEmpty() const { return width == 0 || height == 0; }
+    bool overlaps(const RSMRect& other) const;
+    /** @brief Smallest rectangle holding both. */
+    RSMRect merged(const RSMRect& other) const;
+};
+
+/** @brief World-space padding of a footprint (covers SURF_DIST and the normal taps). */
+constexpr float kRSMFootprintMargin = 0.05f;
+
+/**
+ * @brief Texels whose light ray can pass near sphere `sphere` (0 or 1): its bounding
+ * circle on the light's image plane, padded by kRSMFootprintMargin and a texel,
+ * clipped to the RSM. Empty when the sphere is outside the RSM.
+ *
+ * Texels outside it march the same surface whether or not the sphere is there; only
+ * where within SURF_DIST of that surface the march stops can differ.
+ */
+RSMRect getRSMSphereFootprint(const RSMInputs& inputs, int sphere);
+
+/**
+ * @brief Decides once per frame whether the RSM has to be re-rendered.
+ *
+ * Usage:
+ *   if (scheduler.shouldRender(uniforms, lastRsmMs)) { ... record the RSM pass ... }
+ *
+ * The RSM attachments must persist between frames for reuse to be valid;
+ * call invalidate() whenever they are recreated or their contents are lost.
+ */
+class RSMUpdateScheduler {
+public:
+    struct Stats {
+        uint64_t rendered = 0;
+        uint64_t partial = 0; // of rendered: only the spheres' footprints
+        uint64_t skipped = 0;
+    };
+
+    void setMode(RSMUpdateMode newMode) { mode = newMode; }
+    RSMUpdateMode getMode() const { return mode; }
+    void setInterval(uint32_t frames) { interval = frames > 0 ? frames : 1; }
+    uint32_t getInterval() const { return interval; }
+    void setBudgetMs(double ms) { budgetMs = ms; }
+    double getBudgetMs() const { return budgetMs; }
+    void setPartialUpdates(bool enabled) { partialUpdates = enabled; }
+    bool getPartialUpdates() const { return partialUpdates; }
+
+    /**
+     * @brief Force the next shouldRender() to return true.
+     */
+    void invalidate() { valid = false; }
+
+    /**
+     * @brief Call exactly once per frame. Returns true when the RSM pass must be
+     * recorded this frame; the inputs are then remembered as the current contents.
+     * `lastRenderMs` is the latest measured cost of one RSM pass (Budget mode only;
+     * <= 0 when unknown, which refreshes on every change).
+     */
+    bool shouldRender(const SDFCornellUniforms& uniforms, double lastRenderMs = 0.0);
+
+    /**
+     * @brief Disjoint rectangles the pass must re-render after shouldRender() returned
+     * true. The whole RSM, unless only the spheres changed since the last refresh:
+     * then per changed sphere the union of its old and new footprint (merged when
+     * the two overlap), and texels outside them keep their contents. A refresh
+     * whose footprints miss the RSM is counted as skipped.
+     */
+    const std::vector<RSMRect>& getRenderRects() const { return renderRects; }
+    /** @brief Bounds of getRenderRects(), e.g. the render area. */
+    const RSMRect& getRenderBounds() const { return renderBounds; }
+    bool isPartialRender() const { return partialRender; }
+
+    /**
+     * @brief True when the RSM contents do not match the latest inputs (Interval/Budget lag).
+     */
+    bool isStale() const { return stale; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    uint32_t framesBetweenRefreshes(double lastRenderMs) const;
+
+    RSMUpdateMode mode = RSMUpdateMode::OnChange;
+    uint32_t interval = 4;
+    double budgetMs = 1.0;
+    bool partialUpdates = true;
+
+    bool valid = false;
+    bool stale = false;
+    RSMInputs rendered;
+    uint32_t framesSinceRefresh = 0;
+    std::vector<RSMRect> renderRects;
+    RSMRect renderBounds;
+    bool partialRender = false;
+    Stats stats;
+};
@@ -0,0 +1,112 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 10:00:00
+ * @Description  : Command line options shared by all scenes
+ * @FilePath     : RunOptions.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+struct RunOptions {
+    // Help was requested; main prints usage and exits
+    bool showHelp = false;
+
+    // Headless: render into offscreen images instead of a swapchain,
+    // run a fixed number of frames and exit (no display server needed)
+    bool headless = false;
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    uint32_t frameCount = 300;
+
+    // Optional PPM dump of the last headless frame (empty = disabled)
+    std::string outputPath;
+
+    // Optional CSV stream of per-pass GPU timings (empty = disabled)
+    std::string profileCsvPath;
+
+    // Frame-time statistics: background report period (0 = only at exit)
+    // and optional JSON summary written at exit (empty = disabled)
+    double statsIntervalSeconds = 2.0;
+    std::string statsJsonPath;
+
+    // On-disk VkPipelineCache (empty path = per-scene default in the working directory)
+    bool usePipelineCache = true;
+    std::string pipelineCachePath;
+
+    // Animation time pinned for every frame (< 0 = real time); makes frames reproducible
+    double fixedTime = -1.0;
+
+    // 3D scene: march the baked brick map far from surfaces (false = analytic map() only)
+    bool brickMap = true;
+
+    // Cornell scene: start with reflective shadow maps enabled
+    bool enableRSM = false;
+
+    // Cornell scene: when the RSM is re-rendered ("every", "change", "interval", "budget"),
+    // the frame spacing for "interval" and the per-frame RSM cost target for "budget"
+    std::string rsmUpdate = "change";
+    uint32_t rsmInterval = 4;
+    double rsmBudgetMs = 1.0;
+    // Re-render only the light-space footprint of the spheres when nothing else changed
+    bool rsmPartialUpdates = true;
+
+    // Cornell scene: RSM attachment formats ("full" or "compact", see RSMEncoding)
+    std::string rsmEncoding = "full";
+
+    // Cornell scene: indirect lighting modes the ImGui panel otherwise switches.
+    // VPL clusters shade with a k-means reduced list (0 = off)
+    uint32_t vplClusters = 0;
+    // How the gather picks VPLs: "uniform", "importance" or "hierarchical" (flux pyramid)
+    std::string vplSampling = "hierarchical";
+    // VPLs per pixel with hierarchical sampling (1-16)
+    uint32_t vplSamples = 4;
+    // Temporal accumulation gathers temporalTaps VPL taps per pixel and frame (1-16)
+    bool temporalIndirect = false;
+    uint32_t temporalTaps = 4;
+    // Indirect light rendered at 1/indirectDivisor width and height, then upsampled (1, 2 or 4)
+    uint32_t indirectDivisor = 1;
+    // ReSTIR: restirCandidates initial VPLs per pixel (1-32), merged with the
+    // previous frame's reservoir and restirNeighbours neighbouring ones (0-8)
+    bool restir = false;
+    uint32_t restirCandidates = 8;
+    uint32_t restirNeighbours = 4;
+    // Show the indirect term only (the view the indirect-lighting PSNRs are measured in)
+    bool showIndirectOnly = false;
+
+    // Cornell scene: render on the CPU instead of Vulkan (0 threads = all cores),
+    // optionally checking the result against a golden PPM
+    bool cpuReference = false;
+    unsigned cpuThreads = 0;
+    std::string comparePath;
+    double minPsnrDb = 30.0;
+
+    // CPU ray marching: packet kernel ("auto", "scalar", "sse4", "avx2", "avx512")
+    // and a standalone throughput benchmark of all kernels
+    std::string simdLevel = "auto";
+    bool benchRayMarch = false;
+};
+
+/**
+ * @brief Parse command line arguments. Throws std::runtime_error on bad input.
+ */
+RunOptions parseRunOptions(int argc, char** argv);
+
+/**
+ * @brief Print the supported options.
+ */
+void printRunOptionsUsage(std::ostream& os, const char* programName);
+
+/**
+ * @brief Pipeline cache file for a scene, or an empty string when caching is disabled.
+ */
+std::string resolvePipelineCachePath(const RunOptions& options, const char* sceneName);
+
+/**
+ * @brief Print the timing summary at the end of a headless run.
+ */
+void printHeadlessSummary(std::ostream& os, const RunOptions& options, double totalMs);
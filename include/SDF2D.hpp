@@ -27,6 +27,16 @@
 #include <EasyVulkan/Utils/ResourceUtils.hpp>
 #include <EasyVulkan/Utils/CommandUtils.hpp>
 
+#include "RunOptions.hpp"
+#include "OffscreenTarget.hpp"
+#include "UniformRingBuffer.hpp"
+#include "GpuProfiler.hpp"
+#include "FrameStats.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineBuildService.hpp"
+#include "ComputePipeline.hpp"
+#include "SDF2DScene.hpp"
+
 
 
 struct TriangleVertex {
@@ -35,15 +45,6 @@ struct TriangleVertex {
     float texCoord[2];
 };
 
-struct ShaderToyUniforms {
-    alignas(16) float iTime;
-    alignas(8) float iResolution[2];
-    alignas(8) float iMouse[2];           // Mouse position for circle
-    alignas(8) float lightPos[2];         // Light 1 position
-    alignas(16) float lightOn[4];
-    alignas(16) float lightRadius[4];
-};
-
 class SDF2D {
 public:
 #if defined(__OHOS__)
@@ -55,7 +56,11 @@ public:
     void run();
 #endif
     void mainLoop();
-    
+
+    /**
+     * @brief Apply command line options (headless mode etc.); call before run()
+     */
+    void setRunOptions(const RunOptions& options) { runOptions = options; }
     
     /**
      * @brief Destructor to clean up resources
@@ -72,7 +77,10 @@ private:
     static constexpr int frameNum = 3;
 #endif
 
-    int framePauseInterval = 10;
+    RunOptions runOptions;
+
+    // Bounded frame-time statistics, reported from a background thread
+    FrameStats frameStats;
 
     /* -------------------------------------------------------------------------- */
     /*                                App necessary                               */
@@ -95,9 +103,14 @@ private:
     std::vector<VkCommandBuffer> commandBuffers;  // Recorded for each swapchain image
     std::vector<VkFramebuffer> framebuffers;
 
-    // ShaderToy SDF uniforms
-    VkBuffer uniformBuffer = VK_NULL_HANDLE;
-    VmaAllocation uniformBufferAllocation = VK_NULL_HANDLE;
+    // Headless mode renders into these instead of the swapchain images
+    OffscreenTarget offscreenTarget;
+
+    // Per-pass GPU timings (timestamp queries, one pool per frame in flight)
+    GpuProfiler gpuProfiler;
+
+    // ShaderToy SDF uniforms: one slice per frame in flight, bound with a dynamic offset
+    UniformRingBuffer uniformRing;
     std::vector<VkDescriptorSet> descriptorSets;
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
@@ -110,13 +123,59 @@ private:
     float ballX = 0.0f;
     float ballY = 0.0f;
 
-    // Light controls (UI state)
-    bool  lightEnabled[3] = {true, true, false};
-    float lightRadii[3]   = {60.0f, 80.0f, 12.0f};
-    // range is auto-derived in shader: range = radius * 25.0
-    // Light 1 position controlled via ImGui (in pixel coordinates)
-    float light1PositionX = 400.0f;
-    float light1PositionY = 300.0f;
+    // Light list (UI state), uploaded every frame into a storage buffer ring.
+    // Range is derived from the radius: range = radius * kLightRangeScale.
+    static constexpr uint32_t kMaxLights = 256;
+    std::vector<SceneLight2D> lights = makeDefaultSDF2DLights();
+    UniformRingBuffer lightRing;
+    uint32_t activeLightCount = 0; // enabled lights uploaded this frame
+    uint32_t randomLightSeed = 1;
+
+    // Tiled light culling: sdf2d_light_binning.comp writes, per 16x16 pixel tile, the
+    // lights whose range circle touches it; each pixel then shades only those.
+    // Tile layout: [count, index0, index1, ...], kLightTileStride uints per tile.
+    // Must match LIGHT_TILE_SIZE / LIGHT_TILE_STRIDE in sdf2d_scene.glsl.
+    static constexpr uint32_t kLightTileSize = 16;
+    static constexpr uint32_t kLightTileStride = kMaxLights + 1; // count + every light, so no tile overflows
+    bool useTiledLighting = true;
+    uint32_t tileColumns = 0;
+    uint32_t tileRows = 0;
+    std::vector<VkBuffer> tileLightBuffers; // one per frame in flight, device local
+    VkDescriptorSetLayout lightBinningLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> lightBinningSets;
+    VkPipelineLayout lightBinningPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline lightBinningPipeline = VK_NULL_HANDLE;
+
+    // Baked scene distance: sdf2d_distance.comp evaluates sceneDist() once per pixel,
+    // the soft-shadow marches then read it. One R32F image per frame in flight.
+    bool useDistanceTexture = true;
+    std::vector<VkImage> distanceImages;
+    std::vector<VkImageView> distanceViews;
+    std::vector<VmaAllocation> distanceAllocs;
+    VkSampler distanceSampler = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> distanceComputeSets;
+    VkPipelineLayout distancePipelineLayout = VK_NULL_HANDLE;
+    VkPipeline distancePipeline = VK_NULL_HANDLE;
+
+    // Polar shadow maps: sdf2d_polar_shadow.comp marches kPolarShadowResolution rays
+    // outward from each light and stores the occluder distance per angle (one row per
+    // light), so each pixel replaces the 64-step cone march with a fixed-size lookup.
+    static constexpr uint32_t kPolarShadowResolution = 1024; // multiple of the 256-wide workgroup
+    static constexpr uint32_t kPolarShadowRows = kMaxLights; // one per light
+    bool usePolarShadows = true;
+    std::vector<VkImage> polarShadowImages;
+    std::vector<VkImageView> polarShadowViews;
+    std::vector<VmaAllocation> polarShadowAllocs;
+    std::vector<VkDescriptorSet> polarShadowComputeSets;
+    VkPipelineLayout polarShadowPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline polarShadowPipeline = VK_NULL_HANDLE;
+
+    // Set 1 of the main pass samples both baked textures and reads the tile lists; the
+    // bake passes share one compute layout (binding 0 = scene UBO, binding 1 = the
+    // storage image they write, binding 2 = light list)
+    VkDescriptorSetLayout sceneTextureLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout bakeComputeLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> sceneTextureSets;
 
     /* -------------------------------------------------------------------------- */
     /*                                  Methods                                   */
@@ -124,10 +183,32 @@ private:
     void createRenderPass();
     void createFramebuffers();
     void createVertexBuffer();
-    void createPipeline();
+    std::future<BuiltPipeline> createPipeline();
+    void createDistanceResources();
+    void createPolarShadowResources();
+    void createSceneTextureSets();
+    std::future<BuiltPipeline> submitComputePipeline(const ComputePipelineDesc& desc);
+    std::future<BuiltPipeline> createDistancePipeline();
+    std::future<BuiltPipeline> createPolarShadowPipeline();
+    void recordDistancePass(VkCommandBuffer cmd);
+    void recordPolarShadowPass(VkCommandBuffer cmd);
+    void createLightResources();
+    std::future<BuiltPipeline> createLightBinningPipeline();
+    void recordLightBinningPass(VkCommandBuffer cmd);
+    void uploadLights(float time, float width);
+    void drawLightListImGui(const VkExtent2D& extent);
     void createCommandBuffers();
     void recordCommandBuffer(uint32_t imageIndex);
     void drawFrame();
+    void mainLoopHeadless();
+    void startFrameStats();
+    void finishFrameStats();
+
+    // Render target queries that work for both the swapchain and headless mode
+    size_t getTargetCount() const;
+    VkExtent2D getTargetExtent() const;
+    VkFormat getTargetFormat() const;
+    std::vector<VkImageView> getTargetImageViews() const;
     
     // ShaderToy SDF methods
     void createUniformBuffer();
@@ -141,7 +222,11 @@ private:
     /* -------------------------------------------------------------------------- */
     VkRenderPass renderPass = VK_NULL_HANDLE;
     
-    // Triangle rendering pipeline
+    // Loaded from disk at init, saved at shutdown
+    PipelineCache pipelineCache;
+    PipelineBuildService pipelineBuilds; // startup only: the pipelines compile in parallel
+
+    // Triangle rendering pipeline (owned: built outside the ResourceManager)
     VkPipelineLayout trianglePipelineLayout = VK_NULL_HANDLE;
     VkPipeline trianglePipeline = VK_NULL_HANDLE;
 
@@ -0,0 +1,82 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : 2D scene uniform block and light list shared by the GPU and CPU renderers
+ * @FilePath     : SDF2DScene.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// std140-compatible layout mirroring ShaderToyUBO in shaders/sdf2d_scene.glsl
+struct ShaderToyUniforms {
+    alignas(16) float iTime;
+    alignas(8) float iResolution[2];
+    alignas(8) float iMouse[2];           // Mouse position for circle
+    // Per-frame values of sdf2dCircleRect.frag, computed once here instead of per pixel
+    alignas(16) float shapeCenters[4];    // xy = circle, zw = rectangle
+    alignas(16) float shapeColor[4];      // animated fill colour
+    alignas(16) float distanceParams[4];  // x = 1: shadows sample the baked distance texture
+    alignas(16) float shadowParams[4];    // x = 1: polar shadow map lookup instead of the cone march
+    alignas(16) uint32_t lightInfo[4];    // x = light count, y/z = tile columns/rows, w = 1: tiled culling
+};
+
+/**
+ * @brief One entry of the 2D light storage buffer (std430, matches Light2D in sdf2d_scene.glsl).
+ * Colours are pre-scaled to their target luminance on the CPU.
+ */
+struct Light2DGpu {
+    alignas(16) float position[2];
+    float radius;
+    float range;
+    alignas(16) float color[4];
+};
+static_assert(sizeof(Light2DGpu) == 32, "Light2DGpu must match the std430 layout");
+
+/**
+ * @brief Editable description of a 2D light (ImGui state).
+ * Sweeping lights move horizontally: x = width * (sin(time + sweepPhase) + 1.2) / 2.4.
+ */
+struct SceneLight2D {
+    bool enabled = true;
+    float position[2] = {0.0f, 0.0f};
+    float radius = 20.0f;
+    float color[3] = {1.0f, 1.0f, 1.0f};
+    float luminance = 0.6f;
+    bool sweep = false;
+    float sweepPhase = 0.0f;
+};
+
+// Light range is derived from the radius: range = radius * kLightRangeScale
+constexpr float kLightRangeScale = 25.0f;
+
+/**
+ * @brief Warm key light at (400, 300), a sweeping blue light and a (disabled) magenta accent.
+ */
+std::vector<SceneLight2D> makeDefaultSDF2DLights();
+
+/**
+ * @brief Per-frame values that do not come from the settings panel.
+ */
+struct SDF2DFrameInputs {
+    float time = 0.0f;
+    uint32_t width = 1;
+    uint32_t height = 1;
+    float ball[2] = {0.0f, 0.0f}; // circle position / 2 (mouse-driven)
+};
+
+/**
+ * @brief Fill the scene part of the uniform block exactly as the GPU path uploads it.
+ * The renderer toggles (distanceParams, shadowParams, lightInfo) are left zero.
+ */
+ShaderToyUniforms makeSDF2DUniforms(const SDF2DFrameInputs& frame);
+
+/**
+ * @brief The enabled lights at `time`, in list order, at most `maxLights` of them.
+ */
+std::vector<Light2DGpu> makeSDF2DLights(const std::vector<SceneLight2D>& lights, float time,
+                                        float width, size_t maxLights);
@@ -17,6 +17,16 @@
 #include <EasyVulkan/DataStructures.hpp>
 #include <EasyVulkan/Utils/ResourceUtils.hpp>
 
+#include "RunOptions.hpp"
+#include "OffscreenTarget.hpp"
+#include "UniformRingBuffer.hpp"
+#include "GpuProfiler.hpp"
+#include "FrameStats.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineBuildService.hpp"
+#include "BrickMap.hpp"
+#include "SDF3DScene.hpp"
+
 #include <memory>
 #include <vector>
 #include <chrono>
@@ -33,6 +43,14 @@ struct ShaderToy3DUniforms {
     alignas(8)  float iMouse[2];
     alignas(4)  int   iFrame;
     alignas(16) int   enableLights[4]; // 1 to enable, 0 to disable for lights 1..4
+    alignas(16) float cameraOrigin[4];    // per-frame camera position (xyz)
+    alignas(16) float cameraBasis[3][4];  // per-frame camera matrix, mat3 columns padded to vec4 (std140)
+    alignas(16) float brickOrigin[4];     // baked field min corner (xyz), voxel size (w)
+    alignas(16) uint32_t brickGrid[4];    // cells per axis (xyz), atlas bricks per row (w)
+    alignas(16) float brickParams[4];     // x: 1 = march the baked field, y: analytic refine distance
+    alignas(16) float sceneBoundsMin[4];  // bounds of all primitives (xyz), the box raycast() marches in
+    alignas(16) float sceneBoundsMax[4];
+    alignas(16) uint32_t sceneInfo[4];    // x: BVH node count
 };
 
 class SDF3D {
@@ -46,6 +64,7 @@ public:
     void run();
 #endif
     void mainLoop();
+    void setRunOptions(const RunOptions& options) { runOptions = options; }
     ~SDF3D();
 
 private:
@@ -55,7 +74,8 @@ private:
     static constexpr int frameNum = 3;
 #endif
 
-    int framePauseInterval = 10;
+    RunOptions runOptions;
+    FrameStats frameStats; // bounded frame-time statistics
 
     // Core context
     std::unique_ptr<ev::VulkanContext> context;
@@ -72,15 +92,39 @@ private:
     VkBuffer fullscreenVertexBuffer = VK_NULL_HANDLE;
     std::vector<VkCommandBuffer> commandBuffers;
     std::vector<VkFramebuffer> framebuffers;
+    OffscreenTarget offscreenTarget; // headless replacement for swapchain images
+    GpuProfiler gpuProfiler;          // per-pass GPU timestamps
 
-    // ShaderToy-like UBO
-    VkBuffer uniformBuffer = VK_NULL_HANDLE;
-    VmaAllocation uniformBufferAllocation = VK_NULL_HANDLE;
+    // ShaderToy-like UBO, one dynamic-offset slice per frame in flight
+    UniformRingBuffer uniformRing;
     std::vector<VkDescriptorSet> descriptorSets;
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
 
+    // Primitives and their BVH, one storage slice per frame in flight, rewritten
+    // only after primitives moved
+    std::unique_ptr<SDF3DScene> scene;
+    std::vector<sdf::Vec3> restPositions;
+    UniformRingBuffer primitiveRing;
+    UniformRingBuffer bvhRing;
+    uint32_t sceneUploadsPending = 0;
+    bool animatePrimitives = false;
+    bool primitivesDisplaced = false;
+
+    // Baked brick map of the static primitives (uploaded once at start-up)
+    VkImage brickAtlasImage = VK_NULL_HANDLE;
+    VkImageView brickAtlasView = VK_NULL_HANDLE;
+    VmaAllocation brickAtlasAlloc = VK_NULL_HANDLE;
+    VkSampler brickAtlasSampler = VK_NULL_HANDLE;
+    VkBuffer brickIndirectionBuffer = VK_NULL_HANDLE;
+    VkBuffer brickCoarseBuffer = VK_NULL_HANDLE;
+    float brickOrigin[4] = {};
+    uint32_t brickGrid[4] = {};
+    bool useBrickMap = true;
+
     // Pipeline
     VkRenderPass renderPass = VK_NULL_HANDLE;
+    PipelineCache pipelineCache; // persisted between launches
+    PipelineBuildService pipelineBuilds; // startup only: compiles while the brick map bakes
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
     VkPipeline graphicsPipeline = VK_NULL_HANDLE;
 
@@ -101,12 +145,25 @@ private:
     void createRenderPass();
     void createFramebuffers();
     void createVertexBuffer();
-    void createPipeline();
+    std::future<BuiltPipeline> createPipeline();
     void createCommandBuffers();
     void recordCommandBuffer(uint32_t imageIndex);
     void drawFrame();
+    void mainLoopHeadless();
+    void startFrameStats();
+    void finishFrameStats();
+
+    // Swapchain or offscreen (headless) render target queries
+    size_t getTargetCount() const;
+    VkExtent2D getTargetExtent() const;
+    VkFormat getTargetFormat() const;
+    std::vector<VkImageView> getTargetImageViews() const;
 
     void createUniformBuffer();
+    void createScene();
+    void updateScene(float time);
+    void createBrickMap();
+    void uploadBrickAtlas(const BrickMap& brickMap);
     void createDescriptorSetLayout();
     void createDescriptorSets();
     void updateUniformBuffer(uint32_t imageIndex);
@@ -0,0 +1,114 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 20:00:00
+ * @Description  : Data-driven primitive scene of sdf3d.frag (CPU side and GPU layout)
+ * @FilePath     : SDF3DScene.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "PrimitiveBVH.hpp"
+#include "SDFMath.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Primitive kinds evaluatePrimitive() in sdf3d.frag understands (same values).
+ *
+ * Parameter layout, params[0..7]; a / b are the end points of the oriented shapes:
+ * - Sphere: r | Box: b.xyz | BoxFrame: b.xyz, e | Ellipsoid: r.xyz
+ * - Torus: R, r | CappedTorus: sc.xy, ra, rb | HexPrism, TriPrism, Cylinder: h.xy
+ * - OctogonPrism: r, h | RoundCone: r1, r2, h | Cone: c.xy, h | CappedCone: h, r1, r2
+ * - Capsule, CylinderAB: a.xyz, r, b.xyz | RoundConeAB, CappedConeAB: a.xyz, r1, b.xyz, r2
+ * - SolidAngle: c.xy, ra | Octahedron: s | Pyramid: h | Rhombus: la, lb, h, ra
+ * - Horseshoe: c.xy, r, le, w.xy
+ */
+enum class PrimitiveType3D : uint32_t {
+    Sphere = 0,
+    Box,
+    BoxFrame,
+    Ellipsoid,
+    Torus,
+    CappedTorus,
+    HexPrism,
+    OctogonPrism,
+    Capsule,
+    RoundCone,
+    RoundConeAB,
+    TriPrism,
+    Cylinder,
+    CylinderAB,
+    Cone,
+    CappedCone,
+    CappedConeAB,
+    SolidAngle,
+    Octahedron,
+    Pyramid,
+    Rhombus,
+    Horseshoe,
+};
+
+struct ScenePrimitive3D {
+    PrimitiveType3D type = PrimitiveType3D::Sphere;
+    sdf::Vec3 position;   // world position of the local origin
+    sdf::Mat3 rotation;   // world to local; orthonormal, so distances stay exact
+    float params[8] = {};
+    float material = 1.0f; // colour id of render() (0 and 1 are the ground)
+};
+
+/**
+ * @brief A ScenePrimitive3D as the shader reads it (std430, 112 bytes).
+ */
+struct Primitive3DGpu {
+    float position[4];    // xyz, w = material
+    float rotation[3][4]; // rows of the world-to-local rotation
+    float params[2][4];
+    uint32_t type;
+    uint32_t padding[3];
+};
+
+/** @brief Signed distance from a world position to one primitive. */
+float evaluatePrimitive(const ScenePrimitive3D& primitive, sdf::Vec3 pos);
+
+/** @brief Conservative world-space bounds of a primitive's surface. */
+Aabb3 computePrimitiveBounds(const ScenePrimitive3D& primitive);
+
+Primitive3DGpu toGpuPrimitive(const ScenePrimitive3D& primitive);
+
+/** @brief The Inigo Quilez primitive gallery that sdf3d.frag used to hard-code. */
+std::vector<ScenePrimitive3D> makeSDF3DGallery();
+
+/**
+ * @brief Primitives plus a BVH over their bounds. map() matches map() in
+ * sdf3d.frag: the ground plane, then only the primitives whose bounds are
+ * closer than the best distance so far.
+ */
+class SDF3DScene {
+public:
+    explicit SDF3DScene(std::vector<ScenePrimitive3D> scenePrimitives);
+
+    const std::vector<ScenePrimitive3D>& getPrimitives() const { return primitives; }
+    const PrimitiveBVH& getBvh() const { return bvh; }
+    Aabb3 getBounds() const { return bvh.getBounds(); }
+
+    /** @brief Move a primitive; call refit() once all moves of a frame are done. */
+    void setPosition(size_t index, sdf::Vec3 position);
+    void refit();
+
+    /** @brief Primitives in BVH leaf order, ready for the shader's storage buffer. */
+    std::vector<Primitive3DGpu> packGpuPrimitives() const;
+
+    /** @brief (distance, material) of the nearest surface, ground plane (material 0) included. */
+    sdf::Vec2 map(sdf::Vec3 pos) const;
+    /** @brief Distance to the primitives only, without the ground plane. */
+    float mapPrimitives(sdf::Vec3 pos) const;
+
+private:
+    sdf::Vec2 nearest(sdf::Vec3 pos, sdf::Vec2 res) const;
+
+    std::vector<ScenePrimitive3D> primitives;
+    std::vector<Aabb3> bounds;
+    PrimitiveBVH bvh;
+};
@@ -17,7 +17,24 @@
 #include <EasyVulkan/DataStructures.hpp>
 #include <EasyVulkan/Utils/ResourceUtils.hpp>
 
+#include "RunOptions.hpp"
+#include "OffscreenTarget.hpp"
+#include "UniformRingBuffer.hpp"
+#include "GpuProfiler.hpp"
+#include "FrameStats.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineBuildService.hpp"
+#include "SDFCornellScene.hpp"
+#include "RSMUpdateScheduler.hpp"
+#include "RSMPyramid.hpp"
+#include "RSMEncoding.hpp"
+#include "VplClusters.hpp"
+#include "DeferredDeletionQueue.hpp"
+
+#include <array>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <chrono>
 
@@ -27,43 +44,6 @@ struct SDFCornellVertex {
     float texCoord[2];
 };
 
-// std140-compatible layout mirroring shaders/sdf_practice.frag
-struct SDFCornellUniforms {
-    alignas(16) float iTime;
-    alignas(8)  float iResolution[2];
-    alignas(8)  float iMouse[2];
-    alignas(4)  int   iFrame;
-
-    alignas(16) float sphereRotation[4]; // xyz angles (rad), w = animation time
-
-    alignas(16) float sphereColor[4];      // RGB sphere color
-
-    alignas(16) int   enableLights[4];     // x=key, y=fill, z=rim, w=env
-    alignas(16) float lightDir[4];         // xyz dir, w intensity
-    alignas(16) float lightColors[3][4];   // rgb + alpha(intensity)
-    alignas(16) float ambientColor[4];     // rgb + alpha(strength)
-
-    alignas(16) float shadowParams[4];     // x=quality, y=intensity, z=blueTint, w=metallic
-
-    // RSM / light camera parameters
-    alignas(16) float lightRight[4];        // xyz right basis of light camera
-    alignas(16) float lightUp[4];           // xyz up basis of light camera
-    alignas(16) float lightOrigin[4];       // origin of light camera
-    alignas(16) float lightOrthoHalfSize[4];// xy half size of ortho frustum
-    alignas(16) float rsmResolution[4];     // xy: RSM texture size
-    alignas(16) float rsmParams[4];         // x=radius, y=samples, z=enableIndirectLighting(>0.5), w=enableRSM(>0.5)
-    alignas(16) float indirectParams[4];    // x=indirectIntensity, y/z/w reserved
-    
-    // Debug controls
-    alignas(16) float debugParams[4];       // x=showRSMOnly (>0.5), y/z/w reserved
-
-    // PBR parameters
-    alignas(16) float pbrParams[4];         // x=enablePBR(>0.5), y=globalRoughness, z=globalMetallic, w=reserved
-    alignas(16) float roughnessValues[2];   // per-material roughness: [0]=sphere1, [1]=sphere2  
-    alignas(16) float metallicValues[2];    // per-material metallic: [0]=sphere1, [1]=sphere2
-    alignas(16) float baseColorFactors[4];  // global color tinting factors: RGB + intensity
-};
-
 class SDFCornell {
 public:
 #if !defined(__OHOS__)
@@ -79,6 +59,7 @@ public:
     void run();
 #endif
     void mainLoop();
+    void setRunOptions(const RunOptions& options) { runOptions = options; }
     ~SDFCornell();
 
 private:
@@ -88,6 +69,9 @@ private:
     static constexpr int frameNum = 3;
 #endif
 
+    RunOptions runOptions;
+    FrameStats frameStats; // bounded frame-time statistics
+
     // Core context
     std::unique_ptr<ev::VulkanContext> context;
     ev::VulkanDevice* device = nullptr;
@@ -103,14 +87,29 @@ private:
     VkBuffer fullscreenVertexBuffer = VK_NULL_HANDLE;
     std::vector<VkCommandBuffer> commandBuffers;
     std::vector<VkFramebuffer> framebuffers;
+    OffscreenTarget offscreenTarget; // headless replacement for swapchain images
+    GpuProfiler gpuProfiler;          // per-pass GPU timestamps (RSM / Main / ImGui)
 
     VkRenderPass renderPass = VK_NULL_HANDLE;
-    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
-    VkPipeline pipeline = VK_NULL_HANDLE;
+    PipelineCache pipelineCache; // persisted between launches, shared by all pipelines
 
-    // UBO and descriptors
-    VkBuffer uniformBuffer = VK_NULL_HANDLE;
-    VmaAllocation uniformBufferAllocation = VK_NULL_HANDLE;
+    // Main pass: one pipeline per feature set (makeCornellVariantKey), built on first use
+    static constexpr int32_t kMaxSteps = 128;        // MAX_STEPS of sdf_practice.frag
+    static constexpr int32_t kSoftShadowSteps = 64;  // SOFT_SHADOW_STEPS of sdf_practice.frag
+    struct PipelineVariant {
+        std::future<BuiltPipeline> pending; // valid until the build has been collected
+        BuiltPipeline built;
+    };
+    PipelineBuildService pipelineBuilds; // compiles variants while frames keep drawing
+    VkShaderModule mainVertShader = VK_NULL_HANDLE;
+    VkShaderModule mainFragShader = VK_NULL_HANDLE;
+    std::unordered_map<uint32_t, PipelineVariant> pipelineVariants;
+    uint32_t activeVariantKey = 0; // newest built variant the frame asked for (with its indirect pass, if any)
+    double lastVariantBuildMs = 0.0; // compile time of the most recently collected variant
+    SDFCornellUniforms frameUniforms{}; // as uploaded for the frame being recorded
+
+    // UBO (one dynamic-offset slice per frame in flight) and descriptors
+    UniformRingBuffer uniformRing;
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
     std::vector<VkDescriptorSet> descriptorSets;
 
@@ -120,62 +119,38 @@ private:
     float mouseX = 0.0f;
     float mouseY = 0.0f;
 
-    // UI state
-    float rotationEuler[3] = {0.0f, 0.0f, 0.0f};
-    float rotationAnimSpeed = 0.6f;
+    // UI state (shared with the CPU reference renderer)
+    SDFCornellSettings settings;
     float virtualStick[2] = {0.0f, 0.0f}; // -1..1 range
+    int selectedMaterial = 0; // For per-material editing: 0=sphere1, 1=sphere2
 
-    float sphereColor[3] = {0.3f, 0.7f, 1.0f}; // RGB solid color for spheres
-
-    // Lighting
-    bool  enableKey = true;
-    bool  enableFill = true;
-    bool  enableRim = true;
-    bool  enableEnv = true;
-    float keyIntensity = 1.2f;
-    float ambientStrength = 0.25f;
-    float blueTint = 1.0f;
-    float shadowQuality = 1.0f;
-    float shadowIntensity = 0.9f;
-    float metallic = 0.6f;
-    
-    // Light direction angles (in radians)
-    float lightElevation = 0.8f;  // Elevation angle (pitch) 
-    float lightAzimuth = -0.7f;   // Azimuth angle (yaw)
-    
-    // Light orthographic projection size control
-    float lightOrthoHalfSize[2] = {8.0f, 8.0f}; // X and Y half-size of orthographic frustum
-
-    // RSM controls and resources
-    bool  enableRSM = false;
-    bool  enableIndirectLighting = true;  // Enable indirect lighting when RSM is enabled
-    bool  enableImportanceSampling = true; // Enable adaptive importance sampling for RSM
+    // RSM resources
     uint32_t rsmWidth = 1024;
     uint32_t rsmHeight = 1024;
     int rsmResolutionIndex = 1; // 0:512, 1:1024, 2:2048, 3:4096
     bool rsmRecreatePending = false;
     uint32_t rsmPendingSize = 1024;
-    float indirectIntensity = 1.0f; // Physically-based scale for indirect lighting
-
-    // Debug/visualization
-    bool showRSMOnly = false;
-    bool showIndirectOnly = false;  // New debug mode: show only indirect lighting
-
-    // PBR controls
-    bool enablePBR = false;
-    float globalRoughness = 0.5f;
-    float globalMetallic = 0.0f;
-    float sphere1Roughness = 0.4f;  // Textured sphere - medium roughness
-    float sphere1Metallic = 0.1f;   // Slightly metallic
-    float sphere2Roughness = 0.2f;  // Colored sphere - smoother
-    float sphere2Metallic = 0.8f;   // More metallic
-    float baseColorIntensity = 1.0f;
-    int selectedMaterial = 0; // For per-material editing: 0=sphere1, 1=sphere2
+    RSMEncoding rsmEncoding = RSMEncoding::Full; // formats of the current attachments
+    RSMEncoding rsmPendingEncoding = RSMEncoding::Full;
+    bool compactRSMSupported = false; // every Compact format renders and filters on this device
+    uint32_t rsmGeneration = 0; // bumped on every resolution or encoding switch, see rsmResourceName()
+    DeferredDeletionQueue deletionQueue; // retired RSM generations, freed once their frames retire
 
-    VkRenderPass rsmRenderPass = VK_NULL_HANDLE;
+    // RSM reuse: the attachments persist between frames and are only re-rendered
+    // when the scheduler says so (decided in updateUniformBuffer)
+    RSMUpdateScheduler rsmScheduler;
+    bool rsmRenderThisFrame = false;
+    bool rsmImagesInitialized = false; // layout is SHADER_READ_ONLY_OPTIMAL
+
+    // One render pass and pipeline per RSMEncoding (attachment formats differ),
+    // all built up front so switching only recreates the attachments
+    std::array<VkRenderPass, kRSMEncodingCount> rsmRenderPasses{};
+    // Same attachments loaded instead of cleared, for refreshes of part of the RSM
+    // (compatible with the framebuffer and pipelines of rsmRenderPasses)
+    std::array<VkRenderPass, kRSMEncodingCount> rsmPartialRenderPasses{};
+    std::array<BuiltPipeline, kRSMEncodingCount> rsmPipelines{};
     VkFramebuffer rsmFramebuffer = VK_NULL_HANDLE;
-    VkPipeline rsmPipeline = VK_NULL_HANDLE;
-    VkPipelineLayout rsmPipelineLayout = VK_NULL_HANDLE;
+    RSMLightFrame rsmLightFrame; // light camera of the current RSM contents, for the compute passes
 
     VkImage rsmPositionImage = VK_NULL_HANDLE;
     VkImage rsmNormalImage = VK_NULL_HANDLE;
@@ -188,6 +163,73 @@ private:
     VkImageView rsmFluxView = VK_NULL_HANDLE;
     VkSampler rsmSampler = VK_NULL_HANDLE;
 
+    // Flux pyramid and VPL clusters for hierarchical sampling (rsm_pyramid.comp),
+    // rebuilt after every RSM pass; the images stay in GENERAL
+    RSMPyramidLayout rsmPyramidLayout;
+    VkImage rsmPyramidImage = VK_NULL_HANDLE;
+    VkImage rsmClusterConeImage = VK_NULL_HANDLE;
+    VkImage rsmClusterBoundsImage = VK_NULL_HANDLE;
+    VmaAllocation rsmPyramidAlloc = VK_NULL_HANDLE;
+    VmaAllocation rsmClusterConeAlloc = VK_NULL_HANDLE;
+    VmaAllocation rsmClusterBoundsAlloc = VK_NULL_HANDLE;
+    VkImageView rsmPyramidView = VK_NULL_HANDLE;
+    VkImageView rsmClusterConeView = VK_NULL_HANDLE;
+    VkImageView rsmClusterBoundsView = VK_NULL_HANDLE;
+    VkSampler rsmPyramidSampler = VK_NULL_HANDLE; // nearest: R32F need not support linear filtering
+    VkDescriptorSetLayout rsmPyramidSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSet rsmPyramidSet = VK_NULL_HANDLE;
+    VkPipeline rsmPyramidPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout rsmPyramidPipelineLayout = VK_NULL_HANDLE;
+    bool rsmPyramidInitialized = false; // layout is GENERAL
+
+    // Clustered VPL list (vpl_cluster.comp); the buffers outlive RSM generations so
+    // each build refines the previous centroids, only the descriptor set follows the RSM
+    VkBuffer vplClusterBuffer = VK_NULL_HANDLE;    // kMaxVplClusters GpuVplCluster
+    VkBuffer vplCellBuffer = VK_NULL_HANDLE;       // kVplClusterCellCount GpuVplCluster
+    VkBuffer vplAssignmentBuffer = VK_NULL_HANDLE; // kVplClusterCellCount uint
+    VkDescriptorSetLayout vplClusterSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSet vplClusterSet = VK_NULL_HANDLE;
+    VkPipeline vplClusterPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout vplClusterPipelineLayout = VK_NULL_HANDLE;
+    uint32_t vplClusterSeededCount = 0; // cluster count of the last seed; 0: seed on the next build
+    bool vplClustersStale = true;       // the RSM changed since the last build
+
+    // Indirect pass (usesCornellIndirectPass()): the pass variant renders the indirect
+    // term into indirectRawImage. With kCornellVariantTemporalIndirect,
+    // indirect_temporal.comp blends it into indirectAccumImage, which the main pass
+    // reads and which is then copied to indirectHistoryImage for the next frame; with
+    // kCornellVariantIndirectUpsample all three are 1/indirectDivisor of the target
+    // and the main pass upsamples. Recreated on divisor switches; accum and history
+    // stay in GENERAL
+    VkRenderPass indirectRenderPass = VK_NULL_HANDLE;
+    VkFramebuffer indirectFramebuffer = VK_NULL_HANDLE;
+    VkImage indirectRawImage = VK_NULL_HANDLE;
+    VkImage indirectAccumImage = VK_NULL_HANDLE;
+    VkImage indirectHistoryImage = VK_NULL_HANDLE;
+    VmaAllocation indirectRawAlloc = VK_NULL_HANDLE;
+    VmaAllocation indirectAccumAlloc = VK_NULL_HANDLE;
+    VmaAllocation indirectHistoryAlloc = VK_NULL_HANDLE;
+    VkImageView indirectRawView = VK_NULL_HANDLE;
+    VkImageView indirectAccumView = VK_NULL_HANDLE;
+    VkImageView indirectHistoryView = VK_NULL_HANDLE;
+    VkDescriptorSetLayout indirectTemporalSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSet indirectTemporalSet = VK_NULL_HANDLE;
+    VkPipeline indirectTemporalPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout indirectTemporalPipelineLayout = VK_NULL_HANDLE;
+    bool indirectImagesInitialized = false; // accum and history are in GENERAL
+    uint32_t indirectHistoryKey = 0;        // indirect pass that wrote the history; 0: none (last frame had no pass)
+    float indirectHistorySphereCenters[2][4] = {}; // sphere centres when the history was written
+    uint32_t indirectDivisor = 1;    // of the current targets: 1, 2 or 4
+    bool indirectReservoirs = false; // the current targets include full-size ReSTIR reservoirs
+    uint32_t indirectGeneration = 0; // bumped on every divisor or reservoir switch, see indirectResourceName()
+
+    // ReSTIR (kCornellVariantRestir): two halves of GpuRestirReservoir per pass texel.
+    // The pass writes half restirHalf from the other one, the main pass reads it
+    VkBuffer restirReservoirBuffer = VK_NULL_HANDLE;
+    uint32_t restirHalf = 0;            // written by the next pass
+    bool restirReservoirsValid = false; // the other half holds the last frame's; cleared before the pass otherwise
+    float restirSphereCenters[2][4] = {}; // sphere centres when the last reservoirs were written
+
     // Flower texture resources
     VkImage flowerTexture = VK_NULL_HANDLE;
     VmaAllocation flowerTextureAllocation = VK_NULL_HANDLE;
@@ -200,21 +242,52 @@ private:
     VkDescriptorSetLayout rsmDescriptorSetLayout = VK_NULL_HANDLE;
     VkDescriptorSet rsmDescriptorSet = VK_NULL_HANDLE;
 
+    void initVulkanHeadless();
+    void createContext(int width, int height);
+    void createSceneResources();
     void createRenderPass();
     void createFramebuffers();
     void createRSMPassResources();
-    void recreateRSMResources(uint32_t newSize);
+    void createRSMAttachments();
+    void recreateRSMResources(uint32_t newSize, RSMEncoding newEncoding);
+    std::string rsmResourceName(const char* base) const;
     void createVertexBuffer();
     void createFlowerTexture();
     void createPipeline();
-    void createRSMPipeline();
+    void requestPipelineVariant(uint32_t key, bool urgent);
+    BuiltPipeline buildPipelineVariant(uint32_t key) const; // runs on a build worker
+    void precompilePipelineVariants();
+    const BuiltPipeline& selectPipelineVariant(uint32_t key);
+    std::future<BuiltPipeline> createRSMPipeline(RSMEncoding encoding);
+    std::future<BuiltPipeline> createRSMPyramidPipeline();
+    void recordRSMPyramidPass(VkCommandBuffer cmd);
+    std::future<BuiltPipeline> createVplClusterPipeline();
+    void recordVplClusterPass(VkCommandBuffer cmd, uint32_t clusterCount);
+    void createIndirectPassResources();
+    void createIndirectTargets();
+    void recreateIndirectTargets(uint32_t newDivisor, bool withReservoirs);
+    std::string indirectResourceName(const char* base) const;
+    VkExtent2D getIndirectExtent() const;
+    std::future<BuiltPipeline> createTemporalIndirectPipeline();
+    void recordIndirectPass(VkCommandBuffer cmd, uint32_t imageIndex, uint32_t uniformOffset);
     void createCommandBuffers();
     void recordCommandBuffer(uint32_t imageIndex);
     void drawFrame();
+    void mainLoopHeadless();
+    void startFrameStats();
+    void finishFrameStats();
+
+    // Swapchain or offscreen (headless) render target queries
+    size_t getTargetCount() const;
+    VkExtent2D getTargetExtent() const;
+    VkFormat getTargetFormat() const;
+    std::vector<VkImageView> getTargetImageViews() const;
 
     void createUniformBuffer();
     void createDescriptorSetLayout();
     void createDescriptorSets();
+    std::string descriptorSetName(size_t index) const;
     void updateUniformBuffer(uint32_t imageIndex);
+    double getLastRSMGpuMs() const; // latest RSM pass GPU time, 0 when not measured yet
     void setupMouseCallback();
 };
@@ -0,0 +1,214 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Cornell scene parameters and uniform block shared by the GPU and CPU renderers
+ * @FilePath     : SDFCornellScene.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include "RSMEncoding.hpp"
+
+#include <cstdint>
+
+struct RunOptions;
+
+// std140-compatible layout mirroring shaders/sdf_practice.frag
+struct SDFCornellUniforms {
+    alignas(16) float iTime;
+    alignas(8)  float iResolution[2];
+    alignas(8)  float iMouse[2];
+    alignas(4)  int   iFrame;
+
+    alignas(16) float sphereRotation[4]; // xyz angles (rad), w = animation time
+
+    alignas(16) float sphereColor[4];      // RGB sphere color
+
+    alignas(16) int   enableLights[4];     // x=key, y=fill, z=rim, w=env
+    alignas(16) float lightDir[4];         // xyz dir, w intensity
+    alignas(16) float lightColors[3][4];   // rgb + alpha(intensity)
+    alignas(16) float ambientColor[4];     // rgb + alpha(strength)
+
+    alignas(16) float shadowParams[4];     // x=quality, y=intensity, z=blueTint, w=metallic
+
+    // RSM / light camera parameters
+    alignas(16) float lightRight[4];        // xyz right basis of light camera
+    alignas(16) float lightUp[4];           // xyz up basis of light camera
+    alignas(16) float lightOrigin[4];       // origin of light camera
+    alignas(16) float lightOrthoHalfSize[4];// xy half size of ortho frustum, z=compact RSM encoding(>0.5)
+    alignas(16) float rsmResolution[4];     // xy: RSM texture size, zw: 1 / size (texel step)
+    alignas(16) float rsmParams[4];         // x=radius, y=samples, z=enableIndirectLighting(>0.5), w=enableRSM(>0.5)
+    alignas(16) float indirectParams[4];    // x=indirectIntensity, y=VPL samples per pixel (hierarchical), z=VPL clusters (0: off), w=temporal taps per frame (0: off)
+    
+    // Debug controls
+    alignas(16) float debugParams[4];       // x=showRSMOnly, y=importance sampling, z=showIndirectOnly, w=hierarchical sampling (>0.5)
+
+    // PBR parameters
+    alignas(16) float pbrParams[4];         // x=enablePBR(>0.5), y=globalRoughness, z=globalMetallic, w=indirect resolution divisor (1: full)
+    alignas(16) float roughnessValues[2];   // per-material roughness: [0]=sphere1, [1]=sphere2  
+    alignas(8)  float metallicValues[2];    // per-material metallic: [0]=sphere1, [1]=sphere2 (std140: vec2 packs after vec2)
+    alignas(16) float baseColorFactors[4];  // global color tinting factors: RGB + intensity
+
+    // Per-frame precompute: uniform-only math the shaders used to redo on every SDF evaluation
+    alignas(16) float sphereCenters[2][4];       // xyz world-space centres of sphere1 / sphere2, w radius
+    alignas(16) float sphereLocalRotation[3][4]; // mat3 rotateX*rotateY*rotateZ, columns padded to vec4 (std140)
+
+    // ReSTIR VPL reservoirs
+    alignas(16) float restirParams[4];          // x=initial candidates (0: off), y=spatial neighbours, z=reservoir half written this frame
+    alignas(16) float prevSphereCenters[2][4];  // sphereCenters when the previous reservoirs were written
+};
+
+/**
+ * @brief User-facing scene controls (the ImGui panel edits these directly).
+ */
+struct SDFCornellSettings {
+    float rotationEuler[3] = {0.0f, 0.0f, 0.0f};
+    float rotationAnimSpeed = 0.6f;
+
+    float sphereColor[3] = {0.3f, 0.7f, 1.0f}; // RGB solid color for spheres
+
+    // Lighting
+    bool  enableKey = true;
+    bool  enableFill = true;
+    bool  enableRim = true;
+    bool  enableEnv = true;
+    float keyIntensity = 1.2f;
+    float ambientStrength = 0.25f;
+    float blueTint = 1.0f;
+    float shadowQuality = 1.0f;
+    float shadowIntensity = 0.9f;
+    float metallic = 0.6f;
+
+    // Light direction angles (in radians)
+    float lightElevation = 0.8f;  // Elevation angle (pitch)
+    float lightAzimuth = -0.7f;   // Azimuth angle (yaw)
+
+    // Light orthographic projection size control
+    float lightOrthoHalfSize[2] = {8.0f, 8.0f}; // X and Y half-size of orthographic frustum
+
+    // RSM controls
+    bool  enableRSM = false;
+    bool  enableIndirectLighting = true;  // Enable indirect lighting when RSM is enabled
+    bool  enableImportanceSampling = true; // Enable adaptive importance sampling for RSM
+    bool  enableHierarchicalSampling = true; // Sample VPLs from the whole RSM through the flux pyramid
+    int   vplSamples = 4; // VPLs per pixel with hierarchical sampling (1-16)
+    bool  enableVplClustering = false; // Shade with a k-means reduced VPL list instead (overrides hierarchical)
+    int   vplClusterCount = 256; // kMinVplClusters-kMaxVplClusters
+    bool  enableTemporalIndirect = false; // Gather a few taps per frame and accumulate them over frames (not with clustering)
+    int   temporalTaps = 4; // VPL taps per pixel and frame with temporal accumulation (1-16)
+    int   indirectResolutionDivisor = 1; // 1, 2 or 4: indirect light rendered at 1/n width and height, then upsampled
+    bool  enableRestir = false; // Resample VPLs through per-pixel reservoirs reused over frames and neighbours (not with clustering)
+    int   restirCandidates = 8; // Initial VPL candidates per pixel and frame with ReSTIR (1-32)
+    int   restirSpatialNeighbours = 4; // Neighbour reservoirs each pixel merges with ReSTIR (0-8)
+    float indirectIntensity = 1.0f; // Physically-based scale for indirect lighting
+
+    // Debug/visualization
+    bool showRSMOnly = false;
+    bool showIndirectOnly = false;  // Show only indirect lighting
+
+    // PBR controls
+    bool enablePBR = false;
+    float globalRoughness = 0.5f;
+    float globalMetallic = 0.0f;
+    float sphere1Roughness = 0.4f;  // Textured sphere - medium roughness
+    float sphere1Metallic = 0.1f;   // Slightly metallic
+    float sphere2Roughness = 0.2f;  // Colored sphere - smoother
+    float sphere2Metallic = 0.8f;   // More metallic
+    float baseColorIntensity = 1.0f;
+};
+
+/**
+ * @brief Per-frame values that do not come from the settings panel.
+ */
+struct SDFCornellFrameInputs {
+    float time = 0.0f;
+    uint32_t width = 1;
+    uint32_t height = 1;
+    int frame = 0;
+    float mouse[2] = {0.0f, 0.0f};
+    uint32_t rsmWidth = 1024;
+    uint32_t rsmHeight = 1024;
+    RSMEncoding rsmEncoding = RSMEncoding::Full; // how the RSM attachments store a texel
+};
+
+/**
+ * @brief Supported indirect resolution divisor for a requested one: 1, 2 or 4.
+ */
+uint32_t clampCornellIndirectDivisor(int divisor);
+
+/**
+ * @brief Width or height of the indirect pass for a `fullSize` target, rounded up.
+ */
+inline uint32_t getCornellIndirectSize(uint32_t fullSize, uint32_t divisor) {
+    return (fullSize + divisor - 1) / divisor;
+}
+
+/**
+ * @brief Fill the uniform block exactly as the GPU path uploads it.
+ */
+SDFCornellUniforms makeCornellUniforms(const SDFCornellSettings& settings, const SDFCornellFrameInputs& frame);
+
+/**
+ * @brief Start settings from the command line, for the GPU scene and the CPU reference alike.
+ */
+void applyCornellRunOptions(const RunOptions& options, SDFCornellSettings& settings);
+
+/**
+ * @brief Feature bits of an sdf_practice.frag pipeline variant. Bit i is the
+ * boolean specialization constant with constant_id i.
+ */
+enum CornellVariantBits : uint32_t {
+    kCornellVariantKeyLight = 1u << 0,
+    kCornellVariantFillLight = 1u << 1,
+    kCornellVariantRimLight = 1u << 2,
+    kCornellVariantEnvLight = 1u << 3,
+    kCornellVariantRSM = 1u << 4,
+    kCornellVariantIndirect = 1u << 5,
+    kCornellVariantImportanceSampling = 1u << 6,
+    kCornellVariantPBR = 1u << 7,
+    kCornellVariantDebugRSM = 1u << 8,
+    kCornellVariantDebugIndirect = 1u << 9,
+    kCornellVariantHierarchical = 1u << 10,
+    kCornellVariantVplClusters = 1u << 11,
+    kCornellVariantTemporalIndirect = 1u << 12, // indirect term read from indirect_temporal.comp's output
+    kCornellVariantIndirectPass = 1u << 13,     // renders that term's raw taps instead of the image
+    kCornellVariantIndirectUpsample = 1u << 14, // indirect term upsampled from a reduced-resolution pass
+    kCornellVariantRestir = 1u << 15,           // indirect term resampled from the pass's reservoirs
+};
+constexpr uint32_t kCornellVariantFlagCount = 16;
+
+/** @brief Cap on the frames temporal accumulation averages (indirect_temporal.comp). */
+constexpr float kTemporalIndirectMaxFrames = 16.0f;
+
+/** @brief One ReSTIR reservoir of the storage buffer (std430, RestirReservoir in sdf_practice.frag). */
+struct GpuRestirReservoir {
+    float surface[4]; // xyz normal, w hit distance (0: empty)
+    uint32_t texel;   // selected RSM texel, y * size + x
+    float weight;     // W, its unbiased contribution weight
+    float count;      // M, candidates seen
+    float pad;
+};
+static_assert(sizeof(GpuRestirReservoir) == 32, "GpuRestirReservoir must match RestirReservoir in sdf_practice.frag");
+
+/**
+ * @brief The variant that renders `settings`. Flags that cannot change the image
+ * (importance sampling without indirect light or under hierarchical sampling,
+ * hierarchical sampling, temporal accumulation and ReSTIR under VPL clustering, temporal
+ * accumulation under ReSTIR, everything but the RSM under
+ * "Show RSM Only") are dropped so such settings share one pipeline.
+ */
+uint32_t makeCornellVariantKey(const SDFCornellSettings& settings);
+
+/**
+ * @brief True if main variant `key` reads its indirect term from a separate pass
+ * (temporal accumulation, ReSTIR, reduced resolution or a mix).
+ */
+bool usesCornellIndirectPass(uint32_t key);
+
+/**
+ * @brief The kCornellVariantIndirectPass variant that feeds a main variant `key`
+ * for which usesCornellIndirectPass() holds: only the flags that pick the
+ * indirect sampling survive.
+ */
+uint32_t makeCornellIndirectPassKey(uint32_t key);
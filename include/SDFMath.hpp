@@ -0,0 +1,115 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Minimal GLSL-style vector math for the CPU ports of the shaders
+ * @FilePath     : SDFMath.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief float-only vec2/vec3/mat3 with GLSL semantics, so shader code can be
+ * ported line by line. Mat3 is column-major and its constructor takes the
+ * same nine scalars, in the same order, as GLSL's mat3(...).
+ */
+namespace sdf {
+
+struct Vec2 {
+    float x = 0.0f, y = 0.0f;
+    constexpr Vec2() = default;
+    constexpr Vec2(float x_, float y_) : x(x_), y(y_) {}
+    constexpr explicit Vec2(float s) : x(s), y(s) {}
+};
+
+struct Vec3 {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    constexpr Vec3() = default;
+    constexpr Vec3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
+    constexpr explicit Vec3(float s) : x(s), y(s), z(s) {}
+    float& operator[](int i) { return i == 0 ? x : (i == 1 ? y : z); }
+    float operator[](int i) const { return i == 0 ? x : (i == 1 ? y : z); }
+};
+
+inline constexpr Vec2 operator+(Vec2 a, Vec2 b) { return {a.x + b.x, a.y + b.y}; }
+inline constexpr Vec2 operator-(Vec2 a, Vec2 b) { return {a.x - b.x, a.y - b.y}; }
+inline constexpr Vec2 operator*(Vec2 a, Vec2 b) { return {a.x * b.x, a.y * b.y}; }
+inline constexpr Vec2 operator/(Vec2 a, Vec2 b) { return {a.x / b.x, a.y / b.y}; }
+inline constexpr Vec2 operator*(Vec2 a, float s) { return {a.x * s, a.y * s}; }
+inline constexpr Vec2 operator*(float s, Vec2 a) { return {a.x * s, a.y * s}; }
+inline constexpr Vec2 operator/(Vec2 a, float s) { return {a.x / s, a.y / s}; }
+inline Vec2& operator+=(Vec2& a, Vec2 b) { a = a + b; return a; }
+
+inline constexpr Vec3 operator+(Vec3 a, Vec3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline constexpr Vec3 operator-(Vec3 a, Vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline constexpr Vec3 operator-(Vec3 a) { return {-a.x, -a.y, -a.z}; }
+inline constexpr Vec3 operator*(Vec3 a, Vec3 b) { return {a.x * b.x, a.y * b.y, a.z * b.z}; }
+inline constexpr Vec3 operator/(Vec3 a, Vec3 b) { return {a.x / b.x, a.y / b.y, a.z / b.z}; }
+inline constexpr Vec3 operator*(Vec3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+inline constexpr Vec3 operator*(float s, Vec3 a) { return {a.x * s, a.y * s, a.z * s}; }
+inline constexpr Vec3 operator/(Vec3 a, float s) { return {a.x / s, a.y / s, a.z / s}; }
+inline constexpr Vec3 operator+(Vec3 a, float s) { return {a.x + s, a.y + s, a.z + s}; }
+inline constexpr Vec3 operator-(float s, Vec3 a) { return {s - a.x, s - a.y, s - a.z}; }
+inline Vec3& operator+=(Vec3& a, Vec3 b) { a = a + b; return a; }
+inline Vec3& operator*=(Vec3& a, Vec3 b) { a = a * b; return a; }
+inline Vec3& operator*=(Vec3& a, float s) { a = a * s; return a; }
+
+inline constexpr float dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+inline constexpr float dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline constexpr Vec3 cross(Vec3 a, Vec3 b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+inline float length(Vec2 a) { return std::sqrt(dot(a, a)); }
+inline float length(Vec3 a) { return std::sqrt(dot(a, a)); }
+// Like GLSL, a zero vector yields NaNs; callers must not rely on the result
+inline Vec2 normalize(Vec2 a) { return a / length(a); }
+inline Vec3 normalize(Vec3 a) { return a / length(a); }
+inline constexpr Vec3 reflect(Vec3 i, Vec3 n) { return i - n * (2.0f * dot(n, i)); }
+
+inline float clamp(float v, float lo, float hi) { return std::min(std::max(v, lo), hi); }
+inline Vec2 clamp(Vec2 v, float lo, float hi) { return {clamp(v.x, lo, hi), clamp(v.y, lo, hi)}; }
+inline Vec3 clamp(Vec3 v, float lo, float hi) { return {clamp(v.x, lo, hi), clamp(v.y, lo, hi), clamp(v.z, lo, hi)}; }
+inline Vec2 max(Vec2 a, Vec2 b) { return {std::max(a.x, b.x), std::max(a.y, b.y)}; }
+inline Vec3 max(Vec3 a, Vec3 b) { return {std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)}; }
+inline Vec3 min(Vec3 a, Vec3 b) { return {std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)}; }
+inline constexpr float mix(float a, float b, float t) { return a + (b - a) * t; }
+inline constexpr Vec3 mix(Vec3 a, Vec3 b, float t) { return a + (b - a) * t; }
+inline float fract(float v) { return v - std::floor(v); }
+inline float smoothstep(float e0, float e1, float x) {
+    float t = clamp((x - e0) / (e1 - e0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+struct Mat3 {
+    Vec3 c0{1.0f, 0.0f, 0.0f}, c1{0.0f, 1.0f, 0.0f}, c2{0.0f, 0.0f, 1.0f}; // columns
+    constexpr Mat3() = default;
+    constexpr Mat3(float m00, float m01, float m02,
+                   float m10, float m11, float m12,
+                   float m20, float m21, float m22)
+        : c0(m00, m01, m02), c1(m10, m11, m12), c2(m20, m21, m22) {}
+};
+
+inline constexpr Vec3 operator*(const Mat3& m, Vec3 v) { return m.c0 * v.x + m.c1 * v.y + m.c2 * v.z; }
+inline constexpr Mat3 operator*(const Mat3& a, const Mat3& b) {
+    Vec3 c0 = a * b.c0, c1 = a * b.c1, c2 = a * b.c2;
+    return {c0.x, c0.y, c0.z, c1.x, c1.y, c1.z, c2.x, c2.y, c2.z};
+}
+
+// Same matrices as rotateX/Y/Z in the shaders
+inline Mat3 rotateX(float a) {
+    float s = std::sin(a), c = std::cos(a);
+    return {1, 0, 0, 0, c, -s, 0, s, c};
+}
+inline Mat3 rotateY(float a) {
+    float s = std::sin(a), c = std::cos(a);
+    return {c, 0, s, 0, 1, 0, -s, 0, c};
+}
+inline Mat3 rotateZ(float a) {
+    float s = std::sin(a), c = std::cos(a);
+    return {c, -s, 0, s, c, 0, 0, 0, 1};
+}
+
+} // namespace sdf
@@ -0,0 +1,50 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 11:00:00
+ * @Description  : Persistently mapped uniform buffer with one slice per frame in flight
+ * @FilePath     : UniformRingBuffer.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <EasyVulkan/Core/VulkanDevice.hpp>
+#include <EasyVulkan/DataStructures.hpp>
+
+#include <cstdint>
+
+/**
+ * @brief One VkBuffer split into `sliceCount` uniform slices.
+ *
+ * Slice i belongs to frame-in-flight i. A slice is only written after the fence
+ * of its frame has been waited on, so the CPU never overwrites data the GPU may
+ * still read. Descriptors use VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC with
+ * range = getSliceSize() and select the slice via getDynamicOffset() at bind time.
+ * The memory stays mapped for the lifetime of the buffer.
+ *
+ * With `usage` = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT the same scheme backs
+ * VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC descriptors (per-frame light lists etc.).
+ */
+class UniformRingBuffer {
+public:
+    void create(ev::VulkanDevice* device, VkDeviceSize sliceSize, uint32_t sliceCount,
+                VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    void destroy();
+
+    void write(uint32_t slice, const void* data, VkDeviceSize size);
+    template <typename T>
+    void write(uint32_t slice, const T& value) { write(slice, &value, sizeof(T)); }
+
+    VkBuffer getBuffer() const { return buffer; }
+    VkDeviceSize getSliceSize() const { return sliceSize; }
+    uint32_t getDynamicOffset(uint32_t slice) const { return static_cast<uint32_t>(slice * stride); }
+
+private:
+    ev::VulkanDevice* device = nullptr;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    uint8_t* mapped = nullptr;
+    VkDeviceSize sliceSize = 0;
+    VkDeviceSize stride = 0; // sliceSize rounded up to the min uniform/storage offset alignment
+    uint32_t sliceCount = 0;
+};
@@ -0,0 +1,39 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 23:40:00
+ * @Description  : Constants and buffer layout of the clustered VPL list built from the RSM
+ * @FilePath     : VplClusters.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Clustered VPLs: vpl_cluster.comp reduces the RSM to at most
+ * kMaxVplClusters virtual point lights by k-means over position and normal, and
+ * sdf_practice.frag loops over that list instead of reading RSM texels, so the
+ * indirect cost no longer depends on the RSM resolution. shaders/vpl_cluster.glsl
+ * holds the GLSL side of these definitions; CpuCornellRenderer mirrors the build.
+ *
+ * The RSM is first summed into a kVplClusterGridSize^2 grid of cells (flux
+ * summed, position and normal flux-weighted), which are then clustered. Seeds
+ * are drawn in proportion to flux through the RSM pyramid (RSMPyramidLayout),
+ * since lit texels can be a small fraction of the RSM. Centroids persist between
+ * builds, so every RSM update only refines the previous clustering
+ * (kVplClusterIterations Lloyd steps) instead of starting over.
+ */
+constexpr uint32_t kVplClusterGridSize = 128;
+constexpr uint32_t kVplClusterCellCount = kVplClusterGridSize * kVplClusterGridSize;
+constexpr uint32_t kVplClusterIterations = 4;
+constexpr int kMinVplClusters = 64;
+constexpr int kMaxVplClusters = 1024;
+
+/** @brief One entry of the cluster and cell storage buffers (std430). */
+struct GpuVplCluster {
+    float position[4]; // xyz flux-weighted centroid, w member cells (0: empty)
+    float normal[4];   // xyz flux-weighted mean normal
+    float flux[4];     // rgb summed flux of the member texels
+};
+static_assert(sizeof(GpuVplCluster) == 48, "GpuVplCluster must match VplCluster in vpl_cluster.glsl");
@@ -0,0 +1,82 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Fixed-size thread pool with per-worker deques and work stealing
+ * @FilePath     : WorkStealingPool.hpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs index-based task batches on all cores.
+ *
+ * parallelFor() deals the task indices out in contiguous runs, one run per
+ * participant, so neighbouring tiles stay on the same core. A participant pops
+ * from the back of its own deque and, once empty, steals from the front of the
+ * others', which evens out tiles of very different cost (sky vs. shadowed
+ * geometry). The calling thread participates as worker 0.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void(size_t taskIndex, unsigned workerIndex)>;
+
+    /**
+     * @brief `threadCount` participants including the caller; 0 = hardware concurrency.
+     */
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Run task(0..taskCount-1) and return when all have finished.
+     * The first exception thrown by a task is rethrown here.
+     */
+    void parallelFor(size_t taskCount, const Task& task);
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(queues.size()); }
+
+    /**
+     * @brief Tasks executed by a worker other than the one they were dealt to.
+     */
+    uint64_t getStealCount() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void workerLoop(unsigned workerIndex);
+    void drain(unsigned workerIndex);
+    bool popLocal(unsigned workerIndex, size_t& task);
+    bool steal(unsigned thiefIndex, size_t& task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex jobMutex;
+    std::condition_variable jobCv;
+    std::condition_variable doneCv;
+    const Task* job = nullptr;
+    uint64_t generation = 0;
+    unsigned busyWorkers = 0;
+    bool stopping = false;
+    std::exception_ptr firstError;
+
+    std::atomic<uint64_t> steals{0};
+};
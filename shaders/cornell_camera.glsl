@@ -0,0 +1,32 @@
+// Fixed camera of the Cornell scene as main() of sdf_practice.frag sets it up,
+// for passes that reconstruct or reproject its pixels (indirect_temporal.comp).
+// Include after the #version line with GL_GOOGLE_include_directive enabled.
+
+const vec3 CORNELL_CAMERA_ORIGIN = vec3(0.0, 0.0, 5.0);
+const vec3 CORNELL_CAMERA_TARGET = vec3(0.0, 0.0, 0.0);
+const float CORNELL_CAMERA_FOCAL = 1.2; // the 1.2 * cw of the ray direction
+
+void cornellCameraBasis(out vec3 cu, out vec3 cv, out vec3 cw) {
+    cw = normalize(CORNELL_CAMERA_TARGET - CORNELL_CAMERA_ORIGIN);
+    cu = normalize(cross(cw, vec3(0.0, 1.0, 0.0)));
+    cv = normalize(cross(cu, cw));
+}
+
+// Ray direction through fragTexCoord; aspect is width / height
+vec3 cornellCameraRay(vec2 texCoord, float aspect) {
+    vec3 cu, cv, cw;
+    cornellCameraBasis(cu, cv, cw);
+    vec2 uv = (texCoord - 0.5) * 2.0;
+    uv.x *= aspect;
+    return normalize(uv.x * cu + uv.y * cv + CORNELL_CAMERA_FOCAL * cw);
+}
+
+// fragTexCoord a point in front of the camera is seen at (the inverse of cornellCameraRay)
+vec2 cornellCameraProject(vec3 p, float aspect) {
+    vec3 cu, cv, cw;
+    cornellCameraBasis(cu, cv, cw);
+    vec3 v = p - CORNELL_CAMERA_ORIGIN;
+    vec2 uv = vec2(dot(v, cu), dot(v, cv)) * (CORNELL_CAMERA_FOCAL / dot(v, cw));
+    uv.x /= aspect;
+    return uv * 0.5 + 0.5;
+}
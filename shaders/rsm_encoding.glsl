@@ -0,0 +1,58 @@
+// Storage of the three RSM attachments (RSMEncoding in include/RSMEncoding.hpp),
+// shared by rsm_light.frag, which writes them, and by sdf_practice.frag,
+// rsm_pyramid.comp and vpl_cluster.comp, which read them.
+// Include after the #version line with GL_GOOGLE_include_directive enabled.
+//
+// Full:    RGBA16F position, RGBA16F normal, RGBA16F flux.
+// Compact: R16_UNORM depth along the light from its image plane / RSM_DEPTH_RANGE,
+//          RG16_SNORM octahedral normal, B10G11R11_UFLOAT flux.
+// Depth 0 marks a ray that left the scene; it decodes to position 0, as the
+// cleared Full attachment reads. Flux has no alpha in either encoding.
+
+// kRSMDepthRange: farther hits are stored as misses
+const float RSM_DEPTH_RANGE = 32.0;
+
+// Light camera the RSM is rendered with; sdf_practice.frag builds it from its
+// uniforms, the compute passes get it as push constants
+struct RSMLightFrame {
+    vec4 origin; // xyz image plane centre, w 1 for the compact encoding
+    vec4 right;  // xyz, w ortho half width
+    vec4 up;     // xyz, w ortho half height
+    vec4 dir;    // xyz unit direction the light travels
+};
+
+bool rsmIsCompact(RSMLightFrame frame) {
+    return frame.origin.w > 0.5;
+}
+
+// Point of the light's image plane at RSM coordinate uv
+vec3 rsmImagePlanePoint(RSMLightFrame frame, vec2 uv) {
+    vec2 ndc = uv * 2.0 - 1.0;
+    return frame.origin.xyz + frame.right.xyz * (ndc.x * frame.right.w) + frame.up.xyz * (ndc.y * frame.up.w);
+}
+
+// Octahedral map of the unit sphere onto [-1, 1]^2
+vec2 rsmEncodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signs;
+}
+
+// Position texel (texture() or texelFetch()) read at RSM coordinate uv
+vec3 rsmDecodePosition(RSMLightFrame frame, vec4 texel, vec2 uv) {
+    if (!rsmIsCompact(frame)) {
+        return texel.xyz;
+    }
+    return texel.r > 0.0 ? rsmImagePlanePoint(frame, uv) + frame.dir.xyz * (texel.r * RSM_DEPTH_RANGE) : vec3(0.0);
+}
+
+// Unit length for the compact encoding; as stored (callers normalize) for the full one
+vec3 rsmDecodeNormal(RSMLightFrame frame, vec4 texel) {
+    if (!rsmIsCompact(frame)) {
+        return texel.xyz;
+    }
+    vec3 n = vec3(texel.xy, 1.0 - abs(texel.x) - abs(texel.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
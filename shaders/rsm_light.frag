@@ -1,4 +1,7 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "rsm_encoding.glsl"
 
 // G-Buffer Pass for Reflective Shadow Map (RSM)
 // 目的：从光源视角渲染场景，生成三个G-Buffer纹理：
@@ -11,6 +14,7 @@ layout(location = 1) in vec2 fragTexCoord; // 渲染全屏四边形的纹理坐
 
 // --- 输出变量 (Multiple Render Targets - MRT) ---
 // 这些变量将分别写入到不同的纹理附件中
+// 格式见 rsm_encoding.glsl：full 编码如下；compact 编码为 深度 / 八面体法线 / B10G11R11 通量
 layout(location = 0) out vec4 outPosition; // 输出 G-Buffer 0: 世界空间位置 (xyz) + 有效标记 (w)
 layout(location = 1) out vec4 outNormal;   // 输出 G-Buffer 1: 世界空间法线 (xyz)
 layout(location = 2) out vec4 outFlux;     // 输出 G-Buffer 2: 辐射通量 (rgb)，即从该点反射的光能
@@ -32,10 +36,17 @@ layout(binding = 0) uniform SDFCornellUniforms {
     vec4  lightRight;         // 光源相机的 "right" 向量
     vec4  lightUp;            // 光源相机的 "up" 向量
     vec4  lightOrigin;        // 光源相机的原点
-    vec4  lightOrthoHalfSize; // 光源正交投影视锥体的一半大小 (width/2, height/2)
+    vec4  lightOrthoHalfSize; // 光源正交投影视锥体的一半大小 (width/2, height/2)，z = compact 编码
     vec4  rsmResolution;      // RSM 纹理的分辨率
     vec4  rsmParams;          // RSM 相关参数
+    vec4  indirectParams;     // (未使用)
     vec4  debugParams;        // 调试参数 (x=showRSMOnly)
+    vec4  pbrParams;          // (未使用)
+    vec2  roughnessValues;    // (未使用)
+    vec2  metallicValues;     // (未使用)
+    vec4  baseColorFactors;   // (未使用)
+    vec4  sphereCenters[2];   // 每帧预计算：两个球体的世界坐标中心 (xyz) 和半径 (w)
+    mat3  sphereLocalRotation;// 每帧预计算：球体自身旋转 (未使用)
 } u;
 
 // --- 常量 ---
@@ -44,22 +55,6 @@ const int   MAX_STEPS = 128;     // 光线步进的最大步数
 const float SURF_DIST = 0.006;   // 判断是否击中物体表面的距离阈值
 
 // --- 辅助函数 ---
-// X轴旋转矩阵
-mat3 rotateX(float a) {
-    float s = sin(a), c = cos(a);
-    return mat3(1, 0, 0, 0, c, -s, 0, s, c);
-}
-// Y轴旋转矩阵
-mat3 rotateY(float a) {
-    float s = sin(a), c = cos(a);
-    return mat3(c, 0, s, 0, 1, 0, -s, 0, c);
-}
-// Z轴旋转矩阵
-mat3 rotateZ(float a) {
-    float s = sin(a), c = cos(a);
-    return mat3(c, -s, 0, s, c, 0, 0, 0, 1);
-}
-
 // 球体的SDF（Signed Distance Function）
 // 返回点p到半径为r的球体表面的最短距离
 float sphereSDF(vec3 p, float r) { return length(p) - r; }
@@ -67,23 +62,9 @@ float sphereSDF(vec3 p, float r) { return length(p) - r; }
 // 整个场景的SDF
 // 通过组合不同形状的SDF来构建复杂场景
 float sceneSDF(vec3 p) {
-    // 基于时间创建Z轴旋转动画
-    float rotationAngle = u.iTime * 0.5;
-    mat3 zRotation = rotateZ(rotationAngle);
-
-    // 第一个球体
-    vec3 sphere1Pos = zRotation * vec3(2.0, 0.0, 0.0);
-    vec3 sphere1P = p - sphere1Pos;
-    mat3 rotation1 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-    sphere1P = rotation1 * sphere1P; // 应用球体自身的旋转
-    float sphere1 = sphereSDF(sphere1P, 1.0);
-
-    // 第二个球体
-    vec3 sphere2Pos = zRotation * vec3(-2.0, 0.0, 0.0);
-    vec3 sphere2P = p - sphere2Pos;
-    mat3 rotation2 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-    sphere2P = rotation2 * sphere2P; // 应用球体自身的旋转
-    float sphere2 = sphereSDF(sphere2P, 1.0);
+    // 球心（绕Z轴的旋转动画）每帧在CPU上预计算；球体自身的旋转不改变距离，无需应用
+    float sphere1 = sphereSDF(p - u.sphereCenters[0].xyz, u.sphereCenters[0].w);
+    float sphere2 = sphereSDF(p - u.sphereCenters[1].xyz, u.sphereCenters[1].w);
 
     // 使用min操作合并两个球体
     float spheres = min(sphere1, sphere2);
@@ -131,21 +112,8 @@ float rayMarch(vec3 ro, vec3 rd) {
 // 根据世界坐标p获取该点的材质反照率（Albedo）
 // 这段逻辑必须和sceneSDF保持一致，以正确判断p点属于哪个物体
 vec3 getMaterialAlbedo(vec3 p) {
-    // 重新计算SDF值来确定哪个表面最近
-    float rotationAngle = u.iTime * 0.5;
-    mat3 zRotation = rotateZ(rotationAngle);
-    
-    vec3 sphere1Pos = zRotation * vec3(2.0, 0.0, 0.0);
-    vec3 sphere1P = p - sphere1Pos;
-    mat3 rotation1 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-    sphere1P = rotation1 * sphere1P;
-    float sphere1 = sphereSDF(sphere1P, 1.0);
-    
-    vec3 sphere2Pos = zRotation * vec3(-2.0, 0.0, 0.0);
-    vec3 sphere2P = p - sphere2Pos;
-    mat3 rotation2 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-    sphere2P = rotation2 * sphere2P;
-    float sphere2 = sphereSDF(sphere2P, 1.0);
+    float sphere1 = sphereSDF(p - u.sphereCenters[0].xyz, u.sphereCenters[0].w);
+    float sphere2 = sphereSDF(p - u.sphereCenters[1].xyz, u.sphereCenters[1].w);
     
     float spheres = min(sphere1, sphere2);
     
@@ -190,9 +158,10 @@ void main() {
 
   // --- 2. 执行光线步进，找到与场景的交点 ---
   float d = rayMarch(ro, rd);
+  bool compact = u.lightOrthoHalfSize.z > 0.5;
   
-  // 如果距离超过最大值，说明射线没有击中任何物体
-  if (d >= MAX_DIST) {
+  // 如果距离超过最大值，说明射线没有击中任何物体；compact 编码的深度存不下的击中点也按未击中处理
+  if (d >= MAX_DIST || (compact && d >= RSM_DEPTH_RANGE)) {
     // 写入无效数据（全0），以便在后续处理中可以忽略这些像素
     outPosition = vec4(0.0);
     outNormal = vec4(0.0);
@@ -221,10 +190,16 @@ void main() {
   vec3 flux = albedo * lightColor * u.lightDir.w * nDotL * 2.0; 
 
   // --- 5. 将计算结果写入 G-Buffer ---
-  // 将世界坐标写入第一个渲染目标
-  outPosition = vec4(pos, 1.0); // w=1.0 表示这是一个有效的击中点
-  // 将法线写入第二个渲染目标
-  outNormal = vec4(nor, 0.0);
-  // 将辐射通量写入第三个渲染目标
-  outFlux = vec4(flux, 1.0);
+  if (compact) {
+    // 只存沿光线的深度（0 保留给未击中），位置由读取方根据光源相机重建
+    outPosition = vec4(max(d / RSM_DEPTH_RANGE, 1.0 / 65535.0));
+    outNormal = vec4(rsmEncodeNormal(nor), 0.0, 0.0);
+  } else {
+    // 将世界坐标写入第一个渲染目标
+    outPosition = vec4(pos, 1.0); // w=1.0 表示这是一个有效的击中点
+    // 将法线写入第二个渲染目标
+    outNormal = vec4(nor, 0.0);
+  }
+  // 将辐射通量写入第三个渲染目标（两种编码都没有 alpha）
+  outFlux = vec4(flux, 0.0);
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+// Layout of the RSM flux pyramid (RSMPyramidLayout in include/RSMPyramid.hpp),
+// shared by rsm_pyramid.comp, which builds the pyramid, and sdf_practice.frag and
+// vpl_cluster.comp, which descend it.
+// Include after the #version line with GL_GOOGLE_include_directive enabled.
+//
+// Level 0 holds the mean flux luminance of 2x2 RSM texels, every further level
+// the mean of 2x2 nodes of the level below, down to a single node. All levels
+// share one R32F atlas: level 0 on the left, levels 1.. stacked top to bottom in
+// the column to its right. Nodes of RSM_CLUSTER_LEVEL cover 16x16 RSM texels; the
+// cluster images hold a normal cone and a bounding sphere for each of them.
+
+const int RSM_CLUSTER_LEVEL = 3;
+
+// Weight VPLs are sampled by
+float rsmLuminance(vec3 flux) {
+    return dot(flux, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// rsmLuminance of the 2x2 flux texels around uv, in textureGather order; the
+// compact flux format has no alpha to keep it in, so it is one gather per channel
+vec4 rsmGatherLuminance(sampler2D fluxTex, vec2 uv) {
+    return 0.2126 * textureGather(fluxTex, uv, 0) + 0.7152 * textureGather(fluxTex, uv, 1) +
+           0.0722 * textureGather(fluxTex, uv, 2);
+}
+
+// Levels above a square power-of-two RSM of rsmSize texels (level 0 is rsmSize / 2)
+int rsmPyramidLevelCount(int rsmSize) {
+    return findMSB(rsmSize);
+}
+
+// Atlas texel of the level's top-left node; baseSize is the width of level 0
+ivec2 rsmPyramidLevelOrigin(int level, int baseSize) {
+    return level == 0 ? ivec2(0) : ivec2(baseSize, baseSize - (baseSize >> (level - 1)));
+}
+
+// PCG hash; also what vpl_cluster.comp reseeds empty clusters with
+uint pcgHash(uint v) {
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// Per-pixel offset of the stratified descents, stable across frames
+float rsmSampleOffset(ivec2 pixel) {
+    return float(pcgHash(uint(pixel.x) + 65536u * uint(pixel.y)) >> 8) * (1.0 / 16777216.0);
+}
@@ -1,4 +1,5 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
 // Input from vertex shader
 layout(location = 0) in vec3 fragColor;
@@ -7,106 +8,34 @@ layout(location = 1) in vec2 fragTexCoord;
 // Output
 layout(location = 0) out vec4 outColor;
 
-// Uniform buffer for ShaderToy-style uniforms
-layout(std140, binding = 0) uniform ShaderToyUBO {
-    float iTime;
-    vec2 iResolution;
-    vec2 iMouse;        // Mouse position for circle
-    vec2 lightPos;      // Light 1 position
-    vec4 lightOn;
-    vec4 lightRadius;
-};
-
-//////////////////////////////////////
-// Combine distance field functions //
-//////////////////////////////////////
-
-float smoothMerge(float d1, float d2, float k)
-{
-    float h = clamp(0.5 + 0.5*(d2 - d1)/k, 0.0, 1.0);
-    return mix(d2, d1, h) - k * h * (1.0-h);
-}
-
-float merge(float d1, float d2)
-{
-    return min(d1, d2);
-}
+#include "sdf2d_scene.glsl"
 
-//////////////////////////////
-// Rotation and translation //
-//////////////////////////////
+// Baked by the compute pre-passes (set 1, one image each per frame in flight)
+layout(set = 1, binding = 0) uniform sampler2D sceneDistanceTex; // sceneDist() per pixel
+layout(set = 1, binding = 1) uniform sampler2D polarShadowTex;   // see sdf2d_polar_shadow.comp
 
-vec2 translate(vec2 p, vec2 t)
-{
-    return p - t;
-}
-
-vec2 rotateCW(vec2 p, float a)
-{
-    mat2 m = mat2(cos(a), -sin(a), sin(a), cos(a));
-    return p * m;
-}
-
-//////////////////////////////
-// Distance field functions //
-//////////////////////////////
-
-float circleDist(vec2 p, float radius)
-{
-    return length(p) - radius;
-}
-
-float boxDist(vec2 p, vec2 size, float radius)
-{
-    size -= vec2(radius);
-    vec2 d = abs(p) - size;
-    return min(max(d.x, d.y), 0.0) + length(max(d, 0.0)) - radius;
-}
+// Lights touching each screen tile, written by sdf2d_light_binning.comp
+layout(std430, set = 1, binding = 2) readonly buffer TileLights {
+    uint tileLights[];
+};
 
-vec2 flamePerturbation(vec2 p, vec2 rectPos, vec2 rectSize)
+// Bilinear lookup of the baked field at pixel position p (texel centres at +0.5).
+// Filtered by hand: linear filtering of 32-bit float textures is an optional feature.
+// Outside the screen the edge texels are repeated.
+float sampleSceneDist(vec2 p)
 {
-    // vec2 relativeP = p - rectPos;
-    // float rectDist = boxDist(relativeP, rectSize, 5.0);
-    
-    // // Only apply perturbation near the edges (distance < 80 for flame spread)
-    // float edgeInfluence = smoothstep(80.0, 0.0, rectDist);
-    
-    // // Calculate height from rectangle bottom for upward flame flow
-    // float heightFromBottom = (relativeP.y + rectSize.y) / (rectSize.y * 2.0);
-    // heightFromBottom = clamp(heightFromBottom, 0.0, 1.0);
-    
-    // // Flame flows more upward as height increases
-    // float upwardBias = heightFromBottom * 2.0 + 0.5;
-    
-    // // Fast flickering time for flame dynamics
-    // float time = iTime * 2.5;
-    // vec2 noiseCoord = p * 0.004;
-    
-    // vec2 flameDistortion = vec2(0.0);
-    
-    // // Large flame tongues with strong upward bias
-    // float largeFlamex = sin(noiseCoord.x * 3.0 + time * 1.2) * cos(noiseCoord.y * 2.0 + time * 0.8);
-    // float largeFlamey = cos(noiseCoord.x * 2.5 + time * 1.5) * sin(noiseCoord.y * 3.5 + time * 1.1) * upwardBias;
-    // flameDistortion += vec2(largeFlamex, largeFlamey) * 35.0;
-    
-    // // Medium flickering flames
-    // float medFlamex = sin(noiseCoord.x * 8.0 + time * 2.0) * cos(noiseCoord.y * 6.0 + time * 1.8);
-    // float medFlamey = cos(noiseCoord.x * 7.0 + time * 2.3) * sin(noiseCoord.y * 9.0 + time * 2.1) * upwardBias;
-    // flameDistortion += vec2(medFlamex, medFlamey) * 20.0;
-    
-    // // Fine flame detail with rapid flickering
-    // float fineFlamex = sin(noiseCoord.x * 20.0 + time * 4.0) * cos(noiseCoord.y * 18.0 + time * 3.5);
-    // float fineFlamey = cos(noiseCoord.x * 19.0 + time * 4.2) * sin(noiseCoord.y * 22.0 + time * 4.8) * upwardBias;
-    // flameDistortion += vec2(fineFlamex, fineFlamey) * 10.0;
-    
-    // // Additional vertical stretching for flame effect
-    // flameDistortion.y *= 1.5;
-    
-    // // Apply falloff based on distance from rectangle edge with flame-specific curve
-    // float flameFalloff = exp(-rectDist * 0.015) * (1.0 + heightFromBottom * 0.8);
-    
-    // return p + flameDistortion * edgeInfluence * flameFalloff;
-    return p;
+    if (distanceParams.x < 0.5) {
+        return sceneDist(p);
+    }
+    vec2 st = p - 0.5;
+    ivec2 i0 = ivec2(floor(st));
+    vec2 f = st - vec2(i0);
+    ivec2 maxTexel = textureSize(sceneDistanceTex, 0) - 1;
+    float d00 = texelFetch(sceneDistanceTex, clamp(i0,               ivec2(0), maxTexel), 0).r;
+    float d10 = texelFetch(sceneDistanceTex, clamp(i0 + ivec2(1, 0), ivec2(0), maxTexel), 0).r;
+    float d01 = texelFetch(sceneDistanceTex, clamp(i0 + ivec2(0, 1), ivec2(0), maxTexel), 0).r;
+    float d11 = texelFetch(sceneDistanceTex, clamp(i0 + ivec2(1, 1), ivec2(0), maxTexel), 0).r;
+    return mix(mix(d00, d10, f.x), mix(d01, d11, f.x), f.y);
 }
 
 ///////////////////////
@@ -125,56 +54,6 @@ float innerBorderMask(float dist, float width)
     return alpha1 - alpha2;
 }
 
-///////////////
-// The scene //
-///////////////
-
-float sceneDist(vec2 p)
-{
-    // Animation parameters
-    float time = iTime * 1.5;  // Speed of animation
-    float cycle = 8.0;         // Duration of one complete cycle
-    float t = mod(time, cycle) / cycle;  // Normalized time [0,1] for one cycle
-    
-    // Shape parameters
-    float circleRadius = 35.0;
-    vec2 rectSize = vec2(80.0, 250.0);
-    vec2 centerScreen = iResolution.xy / 2.0;
-    
-    // Rectangle stays fixed at center of screen
-    vec2 rectPos = centerScreen;
-    
-    // Circle follows mouse position
-    vec2 circlePos = iMouse.xy * 2.0;
-    
-    // Calculate shape distances
-    float circle = circleDist(translate(p, circlePos), circleRadius);
-    
-    // Rectangle with flame perturbation effect on edges
-    vec2 perturbedP = flamePerturbation(p, rectPos, rectSize);
-    float rectangle = boxDist(translate(perturbedP, rectPos), rectSize, 5.0); // Rounded corners
-    
-    // Merge the shapes with smooth blending when boundaries get close
-    float blendRadius = 200.0;  // Distance between boundaries at which smooth merging starts
-    
-    // Calculate the distance between the boundaries (not centers)
-    // This is the minimum distance between the surfaces of the two shapes
-    float boundaryDist = max(circle, rectangle);  // Distance from point to closest boundary
-    
-    // Alternative approach: calculate actual boundary-to-boundary distance
-    // We need to find how close the surfaces are to each other
-    float surfaceDistance = circle + rectangle;  // Sum gives approximate boundary separation
-    
-    if (surfaceDistance < blendRadius) {
-        // Use smooth merge when boundaries are close
-        float k = 100.0 * (1.0 - surfaceDistance / blendRadius);  // Blend strength increases as boundaries get closer
-        return smoothMerge(circle, rectangle, k);
-    } else {
-        // Use regular merge when boundaries are far apart
-        return merge(circle, rectangle);
-    }
-}
-
 //////////////////////
 // Shadow and light //
 //////////////////////
@@ -193,7 +72,7 @@ float shadow(vec2 p, vec2 pos, float radius)
     for (int i = 0; i < 64; ++i)
     {			
         // distance to scene at current position
-        float sd = sceneDist(p + dir * dt);
+        float sd = sampleSceneDist(p + dir * dt);
 
         // early out when this ray is guaranteed to be full shadow
         if (sd < -radius) 
@@ -217,7 +96,40 @@ float shadow(vec2 p, vec2 pos, float radius)
     return lf;
 }
 
-vec4 drawLight(vec2 p, vec2 pos, vec4 color, float dist, float range, float radius)
+// Same soft shadow from the light's polar shadow map: a 1D PCSS lookup.
+// A receiver at distance d behind an occluder edge at distance r is in penumbra
+// for angles within radius * (d - r) / (d * r) of the edge, so the depth test is
+// box-filtered over that angular window.
+float polarShadow(vec2 p, int light, vec2 pos, float radius)
+{
+    vec2 toP = p - pos;
+    float d = length(toP);
+    int width = textureSize(polarShadowTex, 0).x;
+    float u = polarTexelOfAngle(atan(toP.y, toP.x), float(width));
+    int centre = polarWrap(int(round(u)), width);
+
+    // No occluder in front of the receiver anywhere near this direction: fully lit
+    float blocker = texelFetch(polarShadowTex, ivec2(centre, light), 0).g;
+    if (d <= blocker)
+        return 1.0;
+
+    blocker = max(blocker, 1.0);
+    float penumbra = radius * (d - blocker) / (d * blocker);
+    float halfTexels = clamp(penumbra / (2.0 * POLAR_PI) * float(width), 0.5, float(POLAR_BLOCKER_RADIUS));
+
+    const int TAPS = 6; // 2 * TAPS + 1 samples
+    float lit = 0.0;
+    for (int k = -TAPS; k <= TAPS; ++k)
+    {
+        int texel = polarWrap(int(round(u + float(k) / float(TAPS) * halfTexels)), width);
+        float occluder = texelFetch(polarShadowTex, ivec2(texel, light), 0).r;
+        lit += d <= occluder + 1.0 ? 1.0 : 0.0;
+    }
+    lit /= float(2 * TAPS + 1);
+    return smoothstep(0.0, 1.0, lit);
+}
+
+vec4 drawLight(vec2 p, int light, vec2 pos, vec4 color, float dist, float range, float radius)
 {
     // distance to light
     float ld = length(p - pos);
@@ -226,22 +138,17 @@ vec4 drawLight(vec2 p, vec2 pos, vec4 color, float dist, float range, float radi
     if (ld > range) return vec4(0.0);
     
     // shadow and falloff
-    float shad = shadow(p, pos, radius);
+    float shad = shadowParams.x > 0.5 ? polarShadow(p, light, pos, radius) : shadow(p, pos, radius);
     float fall = (range - ld)/range;
     fall *= fall;
     float source = fillMask(circleDist(p - pos, radius));
     return (shad * fall + source) * color;
 }
 
-float luminance(vec4 col)
-{
-    return 0.2126 * col.r + 0.7152 * col.g + 0.0722 * col.b;
-}
-
-void setLuminance(inout vec4 col, float lum)
+vec4 shadeLight(vec2 p, uint i, float dist)
 {
-    lum /= luminance(col);
-    col *= lum;
+    Light2D light = sceneLights[i];
+    return drawLight(p, int(i), light.position, light.color, dist, light.range, light.radius);
 }
 
 float AO(vec2 p, float dist, float radius, float intensity)
@@ -261,20 +168,7 @@ void main()
     vec2 p = fragCoord;
     vec2 c = iResolution.xy / 2.0;
     
-    float dist = sceneDist(p);
-    
-    // Beautiful three light setup with warm/cool contrast
-    vec2 light1Pos = lightPos.xy;  // Use slider-controlled position
-    vec4 light1Col = vec4(1.0, 0.8, 0.3, 1.0);  // Warm golden light
-    setLuminance(light1Col, 0.6);
-    
-    vec2 light2Pos = vec2(iResolution.x * (sin(iTime + 3.1415) + 1.2) / 2.4, 175.0);
-    vec4 light2Col = vec4(0.3, 0.7, 1.0, 1.0);  // Cool blue light
-    setLuminance(light2Col, 0.7);
-    
-    vec2 light3Pos = vec2(iResolution.x * (sin(iTime) + 1.2) / 2.4, 340.0);
-    vec4 light3Col = vec4(1.0, 0.4, 0.6, 1.0);  // Magenta accent light
-    setLuminance(light3Col, 0.5);
+    float dist = sampleSceneDist(p); // exact at pixel centres
     
     // Beautiful dark gradient background
     float gradientFactor = 1.0 - length(c - p) / (iResolution.x * 0.8);
@@ -294,26 +188,27 @@ void main()
     // ambient occlusion
     col *= AO(p, dist, 40.0, 0.4);
     
-    // light (range auto-calculated from radius; 25.0 keeps previous defaults)
-    float r2range = 25.0;
-    col += lightOn.x * drawLight(p, light1Pos, light1Col, dist, lightRadius.x * r2range, lightRadius.x);
-    col += lightOn.y * drawLight(p, light2Pos, light2Col, dist, lightRadius.y * r2range, lightRadius.y);
-    col += lightOn.z * drawLight(p, light3Pos, light3Col, dist, lightRadius.z * r2range, lightRadius.z);
+    // lights: only those whose range touches this pixel's tile, in list order
+    if (lightInfo.w != 0u) {
+        uvec2 tile = uvec2(p) / LIGHT_TILE_SIZE;
+        uint base = (tile.y * lightInfo.y + tile.x) * LIGHT_TILE_STRIDE;
+        uint count = tileLights[base];
+        for (uint i = 0u; i < count; ++i) {
+            col += shadeLight(p, tileLights[base + 1u + i], dist);
+        }
+    } else {
+        for (uint i = 0u; i < lightInfo.x; ++i) {
+            col += shadeLight(p, i, dist);
+        }
+    }
     
     // Fill shapes with beautiful gradient colors
-    // Create a dynamic color based on position and time for more interest
-    float colorPhase = sin(iTime * 0.5) * 0.5 + 0.5;
-    vec4 shapeColor = mix(
-        vec4(0.2, 0.8, 1.0, 1.0),     // Bright cyan
-        vec4(0.8, 0.3, 1.0, 1.0),     // Purple-magenta
-        colorPhase
-    );
-    
-    // Add some spatial variation to the color
+    // Time-varying cyan/purple mix comes from the CPU; add some spatial variation to it
+    vec4 fillColor = shapeColor;
     float spatialVariation = sin(p.x * 0.01) * sin(p.y * 0.01) * 0.3 + 0.7;
-    shapeColor.rgb *= spatialVariation;
+    fillColor.rgb *= spatialVariation;
     
-    col = mix(col, shapeColor, fillMask(dist));
+    col = mix(col, fillColor, fillMask(dist));
     
     // Add elegant shape outline with subtle glow
     vec4 outlineColor = vec4(0.9, 0.9, 1.0, 1.0) * 0.8;  // Soft white-blue outline
@@ -0,0 +1,205 @@
+// Scene of the 2D circle/rectangle demo, shared by sdf2dCircleRect.frag and the
+// compute pre-passes that bake it once per frame (sdf2d_distance.comp: sceneDist()
+// per pixel, sdf2d_polar_shadow.comp: occluder distance per light and angle,
+// sdf2d_light_binning.comp: lights per screen tile).
+// Include after the #version line with GL_GOOGLE_include_directive enabled.
+
+// Uniform buffer for ShaderToy-style uniforms
+layout(std140, binding = 0) uniform ShaderToyUBO {
+    float iTime;
+    vec2 iResolution;
+    vec2 iMouse;        // Mouse position for circle
+    // Per-frame values computed on the CPU (SDF2D::updateUniformBuffer) instead of per pixel
+    vec4 shapeCenters;    // xy = circle, zw = rectangle
+    vec4 shapeColor;      // animated fill colour
+    vec4 distanceParams;  // x > 0.5: sample the baked distance texture instead of calling sceneDist
+    vec4 shadowParams;    // x > 0.5: polar shadow map lookup instead of the cone march
+    uvec4 lightInfo;      // x = light count, y/z = tile columns/rows, w != 0: tiled culling
+};
+
+////////////
+// Lights //
+////////////
+
+// Enabled lights only, lightInfo.x of them (SDF2D::uploadLights, Light2DGpu).
+// range = radius * 25; colour is already scaled to the light's luminance.
+struct Light2D {
+    vec2 position;
+    float radius;
+    float range;
+    vec4 color;
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer SceneLights {
+    Light2D sceneLights[];
+};
+
+// Screen tiles of LIGHT_TILE_SIZE^2 pixels; each holds LIGHT_TILE_STRIDE uints:
+// [count, light index 0, light index 1, ...] (SDF2D::kLightTileSize/kLightTileStride).
+// The stride fits all SDF2D::kMaxLights lights, so a tile never drops one
+const uint LIGHT_TILE_SIZE = 16u;
+const uint LIGHT_TILE_STRIDE = 257u;
+
+///////////////////////
+// Polar shadow maps //
+///////////////////////
+
+// Row = light, column = angle around it in atan() order (-pi..pi)
+
+const float POLAR_PI = 3.14159265359;
+
+// Half-width, in texels, of the window the bake pass min-filters into the y channel
+const int POLAR_BLOCKER_RADIUS = 32;
+
+float polarAngleOfTexel(float texel, float width)
+{
+    return (texel + 0.5) / width * (2.0 * POLAR_PI) - POLAR_PI;
+}
+
+// Continuous texel coordinate (texel centres at integers) of a direction
+float polarTexelOfAngle(float angle, float width)
+{
+    return (angle + POLAR_PI) / (2.0 * POLAR_PI) * width - 0.5;
+}
+
+// Angles wrap around; i is never more than one width out of range
+int polarWrap(int i, int width)
+{
+    return i < 0 ? i + width : (i >= width ? i - width : i);
+}
+
+//////////////////////////////////////
+// Combine distance field functions //
+//////////////////////////////////////
+
+float smoothMerge(float d1, float d2, float k)
+{
+    float h = clamp(0.5 + 0.5*(d2 - d1)/k, 0.0, 1.0);
+    return mix(d2, d1, h) - k * h * (1.0-h);
+}
+
+float merge(float d1, float d2)
+{
+    return min(d1, d2);
+}
+
+//////////////////////////////
+// Rotation and translation //
+//////////////////////////////
+
+vec2 translate(vec2 p, vec2 t)
+{
+    return p - t;
+}
+
+vec2 rotateCW(vec2 p, float a)
+{
+    mat2 m = mat2(cos(a), -sin(a), sin(a), cos(a));
+    return p * m;
+}
+
+//////////////////////////////
+// Distance field functions //
+//////////////////////////////
+
+float circleDist(vec2 p, float radius)
+{
+    return length(p) - radius;
+}
+
+float boxDist(vec2 p, vec2 size, float radius)
+{
+    size -= vec2(radius);
+    vec2 d = abs(p) - size;
+    return min(max(d.x, d.y), 0.0) + length(max(d, 0.0)) - radius;
+}
+
+vec2 flamePerturbation(vec2 p, vec2 rectPos, vec2 rectSize)
+{
+    // vec2 relativeP = p - rectPos;
+    // float rectDist = boxDist(relativeP, rectSize, 5.0);
+    
+    // // Only apply perturbation near the edges (distance < 80 for flame spread)
+    // float edgeInfluence = smoothstep(80.0, 0.0, rectDist);
+    
+    // // Calculate height from rectangle bottom for upward flame flow
+    // float heightFromBottom = (relativeP.y + rectSize.y) / (rectSize.y * 2.0);
+    // heightFromBottom = clamp(heightFromBottom, 0.0, 1.0);
+    
+    // // Flame flows more upward as height increases
+    // float upwardBias = heightFromBottom * 2.0 + 0.5;
+    
+    // // Fast flickering time for flame dynamics
+    // float time = iTime * 2.5;
+    // vec2 noiseCoord = p * 0.004;
+    
+    // vec2 flameDistortion = vec2(0.0);
+    
+    // // Large flame tongues with strong upward bias
+    // float largeFlamex = sin(noiseCoord.x * 3.0 + time * 1.2) * cos(noiseCoord.y * 2.0 + time * 0.8);
+    // float largeFlamey = cos(noiseCoord.x * 2.5 + time * 1.5) * sin(noiseCoord.y * 3.5 + time * 1.1) * upwardBias;
+    // flameDistortion += vec2(largeFlamex, largeFlamey) * 35.0;
+    
+    // // Medium flickering flames
+    // float medFlamex = sin(noiseCoord.x * 8.0 + time * 2.0) * cos(noiseCoord.y * 6.0 + time * 1.8);
+    // float medFlamey = cos(noiseCoord.x * 7.0 + time * 2.3) * sin(noiseCoord.y * 9.0 + time * 2.1) * upwardBias;
+    // flameDistortion += vec2(medFlamex, medFlamey) * 20.0;
+    
+    // // Fine flame detail with rapid flickering
+    // float fineFlamex = sin(noiseCoord.x * 20.0 + time * 4.0) * cos(noiseCoord.y * 18.0 + time * 3.5);
+    // float fineFlamey = cos(noiseCoord.x * 19.0 + time * 4.2) * sin(noiseCoord.y * 22.0 + time * 4.8) * upwardBias;
+    // flameDistortion += vec2(fineFlamex, fineFlamey) * 10.0;
+    
+    // // Additional vertical stretching for flame effect
+    // flameDistortion.y *= 1.5;
+    
+    // // Apply falloff based on distance from rectangle edge with flame-specific curve
+    // float flameFalloff = exp(-rectDist * 0.015) * (1.0 + heightFromBottom * 0.8);
+    
+    // return p + flameDistortion * edgeInfluence * flameFalloff;
+    return p;
+}
+
+///////////////
+// The scene //
+///////////////
+
+float sceneDist(vec2 p)
+{
+    // Shape parameters
+    float circleRadius = 35.0;
+    vec2 rectSize = vec2(80.0, 250.0);
+    
+    // Rectangle stays fixed at center of screen
+    vec2 rectPos = shapeCenters.zw;
+    
+    // Circle follows mouse position
+    vec2 circlePos = shapeCenters.xy;
+    
+    // Calculate shape distances
+    float circle = circleDist(translate(p, circlePos), circleRadius);
+    
+    // Rectangle with flame perturbation effect on edges
+    vec2 perturbedP = flamePerturbation(p, rectPos, rectSize);
+    float rectangle = boxDist(translate(perturbedP, rectPos), rectSize, 5.0); // Rounded corners
+    
+    // Merge the shapes with smooth blending when boundaries get close
+    float blendRadius = 200.0;  // Distance between boundaries at which smooth merging starts
+    
+    // Calculate the distance between the boundaries (not centers)
+    // This is the minimum distance between the surfaces of the two shapes
+    float boundaryDist = max(circle, rectangle);  // Distance from point to closest boundary
+    
+    // Alternative approach: calculate actual boundary-to-boundary distance
+    // We need to find how close the surfaces are to each other
+    float surfaceDistance = circle + rectangle;  // Sum gives approximate boundary separation
+    
+    if (surfaceDistance < blendRadius) {
+        // Use smooth merge when boundaries are close
+        float k = 100.0 * (1.0 - surfaceDistance / blendRadius);  // Blend strength increases as boundaries get closer
+        return smoothMerge(circle, rectangle, k);
+    } else {
+        // Use regular merge when boundaries are far apart
+        return merge(circle, rectangle);
+    }
+}
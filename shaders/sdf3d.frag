@@ -14,8 +14,40 @@ layout(std140, binding = 0) uniform ShaderToyUBO {
   vec2 iMouse;        // 鼠标位置，像素
   int iFrame;         // 当前帧数
   ivec4 enableLights; // x,y,z,w 对应启用光源 1..4（1 启用，0 关闭）
+  vec4 cameraOrigin;  // 每帧在CPU上预计算的相机位置 ro (xyz)
+  mat3 cameraBasis;   // 每帧在CPU上预计算的相机矩阵 setCamera(ro, ta, 0.0)
+  vec4 brickOrigin;   // 烘焙距离场(brick map)的最小角 (xyz)，w 为体素边长
+  uvec4 brickGrid;    // 网格的单元数 (xyz)，w 为图集每行的 brick 数
+  vec4 brickParams;   // x: 1 表示步进烘焙场；y: 距离小于它时改用解析 map()
+  vec4 sceneBoundsMin; // 所有几何体的包围盒（BVH 根节点），raycast() 只在其中步进
+  vec4 sceneBoundsMax;
+  uvec4 sceneInfo;     // x: BVH 节点数（0 表示只有地面）
 };
 
+// 场景几何体（按 BVH 叶子顺序）和 BVH 节点，布局见 include/SDF3DScene.hpp
+// 与 include/PrimitiveBVH.hpp。每个飞行中的帧一份，几何体移动时逐帧更新
+struct Primitive {
+  vec4 position;    // xyz 平移，w 材质ID
+  vec4 rotation[3]; // 世界到局部的旋转矩阵（行）
+  vec4 params[2];
+  uvec4 type;       // x 类型
+};
+struct BvhNode {
+  vec3 boundsMin;
+  uint leftOrFirst; // 内部节点：左子节点（右子节点紧随其后）；叶子：第一个几何体
+  vec3 boundsMax;
+  uint count;       // 叶子中的几何体数，0 表示内部节点
+};
+layout(std430, binding = 4) readonly buffer ScenePrimitives { Primitive primitives[]; };
+layout(std430, binding = 5) readonly buffer SceneBvh { BvhNode bvhNodes[]; };
+
+// 烘焙距离场（布局见 include/BrickMap.hpp）：
+// 每个单元 8^3 个体素，靠近表面的单元在图集中有一个 9^3 采样的 brick，
+// 其余单元只用粗网格（单元角点）上的距离
+layout(binding = 1) uniform sampler2D brickAtlas;
+layout(std430, binding = 2) readonly buffer BrickIndirection { uint brickSlots[]; };
+layout(std430, binding = 3) readonly buffer BrickCoarse { float brickCoarse[]; };
+
 // --- Inigo Quilez 的 3D SDF 函数库 ---
 // 源码来自 https://www.iquilezles.org/articles/distfunctions/
 // 这里进行了少量适配
@@ -251,93 +283,136 @@ float sdU(in vec3 p, in float r, in float le, vec2 w) { // U形
 // d1和d2的.x是距离，.y是材质ID
 vec2 opU(vec2 d1, vec2 d2) { return (d1.x < d2.x) ? d1 : d2; }
 
+// 单个几何体：把 pos 变换到局部坐标后调用对应的 SDF。
+// 类型与参数布局见 include/SDF3DScene.hpp (PrimitiveType3D)
+float evaluatePrimitive(in Primitive prim, in vec3 pos) {
+  vec3 d = pos - prim.position.xyz;
+  vec3 q = vec3(dot(prim.rotation[0].xyz, d), dot(prim.rotation[1].xyz, d),
+                dot(prim.rotation[2].xyz, d));
+  vec4 a = prim.params[0];
+  vec4 b = prim.params[1];
+  switch (prim.type.x) {
+  case 0u: return sdSphere(q, a.x);
+  case 1u: return sdBox(q, a.xyz);
+  case 2u: return sdBoxFrame(q, a.xyz, a.w);
+  case 3u: return sdEllipsoid(q, a.xyz);
+  case 4u: return sdTorus(q, a.xy);
+  case 5u: return sdCappedTorus(q, a.xy, a.z, a.w);
+  case 6u: return sdHexPrism(q, a.xy);
+  case 7u: return sdOctogonPrism(q, a.x, a.y);
+  case 8u: return sdCapsule(q, a.xyz, b.xyz, a.w);
+  case 9u: return sdRoundCone(q, a.x, a.y, a.z);
+  case 10u: return sdRoundCone(q, a.xyz, b.xyz, a.w, b.w);
+  case 11u: return sdTriPrism(q, a.xy);
+  case 12u: return sdCylinder(q, a.xy);
+  case 13u: return sdCylinder(q, a.xyz, b.xyz, a.w);
+  case 14u: return sdCone(q, a.xy, a.z);
+  case 15u: return sdCappedCone(q, a.x, a.y, a.z);
+  case 16u: return sdCappedCone(q, a.xyz, b.xyz, a.w, b.w);
+  case 17u: return sdSolidAngle(q, a.xy, a.z);
+  case 18u: return sdOctahedron(q, a.x);
+  case 19u: return sdPyramid(q, a.x);
+  case 20u: return sdRhombus(q, a.x, a.y, a.z, a.w);
+  case 21u: return sdHorseshoe(q, a.xy, a.z, a.w, b.xy);
+  }
+  return 1e10;
+}
+
+// 点到包围盒的距离（盒内为0），是盒内任何表面距离的下界
+float aabbDistance(in vec3 p, in vec3 bmin, in vec3 bmax) {
+  return length(max(max(bmin - p, p - bmax), 0.0));
+}
+
 // map函数：定义整个3D场景。
 // 输入一个空间点pos，返回场景中离此点最近的物体的(距离, 材质ID)。
-// 这是所有SDF渲染的核心，通过组合不同的SDF几何体来“搭建”场景。
+// 几何体来自存储缓冲，遍历CPU上构建的BVH：只有包围盒比当前最近距离更近的
+// 节点才会被展开，因此每次调用只计算少数几个几何体（与 SDF3DScene::map 相同）
 vec2 map(in vec3 pos) {
   // res的x是距离，y是材质ID。初始时，我们假定场景中只有y=0的平面。
-  vec2 res = vec2(pos.y, 0.0); 
+  vec2 res = vec2(pos.y, 0.0);
+  if (sceneInfo.x == 0u)
+    return res;
 
-  // 下面的代码通过检查包围盒(sdBox)来剔除无关计算，提高效率
-  // 如果点pos在某个大区域内，才计算该区域内的所有小物体
-  
-  // 第一列物体
-  if (sdBox(pos - vec3(-2.0, 0.3, 0.25), vec3(0.3, 0.3, 1.0)) < res.x) {
-    res = opU(res, vec2(sdSphere(pos - vec3(-2.0, 0.25, 0.0), 0.25), 26.9));
-    res = opU(res, vec2(sdRhombus((pos - vec3(-2.0, 0.25, 1.0)).xzy, 0.15, 0.25,
-                                  0.04, 0.08),
-                        17.0));
-  }
-  // 第二列物体
-  if (sdBox(pos - vec3(0.0, 0.3, -1.0), vec3(0.35, 0.3, 2.5)) < res.x) {
-    res = opU(res,
-              vec2(sdCappedTorus((pos - vec3(0.0, 0.30, 1.0)) * vec3(1, -1, 1),
-                                 vec2(0.866025, -0.5), 0.25, 0.05),
-                   25.0));
-    res = opU(res, vec2(sdBoxFrame(pos - vec3(0.0, 0.25, 0.0),
-                                   vec3(0.3, 0.25, 0.2), 0.025),
-                        16.9));
-    res =
-        opU(res, vec2(sdCone(pos - vec3(0.0, 0.45, -1.0), vec2(0.6, 0.8), 0.45),
-                      55.0));
-    res = opU(res,
-              vec2(sdCappedCone(pos - vec3(0.0, 0.25, -2.0), 0.25, 0.25, 0.1),
-                   13.67));
-    res = opU(res, vec2(sdSolidAngle(pos - vec3(0.0, 0.00, -3.0),
-                                     vec2(3, 4) / 5.0, 0.4),
-                        49.13));
-  }
-  // ... 其他列物体的定义 ...
-  if (sdBox(pos - vec3(1.0, 0.3, -1.0), vec3(0.35, 0.3, 2.5)) < res.x) {
-    res = opU(
-        res,
-        vec2(sdTorus((pos - vec3(1.0, 0.30, 1.0)).xzy, vec2(0.25, 0.05)), 7.1));
-    res = opU(res, vec2(sdBox(pos - vec3(1.0, 0.25, 0.0), vec3(0.3, 0.25, 0.1)),
-                        3.0));
-    res = opU(res,
-              vec2(sdCapsule(pos - vec3(1.0, 0.00, -1.0), vec3(-0.1, 0.1, -0.1),
-                             vec3(0.2, 0.4, 0.2), 0.1),
-                   31.9));
-    res =
-        opU(res, vec2(sdCylinder(pos - vec3(1.0, 0.25, -2.0), vec2(0.15, 0.25)),
-                      8.0));
-    res = opU(res, vec2(sdHexPrism(pos - vec3(1.0, 0.2, -3.0), vec2(0.2, 0.05)),
-                        18.4));
+  // 深度不超过 PrimitiveBVH::kMaxDepth，栈不会溢出；较近的子节点后入栈、先访问
+  uint stack[32];
+  int top = 0;
+  stack[top++] = 0u;
+  while (top > 0) {
+    BvhNode node = bvhNodes[stack[--top]];
+    if (aabbDistance(pos, node.boundsMin, node.boundsMax) >= res.x)
+      continue;
+    if (node.count > 0u) {
+      for (uint i = 0u; i < node.count; i++) {
+        Primitive prim = primitives[node.leftOrFirst + i];
+        res = opU(res, vec2(evaluatePrimitive(prim, pos), prim.position.w));
+      }
+    } else {
+      uint left = node.leftOrFirst;
+      bool leftFirst =
+          aabbDistance(pos, bvhNodes[left].boundsMin, bvhNodes[left].boundsMax) <=
+          aabbDistance(pos, bvhNodes[left + 1u].boundsMin, bvhNodes[left + 1u].boundsMax);
+      stack[top++] = leftFirst ? left + 1u : left;
+      stack[top++] = leftFirst ? left : left + 1u;
+    }
   }
-  if (sdBox(pos - vec3(-1.0, 0.35, -1.0), vec3(0.35, 0.35, 2.5)) < res.x) {
-    res = opU(res, vec2(sdPyramid(pos - vec3(-1.0, -0.6, -3.0), 1.0), 13.56));
-    res =
-        opU(res, vec2(sdOctahedron(pos - vec3(-1.0, 0.15, -2.0), 0.35), 23.56));
-    res =
-        opU(res, vec2(sdTriPrism(pos - vec3(-1.0, 0.15, -1.0), vec2(0.3, 0.05)),
-                      43.5));
-    res = opU(res, vec2(sdEllipsoid(pos - vec3(-1.0, 0.25, 0.0),
-                                    vec3(0.2, 0.25, 0.05)),
-                        43.17));
-    res = opU(res, vec2(sdHorseshoe(pos - vec3(-1.0, 0.25, 1.0),
-                                    vec2(cos(1.3), sin(1.3)), 0.2, 0.3,
-                                    vec2(0.03, 0.08)),
-                        11.5));
+  return res;
+}
+
+// 烘焙场中的距离（不含地面）。与 BrickMap::sample() 的查找完全一致
+float brickMapDistance(in vec3 p) {
+  const uint kEmpty = 0xFFFFFFFFu;
+  float cellSize = brickOrigin.w * 8.0;
+  vec3 boundsMax = brickOrigin.xyz + vec3(brickGrid.xyz) * cellSize;
+  // 包围盒外只知道最近内部点的距离，返回一个下界
+  vec3 q = clamp(p, brickOrigin.xyz, boundsMax);
+  float outside = length(p - q);
+
+  vec3 local = (q - brickOrigin.xyz) / cellSize;
+  uvec3 c = min(uvec3(local), brickGrid.xyz - 1u);
+  vec3 f = clamp(local - vec3(c), 0.0, 1.0);
+  uint slot = brickSlots[(c.z * brickGrid.y + c.y) * brickGrid.x + c.x];
+
+  float d;
+  if (slot == kEmpty) {
+    // 空单元：粗网格三线性插值，再用角点的 Lipschitz 下界截断，
+    // 保证球体步进不会越过细小的几何体
+    uvec3 s = brickGrid.xyz + 1u;
+    float v[8];
+    float bound = 0.0;
+    for (int i = 0; i < 8; i++) {
+      uvec3 o = uvec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+      uvec3 g = c + o;
+      v[i] = brickCoarse[(g.z * s.y + g.y) * s.x + g.x];
+      bound = max(bound, abs(v[i]) - length((f - vec3(o)) * cellSize));
+    }
+    float tri = mix(mix(mix(v[0], v[1], f.x), mix(v[2], v[3], f.x), f.y),
+                    mix(mix(v[4], v[5], f.x), mix(v[6], v[7], f.x), f.y), f.z);
+    d = sign(v[0]) * min(abs(tri), bound);
+  } else {
+    // brick：z 切片在图集中横向排列，每片 9 个纹素宽；
+    // 硬件双线性插值 x/y，两次采样之间再插值 z
+    vec3 t = f * 8.0;
+    float z0 = min(floor(t.z), 7.0);
+    vec2 base = vec2(float(slot % brickGrid.w) * 81.0, float(slot / brickGrid.w) * 9.0);
+    vec2 uv = base + vec2(z0 * 9.0, 0.0) + t.xy + 0.5;
+    vec2 texel = 1.0 / vec2(textureSize(brickAtlas, 0));
+    float d0 = textureLod(brickAtlas, uv * texel, 0.0).r;
+    float d1 = textureLod(brickAtlas, (uv + vec2(9.0, 0.0)) * texel, 0.0).r;
+    d = mix(d0, d1, t.z - z0);
   }
-  if (sdBox(pos - vec3(2.0, 0.3, -1.0), vec3(0.35, 0.3, 2.5)) < res.x) {
-    res = opU(
-        res, vec2(sdOctogonPrism(pos - vec3(2.0, 0.2, -3.0), 0.2, 0.05), 51.8));
-    res = opU(res,
-              vec2(sdCylinder(pos - vec3(2.0, 0.14, -2.0), vec3(0.1, -0.1, 0.0),
-                              vec3(-0.2, 0.35, 0.1), 0.08),
-                   31.2));
-    res = opU(
-        res, vec2(sdCappedCone(pos - vec3(2.0, 0.09, -1.0), vec3(0.1, 0.0, 0.0),
-                               vec3(-0.2, 0.40, 0.1), 0.15, 0.05),
-                  46.1));
-    res = opU(res,
-              vec2(sdRoundCone(pos - vec3(2.0, 0.15, 0.0), vec3(0.1, 0.0, 0.0),
-                               vec3(-0.1, 0.35, 0.1), 0.15, 0.05),
-                   51.7));
-    res = opU(res, vec2(sdRoundCone(pos - vec3(2.0, 0.20, 1.0), 0.2, 0.1, 0.3),
-                        37.0));
+  return outside > 0.0 ? max(outside, d - outside) : d;
+}
+
+// 步进用的场景距离：开启烘焙时，离表面较远处只查烘焙场（材质ID为-1，
+// 不会被当作命中）；足够近时回到解析 map()，得到精确的交点和材质
+vec2 mapScene(in vec3 pos) {
+  if (brickParams.x > 0.5) {
+    float d = brickMapDistance(pos);
+    if (d >= brickParams.y) {
+      return opU(vec2(pos.y, 0.0), vec2(d, -1.0));
+    }
   }
-  return res;
+  return map(pos);
 }
 
 // --- 渲染核心函数 ---
@@ -370,7 +445,9 @@ vec2 raycast(in vec3 ro, in vec3 rd) {
   
   // 检查与场景物体的总包围盒的交点，这是一个优化
   // 只有当射线穿过这个大盒子时，才进行详细的步进计算
-  vec2 tb = iBox(ro - vec3(0.0, 0.4, -0.5), rd, vec3(2.5, 0.41, 3.0));
+  vec3 boxCenter = 0.5 * (sceneBoundsMax.xyz + sceneBoundsMin.xyz);
+  vec3 boxHalf = 0.5 * (sceneBoundsMax.xyz - sceneBoundsMin.xyz);
+  vec2 tb = iBox(ro - boxCenter, rd, boxHalf);
   if (tb.x < tb.y && tb.y > 0.0 && tb.x < tmax) {
     tmin = max(tb.x, tmin); // 更新步进的起始距离
     tmax = min(tb.y, tmax); // 更新步进的结束距离
@@ -379,7 +456,7 @@ vec2 raycast(in vec3 ro, in vec3 rd) {
     float t = tmin;
     for (int i = 0; i < 70 && t < tmax; i++) {
       // 在当前位置调用map函数，获取到场景的最近距离h
-      vec2 h = map(ro + rd * t);
+      vec2 h = mapScene(ro + rd * t);
       // 如果距离h小到一个阈值，就认为射线击中了表面
       if (abs(h.x) < (0.0001 * t)) {
         res = vec2(t, h.y); // 记录距离t和材质ID
@@ -405,7 +482,7 @@ float calcSoftshadow(in vec3 ro, in vec3 rd, in float mint, in float tmax) {
   float t = mint;
   // 步进循环，但步长较小，检查遮挡
   for (int i = ZERO; i < 24; i++) {
-    float h = map(ro + rd * t).x;
+    float h = mapScene(ro + rd * t).x;
     // 使用一个公式根据距离h来计算阴影的柔和程度
     float s = clamp(8.0 * h / t, 0.0, 1.0);
     res = min(res, s); // 取最暗的阴影值
@@ -437,7 +514,7 @@ float calcAO(in vec3 pos, in vec3 nor) {
   float sca = 1.0;
   for (int i = ZERO; i < 5; i++) {
     float h = 0.01 + 0.12 * float(i) / 4.0; // 步进距离越来越长
-    float d = map(pos + h * nor).x; // 获取该点的距离
+    float d = mapScene(pos + h * nor).x; // 获取该点的距离
     occ += (h - d) * sca;
     sca *= 0.95;
     if (occ > 0.35)
@@ -565,18 +642,11 @@ void main() {
   
   // 鼠标位置归一化（但不影响相机）
   vec2 mo = iMouse.xy / max(iResolution.xy, vec2(1.0));
-  // 时间，用于动画
-  float time = 32.0 + iTime * 1.5;
-
   // --- 摄像机设置 ---
-  // 目标点 (Look-at Target)
-  vec3 ta = vec3(0.25, -0.75, -0.75); 
-  // 相机位置 (Ray Origin)，围绕目标点ta做圆周运动（不随鼠标变化）
-  vec3 ro = ta + vec3(4.5 * cos(0.1 * time), 2.2,
-                      4.5 * sin(0.1 * time));
-  
-  // 计算相机坐标系矩阵
-  mat3 ca = setCamera(ro, ta, 0.0);
+  // 相机围绕目标点 (0.25, -0.75, -0.75) 做圆周运动；位置和坐标系矩阵只与时间有关，
+  // 每帧在CPU上计算一次（见 SDF3D::updateUniformBuffer），而不是每个像素都算
+  vec3 ro = cameraOrigin.xyz;
+  mat3 ca = cameraBasis;
 
   vec3 tot = vec3(0.0); // 用于抗锯齿的颜色累加器
 
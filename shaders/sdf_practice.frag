@@ -1,4 +1,10 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "cornell_camera.glsl"
+#include "rsm_encoding.glsl"
+#include "rsm_pyramid.glsl"
+#include "vpl_cluster.glsl"
 
 // 输入：从顶点着色器传入的片段颜色和纹理坐标
 layout(location = 0) in vec3 fragColor;
@@ -21,7 +27,7 @@ layout(binding = 0) uniform SDFCornellUniforms {
     vec4 sphereColor;     // RGB 球体颜色
     
     // 光照控制
-    ivec4 enableLights;   // 1表示启用, 0表示禁用 (x=主光源, y=填充光, z=边缘光, w=环境反射)
+    ivec4 enableLights;   // 1表示启用, 0表示禁用 (x=主光源, y=填充光, z=边缘光, w=环境反射); 本着色器改读 ENABLE_*_LIGHT
     vec4 lightDir;        // xyz = 方向, w = 强度
     vec4 lightColors[3];  // 3个光源的颜色
     vec4 ambientColor;    // RGBA 环境光
@@ -33,20 +39,29 @@ layout(binding = 0) uniform SDFCornellUniforms {
     vec4 lightRight;        // xyz basis
     vec4 lightUp;           // xyz basis
     vec4 lightOrigin;       // origin of light camera
-    vec4 lightOrthoHalfSize;// xy half size
-    vec4 rsmResolution;     // xy
-    vec4 rsmParams;         // x radius, y samples, z enableIndirectLighting (>0.5), w enableRSM (>0.5)
-    vec4 indirectParams;    // x indirect intensity, y/z/w reserved
-    vec4 debugParams;       // x showRSMOnly (>0.5)
+    vec4 lightOrthoHalfSize;// xy half size, z compact RSM encoding (>0.5)
+    vec4 rsmResolution;     // xy size, zw 1/size (texel step)
+    vec4 rsmParams;         // x radius, y samples, z enableIndirectLighting (>0.5), w enableRSM (>0.5); z/w are specialized here
+    vec4 indirectParams;    // x indirect intensity, y VPL samples per pixel (hierarchical), z VPL clusters, w temporal taps per frame
+    vec4 debugParams;       // x showRSMOnly, y importance sampling, z showIndirectOnly, w hierarchical; specialized here
     
     // PBR parameters
-    vec4 pbrParams;         // x=enablePBR(>0.5), y=globalRoughness, z=globalMetallic, w=reserved
+    vec4 pbrParams;         // x=enablePBR(>0.5, specialized here), y=globalRoughness, z=globalMetallic, w=indirect resolution divisor (of the INDIRECT_PASS targets)
     vec2 roughnessValues;   // per-material roughness: [0]=sphere1, [1]=sphere2  
     vec2 metallicValues;    // per-material metallic: [0]=sphere1, [1]=sphere2
     vec4 baseColorFactors;  // global color tinting factors: RGB + intensity
+
+    // Per-frame precompute (filled once per frame on the CPU)
+    vec4 sphereCenters[2];     // xyz 两个球体的世界坐标中心, w 半径
+    mat3 sphereLocalRotation;  // rotateX(sr.x) * rotateY(sr.y) * rotateZ(sr.z)
+
+    // ReSTIR VPL reservoirs
+    vec4 restirParams;         // x initial candidates (0: off), y spatial neighbours, z reservoir half this frame writes
+    vec4 prevSphereCenters[2]; // sphereCenters of the previous frame
 } u;
 
-// RSM textures
+// RSM textures, encoded as rsm_encoding.glsl describes: read them through the
+// rsmPosition* / rsmNormal* helpers below (flux is plain rgb either way)
 layout(binding = 1) uniform sampler2D rsmPositionTex;
 layout(binding = 2) uniform sampler2D rsmNormalTex;
 layout(binding = 3) uniform sampler2D rsmFluxTex;
@@ -54,12 +69,90 @@ layout(binding = 3) uniform sampler2D rsmFluxTex;
 // Flower texture
 layout(binding = 4) uniform sampler2D flowerTex;
 
+// RSM flux pyramid and VPL clusters from rsm_pyramid.comp (layout in rsm_pyramid.glsl)
+layout(binding = 5) uniform sampler2D rsmPyramidTex;
+layout(binding = 6) uniform sampler2D rsmClusterConeTex;   // xyz axis, w min cos to the axis
+layout(binding = 7) uniform sampler2D rsmClusterBoundsTex; // xyz centre, w radius (< 0: no VPLs)
+
+// Clustered VPL list from vpl_cluster.comp
+layout(std430, binding = 8) readonly buffer VplClusterBuffer {
+    VplCluster vplClusters[];
+};
+
+// Indirect irradiance accumulated over frames by indirect_temporal.comp (rgb
+// without the albedo, a frames), one texel per indirect pass pixel; read with ENABLE_TEMPORAL_INDIRECT
+layout(binding = 9) uniform sampler2D temporalIndirectTex;
+
+// Output of the INDIRECT_PASS variant (rgb irradiance without the albedo, a hit
+// distance), at 1/2 or 1/4 resolution with INDIRECT_UPSAMPLE
+layout(binding = 10) uniform sampler2D indirectRawTex;
+
+// ReSTIR reservoirs, one per INDIRECT_PASS texel in each of two halves: this
+// frame's (restirParams.z) and the previous frame's; read with ENABLE_RESTIR
+struct RestirReservoir {
+    vec4 surface; // xyz normal of the texel's surface, w hit distance (0: empty)
+    uint texel;   // selected RSM texel, y * size + x
+    float weight; // W, its unbiased contribution weight
+    float count;  // M, candidates seen
+    float pad;
+};
+layout(std430, binding = 11) buffer RestirReservoirBuffer {
+    RestirReservoir restirReservoirs[];
+};
+
+// Specialization constants: SDFCornell builds one pipeline variant per flag set
+// (makeCornellVariantKey), so disabled features are compiled out instead of being
+// branched over per pixel. constant_id 0-15 match the CornellVariantBits bits.
+layout(constant_id = 0) const bool ENABLE_KEY_LIGHT = true;
+layout(constant_id = 1) const bool ENABLE_FILL_LIGHT = true;
+layout(constant_id = 2) const bool ENABLE_RIM_LIGHT = true;
+layout(constant_id = 3) const bool ENABLE_ENV_LIGHT = true;
+layout(constant_id = 4) const bool ENABLE_RSM = false;
+layout(constant_id = 5) const bool ENABLE_INDIRECT = false;          // implies ENABLE_RSM
+layout(constant_id = 6) const bool ENABLE_IMPORTANCE_SAMPLING = false;
+layout(constant_id = 7) const bool ENABLE_PBR = false;
+layout(constant_id = 8) const bool DEBUG_RSM_VIEW = false;
+layout(constant_id = 9) const bool DEBUG_INDIRECT_VIEW = false;
+layout(constant_id = 10) const bool ENABLE_HIERARCHICAL_SAMPLING = false; // replaces both local gathers
+layout(constant_id = 11) const bool ENABLE_VPL_CLUSTERS = false;          // replaces every RSM gather
+layout(constant_id = 12) const bool ENABLE_TEMPORAL_INDIRECT = false;     // reads the accumulated local/hierarchical gather
+layout(constant_id = 13) const bool INDIRECT_PASS = false;                // outputs this frame's taps of it instead
+layout(constant_id = 14) const bool INDIRECT_UPSAMPLE = false;            // reads a reduced-resolution INDIRECT_PASS
+layout(constant_id = 15) const bool ENABLE_RESTIR = false;                // resamples the INDIRECT_PASS reservoirs
+
 // --- 常量定义 ---
 const float PI = 3.14159265359;
 const float MAX_DIST = 100.0;     // 光线行进的最大距离
-const int MAX_STEPS = 128;        // 光线行进的最大步数
+layout(constant_id = 16) const int MAX_STEPS = 128;         // 光线行进的最大步数
+layout(constant_id = 17) const int SOFT_SHADOW_STEPS = 64;  // 软阴影的最大步数
 const float SURF_DIST = 0.006;    // 判断光线是否击中物体表面的最小距离阈值
 
+// --- RSM 读取 ---
+// 编码由 uniform 选择而不是特化常量：附件与 uniform 在同一帧切换，而管线变体可能还在编译
+RSMLightFrame rsmLightFrame() {
+    return RSMLightFrame(vec4(u.lightOrigin.xyz, u.lightOrthoHalfSize.z),
+                         vec4(u.lightRight.xyz, u.lightOrthoHalfSize.x),
+                         vec4(u.lightUp.xyz, u.lightOrthoHalfSize.y),
+                         vec4(normalize(u.lightDir.xyz), 0.0));
+}
+
+// Filtered reads (rsmSampler is linear): decoding the filtered depth gives the filtered position
+vec3 rsmPositionAt(vec2 uv) {
+    return rsmDecodePosition(rsmLightFrame(), texture(rsmPositionTex, uv), uv);
+}
+
+vec3 rsmNormalAt(vec2 uv) {
+    return rsmDecodeNormal(rsmLightFrame(), texture(rsmNormalTex, uv));
+}
+
+vec3 rsmPositionTexel(ivec2 texel) {
+    return rsmDecodePosition(rsmLightFrame(), texelFetch(rsmPositionTex, texel, 0), (vec2(texel) + 0.5) * u.rsmResolution.zw);
+}
+
+vec3 rsmNormalTexel(ivec2 texel) {
+    return rsmDecodeNormal(rsmLightFrame(), texelFetch(rsmNormalTex, texel, 0));
+}
+
 // --- SDF (Signed Distance Function - 有向距离场) 函数 ---
 // SDF的核心思想是：对于空间中的任意一点，函数返回该点到场景中最近物体表面的距离。
 // 如果点在物体外部，距离为正；如果在内部，距离为负。
@@ -73,49 +166,13 @@ float sphereSDF(vec3 p, float r) {
     return length(p) - r;
 }
 
-// --- 辅助函数 ---
-
-// 绕X轴旋转的矩阵
-mat3 rotateX(float a) {
-    float s = sin(a), c = cos(a);
-    return mat3(1, 0, 0, 0, c, -s, 0, s, c);
-}
-
-// 绕Y轴旋转的矩阵
-mat3 rotateY(float a) {
-    float s = sin(a), c = cos(a);
-    return mat3(c, 0, s, 0, 1, 0, -s, 0, c);
-}
-
-// 绕Z轴旋转的矩阵
-mat3 rotateZ(float a) {
-    float s = sin(a), c = cos(a);
-    return mat3(c, -s, 0, s, c, 0, 0, 0, 1);
-}
-
-
 // --- 场景SDF ---
 // 这个函数通过组合多个SDF来定义整个场景的几何形状。
 float sceneSDF(vec3 p) {
-    // 计算绕z轴的旋转，让两个球体围绕中心旋转
-    float rotationAngle = u.iTime * 0.5; // 旋转速度
-    mat3 zRotation = rotateZ(rotationAngle);
-    
-    // 第一个球体 - 位于右侧，围绕z轴旋转
-    vec3 sphere1Pos = zRotation * vec3(2.0, 0.0, 0.0); // 距离中心2个单位
-    vec3 sphere1P = p - sphere1Pos;
-    // 对第一个球体应用局部旋转
-    mat3 rotation1 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-    sphere1P = rotation1 * sphere1P;
-    float sphere1 = sphereSDF(sphere1P, 1.0);
-    
-    // 第二个球体 - 位于左侧，围绕z轴旋转
-    vec3 sphere2Pos = zRotation * vec3(-2.0, 0.0, 0.0); // 距离中心2个单位，相反方向
-    vec3 sphere2P = p - sphere2Pos;
-    // 对第二个球体应用局部旋转
-    mat3 rotation2 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-    sphere2P = rotation2 * sphere2P;
-    float sphere2 = sphereSDF(sphere2P, 1.0);
+    // 球心位置（绕z轴公转）每帧在CPU上计算一次，见 u.sphereCenters。
+    // 球体自身的旋转不改变 |p - c|，因此求距离时无需应用，只在纹理映射时使用。
+    float sphere1 = sphereSDF(p - u.sphereCenters[0].xyz, u.sphereCenters[0].w);
+    float sphere2 = sphereSDF(p - u.sphereCenters[1].xyz, u.sphereCenters[1].w);
     
     // 合并两个球体
     float spheres = min(sphere1, sphere2);
@@ -147,23 +204,9 @@ vec2 getSphereUV(vec3 p) {
 
 // 获取指定点的材质ID
 int getMaterial(vec3 p) {
-    // 计算绕z轴的旋转，让两个球体围绕中心旋转
-    float rotationAngle = u.iTime * 0.5; // 旋转速度
-    mat3 zRotation = rotateZ(rotationAngle);
-    
-    // 第一个球体 - 位于右侧，围绕z轴旋转
-    vec3 sphere1Pos = zRotation * vec3(2.0, 0.0, 0.0);
-    vec3 sphere1P = p - sphere1Pos;
-    mat3 rotation1 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-    sphere1P = rotation1 * sphere1P;
-    float sphere1 = sphereSDF(sphere1P, 1.0);
-    
-    // 第二个球体 - 位于左侧，围绕z轴旋转
-    vec3 sphere2Pos = zRotation * vec3(-2.0, 0.0, 0.0);
-    vec3 sphere2P = p - sphere2Pos;
-    mat3 rotation2 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-    sphere2P = rotation2 * sphere2P;
-    float sphere2 = sphereSDF(sphere2P, 1.0);
+    // 球心与sceneSDF相同，来自每帧预计算的 u.sphereCenters
+    float sphere1 = sphereSDF(p - u.sphereCenters[0].xyz, u.sphereCenters[0].w);
+    float sphere2 = sphereSDF(p - u.sphereCenters[1].xyz, u.sphereCenters[1].w);
     
     float spheres = min(sphere1, sphere2);
     
@@ -246,7 +289,7 @@ float rayMarch(vec3 ro, vec3 rd) {
 float softShadow(vec3 ro, vec3 rd, float mint, float maxt, float k) {
     float res = 1.0; // 结果，1.0代表完全亮，0.0代表完全黑
     float t = mint;
-    for (int i = 0; i < 64; i++) {
+    for (int i = 0; i < SOFT_SHADOW_STEPS; i++) {
         float h = sceneSDF(ro + rd * t);
         if (h < 0.0008) return 0.0; // 完全被遮挡
         res = min(res, k * h / t); // k控制阴影柔和度
@@ -274,7 +317,7 @@ float rsmShadow(vec3 p, vec3 n) {
     // Receiver-plane depth bias to reduce self-shadowing on curved surfaces
     float slope = 1.0 - max(dot(n, Ld), 0.0);
     // PCF-like 8 taps with configurable radius (in texels)
-    vec2 texel = 1.0 / max(u.rsmResolution.xy, vec2(1.0));
+    vec2 texel = u.rsmResolution.zw;
     float radius = max(u.rsmParams.x, 0.5);
     vec2 offs[8] = vec2[8](
         vec2( 0.0,  0.0), vec2( 1.0,  0.0), vec2(-1.0,  0.0), vec2(0.0,  1.0),
@@ -283,7 +326,7 @@ float rsmShadow(vec3 p, vec3 n) {
     float sum = 0.0;
     for (int i = 0; i < 8; ++i) {
         vec2 duv = offs[i] * radius * texel;
-        vec3 vplPos = texture(rsmPositionTex, clamp(uv + duv, 0.0, 1.0)).xyz;
+        vec3 vplPos = rsmPositionAt(clamp(uv + duv, 0.0, 1.0));
         float tRsm = dot(vplPos - u.lightOrigin.xyz, Ld);
         float bias = 0.02 + 0.10 * slope;
         float visible = (tRsm + bias < tSurface) ? 0.0 : 1.0; // biased comparison
@@ -292,6 +335,501 @@ float rsmShadow(vec3 p, vec3 n) {
     return sum / 8.0;
 }
 
+// --- Hierarchical VPL sampling ---
+// Instead of a fixed pattern around the receiver's own RSM texel, pick VPLs from
+// the whole RSM with probability proportional to their flux by descending the
+// pyramid of rsm_pyramid.comp, and weight each by 1 / pdf (unbiased sum over all
+// texels). CpuCornellRenderer mirrors every function below.
+
+// One RSM texel's contribution; the same term as the local gathers, zero where they skip
+vec3 vplContribution(vec3 p, vec3 n, vec3 albedo, int matId, vec3 vplPos, vec3 vplNor, vec3 flux) {
+    if (length(vplPos) < 0.1) return vec3(0.0);
+    vec3 wi = vplPos - p;
+    float dist = length(wi);
+    if (dist < 0.05) return vec3(0.0);
+    wi = normalize(wi);
+    vplNor = normalize(vplNor);
+    float cos1 = max(dot(n, wi), 0.0);
+    float cos2 = max(dot(vplNor, -wi), 0.0);
+    if (cos1 < 0.05 || cos2 < 0.05) return vec3(0.0);
+
+    float enhancedFalloff = 1.0 / max(dist * dist + 0.5, 1e-3);
+    vec3 brdf = albedo / 3.14159;
+    float normalConsistency = dot(normalize(n), vplNor);
+    float geometricDamping = 1.0;
+    if (abs(normalConsistency) > 0.8) {
+        geometricDamping *= 0.3;
+    } else if (abs(normalConsistency) > 0.6) {
+        geometricDamping *= 0.6;
+    }
+    float materialBoost = (matId == 1 || matId == 7) ? 2.0 : 0.7;
+    return brdf * flux * (cos1 * cos2) * enhancedFalloff * materialBoost * geometricDamping;
+}
+
+// False only if no VPL of the cluster can light p, so skipping it keeps the estimate unbiased
+bool clusterCanLight(vec3 p, vec3 n, ivec2 cluster) {
+    vec4 cone = texelFetch(rsmClusterConeTex, cluster, 0);
+    vec4 bounds = texelFetch(rsmClusterBoundsTex, cluster, 0);
+    if (bounds.w < 0.0) return false;
+    vec3 d = p - bounds.xyz;
+    // Every VPL lies below the tangent plane of p
+    if (dot(n, -d) + bounds.w <= 0.0) return false;
+    float dist = length(d);
+    if (dist <= bounds.w) return true;
+    // Every VPL normal points away from p
+    float angle = acos(clamp(dot(cone.xyz, d / dist), -1.0, 1.0));
+    float spread = acos(clamp(cone.w, -1.0, 1.0)) + asin(bounds.w / dist);
+    return angle - spread < 0.5 * PI;
+}
+
+// Walk from the root, picking one of four children in proportion to its flux
+// (one textureGather per level, one per channel over the flux texels), down to an
+// RSM texel; pdf is its probability
+bool sampleVpl(vec3 p, vec3 n, float xi, out ivec2 texel, out float pdf) {
+    int rsmSize = textureSize(rsmFluxTex, 0).x;
+    int baseSize = rsmSize / 2;
+    vec2 atlasSize = vec2(textureSize(rsmPyramidTex, 0));
+    ivec2 node = ivec2(0);
+    pdf = 1.0;
+    texel = ivec2(0);
+    for (int level = rsmPyramidLevelCount(rsmSize) - 1; level >= 0; --level) {
+        // Children: nodes of level - 1, or RSM texels below level 0. Gather returns
+        // (0,1) (1,1) (1,0) (0,0); reorder to (0,0) (1,0) (0,1) (1,1)
+        vec4 w = level > 0
+            ? textureGather(rsmPyramidTex, vec2(rsmPyramidLevelOrigin(level - 1, baseSize) + node * 2 + 1) / atlasSize, 0)
+            : rsmGatherLuminance(rsmFluxTex, vec2(node * 2 + 1) / float(rsmSize));
+        w = w.wzxy;
+        float total = dot(w, vec4(1.0));
+        if (!(total > 0.0)) return false;
+        xi *= total;
+        int pick = 0;
+        for (; pick < 3; ++pick) {
+            if (xi < w[pick]) break;
+            xi -= w[pick];
+        }
+        if (!(w[pick] > 0.0)) return false;
+        xi = min(xi / w[pick], 0.99999994);
+        pdf *= w[pick] / total;
+        node = node * 2 + ivec2(pick & 1, pick >> 1);
+        if (level - 1 == RSM_CLUSTER_LEVEL && !clusterCanLight(p, n, node)) return false;
+    }
+    texel = node;
+    return true;
+}
+
+// Unbiased estimate of the sum over every RSM texel, each VPL standing for the
+// area one texel covers on the light's image plane
+vec3 hierarchicalIndirect(vec3 p, vec3 n, vec3 albedo, int matId) {
+    int samples = clamp(int(u.indirectParams.y), 1, 16);
+    float offset = rsmSampleOffset(ivec2(gl_FragCoord.xy));
+    float texelArea = 4.0 * u.lightOrthoHalfSize.x * u.lightOrthoHalfSize.y * u.rsmResolution.z * u.rsmResolution.w;
+    vec3 sum = vec3(0.0);
+    for (int k = 0; k < samples; ++k) {
+        ivec2 texel;
+        float pdf;
+        if (sampleVpl(p, n, (float(k) + offset) / float(samples), texel, pdf)) {
+            sum += vplContribution(p, n, albedo, matId, rsmPositionTexel(texel), rsmNormalTexel(texel),
+                                   texelFetch(rsmFluxTex, texel, 0).rgb) / pdf;
+        }
+    }
+    return sum * (u.indirectParams.x * texelArea / float(samples));
+}
+
+// Every clustered VPL, carrying the summed flux of its member texels; the cost
+// depends on the cluster count only, not on the RSM resolution
+vec3 clusteredIndirect(vec3 p, vec3 n, vec3 albedo, int matId) {
+    int count = clamp(int(u.indirectParams.z), 0, vplClusters.length());
+    float texelArea = 4.0 * u.lightOrthoHalfSize.x * u.lightOrthoHalfSize.y * u.rsmResolution.z * u.rsmResolution.w;
+    vec3 sum = vec3(0.0);
+    for (int i = 0; i < count; ++i) {
+        VplCluster vpl = vplClusters[i];
+        if (vpl.position.w > 0.0) {
+            sum += vplContribution(p, n, albedo, matId, vpl.position.xyz, vpl.normal.xyz, vpl.flux.rgb);
+        }
+    }
+    return sum * (u.indirectParams.x * texelArea);
+}
+
+// --- Temporal accumulation ---
+// The local gathers below sample fixed patterns of RSM_UNIFORM_OFFSETS, or
+// RSM_COARSE_OFFSETS to find a region and then RSM_DENSE_OFFSETS around it plus
+// RSM_COVERAGE_OFFSETS. With ENABLE_TEMPORAL_INDIRECT the INDIRECT_PASS variant
+// takes indirectParams.w taps of the pattern per frame instead, each pixel
+// starting at its own place and moving on by that many taps every frame, and
+// indirect_temporal.comp averages the frames: after a full cycle the history
+// has seen every tap of the full gather. CpuCornellRenderer mirrors this.
+
+const vec2 RSM_UNIFORM_OFFSETS[32] = vec2[32](
+    vec2(0.0, 0.0),
+    vec2(0.3, 0.0), vec2(-0.3, 0.0), vec2(0.0, 0.3), vec2(0.0, -0.3),
+    vec2(0.2, 0.2), vec2(-0.2, 0.2), vec2(0.2, -0.2), vec2(-0.2, -0.2),
+    vec2(0.6, 0.0), vec2(-0.6, 0.0), vec2(0.0, 0.6), vec2(0.0, -0.6),
+    vec2(0.45, 0.45), vec2(-0.45, 0.45), vec2(0.45, -0.45), vec2(-0.45, -0.45),
+    vec2(1.0, 0.0), vec2(-1.0, 0.0), vec2(0.0, 1.0), vec2(0.0, -1.0),
+    vec2(0.7, 0.7), vec2(-0.7, 0.7), vec2(0.7, -0.7), vec2(-0.7, -0.7),
+    vec2(0.5, 0.2), vec2(-0.5, 0.2), vec2(0.2, 0.5), vec2(-0.2, 0.5),
+    vec2(0.8, 0.3), vec2(-0.8, -0.3), vec2(0.3, -0.8)
+);
+const vec2 RSM_COARSE_OFFSETS[8] = vec2[8](
+    vec2( 0.0,  0.0), vec2( 1.0,  0.0), vec2(-1.0,  0.0), vec2( 0.0,  1.0),
+    vec2( 0.0, -1.0), vec2( 0.7,  0.7), vec2(-0.7,  0.7), vec2( 0.7, -0.7)
+);
+const vec2 RSM_DENSE_OFFSETS[20] = vec2[20](
+    vec2( 0.0,  0.0), vec2( 0.3,  0.0), vec2(-0.3,  0.0), vec2( 0.0,  0.3), vec2( 0.0, -0.3),
+    vec2( 0.2,  0.2), vec2(-0.2,  0.2), vec2( 0.2, -0.2), vec2(-0.2, -0.2),
+    vec2( 0.5,  0.0), vec2(-0.5,  0.0), vec2( 0.0,  0.5), vec2( 0.0, -0.5),
+    vec2( 0.4,  0.4), vec2(-0.4,  0.4), vec2( 0.4, -0.4), vec2(-0.4, -0.4),
+    vec2( 0.6,  0.2), vec2(-0.6, -0.2), vec2( 0.2, -0.6)
+);
+const vec2 RSM_COVERAGE_OFFSETS[4] = vec2[4](
+    vec2(-0.7, -0.7), vec2( 0.8,  0.3), vec2(-0.3,  0.8), vec2( 0.9, -0.4)
+);
+
+// RSM coordinate p projects to
+vec2 rsmBaseUV(vec3 p) {
+    vec3 rel = p - u.lightOrigin.xyz;
+    vec2 base = vec2(dot(rel, u.lightRight.xyz) / max(u.lightOrthoHalfSize.x, 1e-4),
+                     dot(rel, u.lightUp.xyz)    / max(u.lightOrthoHalfSize.y, 1e-4));
+    return base * 0.5 + 0.5;
+}
+
+// Importance sampling phase 1: the coarse offset (in uv) whose VPL faces p the most
+vec2 rsmImportanceRegion(vec3 p, vec3 n, vec2 baseUV, float radius) {
+    float maxImportance = 0.0;
+    vec2 bestRegion = vec2(0.0);
+    for (int i = 0; i < 8; ++i) {
+        vec2 duv = RSM_COARSE_OFFSETS[i] * radius * 0.5 * u.rsmResolution.zw;
+        vec2 uv = clamp(baseUV + duv, 0.0, 1.0);
+
+        vec3 vplPos = rsmPositionAt(uv);
+        vec3 vplNor = rsmNormalAt(uv);
+        vec3 flux = texture(rsmFluxTex, uv).xyz;
+
+        if (length(vplPos) < 0.1) continue;
+
+        vec3 wi = normalize(vplPos - p);
+        float cos1 = max(dot(n, wi), 0.0);
+        float cos2 = max(dot(vplNor, -wi), 0.0);
+        float importance = cos1 * cos2 * length(flux);
+        if (importance > maxImportance) {
+            maxImportance = importance;
+            bestRegion = duv;
+        }
+    }
+    return bestRegion;
+}
+
+// One tap of a local gather: the VPL at uv, counted unless vplContribution() skips it
+void gatherVpl(vec3 p, vec3 n, vec3 albedo, int matId, vec2 uv, inout vec3 bounce, inout int valid) {
+    vec3 vplPos = rsmPositionAt(uv);
+    vec3 vplNor = normalize(rsmNormalAt(uv));
+    if (length(vplPos) < 0.1) return;
+    vec3 wi = vplPos - p;
+    float dist = length(wi);
+    if (dist < 0.05) return;
+    wi /= dist;
+    if (max(dot(n, wi), 0.0) < 0.05 || max(dot(vplNor, -wi), 0.0) < 0.05) return;
+    bounce += vplContribution(p, n, albedo, matId, vplPos, vplNor, texture(rsmFluxTex, uv).xyz);
+    valid++;
+}
+
+// This frame's taps of the active gather with a white albedo (the main pass
+// multiplies the accumulated result by the surface's)
+vec3 temporalIndirectTaps(vec3 p, vec3 n, int matId, ivec2 pixel) {
+    int taps = clamp(int(u.indirectParams.w), 1, 16);
+    float offset = rsmSampleOffset(pixel);
+    if (ENABLE_HIERARCHICAL_SAMPLING) {
+        // Stratified over this frame's taps; the strata shift by the golden ratio every frame
+        float shift = fract(offset + float(u.iFrame) * 0.618034);
+        float texelArea = 4.0 * u.lightOrthoHalfSize.x * u.lightOrthoHalfSize.y * u.rsmResolution.z * u.rsmResolution.w;
+        vec3 sum = vec3(0.0);
+        for (int k = 0; k < taps; ++k) {
+            ivec2 texel;
+            float pdf;
+            if (sampleVpl(p, n, (float(k) + shift) / float(taps), texel, pdf)) {
+                sum += vplContribution(p, n, vec3(1.0), matId, rsmPositionTexel(texel), rsmNormalTexel(texel),
+                                       texelFetch(rsmFluxTex, texel, 0).rgb) / pdf;
+            }
+        }
+        return sum * (u.indirectParams.x * texelArea / float(taps));
+    }
+
+    float radius = max(u.rsmParams.x, 1.0);
+    vec2 baseUV = rsmBaseUV(p);
+    vec3 bounce = vec3(0.0);
+    int valid = 0;
+    if (ENABLE_IMPORTANCE_SAMPLING) {
+        // The region search is cheap and has to agree between frames, so it runs in full
+        vec2 bestRegion = rsmImportanceRegion(p, n, baseUV, radius);
+        const int count = 24; // dense, then coverage
+        int first = int(offset * float(count)) + u.iFrame * taps;
+        for (int k = 0; k < min(taps, count); ++k) {
+            int i = (first + k) % count;
+            vec2 duv = i < 20 ? bestRegion + RSM_DENSE_OFFSETS[i] * 0.3 * radius * u.rsmResolution.zw
+                              : RSM_COVERAGE_OFFSETS[i - 20] * radius * u.rsmResolution.zw;
+            gatherVpl(p, n, vec3(1.0), matId, clamp(baseUV + duv, 0.0, 1.0), bounce, valid);
+        }
+    } else {
+        int count = min(int(max(u.rsmParams.y, 1.0)), 32);
+        int first = int(offset * float(count)) + u.iFrame * taps;
+        for (int k = 0; k < min(taps, count); ++k) {
+            int i = (first + k) % count;
+            // The full gather's jitter of tap i
+            float random = fract(sin(dot(p.xz + float(i), vec2(12.9898, 78.233))) * 43758.5453);
+            vec2 jitter = vec2(fract(random * 43758.5453), fract(random * 23421.6319)) * 2.0 - 1.0;
+            vec2 duv = (RSM_UNIFORM_OFFSETS[i] + jitter * 0.05) * radius * u.rsmResolution.zw;
+            gatherVpl(p, n, vec3(1.0), matId, clamp(baseUV + duv, 0.0, 1.0), bounce, valid);
+        }
+    }
+    return valid > 0 ? u.indirectParams.x * (bounce / float(valid)) : vec3(0.0);
+}
+
+// The full local gather: the three importance sampling phases, or the uniform pattern
+vec3 localIndirect(vec3 p, vec3 n, vec3 albedo, int matId) {
+    float radius = max(u.rsmParams.x, 1.0);
+    vec2 baseUV = rsmBaseUV(p);
+    vec3 bounce = vec3(0.0);
+    int valid = 0;
+    if (ENABLE_IMPORTANCE_SAMPLING) {
+        // Phase 1: coarse search for the most important direction
+        vec2 bestRegion = rsmImportanceRegion(p, n, baseUV, radius);
+        // Phase 2: dense samples around the best region
+        for (int i = 0; i < 20; ++i) {
+            vec2 duv = bestRegion + RSM_DENSE_OFFSETS[i] * 0.3 * radius * u.rsmResolution.zw;
+            gatherVpl(p, n, albedo, matId, clamp(baseUV + duv, 0.0, 1.0), bounce, valid);
+        }
+        // Phase 3: coverage samples
+        for (int i = 0; i < 4; ++i) {
+            vec2 duv = RSM_COVERAGE_OFFSETS[i] * radius * u.rsmResolution.zw;
+            gatherVpl(p, n, albedo, matId, clamp(baseUV + duv, 0.0, 1.0), bounce, valid);
+        }
+    } else {
+        int count = min(int(max(u.rsmParams.y, 1.0)), 32);
+        for (int i = 0; i < count; ++i) {
+            // Some randomization to reduce banding
+            float random = fract(sin(dot(p.xz + float(i), vec2(12.9898, 78.233))) * 43758.5453);
+            vec2 jitter = vec2(fract(random * 43758.5453), fract(random * 23421.6319)) * 2.0 - 1.0;
+            vec2 duv = (RSM_UNIFORM_OFFSETS[i] + jitter * 0.05) * radius * u.rsmResolution.zw;
+            gatherVpl(p, n, albedo, matId, clamp(baseUV + duv, 0.0, 1.0), bounce, valid);
+        }
+    }
+    return valid > 0 ? u.indirectParams.x * (bounce / float(valid)) : vec3(0.0);
+}
+
+// Indirect light of the gather the variant uses
+vec3 gatherIndirect(vec3 p, vec3 n, vec3 albedo, int matId) {
+    if (ENABLE_VPL_CLUSTERS) {
+        return clusteredIndirect(p, n, albedo, matId);
+    }
+    if (ENABLE_HIERARCHICAL_SAMPLING) {
+        return hierarchicalIndirect(p, n, albedo, matId);
+    }
+    return localIndirect(p, n, albedo, matId);
+}
+
+// --- Reduced-resolution indirect ---
+// With INDIRECT_UPSAMPLE the INDIRECT_PASS variant gathers at 1/2 or 1/4 of the
+// width and height. Each pixel blends the 2x2 pass texels around it (after
+// indirect_temporal.comp when accumulating) with bilinear weights times how well
+// the texel's surface point, rebuilt from its hit distance, fits this pixel: same
+// material, and near the plane through p with the full-resolution normal. A
+// pixel none of them fits (thin features, silhouettes) gathers in place.
+// CpuCornellRenderer mirrors this.
+
+const float INDIRECT_UPSAMPLE_PLANE_SCALE = 0.05; // plane distance that scales a texel's weight by 1/e
+
+bool upsampleIndirect(vec3 p, vec3 n, int matId, out vec3 irradiance) {
+    ivec2 size = textureSize(indirectRawTex, 0);
+    vec2 pos = fragTexCoord * vec2(size) - 0.5;
+    ivec2 base = ivec2(floor(pos));
+    vec2 f = pos - vec2(base);
+    float aspect = u.iResolution.x / u.iResolution.y;
+    vec3 sum = vec3(0.0);
+    float weightSum = 0.0;
+    for (int k = 0; k < 4; ++k) {
+        ivec2 corner = ivec2(k & 1, k >> 1);
+        ivec2 texel = clamp(base + corner, ivec2(0), size - 1);
+        vec4 raw = texelFetch(indirectRawTex, texel, 0);
+        if (raw.a >= MAX_DIST) continue;
+        vec3 q = CORNELL_CAMERA_ORIGIN + cornellCameraRay((vec2(texel) + 0.5) / vec2(size), aspect) * raw.a;
+        if (getMaterial(q) != matId) continue;
+        vec2 bilinear = mix(1.0 - f, f, vec2(corner));
+        float w = bilinear.x * bilinear.y * exp(-abs(dot(n, q - p)) / INDIRECT_UPSAMPLE_PLANE_SCALE);
+        sum += w * (ENABLE_TEMPORAL_INDIRECT ? texelFetch(temporalIndirectTex, texel, 0).rgb : raw.rgb);
+        weightSum += w;
+    }
+    if (weightSum < 1e-4) {
+        return false;
+    }
+    irradiance = sum / weightSum;
+    return true;
+}
+
+// --- ReSTIR VPL reservoirs ---
+// Weighted reservoir sampling over RSM texels. The INDIRECT_PASS variant draws
+// restirParams.x candidates from the flux pyramid (sampleVpl), keeps one in
+// proportion to target / pdf, where the target is the luminance of its
+// contribution with a white albedo, and merges in the previous frame's reservoir
+// at the reprojected texel, its M capped at RESTIR_TEMPORAL_M_CAP candidates'
+// worth. Each pixel of the main pass then merges the reservoirs of its own pass
+// texel and of restirParams.y random ones within RESTIR_SPATIAL_RADIUS, and
+// shades the one VPL it ends up with. Reservoirs merge only between surfaces
+// alike in normal and depth; without visibility-aware MIS weights this trades a
+// slight bias for far fewer shading evaluations than a full gather.
+// CpuCornellRenderer mirrors this.
+
+const float RESTIR_TEMPORAL_M_CAP = 20.0;  // history kept, in multiples of the initial candidates
+const float RESTIR_SPATIAL_RADIUS = 12.0;  // in pass texels
+const float RESTIR_NORMAL_THRESHOLD = 0.9; // min dot of the normals of merged reservoirs
+const float RESTIR_DEPTH_THRESHOLD = 0.1;  // max relative difference of their hit distances
+
+// Size of the INDIRECT_PASS targets, as getCornellIndirectSize() rounds it; the
+// pass itself cannot query indirectRawTex, which it renders to
+ivec2 indirectPassSize() {
+    int divisor = max(int(u.pbrParams.w), 1);
+    return (ivec2(u.iResolution) + divisor - 1) / divisor;
+}
+
+float restirRandom(inout uint state) {
+    state = pcgHash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+// Luminance of the contribution of RSM texel `index`, the target the reservoirs sample
+float restirTarget(vec3 p, vec3 n, int matId, uint index) {
+    int rsmSize = textureSize(rsmFluxTex, 0).x;
+    if (index >= uint(rsmSize * rsmSize)) return 0.0;
+    ivec2 texel = ivec2(int(index) % rsmSize, int(index) / rsmSize);
+    return rsmLuminance(vplContribution(p, n, vec3(1.0), matId, rsmPositionTexel(texel), rsmNormalTexel(texel),
+                                        texelFetch(rsmFluxTex, texel, 0).rgb));
+}
+
+bool restirSurfaceMatches(RestirReservoir r, vec3 n, float d) {
+    return r.surface.w > 0.0 && dot(r.surface.xyz, n) > RESTIR_NORMAL_THRESHOLD &&
+           abs(r.surface.w - d) < RESTIR_DEPTH_THRESHOLD * d;
+}
+
+// Stream one candidate of weight w and target pHat into the reservoir being built
+void restirUpdate(inout RestirReservoir r, inout float weightSum, inout float selectedTarget,
+                  uint index, float w, float pHat, float count, inout uint rng) {
+    weightSum += w;
+    r.count += count;
+    if (w > 0.0 && restirRandom(rng) * weightSum < w) {
+        r.texel = index;
+        selectedTarget = pHat;
+    }
+}
+
+void restirFinish(inout RestirReservoir r, float weightSum, float selectedTarget) {
+    r.weight = selectedTarget > 0.0 ? weightSum / (r.count * selectedTarget) : 0.0;
+}
+
+// INDIRECT_PASS: initial candidates plus temporal reuse, stored for this frame
+void restirInitialAndTemporal(vec3 p, vec3 n, int matId, float d, ivec2 pixel) {
+    ivec2 size = indirectPassSize();
+    uint rng = pcgHash(uint(pixel.x) + 65536u * uint(pixel.y)) ^ pcgHash(uint(u.iFrame));
+    RestirReservoir r = RestirReservoir(vec4(n, d), 0u, 0.0, 0.0, 0.0);
+    float weightSum = 0.0;
+    float selectedTarget = 0.0;
+    int rsmSize = textureSize(rsmFluxTex, 0).x;
+    int candidates = clamp(int(u.restirParams.x), 1, 32);
+    float offset = restirRandom(rng);
+    for (int k = 0; k < candidates; ++k) {
+        ivec2 texel;
+        float pdf;
+        // A candidate the pyramid walk rejects has no contribution but still counts
+        float pHat = 0.0, w = 0.0;
+        uint index = 0u;
+        if (sampleVpl(p, n, (float(k) + offset) / float(candidates), texel, pdf)) {
+            index = uint(texel.y * rsmSize + texel.x);
+            pHat = restirTarget(p, n, matId, index);
+            w = pHat / pdf;
+        }
+        restirUpdate(r, weightSum, selectedTarget, index, w, pHat, 1.0, rng);
+    }
+
+    // The previous frame's reservoir where p was then, the camera being fixed
+    vec3 prevP = p;
+    for (int i = 0; i < 2; ++i) {
+        if (length(p - u.sphereCenters[i].xyz) < u.sphereCenters[i].w + 0.05) {
+            prevP += u.prevSphereCenters[i].xyz - u.sphereCenters[i].xyz;
+            break;
+        }
+    }
+    float aspect = u.iResolution.x / u.iResolution.y;
+    ivec2 prevPixel = ivec2(floor(cornellCameraProject(prevP, aspect) * vec2(size)));
+    if (all(greaterThanEqual(prevPixel, ivec2(0))) && all(lessThan(prevPixel, size))) {
+        int previousHalf = 1 - int(u.restirParams.z);
+        RestirReservoir prev = restirReservoirs[(previousHalf * size.y + prevPixel.y) * size.x + prevPixel.x];
+        if (restirSurfaceMatches(prev, n, length(prevP - CORNELL_CAMERA_ORIGIN))) {
+            float count = min(prev.count, RESTIR_TEMPORAL_M_CAP * float(candidates));
+            float pHat = restirTarget(p, n, matId, prev.texel);
+            restirUpdate(r, weightSum, selectedTarget, prev.texel, pHat * prev.weight * count, pHat, count, rng);
+        }
+    }
+    restirFinish(r, weightSum, selectedTarget);
+    int currentHalf = int(u.restirParams.z);
+    restirReservoirs[(currentHalf * size.y + pixel.y) * size.x + pixel.x] = r;
+}
+
+// Main pass: spatial reuse over this frame's reservoirs, then one shading evaluation.
+// False if none fits p (thin features at reduced resolution)
+bool restirIndirect(vec3 p, vec3 n, vec3 albedo, int matId, out vec3 radiance) {
+    ivec2 size = indirectPassSize();
+    ivec2 center = clamp(ivec2(fragTexCoord * vec2(size)), ivec2(0), size - 1);
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    uint rng = pcgHash(uint(pixel.x) + 65536u * uint(pixel.y)) ^ pcgHash(uint(u.iFrame) + 0x9e3779b9u);
+    float d = length(p - CORNELL_CAMERA_ORIGIN);
+    int currentHalf = int(u.restirParams.z);
+    RestirReservoir r = RestirReservoir(vec4(n, d), 0u, 0.0, 0.0, 0.0);
+    float weightSum = 0.0;
+    float selectedTarget = 0.0;
+    int neighbours = clamp(int(u.restirParams.y), 0, 8);
+    for (int i = 0; i <= neighbours; ++i) {
+        ivec2 texel = center;
+        if (i > 0) {
+            float angle = 2.0 * PI * restirRandom(rng);
+            float radius = RESTIR_SPATIAL_RADIUS * sqrt(restirRandom(rng));
+            texel = clamp(center + ivec2(round(radius * vec2(cos(angle), sin(angle)))), ivec2(0), size - 1);
+        }
+        RestirReservoir other = restirReservoirs[(currentHalf * size.y + texel.y) * size.x + texel.x];
+        if (!restirSurfaceMatches(other, n, d)) continue;
+        float pHat = restirTarget(p, n, matId, other.texel);
+        restirUpdate(r, weightSum, selectedTarget, other.texel, pHat * other.weight * other.count, pHat, other.count, rng);
+    }
+    if (!(r.count > 0.0)) {
+        return false;
+    }
+    restirFinish(r, weightSum, selectedTarget);
+    radiance = vec3(0.0);
+    if (r.weight > 0.0) {
+        int rsmSize = textureSize(rsmFluxTex, 0).x;
+        ivec2 texel = ivec2(int(r.texel) % rsmSize, int(r.texel) / rsmSize);
+        float texelArea = 4.0 * u.lightOrthoHalfSize.x * u.lightOrthoHalfSize.y * u.rsmResolution.z * u.rsmResolution.w;
+        radiance = vplContribution(p, n, albedo, matId, rsmPositionTexel(texel), rsmNormalTexel(texel),
+                                   texelFetch(rsmFluxTex, texel, 0).rgb) * (r.weight * u.indirectParams.x * texelArea);
+    }
+    return true;
+}
+
+// The indirect term of getLight() and of the resampled, upsampled or accumulated indirect-only view
+vec3 indirectLighting(vec3 p, vec3 n, vec3 albedo, int matId) {
+    if (ENABLE_RESTIR) {
+        vec3 radiance;
+        if (restirIndirect(p, n, albedo, matId, radiance)) {
+            return radiance;
+        }
+    } else if (INDIRECT_UPSAMPLE) {
+        vec3 irradiance;
+        if (upsampleIndirect(p, n, matId, irradiance)) {
+            return albedo * irradiance;
+        }
+    } else if (ENABLE_TEMPORAL_INDIRECT) {
+        return albedo * texelFetch(temporalIndirectTex, ivec2(gl_FragCoord.xy), 0).rgb;
+    }
+    return gatherIndirect(p, n, albedo, matId);
+}
+
 // --- PBR Helper Functions ---
 
 // Fresnel-Schlick approximation
@@ -383,13 +921,13 @@ vec3 getLight(vec3 p, vec3 n, vec3 viewDir, vec3 albedo, int matId) {
     }
     
     // Increase base ambient for PBR mode to improve visibility
-    float ambientMultiplier = (u.pbrParams.x > 0.5) ? 0.8 : 0.3;
+    float ambientMultiplier = (ENABLE_PBR) ? 0.8 : 0.3;
     vec3 finalColor = vec3(0.12, 0.15, 0.20) * ambientMultiplier;
     
     // Calculate shadow first (used by both direct and indirect lighting)
     float shadow = 1.0;
-    if (u.enableLights.x == 1) {
-        if (u.rsmParams.w > 0.5) {
+    if (ENABLE_KEY_LIGHT) {
+        if (ENABLE_RSM) {
             shadow = rsmShadow(p + n * 0.05, n);
         } else {
             shadow = softShadow(p + n * 0.07, l, 0.07, 6.0, 6.0 * u.shadowParams.x);
@@ -412,17 +950,17 @@ vec3 getLight(vec3 p, vec3 n, vec3 viewDir, vec3 albedo, int matId) {
     
     // Apply global base color factors for PBR (but ensure minimum brightness)
     vec3 pbrAlbedo = albedo;
-    if (u.pbrParams.x > 0.5) { // PBR enabled
+    if (ENABLE_PBR) { // PBR enabled
         // Apply base color factors more conservatively to avoid over-darkening
         vec3 colorFactor = max(u.baseColorFactors.rgb * u.baseColorFactors.a, vec3(0.3));
         pbrAlbedo *= colorFactor;
     }
     
     // 1. 主光源 (Key Light) - Direct Lighting
-    if (u.enableLights.x == 1) {
+    if (ENABLE_KEY_LIGHT) {
         vec3 lightColor = u.lightColors[0].rgb * u.lightColors[0].a;
         
-        if (u.pbrParams.x > 0.5) {
+        if (ENABLE_PBR) {
             // === PBR LIGHTING ===
             vec3 brdf = cook_torrance_brdf(pbrAlbedo, n, viewDir, l, roughness, metallic);
             // Increase PBR lighting intensity to compensate for energy conservation
@@ -443,225 +981,16 @@ vec3 getLight(vec3 p, vec3 n, vec3 viewDir, vec3 albedo, int matId) {
     }
     
     // RSM Indirect Lighting (separate from direct lighting)
-    if (u.rsmParams.w > 0.5 && u.rsmParams.z > 0.5) {
-        float radius = max(u.rsmParams.x, 1.0);
-        int samples = int(max(u.rsmParams.y, 1.0));
-        vec3 rel = p - u.lightOrigin.xyz;
-        vec2 base = vec2(dot(rel, u.lightRight.xyz) / max(u.lightOrthoHalfSize.x, 1e-4),
-                         dot(rel, u.lightUp.xyz)    / max(u.lightOrthoHalfSize.y, 1e-4));
-        vec2 baseUV = base * 0.5 + 0.5;
-        vec3 bounce = vec3(0.0);
-        int validSamples = 0;
-        
-        // Choose sampling strategy based on importance sampling toggle
-        if (u.debugParams[1] > 0.5) {
-            // === IMPORTANCE SAMPLING - Three-Phase Adaptive Strategy ===
-            
-            // Phase 1: Coarse Analysis Pass (8 samples)
-            vec2 coarseOffs[8] = vec2[8](
-                vec2( 0.0,  0.0), vec2( 1.0,  0.0), vec2(-1.0,  0.0), vec2( 0.0,  1.0),
-                vec2( 0.0, -1.0), vec2( 0.7,  0.7), vec2(-0.7,  0.7), vec2( 0.7, -0.7)
-            );
-            
-            float maxImportance = 0.0;
-            vec2 bestRegion = vec2(0.0);
-            
-            for (int i = 0; i < 8; ++i) {
-                vec2 duv = coarseOffs[i] * radius * 0.5 / max(u.rsmResolution.xy, vec2(1.0));
-                vec2 uv = clamp(baseUV + duv, 0.0, 1.0);
-                
-                vec3 vplPos = texture(rsmPositionTex, uv).xyz;
-                vec3 vplNor = texture(rsmNormalTex, uv).xyz;
-                vec3 flux = texture(rsmFluxTex, uv).xyz;
-                
-                if (length(vplPos) < 0.1) continue;
-                
-                vec3 wi = normalize(vplPos - p);
-                float cos1 = max(dot(n, wi), 0.0);
-                float cos2 = max(dot(vplNor, -wi), 0.0);
-                float fluxMag = length(flux);
-                
-                float importance = cos1 * cos2 * fluxMag;
-                if (importance > maxImportance) {
-                    maxImportance = importance;
-                    bestRegion = duv;
-                }
-            }
-            
-            // Phase 2: Focused Dense Sampling (20 samples)
-            vec2 denseOffs[20] = vec2[20](
-                vec2( 0.0,  0.0), vec2( 0.3,  0.0), vec2(-0.3,  0.0), vec2( 0.0,  0.3), vec2( 0.0, -0.3),
-                vec2( 0.2,  0.2), vec2(-0.2,  0.2), vec2( 0.2, -0.2), vec2(-0.2, -0.2),
-                vec2( 0.5,  0.0), vec2(-0.5,  0.0), vec2( 0.0,  0.5), vec2( 0.0, -0.5),
-                vec2( 0.4,  0.4), vec2(-0.4,  0.4), vec2( 0.4, -0.4), vec2(-0.4, -0.4),
-                vec2( 0.6,  0.2), vec2(-0.6, -0.2), vec2( 0.2, -0.6)
-            );
-            
-            for (int i = 0; i < 20; ++i) {
-                vec2 localOffset = denseOffs[i] * 0.3;
-                vec2 duv = (bestRegion + localOffset * radius / max(u.rsmResolution.xy, vec2(1.0)));
-                vec2 uv = clamp(baseUV + duv, 0.0, 1.0);
-                
-                vec3 vplPos = texture(rsmPositionTex, uv).xyz;
-                vec3 vplNor = normalize(texture(rsmNormalTex, uv).xyz);
-                vec3 flux = texture(rsmFluxTex, uv).xyz;
-                
-                if (length(vplPos) < 0.1) continue;
-                
-                vec3 wi = vplPos - p;
-                float dist = length(wi);
-                if (dist < 0.05) continue;
-                wi = normalize(wi);
-                
-                float cos1 = max(dot(n, wi), 0.0);
-                float cos2 = max(dot(vplNor, -wi), 0.0);
-                
-                if (cos1 < 0.05 || cos2 < 0.05) continue;
-
-                // Enhanced VPL contribution with geometric consistency check
-                float enhancedFalloff = 1.0 / max(dist * dist + 0.5, 1e-3);
-                vec3 brdf = albedo / 3.14159;
-                
-                // Geometric consistency check to reduce seam artifacts
-                vec3 vplToReceiver = normalize(p - vplPos);
-                float normalConsistency = dot(normalize(n), normalize(vplNor));
-                
-                // Reduce contribution from VPLs that create harsh geometric discontinuities
-                float geometricDamping = 1.0;
-                if (abs(normalConsistency) > 0.8) { // Nearly parallel or anti-parallel surfaces
-                    geometricDamping *= 0.3; // Strong reduction for seam-like configurations
-                } else if (abs(normalConsistency) > 0.6) {
-                    geometricDamping *= 0.6; // Moderate reduction
-                }
-                
-                // Apply material-based enhancement for spheres but reduce for walls
-                float materialBoost = (matId == 1 || matId == 7) ? 2.0 : 0.7; // Reduced wall contribution
-                bounce += brdf * flux * (cos1 * cos2) * enhancedFalloff * materialBoost * geometricDamping;
-                validSamples++;
-            }
-            
-            // Phase 3: Coverage Sampling (4 samples)
-            vec2 coverageOffs[4] = vec2[4](
-                vec2(-0.7, -0.7), vec2( 0.8,  0.3), vec2(-0.3,  0.8), vec2( 0.9, -0.4)
-            );
-            
-            for (int i = 0; i < 4; ++i) {
-                vec2 duv = coverageOffs[i] * radius / max(u.rsmResolution.xy, vec2(1.0));
-                vec2 uv = clamp(baseUV + duv, 0.0, 1.0);
-                
-                vec3 vplPos = texture(rsmPositionTex, uv).xyz;
-                vec3 vplNor = normalize(texture(rsmNormalTex, uv).xyz);
-                vec3 flux = texture(rsmFluxTex, uv).xyz;
-                
-                if (length(vplPos) < 0.1) continue;
-                
-                vec3 wi = vplPos - p;
-                float dist = length(wi);
-                if (dist < 0.05) continue;
-                wi = normalize(wi);
-                
-                float cos1 = max(dot(n, wi), 0.0);
-                float cos2 = max(dot(vplNor, -wi), 0.0);
-                
-                if (cos1 < 0.05 || cos2 < 0.05) continue;
-
-                // Enhanced falloff for coverage samples with seam reduction
-                float enhancedFalloff = 1.0 / max(dist * dist + 0.5, 1e-3);
-                vec3 brdf = albedo / 3.14159;
-                
-                // Geometric consistency check for coverage samples
-                float normalConsistency = dot(normalize(n), normalize(vplNor));
-                float geometricDamping = 1.0;
-                if (abs(normalConsistency) > 0.8) {
-                    geometricDamping *= 0.3;
-                } else if (abs(normalConsistency) > 0.6) {
-                    geometricDamping *= 0.6;
-                }
-                
-                float materialBoost = (matId == 1 || matId == 7) ? 2.0 : 0.7;
-                bounce += brdf * flux * (cos1 * cos2) * enhancedFalloff * materialBoost * geometricDamping;
-                validSamples++;
-            }
-            
-            // Normalize by the number of contributing samples and scale by user intensity
-            if (validSamples > 0) {
-                finalColor += (u.indirectParams.x) * (bounce / float(validSamples));
-            }
-        } else {
-            // === UNIFORM SAMPLING - Original Strategy ===
-            
-            // Uniform sampling pattern with 32 points
-            vec2 offs[32] = vec2[32](
-                vec2(0.0, 0.0),     // Center - 1
-                vec2(0.3, 0.0), vec2(-0.3, 0.0), vec2(0.0, 0.3), vec2(0.0, -0.3),         // Ring 1 cardinal - 5
-                vec2(0.2, 0.2), vec2(-0.2, 0.2), vec2(0.2, -0.2), vec2(-0.2, -0.2),       // Ring 1 diagonal - 9
-                vec2(0.6, 0.0), vec2(-0.6, 0.0), vec2(0.0, 0.6), vec2(0.0, -0.6),         // Ring 2 cardinal - 13
-                vec2(0.45, 0.45), vec2(-0.45, 0.45), vec2(0.45, -0.45), vec2(-0.45, -0.45), // Ring 2 diagonal - 17
-                vec2(1.0, 0.0), vec2(-1.0, 0.0), vec2(0.0, 1.0), vec2(0.0, -1.0),         // Ring 3 cardinal - 21
-                vec2(0.7, 0.7), vec2(-0.7, 0.7), vec2(0.7, -0.7), vec2(-0.7, -0.7),       // Ring 3 diagonal - 25
-                vec2(0.5, 0.2), vec2(-0.5, 0.2), vec2(0.2, 0.5), vec2(-0.2, 0.5),         // Intermediate 1 - 29
-                vec2(0.8, 0.3), vec2(-0.8, -0.3), vec2(0.3, -0.8)                         // Final 3 - 32
-            );
-            
-            int N = min(samples, 32);
-            int totalValid = 0;
-            
-            for (int i = 0; i < N; ++i) {
-                // Add some randomization to reduce banding
-                float random = fract(sin(dot(p.xz + float(i), vec2(12.9898, 78.233))) * 43758.5453);
-                vec2 jitter = vec2(fract(random * 43758.5453), fract(random * 23421.6319)) * 2.0 - 1.0;
-                vec2 duv = (offs[i] + jitter * 0.05) * radius / max(u.rsmResolution.xy, vec2(1.0));
-                vec2 uv = clamp(baseUV + duv, 0.0, 1.0);
-                
-                vec3 vplPos = texture(rsmPositionTex, uv).xyz;
-                vec3 vplNor = normalize(texture(rsmNormalTex, uv).xyz);
-                vec3 flux   = texture(rsmFluxTex, uv).xyz;
-                
-                // Skip invalid VPLs (background)
-                if (length(vplPos) < 0.1) continue;
-                
-                vec3 wi = vplPos - p;
-                float dist = length(wi);
-                if (dist < 0.05) continue; // Skip self-illumination
-                wi = normalize(wi);
-                
-                float cos1 = max(dot(n, wi), 0.0);
-                float cos2 = max(dot(vplNor, -wi), 0.0);
-                
-                // Skip VPLs facing away from receiver
-                if (cos1 < 0.05 || cos2 < 0.05) continue;
-                
-                // Enhanced falloff for uniform sampling with seam artifact reduction
-                float enhancedFalloff = 1.0 / max(dist * dist + 0.5, 1e-3);
-                vec3 brdf = albedo / 3.14159;
-                
-                // Geometric consistency check to prevent seam over-illumination
-                float normalConsistency = dot(normalize(n), normalize(vplNor));
-                float geometricDamping = 1.0;
-                if (abs(normalConsistency) > 0.8) {
-                    geometricDamping *= 0.3; // Strong reduction for seam-like configurations
-                } else if (abs(normalConsistency) > 0.6) {
-                    geometricDamping *= 0.6;
-                }
-                
-                float materialBoost = (matId == 1 || matId == 7) ? 2.0 : 0.7;
-                bounce += brdf * flux * (cos1 * cos2) * enhancedFalloff * materialBoost * geometricDamping;
-                totalValid++;
-            }
-            
-            // Normalize and apply uniform-sampled indirect lighting
-            if (totalValid > 0) {
-                finalColor += (u.indirectParams.x) * (bounce / float(totalValid));
-            }
-        }
+    if (ENABLE_INDIRECT) {
+        finalColor += indirectLighting(p, n, albedo, matId);
     }
     
     // 2. 填充光 (Fill Light)，用于照亮暗部
-    if (u.enableLights.y == 1) {
+    if (ENABLE_FILL_LIGHT) {
         vec3 fillDir = normalize(vec3(0.4, 0.3, 0.7)); // 填充光方向
         vec3 fillColor = u.lightColors[1].rgb * u.lightColors[1].a;
         
-        if (u.pbrParams.x > 0.5) {
+        if (ENABLE_PBR) {
             // PBR fill light with increased intensity
             vec3 fillBrdf = cook_torrance_brdf(pbrAlbedo, n, viewDir, fillDir, roughness, metallic);
             finalColor += fillBrdf * fillColor * 0.6; // Increased from 0.2 to 0.6
@@ -673,12 +1002,12 @@ vec3 getLight(vec3 p, vec3 n, vec3 viewDir, vec3 albedo, int matId) {
     }
     
     // 3. 边缘光 (Rim Light)，用于勾勒物体轮廓
-    if (u.enableLights.z == 1) {
+    if (ENABLE_RIM_LIGHT) {
         float rim = 1.0 - max(0.0, dot(viewDir, n));
         rim = pow(rim, 3.0);
         vec3 rimColor = u.lightColors[2].rgb * u.lightColors[2].a * 0.8;
         
-        if (u.pbrParams.x > 0.5) {
+        if (ENABLE_PBR) {
             // For PBR, rim lighting is more subtle and affects fresnel
             vec3 F0 = vec3(0.04);
             F0 = mix(F0, pbrAlbedo, metallic);
@@ -691,11 +1020,11 @@ vec3 getLight(vec3 p, vec3 n, vec3 viewDir, vec3 albedo, int matId) {
     }
     
     // 4. 模拟环境反射
-    if (u.enableLights.w == 1) {
+    if (ENABLE_ENV_LIGHT) {
         vec3 envReflect = reflect(-viewDir, n);
         vec3 envColor = vec3(0.95, 0.85, 0.6); // 温暖的金黄色反射
         
-        if (u.pbrParams.x > 0.5) {
+        if (ENABLE_PBR) {
             // === PBR ENVIRONMENT REFLECTION ===
             // Calculate F0 based on metallic workflow
             vec3 F0 = vec3(0.04);
@@ -729,6 +1058,21 @@ void main() {
     vec2 uv = (fragTexCoord - 0.5) * 2.0;
     uv.x *= u.iResolution.x / u.iResolution.y;
     
+    // Debug visualization: show RSM buffers instead of final render when enabled
+    // (before marching: the variant has no use for the scene)
+    if (DEBUG_RSM_VIEW) {
+        // Visualize: position (xyz) as color, normal, and flux
+        // Pack into RGB channels to help debugging. Here prefer flux as primary.
+        vec3 flux = texture(rsmFluxTex, fragTexCoord).rgb;
+        vec3 normalVis = rsmNormalAt(fragTexCoord) * 0.5 + 0.5;
+        vec3 posVis = rsmPositionAt(fragTexCoord) * 0.05 + 0.5;
+        // Compose a quick tri-view by weighting
+        vec3 debugColor = mix(posVis, normalVis, 0.3);
+        debugColor = mix(debugColor, flux, 0.6);
+        outColor = vec4(debugColor, 1.0);
+        return;
+    }
+    
     // 2. 相机设置
     vec3 ro = vec3(0.0, 0.0, 5.0);     // 相机位置 (Ray Origin)
     vec3 target = vec3(0.0, 0.0, 0.0); // 目标点
@@ -746,76 +1090,37 @@ void main() {
     
     // 4. 执行光线步进，获取到场景的距离d
     float d = rayMarch(ro, rd);
-    
-    // 5. 根据距离d计算颜色
-    vec3 color = vec3(0.85, 0.9, 0.95); // 浅灰蓝色背景，更接近图片的柔和背景
-    
-    if (d < MAX_DIST) { // 如果光线击中了物体
-        vec3 p = ro + rd * d;       // 计算交点坐标
-        vec3 n = getNormal(p);      // 计算交点法线
-        int matId = getMaterial(p); // 获取材质ID
-        
-        // 根据材质ID获取物体基础色(Albedo)
-        vec3 albedo;
-        if (matId == 1) { // 球体1 - 带花朵纹理
-            // Calculate sphere UV coordinates for texture mapping
-            // Need to transform back to sphere-local coordinates
-            float rotationAngle = u.iTime * 0.5;
-            mat3 zRotation = rotateZ(rotationAngle);
-            vec3 sphere1Pos = zRotation * vec3(2.0, 0.0, 0.0);
-            vec3 sphere1P = p - sphere1Pos;
-            mat3 rotation1 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-            sphere1P = rotation1 * sphere1P;
-            vec2 sphereUV = getSphereUV(sphere1P);
-            albedo = texture(flowerTex, sphereUV).rgb;
-        } else if (matId == 7) { // 球体2 - 纯色
-            albedo = u.sphereColor.rgb;
-        } else if (matId == 2) { // 地面 (底部) - 深蓝灰色
-            albedo = vec3(0.3, 0.4, 0.6);
-        } else if (matId == 3) { // 天花板 (顶部) - 浅蓝灰色
-            albedo = vec3(0.7, 0.8, 0.9);
-        } else if (matId == 4) { // 左墙 - 温暖绿色
-            albedo = vec3(0.4, 0.7, 0.5);
-        } else if (matId == 5) { // 右墙 - 温暖红色
-            albedo = vec3(0.7, 0.4, 0.4);
-        } else if (matId == 6) { // 后墙 - 温暖紫色
-            albedo = vec3(0.6, 0.4, 0.7);
-        } else { // 默认墙面
-            vec3 baseColor = vec3(0.92, 0.94, 0.98); // 明亮的浅色
-            baseColor += n * 0.001; // 根据法线增加一些颜色变化
-            albedo = baseColor * u.shadowParams.z;
+
+    // Indirect light without albedo (this frame's taps for indirect_temporal.comp),
+    // and the hit distance it is reprojected and upsampled with (MAX_DIST: background).
+    // With ENABLE_RESTIR only the reservoir, which keeps its own hit distance
+    if (INDIRECT_PASS) {
+        if (d < MAX_DIST) {
+            vec3 p = ro + rd * d;
+            vec3 n = getNormal(p);
+            int matId = getMaterial(p);
+            if (ENABLE_RESTIR) {
+                restirInitialAndTemporal(p, n, matId, d, ivec2(gl_FragCoord.xy));
+                outColor = vec4(0.0, 0.0, 0.0, d);
+            } else {
+                outColor = vec4(ENABLE_TEMPORAL_INDIRECT ? temporalIndirectTaps(p, n, matId, ivec2(gl_FragCoord.xy))
+                                                         : gatherIndirect(p, n, vec3(1.0), matId), d);
+            }
+        } else {
+            if (ENABLE_RESTIR) {
+                ivec2 size = indirectPassSize();
+                ivec2 pixel = ivec2(gl_FragCoord.xy);
+                restirReservoirs[(int(u.restirParams.z) * size.y + pixel.y) * size.x + pixel.x] =
+                    RestirReservoir(vec4(0.0), 0u, 0.0, 0.0, 0.0);
+            }
+            outColor = vec4(0.0, 0.0, 0.0, MAX_DIST);
         }
-        
-        // 调用光照函数计算最终颜色
-        color = getLight(p, n, -rd, albedo, matId);
-        
-        // 添加距离雾效，增加场景深度感
-        float fog = 1.0 - exp(-d * 0.08);
-        color = mix(color, vec3(0.85, 0.9, 0.95), fog * 0.15); // 使用明亮的背景色作为雾效
-    }
-    
-    // 6. 后期处理
-    // Removed manual gamma correction to avoid double gamma with sRGB swapchain
-    // 跳过Gamma校正，当前使用sRGB输入+sRGB纹理+sRGB交换链的组合
-    // color = pow(color, vec3(0.75)); // 更强的Gamma校正，提亮整体
-    color = mix(color, color * vec3(1.05, 1.02, 0.95), 0.12); // 增加温暖的黄色色调
-    
-    // Debug visualization: show RSM buffers instead of final render when enabled
-    if (u.debugParams.x > 0.5) {
-        // Visualize: position (xyz) as color, normal, and flux
-        // Pack into RGB channels to help debugging. Here prefer flux as primary.
-        vec3 flux = texture(rsmFluxTex, fragTexCoord).rgb;
-        vec3 normalVis = texture(rsmNormalTex, fragTexCoord).xyz * 0.5 + 0.5;
-        vec3 posVis = texture(rsmPositionTex, fragTexCoord).xyz * 0.05 + 0.5;
-        // Compose a quick tri-view by weighting
-        vec3 debugColor = mix(posVis, normalVis, 0.3);
-        debugColor = mix(debugColor, flux, 0.6);
-        outColor = vec4(debugColor, 1.0);
         return;
     }
     
     // Debug visualization: show only indirect lighting when enabled
-    if (u.debugParams.z > 0.5) {
+    // (the variant skips the direct lighting it would throw away)
+    if (DEBUG_INDIRECT_VIEW) {
         if (d < MAX_DIST) { // If light ray hit an object
             vec3 p = ro + rd * d;
             vec3 n = getNormal(p);
@@ -824,12 +1129,7 @@ void main() {
             // Get albedo for the surface
             vec3 albedo;
             if (matId == 1) {
-                float rotationAngle = u.iTime * 0.5;
-                mat3 zRotation = rotateZ(rotationAngle);
-                vec3 sphere1Pos = zRotation * vec3(2.0, 0.0, 0.0);
-                vec3 sphere1P = p - sphere1Pos;
-                mat3 rotation1 = rotateX(u.sphereRotation.x) * rotateY(u.sphereRotation.y) * rotateZ(u.sphereRotation.z);
-                sphere1P = rotation1 * sphere1P;
+                vec3 sphere1P = u.sphereLocalRotation * (p - u.sphereCenters[0].xyz);
                 vec2 sphereUV = getSphereUV(sphere1P);
                 albedo = texture(flowerTex, sphereUV).rgb;
             } else if (matId == 7) {
@@ -850,7 +1150,13 @@ void main() {
             
             // Only show indirect lighting from RSM
             vec3 indirectOnly = vec3(0.0);
-            if (u.rsmParams.w > 0.5 && u.rsmParams.z > 0.5) {
+            if (ENABLE_INDIRECT && (ENABLE_RESTIR || INDIRECT_UPSAMPLE || ENABLE_TEMPORAL_INDIRECT)) {
+                indirectOnly = indirectLighting(p, n, albedo, matId);
+            } else if (ENABLE_INDIRECT && ENABLE_VPL_CLUSTERS) {
+                indirectOnly = clusteredIndirect(p, n, albedo, matId);
+            } else if (ENABLE_INDIRECT && ENABLE_HIERARCHICAL_SAMPLING) {
+                indirectOnly = hierarchicalIndirect(p, n, albedo, matId);
+            } else if (ENABLE_INDIRECT) {
                 // Calculate only the indirect lighting portion
                 float radius = max(u.rsmParams.x, 1.0);
                 vec3 rel = p - u.lightOrigin.xyz;
@@ -861,7 +1167,7 @@ void main() {
                 int validSamples = 0;
                 
                 // Use same sampling strategy as in getLight function but only return indirect contribution
-                if (u.debugParams[1] > 0.5) {
+                if (ENABLE_IMPORTANCE_SAMPLING) {
                     // Importance sampling approach (simplified version)
                     vec2 offs[16] = vec2[16](
                         vec2(0.0, 0.0), vec2(0.3, 0.0), vec2(-0.3, 0.0), vec2(0.0, 0.3),
@@ -871,11 +1177,11 @@ void main() {
                     );
                     
                     for (int i = 0; i < 16; ++i) {
-                        vec2 duv = offs[i] * radius / max(u.rsmResolution.xy, vec2(1.0));
+                        vec2 duv = offs[i] * radius * u.rsmResolution.zw;
                         vec2 uv = clamp(baseUV + duv, 0.0, 1.0);
                         
-                        vec3 vplPos = texture(rsmPositionTex, uv).xyz;
-                        vec3 vplNor = normalize(texture(rsmNormalTex, uv).xyz);
+                        vec3 vplPos = rsmPositionAt(uv);
+                        vec3 vplNor = normalize(rsmNormalAt(uv));
                         vec3 flux = texture(rsmFluxTex, uv).xyz;
                         
                         if (length(vplPos) < 0.1) continue;
@@ -917,11 +1223,11 @@ void main() {
                     );
                     
                     for (int i = 0; i < 16; ++i) {
-                        vec2 duv = offs[i] * radius / max(u.rsmResolution.xy, vec2(1.0));
+                        vec2 duv = offs[i] * radius * u.rsmResolution.zw;
                         vec2 uv = clamp(baseUV + duv, 0.0, 1.0);
                         
-                        vec3 vplPos = texture(rsmPositionTex, uv).xyz;
-                        vec3 vplNor = normalize(texture(rsmNormalTex, uv).xyz);
+                        vec3 vplPos = rsmPositionAt(uv);
+                        vec3 vplNor = normalize(rsmNormalAt(uv));
                         vec3 flux = texture(rsmFluxTex, uv).xyz;
                         
                         if (length(vplPos) < 0.1) continue;
@@ -970,6 +1276,54 @@ void main() {
         }
     }
 
+    // 5. 根据距离d计算颜色
+    vec3 color = vec3(0.85, 0.9, 0.95); // 浅灰蓝色背景，更接近图片的柔和背景
+    
+    if (d < MAX_DIST) { // 如果光线击中了物体
+        vec3 p = ro + rd * d;       // 计算交点坐标
+        vec3 n = getNormal(p);      // 计算交点法线
+        int matId = getMaterial(p); // 获取材质ID
+        
+        // 根据材质ID获取物体基础色(Albedo)
+        vec3 albedo;
+        if (matId == 1) { // 球体1 - 带花朵纹理
+            // Calculate sphere UV coordinates for texture mapping
+            // Need to transform back to sphere-local coordinates
+            vec3 sphere1P = u.sphereLocalRotation * (p - u.sphereCenters[0].xyz);
+            vec2 sphereUV = getSphereUV(sphere1P);
+            albedo = texture(flowerTex, sphereUV).rgb;
+        } else if (matId == 7) { // 球体2 - 纯色
+            albedo = u.sphereColor.rgb;
+        } else if (matId == 2) { // 地面 (底部) - 深蓝灰色
+            albedo = vec3(0.3, 0.4, 0.6);
+        } else if (matId == 3) { // 天花板 (顶部) - 浅蓝灰色
+            albedo = vec3(0.7, 0.8, 0.9);
+        } else if (matId == 4) { // 左墙 - 温暖绿色
+            albedo = vec3(0.4, 0.7, 0.5);
+        } else if (matId == 5) { // 右墙 - 温暖红色
+            albedo = vec3(0.7, 0.4, 0.4);
+        } else if (matId == 6) { // 后墙 - 温暖紫色
+            albedo = vec3(0.6, 0.4, 0.7);
+        } else { // 默认墙面
+            vec3 baseColor = vec3(0.92, 0.94, 0.98); // 明亮的浅色
+            baseColor += n * 0.001; // 根据法线增加一些颜色变化
+            albedo = baseColor * u.shadowParams.z;
+        }
+        
+        // 调用光照函数计算最终颜色
+        color = getLight(p, n, -rd, albedo, matId);
+        
+        // 添加距离雾效，增加场景深度感
+        float fog = 1.0 - exp(-d * 0.08);
+        color = mix(color, vec3(0.85, 0.9, 0.95), fog * 0.15); // 使用明亮的背景色作为雾效
+    }
+    
+    // 6. 后期处理
+    // Removed manual gamma correction to avoid double gamma with sRGB swapchain
+    // 跳过Gamma校正，当前使用sRGB输入+sRGB纹理+sRGB交换链的组合
+    // color = pow(color, vec3(0.75)); // 更强的Gamma校正，提亮整体
+    color = mix(color, color * vec3(1.05, 1.02, 0.95), 0.12); // 增加温暖的黄色色调
+    
     // 7. 输出最终颜色
     outColor = vec4(color, 1.0);
 }
@@ -0,0 +1,26 @@
+// Clustered VPL list (include/VplClusters.hpp), shared by vpl_cluster.comp,
+// which builds it from the RSM, and sdf_practice.frag, which shades with it.
+// Include after the #version line with GL_GOOGLE_include_directive enabled.
+
+// kVplClusterGridSize: the RSM is reduced to this grid of cells before clustering
+const int VPL_CLUSTER_GRID = 128;
+const int VPL_CLUSTER_CELLS = VPL_CLUSTER_GRID * VPL_CLUSTER_GRID;
+
+// A cluster, and also one grid cell before clustering (a cluster of its own texels)
+struct VplCluster {
+    vec4 position; // xyz flux-weighted centroid, w member cells (cells: 1, or 0 without flux)
+    vec4 normal;   // xyz flux-weighted mean normal
+    vec4 flux;     // rgb summed flux of the member texels
+};
+
+// First RSM texel of a grid cell; the cell ends where the next one begins
+ivec2 vplCellBegin(ivec2 cell, int rsmSize) {
+    return (cell * rsmSize) / VPL_CLUSTER_GRID;
+}
+
+// k-means metric: squared distance plus a penalty for diverging normals, so
+// cells on different walls of a corner end up in different clusters
+float vplClusterDistance(VplCluster cell, VplCluster cluster) {
+    vec3 d = cell.position.xyz - cluster.position.xyz;
+    return dot(d, d) + 2.0 * (1.0 - dot(cell.normal.xyz, cluster.normal.xyz));
+}
@@ -0,0 +1,238 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 20:00:00
+ * @Description  : Sparse brick-map bake of a static signed distance field
+ * @FilePath     : BrickMap.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "BrickMap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace sdf;
+
+namespace {
+
+constexpr uint32_t kMaxAtlasDimension = 4096;
+constexpr uint32_t N = BrickMap::kBrickSamples;
+
+// Corners can land exactly on a primitive's singular point (0/0 in some of the
+// gallery SDFs); the GPU gets NaN there too, but NaN must not spread through filtering
+float sanitize(float d, float fallback) {
+    return std::isfinite(d) ? d : fallback;
+}
+
+float trilinear(const float c[8], float fx, float fy, float fz) {
+    float x00 = mix(c[0], c[1], fx), x10 = mix(c[2], c[3], fx);
+    float x01 = mix(c[4], c[5], fx), x11 = mix(c[6], c[7], fx);
+    return mix(mix(x00, x10, fy), mix(x01, x11, fy), fz);
+}
+
+// Lower bound at a point `outside` away from the bounds, given the distance `d` at
+// the nearest point inside them (the baked surfaces all lie inside)
+float withOutside(float d, float outside) {
+    return outside > 0.0f ? std::max(outside, d - outside) : d;
+}
+
+} // namespace
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    if (((bits >> 23) & 0xFF) == 0xFF) {
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u)); // inf / NaN
+    }
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00u); // overflow to inf
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign); // underflow to zero
+        }
+        // Subnormal: shift in the implicit bit, round to nearest even
+        mantissa |= 0x800000u;
+        const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1u << shift) - 1u);
+        const uint32_t halfway = 1u << (shift - 1u);
+        if (rest > halfway || (rest == halfway && (half & 1u))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    const uint32_t rest = mantissa & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) {
+        ++half; // may carry into the exponent, which is still correct rounding
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value) {
+    const uint32_t sign = (static_cast<uint32_t>(value) & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+    uint32_t bits;
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Subnormal: normalise
+        exponent = 127 - 15 + 1;
+        while (!(mantissa & 0x400u)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+BrickMap bakeBrickMap(WorkStealingPool& pool, const std::function<float(Vec3)>& field, const BrickMapDesc& desc) {
+    if (!(desc.voxelSize > 0.0f)) {
+        throw std::runtime_error("Brick map voxel size must be positive");
+    }
+    BrickMap map;
+    map.origin = desc.boundsMin;
+    map.voxelSize = desc.voxelSize;
+    const float cellSize = map.getCellSize();
+    for (int a = 0; a < 3; ++a) {
+        const float extent = desc.boundsMax[a] - desc.boundsMin[a];
+        map.cells[a] = std::max(1u, static_cast<uint32_t>(std::ceil(extent / cellSize)));
+    }
+    const uint32_t cx = map.cells[0], cy = map.cells[1], cz = map.cells[2];
+    const float halfDiagonal = 0.5f * cellSize * std::sqrt(3.0f);
+    const float farValue = halfDiagonal + desc.band + cellSize;
+
+    // Coarse grid on the cell corners, one task per row
+    map.coarse.resize(static_cast<size_t>(cx + 1) * (cy + 1) * (cz + 1));
+    pool.parallelFor(static_cast<size_t>(cy + 1) * (cz + 1), [&](size_t row, unsigned) {
+        const uint32_t y = static_cast<uint32_t>(row % (cy + 1));
+        const uint32_t z = static_cast<uint32_t>(row / (cy + 1));
+        for (uint32_t x = 0; x <= cx; ++x) {
+            const Vec3 p = map.origin + Vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * cellSize;
+            map.coarse[row * (cx + 1) + x] = sanitize(field(p), farValue);
+        }
+    });
+
+    // Occupancy from the cell centres
+    map.indirection.assign(map.getCellCount(), BrickMap::kBrickEmpty);
+    std::vector<uint8_t> occupied(map.getCellCount(), 0);
+    pool.parallelFor(static_cast<size_t>(cy) * cz, [&](size_t row, unsigned) {
+        const uint32_t y = static_cast<uint32_t>(row % cy);
+        const uint32_t z = static_cast<uint32_t>(row / cy);
+        for (uint32_t x = 0; x < cx; ++x) {
+            const Vec3 centre = map.origin + (Vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) + 0.5f) * cellSize;
+            const float d = field(centre);
+            // NaN compares false: such a cell keeps its brick
+            occupied[row * cx + x] = !(std::fabs(d) > halfDiagonal + desc.band);
+        }
+    });
+
+    // Slots in cell order, so the bake is deterministic
+    std::vector<uint32_t> brickCells;
+    for (size_t i = 0; i < occupied.size(); ++i) {
+        if (occupied[i]) {
+            map.indirection[i] = static_cast<uint32_t>(brickCells.size());
+            brickCells.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    map.brickCount = static_cast<uint32_t>(brickCells.size());
+
+    const uint32_t tileWidth = N * N;
+    map.atlasColumns = std::max(1u, std::min(map.brickCount, kMaxAtlasDimension / tileWidth));
+    const uint32_t rows = std::max(1u, (map.brickCount + map.atlasColumns - 1) / map.atlasColumns);
+    map.atlasWidth = map.atlasColumns * tileWidth;
+    map.atlasHeight = rows * N;
+    if (map.atlasHeight > kMaxAtlasDimension) {
+        throw std::runtime_error("Brick map needs " + std::to_string(map.brickCount) +
+                                 " bricks, more than a 4096x4096 atlas holds; raise the voxel size");
+    }
+    map.atlas.assign(static_cast<size_t>(map.atlasWidth) * map.atlasHeight, floatToHalf(farValue));
+
+    pool.parallelFor(brickCells.size(), [&](size_t slot, unsigned) {
+        const uint32_t cell = brickCells[slot];
+        const Vec3 cellOrigin = map.origin + Vec3(static_cast<float>(cell % cx),
+                                                  static_cast<float>((cell / cx) % cy),
+                                                  static_cast<float>(cell / (cx * cy))) * cellSize;
+        const size_t baseX = (slot % map.atlasColumns) * tileWidth;
+        const size_t baseY = (slot / map.atlasColumns) * N;
+        for (uint32_t z = 0; z < N; ++z) {
+            for (uint32_t y = 0; y < N; ++y) {
+                uint16_t* dst = &map.atlas[(baseY + y) * map.atlasWidth + baseX + z * N];
+                for (uint32_t x = 0; x < N; ++x) {
+                    const Vec3 p = cellOrigin + Vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * map.voxelSize;
+                    dst[x] = floatToHalf(sanitize(field(p), farValue));
+                }
+            }
+        }
+    });
+    return map;
+}
+
+float BrickMap::sample(Vec3 p) const {
+    const float cellSize = getCellSize();
+    const Vec3 boundsMax = origin + Vec3(static_cast<float>(cells[0]), static_cast<float>(cells[1]),
+                                         static_cast<float>(cells[2])) * cellSize;
+    // Outside the bounds the field is only known at the nearest point inside
+    const Vec3 q = min(max(p, origin), boundsMax);
+    const float outside = length(p - q);
+
+    Vec3 local = (q - origin) / cellSize;
+    uint32_t c[3];
+    for (int a = 0; a < 3; ++a) {
+        c[a] = std::min(static_cast<uint32_t>(std::max(local[a], 0.0f)), cells[a] - 1);
+    }
+    const uint32_t slot = indirection[(static_cast<size_t>(c[2]) * cells[1] + c[1]) * cells[0] + c[0]];
+    float f[3];
+    for (int a = 0; a < 3; ++a) {
+        f[a] = clamp(local[a] - static_cast<float>(c[a]), 0.0f, 1.0f);
+    }
+
+    float corners[8];
+    if (slot == kBrickEmpty) {
+        // Trilinear coarse values overestimate next to curved surfaces; clamp them to the
+        // Lipschitz bound of the nearest corner so sphere tracing never steps through
+        // a thin feature. All corners share a sign, as the cell holds no surface.
+        const size_t sx = cells[0] + 1, sy = cells[1] + 1;
+        float bound = 0.0f;
+        for (int i = 0; i < 8; ++i) {
+            const size_t x = c[0] + (i & 1), y = c[1] + ((i >> 1) & 1), z = c[2] + ((i >> 2) & 1);
+            corners[i] = coarse[(z * sy + y) * sx + x];
+            const Vec3 offset = Vec3(f[0] - static_cast<float>(i & 1), f[1] - static_cast<float>((i >> 1) & 1),
+                                     f[2] - static_cast<float>((i >> 2) & 1)) * cellSize;
+            bound = std::max(bound, std::fabs(corners[i]) - length(offset));
+        }
+        const float d = trilinear(corners, f[0], f[1], f[2]);
+        return withOutside(std::copysign(std::min(std::fabs(d), bound), corners[0]), outside);
+    }
+
+    // Position in voxels inside the brick, [0, kBrickCells]
+    uint32_t v[3];
+    float vf[3];
+    for (int a = 0; a < 3; ++a) {
+        const float t = f[a] * static_cast<float>(kBrickCells);
+        v[a] = std::min(static_cast<uint32_t>(t), kBrickCells - 1);
+        vf[a] = t - static_cast<float>(v[a]);
+    }
+    const size_t baseX = (slot % atlasColumns) * N * N;
+    const size_t baseY = (slot / atlasColumns) * N;
+    for (int i = 0; i < 8; ++i) {
+        const size_t x = v[0] + (i & 1), y = v[1] + ((i >> 1) & 1), z = v[2] + ((i >> 2) & 1);
+        corners[i] = halfToFloat(atlas[(baseY + y) * atlasWidth + baseX + z * N + x]);
+    }
+    return withOutside(trilinear(corners, vf[0], vf[1], vf[2]), outside);
+}
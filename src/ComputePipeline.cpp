@@ -0,0 +1,60 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : Compute pipeline factory sharing the persistent pipeline cache
+ * @FilePath     : ComputePipeline.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "ComputePipeline.hpp"
+
+#include <stdexcept>
+
+VkPipeline createComputePipeline(VkDevice device,
+                                 VkPipelineCache cache,
+                                 const ComputePipelineDesc& desc,
+                                 VkPipelineLayout* outLayout) {
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = static_cast<uint32_t>(desc.setLayouts.size());
+    layoutInfo.pSetLayouts = desc.setLayouts.data();
+    layoutInfo.pushConstantRangeCount = static_cast<uint32_t>(desc.pushConstantRanges.size());
+    layoutInfo.pPushConstantRanges = desc.pushConstantRanges.data();
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    VkComputePipelineCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    info.stage.module = desc.computeShader;
+    info.stage.pName = "main";
+    info.layout = layout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(device, cache, 1, &info, nullptr, &pipeline) != VK_SUCCESS) {
+        vkDestroyPipelineLayout(device, layout, nullptr);
+        throw std::runtime_error("failed to create compute pipeline!");
+    }
+    *outLayout = layout;
+    return pipeline;
+}
+
+void imageBarrier(VkCommandBuffer cmd, VkImage image,
+                  VkImageLayout oldLayout, VkImageLayout newLayout,
+                  VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                  VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
@@ -0,0 +1,1593 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Multithreaded CPU port of the Cornell scene shaders (reference renderer)
+ * @FilePath     : CpuCornellRenderer.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "CpuCornellRenderer.hpp"
+#include "FrameStats.hpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#if __has_include(<stb_image.h>)
+#include <stb_image.h> // implementation is compiled into EasyVulkan
+#define SDF_HAS_STB_IMAGE 1
+#endif
+
+using namespace sdf;
+
+namespace {
+
+constexpr float PI = 3.14159265359f;
+constexpr float MAX_DIST = packet_march::MAX_DIST;
+constexpr uint32_t kTileSize = 16;
+constexpr float kIndirectUpsamplePlaneScale = 0.05f; // sdf_practice.frag INDIRECT_UPSAMPLE_PLANE_SCALE
+// sdf_practice.frag RESTIR_*
+constexpr float kRestirTemporalMCap = 20.0f;
+constexpr float kRestirSpatialRadius = 12.0f;
+constexpr float kRestirNormalThreshold = 0.9f;
+constexpr float kRestirDepthThreshold = 0.1f;
+
+inline Vec3 xyz(const float v[4]) { return {v[0], v[1], v[2]}; }
+
+// rsm_pyramid.glsl rsmLuminance(): the weight the pyramid samples VPLs by
+float rsmLuminance(Vec3 flux) { return dot(flux, Vec3(0.2126f, 0.7152f, 0.0722f)); }
+
+// rsm_pyramid.glsl pcgHash() / rsmSampleOffset(): per-pixel start of the stratified VPL samples,
+// pcgHash() also picks the sample an empty VPL cluster restarts on
+uint32_t pcgHash(uint32_t v) {
+    uint32_t state = v * 747796405u + 2891336453u;
+    uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float rsmSampleOffset(uint32_t x, uint32_t y) {
+    return static_cast<float>(pcgHash(x + 65536u * y) >> 8) * (1.0f / 16777216.0f);
+}
+
+#if defined(SDF_HAS_STB_IMAGE)
+float srgbToLinear(float c) {
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+#endif
+
+uint8_t linearToSrgb8(float c) {
+    if (!(c > 0.0f)) {
+        return 0; // also catches NaN
+    }
+    c = std::min(c, 1.0f);
+    float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(std::lround(s * 255.0f));
+}
+
+// sdf_practice.frag RSM_*_OFFSETS: the fixed patterns of the local VPL gathers
+constexpr Vec2 kRSMUniformOffsets[32] = {
+    {0.0f, 0.0f},
+    {0.3f, 0.0f}, {-0.3f, 0.0f}, {0.0f, 0.3f}, {0.0f, -0.3f},
+    {0.2f, 0.2f}, {-0.2f, 0.2f}, {0.2f, -0.2f}, {-0.2f, -0.2f},
+    {0.6f, 0.0f}, {-0.6f, 0.0f}, {0.0f, 0.6f}, {0.0f, -0.6f},
+    {0.45f, 0.45f}, {-0.45f, 0.45f}, {0.45f, -0.45f}, {-0.45f, -0.45f},
+    {1.0f, 0.0f}, {-1.0f, 0.0f}, {0.0f, 1.0f}, {0.0f, -1.0f},
+    {0.7f, 0.7f}, {-0.7f, 0.7f}, {0.7f, -0.7f}, {-0.7f, -0.7f},
+    {0.5f, 0.2f}, {-0.5f, 0.2f}, {0.2f, 0.5f}, {-0.2f, 0.5f},
+    {0.8f, 0.3f}, {-0.8f, -0.3f}, {0.3f, -0.8f}};
+constexpr Vec2 kRSMCoarseOffsets[8] = {
+    {0.0f, 0.0f}, {1.0f, 0.0f}, {-1.0f, 0.0f}, {0.0f, 1.0f},
+    {0.0f, -1.0f}, {0.7f, 0.7f}, {-0.7f, 0.7f}, {0.7f, -0.7f}};
+constexpr Vec2 kRSMDenseOffsets[20] = {
+    {0.0f, 0.0f}, {0.3f, 0.0f}, {-0.3f, 0.0f}, {0.0f, 0.3f}, {0.0f, -0.3f},
+    {0.2f, 0.2f}, {-0.2f, 0.2f}, {0.2f, -0.2f}, {-0.2f, -0.2f},
+    {0.5f, 0.0f}, {-0.5f, 0.0f}, {0.0f, 0.5f}, {0.0f, -0.5f},
+    {0.4f, 0.4f}, {-0.4f, 0.4f}, {0.4f, -0.4f}, {-0.4f, -0.4f},
+    {0.6f, 0.2f}, {-0.6f, -0.2f}, {0.2f, -0.6f}};
+constexpr Vec2 kRSMCoverageOffsets[4] = {{-0.7f, -0.7f}, {0.8f, 0.3f}, {-0.3f, 0.8f}, {0.9f, -0.4f}};
+
+/* -------------------------------------------------------------------------- */
+/*                      Camera (cornell_camera.glsl)                          */
+/* -------------------------------------------------------------------------- */
+constexpr Vec3 kCameraOrigin{0.0f, 0.0f, 5.0f};
+constexpr float kCameraFocal = 1.2f;
+
+void cameraBasis(Vec3& cu, Vec3& cv, Vec3& cw) {
+    const Vec3 target(0.0f, 0.0f, 0.0f);
+    const Vec3 up(0.0f, 1.0f, 0.0f);
+    cw = normalize(target - kCameraOrigin);
+    cu = normalize(cross(cw, up));
+    cv = normalize(cross(cu, cw));
+}
+
+// Ray direction through fragTexCoord; aspect is width / height
+Vec3 cameraRay(Vec2 texCoord, float aspect) {
+    Vec2 uv = (texCoord - Vec2(0.5f)) * 2.0f;
+    uv.x *= aspect;
+    Vec3 cu, cv, cw;
+    cameraBasis(cu, cv, cw);
+    return normalize(cu * uv.x + cv * uv.y + cw * kCameraFocal);
+}
+
+// fragTexCoord a point in front of the camera is seen at
+Vec2 cameraProject(Vec3 p, float aspect) {
+    Vec3 cu, cv, cw;
+    cameraBasis(cu, cv, cw);
+    const Vec3 v = p - kCameraOrigin;
+    Vec2 uv = Vec2(dot(v, cu), dot(v, cv)) * (kCameraFocal / dot(v, cw));
+    uv.x /= aspect;
+    return uv * 0.5f + Vec2(0.5f);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                       Scene (shared by both shaders)                       */
+/* -------------------------------------------------------------------------- */
+struct Scene {
+    const SDFCornellUniforms& u;
+    // Per-frame values precomputed by makeCornellUniforms()
+    Vec3 sphere1Pos;
+    Vec3 sphere2Pos;
+    float sphere1Radius;
+    float sphere2Radius;
+    Mat3 rotation;
+
+    explicit Scene(const SDFCornellUniforms& uniforms) : u(uniforms) {
+        sphere1Pos = xyz(u.sphereCenters[0]);
+        sphere2Pos = xyz(u.sphereCenters[1]);
+        sphere1Radius = u.sphereCenters[0][3];
+        sphere2Radius = u.sphereCenters[1][3];
+        const float (&r)[3][4] = u.sphereLocalRotation;
+        rotation = Mat3(r[0][0], r[0][1], r[0][2], r[1][0], r[1][1], r[1][2], r[2][0], r[2][1], r[2][2]);
+    }
+
+    static float sphereSDF(Vec3 p, float r) { return length(p) - r; }
+
+    struct Distances {
+        float sphere1, sphere2;
+        float ground, leftWall, rightWall, backWall, ceiling;
+        float spheres() const { return std::min(sphere1, sphere2); }
+        float walls() const {
+            return std::min(std::min(std::min(leftWall, rightWall), std::min(backWall, ceiling)), ground);
+        }
+    };
+
+    Distances distances(Vec3 p) const {
+        Distances d;
+        // The local rotation cannot change |p - c|, so the shaders skip it here
+        d.sphere1 = sphereSDF(p - sphere1Pos, sphere1Radius);
+        d.sphere2 = sphereSDF(p - sphere2Pos, sphere2Radius);
+        d.ground = p.y + 4.5f;
+        d.leftWall = p.x + 5.0f;
+        d.rightWall = -p.x + 5.0f;
+        d.backWall = p.z + 2.0f;
+        d.ceiling = -p.y + 4.5f;
+        return d;
+    }
+
+    float sceneSDF(Vec3 p) const {
+        Distances d = distances(p);
+        return std::min(d.spheres(), d.walls());
+    }
+
+    // sdf_practice.frag getMaterial()
+    int getMaterial(Vec3 p) const {
+        Distances d = distances(p);
+        if (d.spheres() < d.walls()) {
+            return d.sphere1 <= d.sphere2 ? 1 : 7;
+        }
+        float minDist = std::min(std::min(std::min(std::min(d.ground, d.leftWall), d.rightWall), d.backWall), d.ceiling);
+        if (d.ground == minDist) return 2;
+        if (d.ceiling == minDist) return 3;
+        if (d.leftWall == minDist) return 4;
+        if (d.rightWall == minDist) return 5;
+        if (d.backWall == minDist) return 6;
+        return 2;
+    }
+
+    // rsm_light.frag getMaterialAlbedo()
+    Vec3 getRSMAlbedo(Vec3 p) const {
+        Distances d = distances(p);
+        if (d.spheres() < d.walls()) {
+            return xyz(u.sphereColor);
+        }
+        float minDist = std::min(std::min(std::min(std::min(d.ground, d.leftWall), d.rightWall), d.backWall), d.ceiling);
+        if (d.ground == minDist) return {0.3f, 0.4f, 0.6f};
+        if (d.ceiling == minDist) return {0.7f, 0.8f, 0.9f};
+        if (d.leftWall == minDist) return {0.4f, 0.7f, 0.5f};
+        if (d.rightWall == minDist) return {0.7f, 0.4f, 0.4f};
+        if (d.backWall == minDist) return {0.6f, 0.4f, 0.7f};
+        return Vec3(0.8f);
+    }
+
+    Vec3 getNormal(Vec3 p) const {
+        const float h = 0.001f;
+        const Vec3 xyy(1, -1, -1), yyx(-1, -1, 1), yxy(-1, 1, -1), xxx(1, 1, 1);
+        return normalize(xyy * sceneSDF(p + xyy * h) +
+                         yyx * sceneSDF(p + yyx * h) +
+                         yxy * sceneSDF(p + yxy * h) +
+                         xxx * sceneSDF(p + xxx * h));
+    }
+
+    float softShadow(Vec3 ro, Vec3 rd, float mint, float maxt, float k) const {
+        float res = 1.0f;
+        float t = mint;
+        for (int i = 0; i < 64; i++) {
+            float h = sceneSDF(ro + rd * t);
+            if (h < 0.0008f) return 0.0f;
+            res = std::min(res, k * h / t);
+            t += clamp(h, 0.002f, 0.05f);
+            if (res < 0.004f || t > maxt) break;
+        }
+        return clamp(res, 0.0f, 1.0f);
+    }
+
+    Vec3 sphere1Local(Vec3 p) const { return rotation * (p - sphere1Pos); }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                         sdf_practice.frag lighting                         */
+/* -------------------------------------------------------------------------- */
+struct Shading {
+    const Scene& scene;
+    const SDFCornellUniforms& u;
+    const CpuTexture& rsmPosition;
+    const CpuTexture& rsmNormal;
+    const CpuTexture& rsmFlux;
+    const CpuRSMPyramid& rsmPyramid;
+    const CpuVplClusters& vplClusters;
+    const CpuTexture& flower;
+    const CpuTexture& indirectPass;          // irradiance without albedo per pass texel, resolved when temporal
+    const std::vector<float>& indirectDepth; // hit distance per pass texel
+    std::vector<GpuRestirReservoir>& restirReservoirs;      // this frame's, one per pass texel
+    const std::vector<GpuRestirReservoir>& restirPrevious;  // the last frame's
+    const float (&restirPrevSphereCenters)[2][4];           // sphere centres when those were written
+
+    Vec2 rsmUV(Vec3 p) const {
+        Vec3 rel = p - xyz(u.lightOrigin);
+        Vec2 base(dot(rel, xyz(u.lightRight)) / std::max(u.lightOrthoHalfSize[0], 1e-4f),
+                  dot(rel, xyz(u.lightUp)) / std::max(u.lightOrthoHalfSize[1], 1e-4f));
+        return base * 0.5f + Vec2(0.5f);
+    }
+
+    Vec2 rsmTexelScale() const {
+        return Vec2(u.rsmResolution[2], u.rsmResolution[3]);
+    }
+
+    float rsmShadow(Vec3 p, Vec3 n) const {
+        Vec2 uv = rsmUV(p);
+        if (uv.x < 0.0f || uv.y < 0.0f || uv.x > 1.0f || uv.y > 1.0f) {
+            return 1.0f;
+        }
+        Vec3 Ld = normalize(xyz(u.lightDir));
+        float tSurface = dot(p - xyz(u.lightOrigin), Ld);
+        float slope = 1.0f - std::max(dot(n, Ld), 0.0f);
+        Vec2 texel = rsmTexelScale();
+        float radius = std::max(u.rsmParams[0], 0.5f);
+        static const Vec2 offs[8] = {
+            {0.0f, 0.0f}, {1.0f, 0.0f}, {-1.0f, 0.0f}, {0.0f, 1.0f},
+            {0.7f, 0.7f}, {-0.7f, 0.7f}, {0.7f, -0.7f}, {-0.7f, -0.7f}};
+        float sum = 0.0f;
+        for (int i = 0; i < 8; ++i) {
+            Vec2 duv = offs[i] * radius * texel;
+            Vec3 vplPos = rsmPosition.sampleClamp(clamp(uv + duv, 0.0f, 1.0f));
+            float tRsm = dot(vplPos - xyz(u.lightOrigin), Ld);
+            float bias = 0.02f + 0.10f * slope;
+            sum += (tRsm + bias < tSurface) ? 0.0f : 1.0f;
+        }
+        return sum / 8.0f;
+    }
+
+    // The VPL term shared by every gather loop of the shader
+    void gatherVPL(Vec3 p, Vec3 n, Vec3 albedo, int matId, Vec2 uv, Vec3& bounce, int& valid) const {
+        Vec3 vplPos = rsmPosition.sampleClamp(uv);
+        Vec3 vplNor = normalize(rsmNormal.sampleClamp(uv));
+        Vec3 flux = rsmFlux.sampleClamp(uv);
+        if (length(vplPos) < 0.1f) return;
+        Vec3 wi = vplPos - p;
+        float dist = length(wi);
+        if (dist < 0.05f) return;
+        wi = normalize(wi);
+        float cos1 = std::max(dot(n, wi), 0.0f);
+        float cos2 = std::max(dot(vplNor, -wi), 0.0f);
+        if (cos1 < 0.05f || cos2 < 0.05f) return;
+
+        float enhancedFalloff = 1.0f / std::max(dist * dist + 0.5f, 1e-3f);
+        Vec3 brdf = albedo / 3.14159f;
+        float normalConsistency = dot(normalize(n), normalize(vplNor));
+        float geometricDamping = 1.0f;
+        if (std::abs(normalConsistency) > 0.8f) {
+            geometricDamping *= 0.3f;
+        } else if (std::abs(normalConsistency) > 0.6f) {
+            geometricDamping *= 0.6f;
+        }
+        float materialBoost = (matId == 1 || matId == 7) ? 2.0f : 0.7f;
+        bounce += brdf * flux * (cos1 * cos2) * enhancedFalloff * materialBoost * geometricDamping;
+        valid++;
+    }
+
+    // vplContribution(): the same term for one RSM texel, zero where gatherVPL() skips it
+    Vec3 vplContribution(Vec3 p, Vec3 n, Vec3 albedo, int matId, Vec3 vplPos, Vec3 vplNor, Vec3 flux) const {
+        Vec3 bounce(0.0f);
+        if (length(vplPos) < 0.1f) return bounce;
+        Vec3 wi = vplPos - p;
+        float dist = length(wi);
+        if (dist < 0.05f) return bounce;
+        wi = normalize(wi);
+        vplNor = normalize(vplNor);
+        float cos1 = std::max(dot(n, wi), 0.0f);
+        float cos2 = std::max(dot(vplNor, -wi), 0.0f);
+        if (cos1 < 0.05f || cos2 < 0.05f) return bounce;
+
+        float enhancedFalloff = 1.0f / std::max(dist * dist + 0.5f, 1e-3f);
+        Vec3 brdf = albedo / 3.14159f;
+        float normalConsistency = dot(normalize(n), vplNor);
+        float geometricDamping = 1.0f;
+        if (std::abs(normalConsistency) > 0.8f) {
+            geometricDamping *= 0.3f;
+        } else if (std::abs(normalConsistency) > 0.6f) {
+            geometricDamping *= 0.6f;
+        }
+        float materialBoost = (matId == 1 || matId == 7) ? 2.0f : 0.7f;
+        return brdf * flux * (cos1 * cos2) * enhancedFalloff * materialBoost * geometricDamping;
+    }
+
+    // clusterCanLight(): false only if no VPL of the cluster can light p
+    static bool clusterCanLight(Vec3 p, Vec3 n, const CpuRSMPyramid::Cluster& cluster) {
+        if (cluster.radius < 0.0f) return false;
+        Vec3 d = p - cluster.center;
+        // Every VPL lies below the tangent plane of p
+        if (dot(n, -d) + cluster.radius <= 0.0f) return false;
+        float dist = length(d);
+        if (dist <= cluster.radius) return true;
+        // Every VPL normal points away from p
+        float angle = std::acos(clamp(dot(cluster.axis, d / dist), -1.0f, 1.0f));
+        float spread = std::acos(clamp(cluster.cosAngle, -1.0f, 1.0f)) + std::asin(cluster.radius / dist);
+        return angle - spread < 0.5f * PI;
+    }
+
+    // sampleVpl(): walk the flux pyramid from the root, picking a child in proportion
+    // to its flux, until an RSM texel is reached. pdf is the texel's probability.
+    bool sampleVpl(Vec3 p, Vec3 n, float xi, uint32_t& texelX, uint32_t& texelY, float& pdf) const {
+        const RSMPyramidLayout& layout = rsmPyramid.layout;
+        uint32_t x = 0, y = 0;
+        pdf = 1.0f;
+        for (int level = static_cast<int>(layout.levelCount) - 1; level >= 0; --level) {
+            // Children in (0,0) (1,0) (0,1) (1,1) order: nodes of level - 1, RSM texels below level 0
+            float w[4];
+            for (uint32_t i = 0; i < 4; ++i) {
+                uint32_t cx = 2 * x + (i & 1), cy = 2 * y + (i >> 1);
+                w[i] = level > 0 ? rsmPyramid.node(static_cast<uint32_t>(level - 1), cx, cy)
+                                 : rsmLuminance(rsmFlux.at(cx, cy));
+            }
+            float total = (w[0] + w[1]) + (w[2] + w[3]);
+            if (!(total > 0.0f)) return false;
+            xi *= total;
+            uint32_t pick = 0;
+            for (; pick < 3; ++pick) {
+                if (xi < w[pick]) break;
+                xi -= w[pick];
+            }
+            if (!(w[pick] > 0.0f)) return false;
+            xi = std::min(xi / w[pick], 0.99999994f);
+            pdf *= w[pick] / total;
+            x = 2 * x + (pick & 1);
+            y = 2 * y + (pick >> 1);
+            if (level - 1 == static_cast<int>(RSMPyramidLayout::kClusterLevel) &&
+                !clusterCanLight(p, n, rsmPyramid.cluster(x, y))) {
+                return false;
+            }
+        }
+        texelX = x;
+        texelY = y;
+        return true;
+    }
+
+    // hierarchicalIndirect(): unbiased estimate of the sum over every RSM texel,
+    // each VPL standing for the area one texel covers on the light's image plane
+    Vec3 hierarchicalIndirect(Vec3 p, Vec3 n, Vec3 albedo, int matId, Vec2 fragCoord) const {
+        if (rsmPyramid.layout.levelCount == 0) {
+            return Vec3(0.0f);
+        }
+        const int samples = std::clamp(static_cast<int>(u.indirectParams[1]), 1, 16);
+        const float offset = rsmSampleOffset(static_cast<uint32_t>(fragCoord.x), static_cast<uint32_t>(fragCoord.y));
+        const float texelArea = 4.0f * u.lightOrthoHalfSize[0] * u.lightOrthoHalfSize[1] *
+                                u.rsmResolution[2] * u.rsmResolution[3];
+        Vec3 sum(0.0f);
+        for (int k = 0; k < samples; ++k) {
+            uint32_t tx, ty;
+            float pdf;
+            if (sampleVpl(p, n, (static_cast<float>(k) + offset) / static_cast<float>(samples), tx, ty, pdf)) {
+                sum += vplContribution(p, n, albedo, matId, rsmPosition.at(tx, ty), rsmNormal.at(tx, ty),
+                                       rsmFlux.at(tx, ty)) / pdf;
+            }
+        }
+        return sum * (u.indirectParams[0] * texelArea / static_cast<float>(samples));
+    }
+
+    // clusteredIndirect(): every clustered VPL, carrying the summed flux of its member texels
+    Vec3 clusteredIndirect(Vec3 p, Vec3 n, Vec3 albedo, int matId) const {
+        const size_t count = std::min(static_cast<size_t>(std::max(u.indirectParams[2], 0.0f)), vplClusters.clusters.size());
+        const float texelArea = 4.0f * u.lightOrthoHalfSize[0] * u.lightOrthoHalfSize[1] *
+                                u.rsmResolution[2] * u.rsmResolution[3];
+        Vec3 sum(0.0f);
+        for (size_t i = 0; i < count; ++i) {
+            const CpuVplClusters::Cluster& vpl = vplClusters.clusters[i];
+            if (vpl.members > 0.0f) {
+                sum += vplContribution(p, n, albedo, matId, vpl.position, vpl.normal, vpl.flux);
+            }
+        }
+        return sum * (u.indirectParams[0] * texelArea);
+    }
+
+    // rsmImportanceRegion(): importance sampling phase 1, the coarse offset whose VPL faces p the most
+    Vec2 importanceRegion(Vec3 p, Vec3 n, Vec2 baseUV, float radius) const {
+        Vec2 texel = rsmTexelScale();
+        float maxImportance = 0.0f;
+        Vec2 bestRegion(0.0f);
+        for (int i = 0; i < 8; ++i) {
+            Vec2 duv = kRSMCoarseOffsets[i] * radius * 0.5f * texel;
+            Vec2 uv = clamp(baseUV + duv, 0.0f, 1.0f);
+            Vec3 vplPos = rsmPosition.sampleClamp(uv);
+            Vec3 vplNor = rsmNormal.sampleClamp(uv);
+            Vec3 flux = rsmFlux.sampleClamp(uv);
+            if (length(vplPos) < 0.1f) continue;
+            Vec3 wi = normalize(vplPos - p);
+            float importance = std::max(dot(n, wi), 0.0f) * std::max(dot(vplNor, -wi), 0.0f) * length(flux);
+            if (importance > maxImportance) {
+                maxImportance = importance;
+                bestRegion = duv;
+            }
+        }
+        return bestRegion;
+    }
+
+    // temporalIndirectTaps(): this frame's indirectParams[3] taps of the active gather
+    // for pixel (x, y), with a white albedo
+    Vec3 temporalIndirectTaps(Vec3 p, Vec3 n, int matId, uint32_t x, uint32_t y) const {
+        const int taps = std::clamp(static_cast<int>(u.indirectParams[3]), 1, 16);
+        const float offset = rsmSampleOffset(x, y);
+        const Vec3 white(1.0f);
+        if (u.debugParams[3] > 0.5f) {
+            if (rsmPyramid.layout.levelCount == 0) {
+                return Vec3(0.0f);
+            }
+            const float shift = fract(offset + static_cast<float>(u.iFrame) * 0.618034f);
+            const float texelArea = 4.0f * u.lightOrthoHalfSize[0] * u.lightOrthoHalfSize[1] *
+                                    u.rsmResolution[2] * u.rsmResolution[3];
+            Vec3 sum(0.0f);
+            for (int k = 0; k < taps; ++k) {
+                uint32_t tx, ty;
+                float pdf;
+                if (sampleVpl(p, n, (static_cast<float>(k) + shift) / static_cast<float>(taps), tx, ty, pdf)) {
+                    sum += vplContribution(p, n, white, matId, rsmPosition.at(tx, ty), rsmNormal.at(tx, ty),
+                                           rsmFlux.at(tx, ty)) / pdf;
+                }
+            }
+            return sum * (u.indirectParams[0] * texelArea / static_cast<float>(taps));
+        }
+
+        const float radius = std::max(u.rsmParams[0], 1.0f);
+        const Vec2 baseUV = rsmUV(p);
+        const Vec2 texel = rsmTexelScale();
+        Vec3 bounce(0.0f);
+        int valid = 0;
+        if (u.debugParams[1] > 0.5f) {
+            const Vec2 bestRegion = importanceRegion(p, n, baseUV, radius);
+            const int count = 24; // dense, then coverage
+            const int first = static_cast<int>(offset * static_cast<float>(count)) + u.iFrame * taps;
+            for (int k = 0; k < std::min(taps, count); ++k) {
+                const int i = (first + k) % count;
+                Vec2 duv = i < 20 ? bestRegion + kRSMDenseOffsets[i] * 0.3f * radius * texel
+                                  : kRSMCoverageOffsets[i - 20] * radius * texel;
+                gatherVPL(p, n, white, matId, clamp(baseUV + duv, 0.0f, 1.0f), bounce, valid);
+            }
+        } else {
+            const int count = std::min(static_cast<int>(std::max(u.rsmParams[1], 1.0f)), 32);
+            const int first = static_cast<int>(offset * static_cast<float>(count)) + u.iFrame * taps;
+            for (int k = 0; k < std::min(taps, count); ++k) {
+                const int i = (first + k) % count;
+                Vec2 xz(p.x + static_cast<float>(i), p.z + static_cast<float>(i));
+                float random = fract(std::sin(dot(xz, Vec2(12.9898f, 78.233f))) * 43758.5453f);
+                Vec2 jitter = Vec2(fract(random * 43758.5453f), fract(random * 23421.6319f)) * 2.0f - Vec2(1.0f);
+                Vec2 duv = (kRSMUniformOffsets[i] + jitter * 0.05f) * radius * texel;
+                gatherVPL(p, n, white, matId, clamp(baseUV + duv, 0.0f, 1.0f), bounce, valid);
+            }
+        }
+        return valid > 0 ? u.indirectParams[0] * (bounce / static_cast<float>(valid)) : Vec3(0.0f);
+    }
+
+    // upsampleIndirect(): the 2x2 pass texels around the pixel, weighted by bilinear
+    // weights, material and distance to the plane through p
+    bool upsampleIndirect(Vec3 p, Vec3 n, int matId, Vec2 fragCoord, Vec3& irradiance) const {
+        const int width = static_cast<int>(indirectPass.getWidth());
+        const int height = static_cast<int>(indirectPass.getHeight());
+        const Vec2 fragTexCoord(fragCoord.x / u.iResolution[0], fragCoord.y / u.iResolution[1]);
+        const Vec2 pos(fragTexCoord.x * width - 0.5f, fragTexCoord.y * height - 0.5f);
+        const int baseX = static_cast<int>(std::floor(pos.x));
+        const int baseY = static_cast<int>(std::floor(pos.y));
+        const Vec2 f(pos.x - baseX, pos.y - baseY);
+        const float aspect = u.iResolution[0] / u.iResolution[1];
+        Vec3 sum(0.0f);
+        float weightSum = 0.0f;
+        for (int k = 0; k < 4; ++k) {
+            const int cx = k & 1, cy = k >> 1;
+            const int tx = std::clamp(baseX + cx, 0, width - 1);
+            const int ty = std::clamp(baseY + cy, 0, height - 1);
+            const float d = indirectDepth[static_cast<size_t>(ty) * width + tx];
+            if (d >= MAX_DIST) continue;
+            const Vec2 texCoord((tx + 0.5f) / width, (ty + 0.5f) / height);
+            const Vec3 q = kCameraOrigin + cameraRay(texCoord, aspect) * d;
+            if (scene.getMaterial(q) != matId) continue;
+            const float bilinear = (cx ? f.x : 1.0f - f.x) * (cy ? f.y : 1.0f - f.y);
+            const float w = bilinear * std::exp(-std::abs(dot(n, q - p)) / kIndirectUpsamplePlaneScale);
+            sum += indirectPass.at(tx, ty) * w;
+            weightSum += w;
+        }
+        if (weightSum < 1e-4f) {
+            return false;
+        }
+        irradiance = sum / weightSum;
+        return true;
+    }
+
+    // indirectPassSize(): getCornellIndirectSize() of the target
+    void indirectPassSize(uint32_t& width, uint32_t& height) const {
+        const uint32_t divisor = clampCornellIndirectDivisor(static_cast<int>(u.pbrParams[3]));
+        width = getCornellIndirectSize(static_cast<uint32_t>(u.iResolution[0]), divisor);
+        height = getCornellIndirectSize(static_cast<uint32_t>(u.iResolution[1]), divisor);
+    }
+
+    static float restirRandom(uint32_t& state) {
+        state = pcgHash(state);
+        return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // restirTarget(): luminance of the contribution of RSM texel `index`
+    float restirTarget(Vec3 p, Vec3 n, int matId, uint32_t index) const {
+        const uint32_t rsmSize = rsmFlux.getWidth();
+        if (index >= rsmSize * rsmSize) return 0.0f;
+        const uint32_t tx = index % rsmSize, ty = index / rsmSize;
+        return rsmLuminance(vplContribution(p, n, Vec3(1.0f), matId, rsmPosition.at(tx, ty), rsmNormal.at(tx, ty),
+                                            rsmFlux.at(tx, ty)));
+    }
+
+    static bool restirSurfaceMatches(const GpuRestirReservoir& r, Vec3 n, float d) {
+        return r.surface[3] > 0.0f && dot(Vec3(r.surface[0], r.surface[1], r.surface[2]), n) > kRestirNormalThreshold &&
+               std::abs(r.surface[3] - d) < kRestirDepthThreshold * d;
+    }
+
+    static void restirUpdate(GpuRestirReservoir& r, float& weightSum, float& selectedTarget, uint32_t index, float w,
+                             float pHat, float count, uint32_t& rng) {
+        weightSum += w;
+        r.count += count;
+        if (w > 0.0f && restirRandom(rng) * weightSum < w) {
+            r.texel = index;
+            selectedTarget = pHat;
+        }
+    }
+
+    static void restirFinish(GpuRestirReservoir& r, float weightSum, float selectedTarget) {
+        r.weight = selectedTarget > 0.0f ? weightSum / (r.count * selectedTarget) : 0.0f;
+    }
+
+    static GpuRestirReservoir restirEmpty(Vec3 n, float d) {
+        return GpuRestirReservoir{{n.x, n.y, n.z, d}, 0u, 0.0f, 0.0f, 0.0f};
+    }
+
+    // restirInitialAndTemporal(): the INDIRECT_PASS half, stored for pass texel (x, y)
+    void restirInitialAndTemporal(Vec3 p, Vec3 n, int matId, float d, uint32_t x, uint32_t y) const {
+        uint32_t width, height;
+        indirectPassSize(width, height);
+        uint32_t rng = pcgHash(x + 65536u * y) ^ pcgHash(static_cast<uint32_t>(u.iFrame));
+        GpuRestirReservoir r = restirEmpty(n, d);
+        float weightSum = 0.0f;
+        float selectedTarget = 0.0f;
+        const uint32_t rsmSize = rsmFlux.getWidth();
+        const int candidates = std::clamp(static_cast<int>(u.restirParams[0]), 1, 32);
+        const float offset = restirRandom(rng);
+        for (int k = 0; k < candidates; ++k) {
+            uint32_t tx, ty;
+            float pdf;
+            // A candidate the pyramid walk rejects has no contribution but still counts
+            float pHat = 0.0f, w = 0.0f;
+            uint32_t index = 0;
+            if (rsmPyramid.layout.levelCount > 0 &&
+                sampleVpl(p, n, (static_cast<float>(k) + offset) / static_cast<float>(candidates), tx, ty, pdf)) {
+                index = ty * rsmSize + tx;
+                pHat = restirTarget(p, n, matId, index);
+                w = pHat / pdf;
+            }
+            restirUpdate(r, weightSum, selectedTarget, index, w, pHat, 1.0f, rng);
+        }
+
+        // The last frame's reservoir where p was then, the camera being fixed
+        Vec3 prevP = p;
+        for (int i = 0; i < 2; ++i) {
+            const Vec3 center = xyz(u.sphereCenters[i]);
+            if (length(p - center) < u.sphereCenters[i][3] + 0.05f) {
+                prevP += xyz(restirPrevSphereCenters[i]) - center;
+                break;
+            }
+        }
+        const Vec2 prevTexCoord = cameraProject(prevP, u.iResolution[0] / u.iResolution[1]);
+        const int px = static_cast<int>(std::floor(prevTexCoord.x * width));
+        const int py = static_cast<int>(std::floor(prevTexCoord.y * height));
+        if (px >= 0 && py >= 0 && px < static_cast<int>(width) && py < static_cast<int>(height)) {
+            const GpuRestirReservoir& prev = restirPrevious[static_cast<size_t>(py) * width + px];
+            if (restirSurfaceMatches(prev, n, length(prevP - kCameraOrigin))) {
+                const float count = std::min(prev.count, kRestirTemporalMCap * static_cast<float>(candidates));
+                const float pHat = restirTarget(p, n, matId, prev.texel);
+                restirUpdate(r, weightSum, selectedTarget, prev.texel, pHat * prev.weight * count, pHat, count, rng);
+            }
+        }
+        restirFinish(r, weightSum, selectedTarget);
+        restirReservoirs[static_cast<size_t>(y) * width + x] = r;
+    }
+
+    // restirIndirect(): spatial reuse over this frame's reservoirs, then one shading evaluation
+    bool restirIndirect(Vec3 p, Vec3 n, Vec3 albedo, int matId, Vec2 fragCoord, Vec3& radiance) const {
+        uint32_t width, height;
+        indirectPassSize(width, height);
+        const Vec2 fragTexCoord(fragCoord.x / u.iResolution[0], fragCoord.y / u.iResolution[1]);
+        const int cx = std::clamp(static_cast<int>(fragTexCoord.x * width), 0, static_cast<int>(width) - 1);
+        const int cy = std::clamp(static_cast<int>(fragTexCoord.y * height), 0, static_cast<int>(height) - 1);
+        const uint32_t pixelX = static_cast<uint32_t>(fragCoord.x), pixelY = static_cast<uint32_t>(fragCoord.y);
+        uint32_t rng = pcgHash(pixelX + 65536u * pixelY) ^ pcgHash(static_cast<uint32_t>(u.iFrame) + 0x9e3779b9u);
+        const float d = length(p - kCameraOrigin);
+        GpuRestirReservoir r = restirEmpty(n, d);
+        float weightSum = 0.0f;
+        float selectedTarget = 0.0f;
+        const int neighbours = std::clamp(static_cast<int>(u.restirParams[1]), 0, 8);
+        for (int i = 0; i <= neighbours; ++i) {
+            int tx = cx, ty = cy;
+            if (i > 0) {
+                const float angle = 2.0f * PI * restirRandom(rng);
+                const float radius = kRestirSpatialRadius * std::sqrt(restirRandom(rng));
+                tx = std::clamp(cx + static_cast<int>(std::round(radius * std::cos(angle))), 0, static_cast<int>(width) - 1);
+                ty = std::clamp(cy + static_cast<int>(std::round(radius * std::sin(angle))), 0, static_cast<int>(height) - 1);
+            }
+            const GpuRestirReservoir& other = restirReservoirs[static_cast<size_t>(ty) * width + tx];
+            if (!restirSurfaceMatches(other, n, d)) continue;
+            const float pHat = restirTarget(p, n, matId, other.texel);
+            restirUpdate(r, weightSum, selectedTarget, other.texel, pHat * other.weight * other.count, pHat, other.count, rng);
+        }
+        if (!(r.count > 0.0f)) {
+            return false;
+        }
+        restirFinish(r, weightSum, selectedTarget);
+        radiance = Vec3(0.0f);
+        if (r.weight > 0.0f) {
+            const uint32_t rsmSize = rsmFlux.getWidth();
+            const uint32_t tx = r.texel % rsmSize, ty = r.texel / rsmSize;
+            const float texelArea = 4.0f * u.lightOrthoHalfSize[0] * u.lightOrthoHalfSize[1] *
+                                    u.rsmResolution[2] * u.rsmResolution[3];
+            radiance = vplContribution(p, n, albedo, matId, rsmPosition.at(tx, ty), rsmNormal.at(tx, ty), rsmFlux.at(tx, ty)) *
+                       (r.weight * u.indirectParams[0] * texelArea);
+        }
+        return true;
+    }
+
+    // indirectLighting(): resampled or upsampled, else accumulated at this pixel, else gathered in place
+    Vec3 indirect(Vec3 p, Vec3 n, Vec3 albedo, int matId, Vec2 fragCoord) const {
+        if (u.restirParams[0] > 0.5f) {
+            Vec3 radiance;
+            if (restirIndirect(p, n, albedo, matId, fragCoord, radiance)) {
+                return radiance;
+            }
+        } else if (u.pbrParams[3] > 1.5f) {
+            Vec3 irradiance;
+            if (upsampleIndirect(p, n, matId, fragCoord, irradiance)) {
+                return albedo * irradiance;
+            }
+        } else if (u.indirectParams[3] > 0.5f) {
+            return albedo * indirectPass.at(static_cast<uint32_t>(fragCoord.x), static_cast<uint32_t>(fragCoord.y));
+        }
+        return gatherIndirect(p, n, albedo, matId, fragCoord);
+    }
+
+    // gatherIndirect(): clustered, hierarchical or the local gather around p's RSM texel
+    Vec3 gatherIndirect(Vec3 p, Vec3 n, Vec3 albedo, int matId, Vec2 fragCoord) const {
+        if (u.indirectParams[2] > 0.5f) {
+            return clusteredIndirect(p, n, albedo, matId);
+        }
+        if (u.debugParams[3] > 0.5f) {
+            return hierarchicalIndirect(p, n, albedo, matId, fragCoord);
+        }
+        float radius = std::max(u.rsmParams[0], 1.0f);
+        int samples = static_cast<int>(std::max(u.rsmParams[1], 1.0f));
+        Vec2 baseUV = rsmUV(p);
+        Vec2 texel = rsmTexelScale();
+        Vec3 bounce(0.0f);
+        int valid = 0;
+
+        if (u.debugParams[1] > 0.5f) {
+            // Phase 1: coarse search for the most important direction
+            Vec2 bestRegion = importanceRegion(p, n, baseUV, radius);
+            // Phase 2: dense samples around the best region
+            for (int i = 0; i < 20; ++i) {
+                Vec2 localOffset = kRSMDenseOffsets[i] * 0.3f;
+                Vec2 duv = bestRegion + localOffset * radius * texel;
+                gatherVPL(p, n, albedo, matId, clamp(baseUV + duv, 0.0f, 1.0f), bounce, valid);
+            }
+            // Phase 3: coverage samples
+            for (int i = 0; i < 4; ++i) {
+                Vec2 duv = kRSMCoverageOffsets[i] * radius * texel;
+                gatherVPL(p, n, albedo, matId, clamp(baseUV + duv, 0.0f, 1.0f), bounce, valid);
+            }
+        } else {
+            int count = std::min(samples, 32);
+            for (int i = 0; i < count; ++i) {
+                Vec2 xz(p.x + static_cast<float>(i), p.z + static_cast<float>(i));
+                float random = fract(std::sin(dot(xz, Vec2(12.9898f, 78.233f))) * 43758.5453f);
+                Vec2 jitter = Vec2(fract(random * 43758.5453f), fract(random * 23421.6319f)) * 2.0f - Vec2(1.0f);
+                Vec2 duv = (kRSMUniformOffsets[i] + jitter * 0.05f) * radius * texel;
+                gatherVPL(p, n, albedo, matId, clamp(baseUV + duv, 0.0f, 1.0f), bounce, valid);
+            }
+        }
+        return valid > 0 ? u.indirectParams[0] * (bounce / static_cast<float>(valid)) : Vec3(0.0f);
+    }
+
+    // Simplified 16-tap gather of the "show indirect only" debug view
+    Vec3 indirectDebug(Vec3 p, Vec3 n, Vec3 albedo, int matId, Vec2 fragCoord) const {
+        if (u.restirParams[0] > 0.5f || u.pbrParams[3] > 1.5f || u.indirectParams[3] > 0.5f) {
+            return indirect(p, n, albedo, matId, fragCoord);
+        }
+        if (u.indirectParams[2] > 0.5f) {
+            return clusteredIndirect(p, n, albedo, matId);
+        }
+        if (u.debugParams[3] > 0.5f) {
+            return hierarchicalIndirect(p, n, albedo, matId, fragCoord);
+        }
+        static const Vec2 importanceOffs[16] = {
+            {0.0f, 0.0f}, {0.3f, 0.0f}, {-0.3f, 0.0f}, {0.0f, 0.3f},
+            {0.0f, -0.3f}, {0.2f, 0.2f}, {-0.2f, 0.2f}, {0.2f, -0.2f},
+            {-0.2f, -0.2f}, {0.5f, 0.0f}, {-0.5f, 0.0f}, {0.0f, 0.5f},
+            {0.0f, -0.5f}, {0.4f, 0.4f}, {-0.4f, 0.4f}, {0.4f, -0.4f}};
+        static const Vec2 uniformOffs[16] = {
+            {0.0f, 0.0f}, {0.3f, 0.0f}, {-0.3f, 0.0f}, {0.0f, 0.3f},
+            {0.0f, -0.3f}, {0.2f, 0.2f}, {-0.2f, 0.2f}, {0.2f, -0.2f},
+            {-0.2f, -0.2f}, {0.6f, 0.0f}, {-0.6f, 0.0f}, {0.0f, 0.6f},
+            {0.0f, -0.6f}, {0.45f, 0.45f}, {-0.45f, 0.45f}, {0.45f, -0.45f}};
+        const Vec2* offs = u.debugParams[1] > 0.5f ? importanceOffs : uniformOffs;
+        float radius = std::max(u.rsmParams[0], 1.0f);
+        Vec2 baseUV = rsmUV(p);
+        Vec2 texel = rsmTexelScale();
+        Vec3 bounce(0.0f);
+        int valid = 0;
+        for (int i = 0; i < 16; ++i) {
+            Vec2 duv = offs[i] * radius * texel;
+            gatherVPL(p, n, albedo, matId, clamp(baseUV + duv, 0.0f, 1.0f), bounce, valid);
+        }
+        return valid > 0 ? u.indirectParams[0] * (bounce / static_cast<float>(valid)) : Vec3(0.0f);
+    }
+
+    static Vec3 fresnelSchlick(float cosTheta, Vec3 F0) {
+        return F0 + (1.0f - F0) * std::pow(clamp(1.0f - cosTheta, 0.0f, 1.0f), 5.0f);
+    }
+
+    static float distributionGGX(Vec3 N, Vec3 H, float roughness) {
+        float a = roughness * roughness;
+        float a2 = a * a;
+        float NdotH = std::max(dot(N, H), 0.0f);
+        float denom = (NdotH * NdotH * (a2 - 1.0f) + 1.0f);
+        denom = PI * denom * denom;
+        return a2 / std::max(denom, 0.0001f);
+    }
+
+    static float geometrySchlickGGX(float NdotV, float roughness) {
+        float r = roughness + 1.0f;
+        float k = (r * r) / 8.0f;
+        return NdotV / std::max(NdotV * (1.0f - k) + k, 0.0001f);
+    }
+
+    static float geometrySmith(Vec3 N, Vec3 V, Vec3 L, float roughness) {
+        return geometrySchlickGGX(std::max(dot(N, L), 0.0f), roughness) *
+               geometrySchlickGGX(std::max(dot(N, V), 0.0f), roughness);
+    }
+
+    static Vec3 cookTorrance(Vec3 albedo, Vec3 N, Vec3 V, Vec3 L, float roughness, float metallic) {
+        Vec3 H = normalize(V + L);
+        Vec3 F0 = mix(Vec3(0.04f), albedo, metallic);
+        float NDF = distributionGGX(N, H, roughness);
+        float G = geometrySmith(N, V, L, roughness);
+        Vec3 F = fresnelSchlick(std::max(dot(H, V), 0.0f), F0);
+        Vec3 specular = (F * (NDF * G)) / (4.0f * std::max(dot(N, V), 0.0f) * std::max(dot(N, L), 0.0f) + 0.0001f);
+        Vec3 kD = (Vec3(1.0f) - F) * (1.0f - metallic);
+        float NdotL = std::max(dot(N, L), 0.0f);
+        Vec3 diffuse = kD * albedo / PI;
+        if (metallic < 0.5f) {
+            diffuse *= 1.5f;
+        }
+        return (diffuse + specular) * NdotL;
+    }
+
+    Vec3 getLight(Vec3 p, Vec3 n, Vec3 viewDir, Vec3 albedo, int matId, Vec2 fragCoord) const {
+        const bool pbr = u.pbrParams[0] > 0.5f;
+        Vec3 l = normalize(-xyz(u.lightDir));
+        Vec3 r = reflect(-l, n);
+
+        float fresnel = 1.0f;
+        if (matId == 1) {
+            fresnel = std::pow(1.0f - std::max(0.0f, dot(viewDir, n)), 2.0f);
+        }
+
+        float ambientMultiplier = pbr ? 0.8f : 0.3f;
+        Vec3 finalColor = Vec3(0.12f, 0.15f, 0.20f) * ambientMultiplier;
+
+        float shadow = 1.0f;
+        if (u.enableLights[0] == 1) {
+            if (u.rsmParams[3] > 0.5f) {
+                shadow = rsmShadow(p + n * 0.05f, n);
+            } else {
+                shadow = softShadow(p + n * 0.07f, l);
+            }
+            shadow = mix(0.2f, 1.0f, shadow * u.shadowParams[1]);
+        }
+
+        float roughness = u.pbrParams[1];
+        float metallic = u.pbrParams[2];
+        if (matId == 1) {
+            roughness = u.roughnessValues[0];
+            metallic = u.metallicValues[0];
+        } else if (matId == 7) {
+            roughness = u.roughnessValues[1];
+            metallic = u.metallicValues[1];
+        }
+
+        Vec3 pbrAlbedo = albedo;
+        if (pbr) {
+            pbrAlbedo *= max(xyz(u.baseColorFactors) * u.baseColorFactors[3], Vec3(0.3f));
+        }
+
+        // 1. Key light
+        if (u.enableLights[0] == 1) {
+            Vec3 lightColor = xyz(u.lightColors[0]) * u.lightColors[0][3];
+            if (pbr) {
+                Vec3 brdf = cookTorrance(pbrAlbedo, n, viewDir, l, roughness, metallic);
+                finalColor += brdf * lightColor * (shadow * u.lightDir[3] * 3.0f);
+            } else {
+                float diff = std::max(0.0f, dot(n, l));
+                float rough = clamp(1.0f - u.shadowParams[3], 0.05f, 0.95f);
+                float specPower = mix(16.0f, 64.0f, u.shadowParams[3]);
+                float spec = std::pow(std::max(0.0f, dot(viewDir, r)), specPower) * (1.0f - rough);
+                finalColor += (albedo * diff + lightColor * spec) * lightColor * (shadow * u.lightDir[3]);
+            }
+        }
+
+        // RSM indirect lighting
+        if (u.rsmParams[3] > 0.5f && u.rsmParams[2] > 0.5f) {
+            finalColor += indirect(p, n, albedo, matId, fragCoord);
+        }
+
+        // 2. Fill light
+        if (u.enableLights[1] == 1) {
+            Vec3 fillDir = normalize(Vec3(0.4f, 0.3f, 0.7f));
+            Vec3 fillColor = xyz(u.lightColors[1]) * u.lightColors[1][3];
+            if (pbr) {
+                finalColor += cookTorrance(pbrAlbedo, n, viewDir, fillDir, roughness, metallic) * fillColor * 0.6f;
+            } else {
+                float fillDiff = std::max(0.0f, dot(n, fillDir)) * 0.2f;
+                finalColor += albedo * fillDiff * fillColor;
+            }
+        }
+
+        // 3. Rim light
+        if (u.enableLights[2] == 1) {
+            float rim = std::pow(1.0f - std::max(0.0f, dot(viewDir, n)), 3.0f);
+            Vec3 rimColor = xyz(u.lightColors[2]) * (u.lightColors[2][3] * 0.8f);
+            if (pbr) {
+                Vec3 F0 = mix(Vec3(0.04f), pbrAlbedo, metallic);
+                finalColor += fresnelSchlick(1.0f - rim, F0) * rimColor * rim;
+            } else {
+                finalColor += rimColor * rim;
+            }
+        }
+
+        // 4. Environment reflection
+        if (u.enableLights[3] == 1) {
+            Vec3 envReflect = reflect(-viewDir, n);
+            Vec3 envColor(0.95f, 0.85f, 0.6f);
+            if (pbr) {
+                Vec3 F0 = mix(Vec3(0.04f), pbrAlbedo, metallic);
+                Vec3 envFresnel = fresnelSchlick(std::max(dot(-viewDir, n), 0.0f), F0);
+                finalColor += envFresnel * envColor * (std::max(0.0f, envReflect.y) * 0.8f);
+            } else {
+                finalColor += envColor * (std::max(0.0f, envReflect.y) * fresnel * 0.3f);
+            }
+        }
+
+        finalColor *= mix(Vec3(1.0f), Vec3(0.7f, 0.85f, 1.0f), u.shadowParams[2]);
+        return finalColor;
+    }
+
+    float softShadow(Vec3 ro, Vec3 l) const {
+        return scene.softShadow(ro, l, 0.07f, 6.0f, 6.0f * u.shadowParams[0]);
+    }
+
+    Vec3 albedoFor(Vec3 p, Vec3 n, int matId, bool debugView) const {
+        switch (matId) {
+            case 1: {
+                Vec3 d = normalize(scene.sphere1Local(p));
+                Vec2 sphereUV(0.5f + std::atan2(d.z, d.x) / (2.0f * PI), 0.5f - std::asin(d.y) / PI);
+                return flower.sampleRepeat(sphereUV);
+            }
+            case 7: return xyz(u.sphereColor);
+            case 2: return {0.3f, 0.4f, 0.6f};
+            case 3: return {0.7f, 0.8f, 0.9f};
+            case 4: return {0.4f, 0.7f, 0.5f};
+            case 5: return {0.7f, 0.4f, 0.4f};
+            case 6: return {0.6f, 0.4f, 0.7f};
+            default:
+                // Unreachable with the current getMaterial(), kept for parity
+                return debugView ? Vec3(0.92f, 0.94f, 0.98f) * u.shadowParams[2]
+                                 : (Vec3(0.92f, 0.94f, 0.98f) + n * 0.001f) * u.shadowParams[2];
+        }
+    }
+
+    static constexpr Vec3 cameraOrigin = kCameraOrigin;
+
+    // sdf_practice.frag main(), up to the ray march
+    Vec3 primaryRay(Vec2 fragTexCoord) const {
+        return cameraRay(fragTexCoord, u.iResolution[0] / u.iResolution[1]);
+    }
+
+    // sdf_practice.frag main(), from the marched distance `d` on
+    Vec3 shade(Vec2 fragTexCoord, Vec3 rd, float d) const {
+        const Vec3 ro = cameraOrigin;
+        const Vec3 background(0.85f, 0.9f, 0.95f);
+        Vec3 color = background;
+        Vec3 p, n;
+        int matId = 0;
+        const bool hit = d < MAX_DIST;
+        const Vec2 fragCoord(fragTexCoord.x * u.iResolution[0], fragTexCoord.y * u.iResolution[1]);
+        if (hit) {
+            p = ro + rd * d;
+            n = scene.getNormal(p);
+            matId = scene.getMaterial(p);
+            color = getLight(p, n, -rd, albedoFor(p, n, matId, false), matId, fragCoord);
+            float fog = 1.0f - std::exp(-d * 0.08f);
+            color = mix(color, background, fog * 0.15f);
+        }
+        color = mix(color, color * Vec3(1.05f, 1.02f, 0.95f), 0.12f);
+
+        if (u.debugParams[0] > 0.5f) {
+            Vec3 flux = rsmFlux.sampleClamp(fragTexCoord);
+            Vec3 normalVis = rsmNormal.sampleClamp(fragTexCoord) * 0.5f + 0.5f;
+            Vec3 posVis = rsmPosition.sampleClamp(fragTexCoord) * 0.05f + 0.5f;
+            return mix(mix(posVis, normalVis, 0.3f), flux, 0.6f);
+        }
+        if (u.debugParams[2] > 0.5f) {
+            if (!hit) {
+                return Vec3(0.0f);
+            }
+            if (u.rsmParams[3] > 0.5f && u.rsmParams[2] > 0.5f) {
+                return indirectDebug(p, n, albedoFor(p, n, matId, true), matId, fragCoord);
+            }
+            return Vec3(0.0f);
+        }
+        return color;
+    }
+};
+
+struct Tile {
+    uint32_t x0, y0, x1, y1;
+
+    template <typename Fn>
+    void forEachPixel(Fn&& fn) const {
+        size_t i = 0;
+        for (uint32_t y = y0; y < y1; ++y) {
+            for (uint32_t x = x0; x < x1; ++x) {
+                fn(x, y, i++);
+            }
+        }
+    }
+};
+
+template <typename Fn>
+void forEachTile(WorkStealingPool& pool, const RSMRect& rect, Fn&& fn) {
+    const uint32_t tilesX = (rect.width + kTileSize - 1) / kTileSize;
+    const uint32_t tilesY = (rect.height + kTileSize - 1) / kTileSize;
+    pool.parallelFor(static_cast<size_t>(tilesX) * tilesY, [&](size_t tile, unsigned) {
+        uint32_t x0 = rect.x + static_cast<uint32_t>(tile % tilesX) * kTileSize;
+        uint32_t y0 = rect.y + static_cast<uint32_t>(tile / tilesX) * kTileSize;
+        fn(Tile{x0, y0, std::min(x0 + kTileSize, rect.x + rect.width), std::min(y0 + kTileSize, rect.y + rect.height)});
+    });
+}
+
+template <typename Fn>
+void forEachTile(WorkStealingPool& pool, uint32_t width, uint32_t height, Fn&& fn) {
+    forEachTile(pool, RSMRect{0, 0, width, height}, std::forward<Fn>(fn));
+}
+
+// One tile worth of rays in the SoA layout the packet kernels read
+struct TileRays {
+    static constexpr size_t kCapacity = kTileSize * kTileSize;
+    alignas(64) std::array<float, kCapacity> ox, oy, oz, dx, dy, dz, t;
+    size_t count = 0;
+
+    void push(Vec3 ro, Vec3 rd) {
+        ox[count] = ro.x; oy[count] = ro.y; oz[count] = ro.z;
+        dx[count] = rd.x; dy[count] = rd.y; dz[count] = rd.z;
+        ++count;
+    }
+    Vec3 origin(size_t i) const { return {ox[i], oy[i], oz[i]}; }
+    Vec3 direction(size_t i) const { return {dx[i], dy[i], dz[i]}; }
+
+    void march(SimdLevel level, const PacketMarchScene& scene) {
+        marchRays(level, scene, RayBatch{ox.data(), oy.data(), oz.data(), dx.data(), dy.data(), dz.data(), t.data(), count});
+    }
+};
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                 CpuTexture                                 */
+/* -------------------------------------------------------------------------- */
+CpuTexture CpuTexture::loadSRGB(const std::string& path) {
+    CpuTexture texture;
+#if defined(SDF_HAS_STB_IMAGE)
+    int w = 0, h = 0, channels = 0;
+    if (stbi_uc* data = stbi_load(path.c_str(), &w, &h, &channels, 4)) {
+        texture.resize(static_cast<uint32_t>(w), static_cast<uint32_t>(h));
+        for (size_t i = 0, n = static_cast<size_t>(w) * h; i < n; ++i) {
+            texture.texels[i] = Vec3(srgbToLinear(data[i * 4 + 0] / 255.0f),
+                                     srgbToLinear(data[i * 4 + 1] / 255.0f),
+                                     srgbToLinear(data[i * 4 + 2] / 255.0f));
+        }
+        stbi_image_free(data);
+        return texture;
+    }
+#endif
+    std::cerr << "Warning: could not decode " << path
+              << "; using a checkerboard (the textured sphere will not match the GPU)\n";
+    texture.resize(64, 64);
+    for (uint32_t y = 0; y < 64; ++y) {
+        for (uint32_t x = 0; x < 64; ++x) {
+            texture.at(x, y) = Vec3(((x / 8 + y / 8) % 2) ? 0.6f : 0.2f);
+        }
+    }
+    return texture;
+}
+
+void CpuTexture::resize(uint32_t w, uint32_t h) {
+    width = w;
+    height = h;
+    texels.assign(static_cast<size_t>(w) * h, Vec3(0.0f));
+}
+
+Vec3 CpuTexture::sample(Vec2 uv, bool repeat) const {
+    if (texels.empty()) {
+        return Vec3(0.0f);
+    }
+    // Bilinear filtering around texel centres, as VK_FILTER_LINEAR without mips
+    float x = uv.x * static_cast<float>(width) - 0.5f;
+    float y = uv.y * static_cast<float>(height) - 0.5f;
+    float fx = std::floor(x), fy = std::floor(y);
+    float tx = x - fx, ty = y - fy;
+    int x0 = static_cast<int>(fx), y0 = static_cast<int>(fy);
+    const int w = static_cast<int>(width), h = static_cast<int>(height);
+    auto fetch = [&](int xi, int yi) {
+        if (repeat) {
+            xi = ((xi % w) + w) % w;
+            yi = ((yi % h) + h) % h;
+        } else {
+            xi = std::clamp(xi, 0, w - 1);
+            yi = std::clamp(yi, 0, h - 1);
+        }
+        return texels[static_cast<size_t>(yi) * width + static_cast<size_t>(xi)];
+    };
+    return mix(mix(fetch(x0, y0), fetch(x0 + 1, y0), tx),
+               mix(fetch(x0, y0 + 1), fetch(x0 + 1, y0 + 1), tx), ty);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                CpuRSMPyramid                               */
+/* -------------------------------------------------------------------------- */
+void CpuRSMPyramid::build(WorkStealingPool& pool, const CpuTexture& position, const CpuTexture& normal,
+                          const CpuTexture& flux) {
+    layout = RSMPyramidLayout::make(flux.getWidth(), flux.getHeight());
+    atlas.assign(static_cast<size_t>(layout.atlasWidth) * layout.atlasHeight, 0.0f);
+    clusters.assign(static_cast<size_t>(layout.clusterCount) * layout.clusterCount, Cluster{});
+    auto nodeAt = [&](uint32_t level, uint32_t x, uint32_t y) -> float& {
+        return atlas[static_cast<size_t>(layout.getLevelOriginY(level) + y) * layout.atlasWidth +
+                     layout.getLevelOriginX(level) + x];
+    };
+
+    // rsm_pyramid.comp mode 0: level 0 from 2x2 RSM texels
+    pool.parallelFor(layout.baseSize, [&](size_t row, unsigned) {
+        const uint32_t y = static_cast<uint32_t>(row);
+        for (uint32_t x = 0; x < layout.baseSize; ++x) {
+            nodeAt(0, x, y) = (rsmLuminance(flux.at(2 * x, 2 * y)) + rsmLuminance(flux.at(2 * x + 1, 2 * y)) +
+                               rsmLuminance(flux.at(2 * x, 2 * y + 1)) + rsmLuminance(flux.at(2 * x + 1, 2 * y + 1))) *
+                              0.25f;
+        }
+    });
+    // Mode 1: each further level from the one below (one dispatch per level on the GPU)
+    for (uint32_t level = 1; level < layout.levelCount; ++level) {
+        for (uint32_t y = 0; y < layout.getLevelSize(level); ++y) {
+            for (uint32_t x = 0; x < layout.getLevelSize(level); ++x) {
+                nodeAt(level, x, y) = (nodeAt(level - 1, 2 * x, 2 * y) + nodeAt(level - 1, 2 * x + 1, 2 * y) +
+                                       nodeAt(level - 1, 2 * x, 2 * y + 1) + nodeAt(level - 1, 2 * x + 1, 2 * y + 1)) *
+                                      0.25f;
+            }
+        }
+    }
+    // Mode 2: normal cone and bounding sphere of the VPLs with flux in each cluster
+    const uint32_t size = RSMPyramidLayout::kClusterSize;
+    pool.parallelFor(clusters.size(), [&](size_t index, unsigned) {
+        const uint32_t x0 = static_cast<uint32_t>(index % layout.clusterCount) * size;
+        const uint32_t y0 = static_cast<uint32_t>(index / layout.clusterCount) * size;
+        Vec3 normalSum(0.0f), positionSum(0.0f);
+        uint32_t count = 0;
+        for (uint32_t y = y0; y < y0 + size; ++y) {
+            for (uint32_t x = x0; x < x0 + size; ++x) {
+                if (rsmLuminance(flux.at(x, y)) > 0.0f) {
+                    normalSum += normalize(normal.at(x, y));
+                    positionSum += position.at(x, y);
+                    ++count;
+                }
+            }
+        }
+        if (count == 0) {
+            return;
+        }
+        Cluster& cluster = clusters[index];
+        const bool hasAxis = length(normalSum) > 1e-4f;
+        cluster.axis = hasAxis ? normalize(normalSum) : Vec3(0.0f, 0.0f, 1.0f);
+        cluster.center = positionSum / static_cast<float>(count);
+        cluster.cosAngle = 1.0f;
+        cluster.radius = 0.0f;
+        for (uint32_t y = y0; y < y0 + size; ++y) {
+            for (uint32_t x = x0; x < x0 + size; ++x) {
+                if (rsmLuminance(flux.at(x, y)) > 0.0f) {
+                    cluster.cosAngle = std::min(cluster.cosAngle, dot(cluster.axis, normalize(normal.at(x, y))));
+                    cluster.radius = std::max(cluster.radius, length(position.at(x, y) - cluster.center));
+                }
+            }
+        }
+        if (!hasAxis) {
+            cluster.cosAngle = -1.0f;
+        }
+    });
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               CpuVplClusters                               */
+/* -------------------------------------------------------------------------- */
+void CpuVplClusters::build(WorkStealingPool& pool, const CpuRSMPyramid& pyramid, const CpuTexture& position,
+                           const CpuTexture& normal, const CpuTexture& flux, uint32_t count) {
+    // vpl_cluster.comp mode 0: RSM texels summed into grid cells
+    const uint32_t rsmSize = flux.getWidth();
+    cells.assign(kVplClusterCellCount, Cluster{});
+    pool.parallelFor(kVplClusterGridSize, [&](size_t row, unsigned) {
+        const uint32_t cy = static_cast<uint32_t>(row);
+        for (uint32_t cx = 0; cx < kVplClusterGridSize; ++cx) {
+            Vec3 positionSum(0.0f), normalSum(0.0f), fluxSum(0.0f);
+            float weightSum = 0.0f;
+            for (uint32_t y = cy * rsmSize / kVplClusterGridSize; y < (cy + 1) * rsmSize / kVplClusterGridSize; ++y) {
+                for (uint32_t x = cx * rsmSize / kVplClusterGridSize; x < (cx + 1) * rsmSize / kVplClusterGridSize; ++x) {
+                    const float weight = rsmLuminance(flux.at(x, y));
+                    if (weight > 0.0f) {
+                        positionSum += position.at(x, y) * weight;
+                        normalSum += normalize(normal.at(x, y)) * weight;
+                        fluxSum += flux.at(x, y);
+                        weightSum += weight;
+                    }
+                }
+            }
+            Cluster& cell = cells[cy * kVplClusterGridSize + cx];
+            if (weightSum > 0.0f) {
+                cell.position = positionSum / weightSum;
+                cell.members = 1.0f;
+            }
+            cell.normal = length(normalSum) > 1e-4f ? normalize(normalSum) : Vec3(0.0f, 0.0f, 1.0f);
+            cell.flux = fluxSum;
+        }
+    });
+    // seedAt(): centroid on the cell of a texel drawn in proportion to flux through the pyramid
+    auto seedAt = [&](float xi) {
+        uint32_t x = 0, y = 0;
+        for (int level = static_cast<int>(pyramid.layout.levelCount) - 1; level >= 0; --level) {
+            float w[4];
+            for (uint32_t i = 0; i < 4; ++i) {
+                const uint32_t cx = 2 * x + (i & 1), cy = 2 * y + (i >> 1);
+                w[i] = level > 0 ? pyramid.node(static_cast<uint32_t>(level - 1), cx, cy) : rsmLuminance(flux.at(cx, cy));
+            }
+            const float total = (w[0] + w[1]) + (w[2] + w[3]);
+            if (!(total > 0.0f)) {
+                return Cluster{Vec3(0.0f), 0.0f, Vec3(0.0f), Vec3(0.0f)}; // no flux anywhere: dead
+            }
+            xi *= total;
+            uint32_t pick = 0;
+            for (; pick < 3; ++pick) {
+                if (xi < w[pick]) break;
+                xi -= w[pick];
+            }
+            xi = std::min(xi / std::max(w[pick], 1e-30f), 0.99999994f);
+            x = 2 * x + (pick & 1);
+            y = 2 * y + (pick >> 1);
+        }
+        Cluster seed = cells[(y * kVplClusterGridSize / rsmSize) * kVplClusterGridSize + x * kVplClusterGridSize / rsmSize];
+        seed.flux = Vec3(0.0f);
+        return seed;
+    };
+
+    // Mode 1: one seed per flux stratum
+    if (seededCount != count) {
+        clusters.resize(count);
+        for (uint32_t c = 0; c < count; ++c) {
+            clusters[c] = seedAt((static_cast<float>(c) + 0.5f) / static_cast<float>(count));
+        }
+        seededCount = count;
+    }
+
+    assignment.assign(kVplClusterCellCount, ~0u);
+    for (uint32_t iteration = 0; iteration < kVplClusterIterations; ++iteration) {
+        // Mode 2: nearest live centroid (vplClusterDistance()) per cell
+        pool.parallelFor(kVplClusterCellCount, [&](size_t index, unsigned) {
+            const Cluster& cell = cells[index];
+            float bestDistance = 3.4e38f;
+            uint32_t best = ~0u;
+            for (uint32_t c = 0; c < count; ++c) {
+                const Cluster& cluster = clusters[c];
+                if (cluster.members <= 0.0f) continue;
+                const Vec3 d = cell.position - cluster.position;
+                const float distance = dot(d, d) + 2.0f * (1.0f - dot(cell.normal, cluster.normal));
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = c;
+                }
+            }
+            assignment[index] = cell.members > 0.0f ? best : ~0u;
+        });
+        // Mode 3: flux-weighted centroids of the members, empty clusters reseeded at a hashed xi
+        struct Sum {
+            Vec3 position{0.0f}, normal{0.0f}, flux{0.0f};
+            float weight = 0.0f, members = 0.0f;
+        };
+        std::vector<Sum> sums(count);
+        for (uint32_t index = 0; index < kVplClusterCellCount; ++index) {
+            if (assignment[index] != ~0u) {
+                const Cluster& cell = cells[index];
+                const float weight = rsmLuminance(cell.flux);
+                Sum& sum = sums[assignment[index]];
+                sum.position += cell.position * weight;
+                sum.normal += cell.normal * weight;
+                sum.flux += cell.flux;
+                sum.weight += weight;
+                sum.members += 1.0f;
+            }
+        }
+        for (uint32_t c = 0; c < count; ++c) {
+            const Sum& sum = sums[c];
+            if (sum.members > 0.0f) {
+                clusters[c].position = sum.position / sum.weight;
+                clusters[c].members = sum.members;
+                clusters[c].normal = length(sum.normal) > 1e-4f ? normalize(sum.normal) : Vec3(0.0f, 0.0f, 1.0f);
+                clusters[c].flux = sum.flux;
+            } else {
+                clusters[c] = seedAt(static_cast<float>(pcgHash(c * 1024u + iteration) >> 8) * (1.0f / 16777216.0f));
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                             CpuCornellRenderer                             */
+/* -------------------------------------------------------------------------- */
+CpuCornellRenderer::CpuCornellRenderer(WorkStealingPool& workerPool)
+    : pool(workerPool), simdLevel(detectSimdLevel()) {}
+
+void CpuCornellRenderer::renderRSM(const SDFCornellUniforms& u) {
+    const uint32_t w = static_cast<uint32_t>(std::max(u.rsmResolution[0], 1.0f));
+    const uint32_t h = static_cast<uint32_t>(std::max(u.rsmResolution[1], 1.0f));
+    if (u.rsmParams[3] <= 0.5f) {
+        // The GPU skips the pass too; the main shader then never reads the RSM
+        rsmPosition.resize(w, h);
+        rsmNormal.resize(w, h);
+        rsmFlux.resize(w, h);
+        rsmPyramid.clear();
+        vplClusters.clear();
+        rsmScheduler.invalidate();
+        return;
+    }
+    if (!rsmScheduler.shouldRender(u, lastRSMMs)) {
+        return; // previous contents reused
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!rsmScheduler.isPartialRender()) {
+        rsmPosition.resize(w, h);
+        rsmNormal.resize(w, h);
+        rsmFlux.resize(w, h);
+    }
+
+    Scene scene(u);
+    const PacketMarchScene marchScene = makePacketMarchScene(u);
+    const Vec3 rd = normalize(xyz(u.lightDir));
+    const Vec3 lightColor = xyz(u.lightColors[0]) * u.lightColors[0][3];
+    const RSMLightFrame lightFrame = RSMLightFrame::fromUniforms(u);
+    // Like the GPU pass: texels outside the rects keep their contents
+    for (const RSMRect& rect : rsmScheduler.getRenderRects()) {
+        forEachTile(pool, rect, [&](const Tile& tile) {
+            // rsm_light.frag main(): march the whole tile as packets, then shade per texel
+            TileRays rays;
+            tile.forEachPixel([&](uint32_t x, uint32_t y, size_t) {
+                Vec2 uv = Vec2((x + 0.5f) / w, (y + 0.5f) / h) * 2.0f - Vec2(1.0f);
+                rays.push(xyz(u.lightOrigin) + xyz(u.lightRight) * (uv.x * u.lightOrthoHalfSize[0]) +
+                              xyz(u.lightUp) * (uv.y * u.lightOrthoHalfSize[1]),
+                          rd);
+            });
+            rays.march(simdLevel, marchScene);
+            tile.forEachPixel([&](uint32_t x, uint32_t y, size_t i) {
+                float d = rays.t[i];
+                if (d >= MAX_DIST) {
+                    rsmPosition.at(x, y) = Vec3(0.0f);
+                    rsmNormal.at(x, y) = Vec3(0.0f);
+                    rsmFlux.at(x, y) = Vec3(0.0f);
+                    return;
+                }
+                Vec3 pos = rays.origin(i) + rd * d;
+                Vec3 nor = scene.getNormal(pos);
+                float nDotL = std::max(dot(nor, -rd), 0.0f);
+                Vec3 flux = scene.getRSMAlbedo(pos) * lightColor * (u.lightDir[3] * nDotL * 2.0f);
+                // What the shaders read back from the attachments
+                roundTripRSMTexel(lightFrame, Vec2((x + 0.5f) / w, (y + 0.5f) / h), pos, nor, flux);
+                rsmPosition.at(x, y) = pos;
+                rsmNormal.at(x, y) = nor;
+                rsmFlux.at(x, y) = flux;
+            });
+        });
+    }
+    // Rebuilt with every RSM, hierarchical sampling on or off, so toggling it needs no new pass
+    rsmPyramid.build(pool, rsmPosition, rsmNormal, rsmFlux);
+    vplClustersStale = true;
+    lastRSMMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void CpuCornellRenderer::render(const SDFCornellUniforms& u, uint32_t width, uint32_t height, ImageRGB8& out) {
+    renderRSM(u);
+    // Like SDFCornell: clusters follow the RSM only while the clustered path is in use
+    const uint32_t vplClusterCount = static_cast<uint32_t>(std::max(u.indirectParams[2], 0.0f));
+    if (u.rsmParams[2] > 0.5f && vplClusterCount > 0 && (vplClustersStale || vplClusterCount != vplClusters.seededCount)) {
+        vplClusters.build(pool, rsmPyramid, rsmPosition, rsmNormal, rsmFlux, vplClusterCount);
+        vplClustersStale = false;
+    }
+
+    out.width = width;
+    out.height = height;
+    out.pixels.resize(static_cast<size_t>(width) * height * 3);
+
+    Scene scene(u);
+    const PacketMarchScene marchScene = makePacketMarchScene(u);
+    // Like SDFCornell: the INDIRECT_PASS output at 1/divisor of the target, resolved
+    // against the history when temporal, before the main pass
+    const bool indirectOn = u.rsmParams[3] > 0.5f && u.rsmParams[2] > 0.5f;
+    const bool temporalIndirect = indirectOn && u.indirectParams[3] > 0.5f;
+    const uint32_t divisor = indirectOn ? clampCornellIndirectDivisor(static_cast<int>(u.pbrParams[3])) : 1;
+    const bool restir = indirectOn && u.restirParams[0] > 0.5f;
+    Shading shading{scene, u, rsmPosition, rsmNormal, rsmFlux, rsmPyramid, vplClusters, flowerTexture,
+                    temporalIndirect ? indirectHistory : indirectRaw, indirectDepth,
+                    restirReservoirs, restirPrevious, restirSphereCenters};
+    auto fragTexCoord = [&](uint32_t x, uint32_t y) { return Vec2((x + 0.5f) / width, (y + 0.5f) / height); };
+
+    if (temporalIndirect || divisor > 1 || restir) {
+        const uint32_t passWidth = getCornellIndirectSize(width, divisor);
+        const uint32_t passHeight = getCornellIndirectSize(height, divisor);
+        if (indirectRaw.getWidth() != passWidth || indirectRaw.getHeight() != passHeight) {
+            for (CpuTexture* texture : {&indirectRaw, &indirectAccum, &indirectAccumFrames, &indirectHistory, &indirectHistoryFrames}) {
+                texture->resize(passWidth, passHeight);
+            }
+            indirectDepth.assign(static_cast<size_t>(passWidth) * passHeight, MAX_DIST);
+            indirectHistoryKey = 0;
+            restirValid = false;
+        }
+        if (restir) {
+            // Like SDFCornell's two halves: last frame's become the previous ones
+            std::swap(restirReservoirs, restirPrevious);
+            const size_t count = static_cast<size_t>(passWidth) * passHeight;
+            if (!restirValid || restirPrevious.size() != count || rsmFlux.getWidth() != restirRSMSize) {
+                restirPrevious.assign(count, GpuRestirReservoir{});
+            }
+            restirReservoirs.assign(count, GpuRestirReservoir{});
+        }
+        forEachTile(pool, passWidth, passHeight, [&](const Tile& tile) {
+            TileRays rays;
+            tile.forEachPixel([&](uint32_t x, uint32_t y, size_t) {
+                rays.push(Shading::cameraOrigin, shading.primaryRay(Vec2((x + 0.5f) / passWidth, (y + 0.5f) / passHeight)));
+            });
+            rays.march(simdLevel, marchScene);
+            tile.forEachPixel([&](uint32_t x, uint32_t y, size_t i) {
+                const float d = rays.t[i];
+                Vec3 irradiance(0.0f);
+                if (d < MAX_DIST) {
+                    const Vec3 p = rays.origin(i) + rays.direction(i) * d;
+                    const Vec3 n = scene.getNormal(p);
+                    const int matId = scene.getMaterial(p);
+                    if (restir) {
+                        shading.restirInitialAndTemporal(p, n, matId, d, x, y);
+                    } else {
+                        irradiance = temporalIndirect ? shading.temporalIndirectTaps(p, n, matId, x, y)
+                                                      : shading.gatherIndirect(p, n, Vec3(1.0f), matId, Vec2(x + 0.5f, y + 0.5f));
+                    }
+                }
+                indirectRaw.at(x, y) = irradiance;
+                indirectDepth[static_cast<size_t>(y) * passWidth + x] = d;
+            });
+        });
+        if (temporalIndirect) {
+            // The pass variant's sampling pattern: history of another one is dropped
+            resolveTemporalIndirect(u, 1u + (u.debugParams[1] > 0.5f ? 1u : 0u) + (u.debugParams[3] > 0.5f ? 2u : 0u));
+        } else {
+            indirectHistoryKey = 0;
+        }
+    } else {
+        indirectHistoryKey = 0;
+    }
+    if (restir) {
+        restirValid = true;
+        restirRSMSize = rsmFlux.getWidth();
+        std::copy(&u.sphereCenters[0][0], &u.sphereCenters[0][0] + 8, &restirSphereCenters[0][0]);
+    } else {
+        restirValid = false;
+    }
+    // At full resolution the temporal indirect pass already marched every pixel
+    const bool marched = temporalIndirect && divisor == 1;
+    forEachTile(pool, width, height, [&](const Tile& tile) {
+        TileRays rays;
+        if (!marched) {
+            tile.forEachPixel([&](uint32_t x, uint32_t y, size_t) {
+                rays.push(Shading::cameraOrigin, shading.primaryRay(fragTexCoord(x, y)));
+            });
+            rays.march(simdLevel, marchScene);
+        }
+        tile.forEachPixel([&](uint32_t x, uint32_t y, size_t i) {
+            Vec3 color = marched
+                ? shading.shade(fragTexCoord(x, y), shading.primaryRay(fragTexCoord(x, y)),
+                                indirectDepth[static_cast<size_t>(y) * width + x])
+                : shading.shade(fragTexCoord(x, y), rays.direction(i), rays.t[i]);
+            uint8_t* px = &out.pixels[(static_cast<size_t>(y) * width + x) * 3];
+            px[0] = linearToSrgb8(color.x);
+            px[1] = linearToSrgb8(color.y);
+            px[2] = linearToSrgb8(color.z);
+        });
+    });
+}
+
+void CpuCornellRenderer::resolveTemporalIndirect(const SDFCornellUniforms& u, uint32_t key) {
+    // indirect_temporal.comp, one row per task
+    const uint32_t width = indirectRaw.getWidth();
+    const uint32_t height = indirectRaw.getHeight();
+    // The pass rendered its rays with the aspect of the full target
+    const float aspect = u.iResolution[0] / u.iResolution[1];
+    const bool dropHistory = indirectHistoryKey != key;
+    auto depthAt = [&](int x, int y) { return indirectDepth[static_cast<size_t>(y) * width + static_cast<size_t>(x)]; };
+    pool.parallelFor(height, [&](size_t row, unsigned) {
+        const int y = static_cast<int>(row);
+        for (int x = 0; x < static_cast<int>(width); ++x) {
+            const float d = depthAt(x, y);
+            if (d >= MAX_DIST) {
+                indirectAccum.at(x, y) = Vec3(0.0f);
+                indirectAccumFrames.at(x, y) = Vec3(0.0f);
+                continue;
+            }
+            const Vec3 current = indirectRaw.at(x, y);
+
+            // Range of this frame's taps over the surface pixels around this one
+            Vec3 lo = current, hi = current;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int nx = std::clamp(x + dx, 0, static_cast<int>(width) - 1);
+                    const int ny = std::clamp(y + dy, 0, static_cast<int>(height) - 1);
+                    if (depthAt(nx, ny) < MAX_DIST) {
+                        lo = min(lo, indirectRaw.at(nx, ny));
+                        hi = max(hi, indirectRaw.at(nx, ny));
+                    }
+                }
+            }
+
+            const Vec2 texCoord((x + 0.5f) / width, (y + 0.5f) / height);
+            Vec3 p = kCameraOrigin + cameraRay(texCoord, aspect) * d;
+            for (int i = 0; i < 2; ++i) {
+                const Vec3 center = xyz(u.sphereCenters[i]);
+                if (length(p - center) < u.sphereCenters[i][3] + 0.05f) {
+                    p += xyz(indirectHistorySphereCenters[i]) - center;
+                    break;
+                }
+            }
+            const Vec2 prevTexCoord = cameraProject(p, aspect);
+
+            Vec3 history(0.0f);
+            float historyFrames = 0.0f;
+            if (!dropHistory && prevTexCoord.x >= 0.0f && prevTexCoord.y >= 0.0f && prevTexCoord.x <= 1.0f &&
+                prevTexCoord.y <= 1.0f) {
+                history = indirectHistory.sampleClamp(prevTexCoord);
+                historyFrames = indirectHistoryFrames.sampleClamp(prevTexCoord).x;
+            }
+            const float frames = std::min(historyFrames + 1.0f, kTemporalIndirectMaxFrames);
+            indirectAccum.at(x, y) = mix(max(min(history, hi), lo), current, 1.0f / frames);
+            indirectAccumFrames.at(x, y) = Vec3(frames);
+        }
+    });
+    // SDFCornell copies the output over the history; the main pass reads either
+    std::swap(indirectAccum, indirectHistory);
+    std::swap(indirectAccumFrames, indirectHistoryFrames);
+    indirectHistoryKey = key;
+    std::copy(&u.sphereCenters[0][0], &u.sphereCenters[0][0] + 8, &indirectHistorySphereCenters[0][0]);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                             --cpu-reference mode                           */
+/* -------------------------------------------------------------------------- */
+int runCornellCpuReference(const RunOptions& options) {
+    WorkStealingPool pool(options.cpuThreads);
+    CpuCornellRenderer renderer(pool);
+    renderer.setSimdLevel(parseSimdLevel(options.simdLevel));
+    renderer.setFlowerTexture(CpuTexture::loadSRGB("assets/flower.png"));
+    RSMUpdateScheduler& rsmScheduler = renderer.getRSMScheduler();
+    rsmScheduler.setMode(parseRSMUpdateMode(options.rsmUpdate));
+    rsmScheduler.setInterval(options.rsmInterval);
+    rsmScheduler.setBudgetMs(options.rsmBudgetMs);
+    rsmScheduler.setPartialUpdates(options.rsmPartialUpdates);
+
+    SDFCornellSettings settings;
+    applyCornellRunOptions(options, settings);
+    const RSMEncoding rsmEncoding = parseRSMEncoding(options.rsmEncoding);
+
+    FrameStats frameStats(4096, 0);
+    ImageRGB8 image;
+    auto runStart = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < options.frameCount; ++i) {
+        SDFCornellFrameInputs frame;
+        frame.time = options.fixedTime >= 0.0 ? static_cast<float>(options.fixedTime) : static_cast<float>(i) / 60.0f;
+        frame.width = options.width;
+        frame.height = options.height;
+        frame.frame = static_cast<int>(i);
+        frame.rsmEncoding = rsmEncoding;
+        const SDFCornellUniforms uniforms = makeCornellUniforms(settings, frame);
+
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        renderer.render(uniforms, options.width, options.height, image);
+        auto frameEnd = std::chrono::high_resolution_clock::now();
+        frameStats.addSample(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+    }
+    auto runEnd = std::chrono::high_resolution_clock::now();
+
+    const double totalMs = std::chrono::duration<double, std::milli>(runEnd - runStart).count();
+    const FrameStats::Summary summary = frameStats.summarize();
+    std::cout << "\nCPU Reference Statistics:\n";
+    std::cout << "Threads: " << pool.getThreadCount() << " (steals: " << pool.getStealCount() << ")\n";
+    std::cout << "Ray march kernel: " << toString(renderer.getSimdLevel()) << "\n";
+    if (settings.enableRSM) {
+        std::cout << "RSM passes (" << toString(rsmScheduler.getMode()) << "): " << rsmScheduler.getStats().rendered
+                  << " rendered (" << rsmScheduler.getStats().partial << " partial), "
+                  << rsmScheduler.getStats().skipped << " reused\n";
+        std::cout << "RSM encoding: " << toString(rsmEncoding) << " (" << getRSMBytesPerTexel(rsmEncoding)
+                  << " bytes per texel)\n";
+    }
+    printHeadlessSummary(std::cout, options, totalMs);
+    if (summary.meanMs > 0.0) {
+        std::cout << "Throughput: "
+                  << (static_cast<double>(options.width) * options.height / (summary.meanMs * 1000.0))
+                  << " Mpixel/s\n";
+    }
+    FrameStats::printSummary(std::cout, summary);
+
+    if (!options.outputPath.empty()) {
+        writePPM(options.outputPath, image);
+        std::cout << "Wrote " << options.outputPath << "\n";
+    }
+
+    if (!options.comparePath.empty()) {
+        const ImageDiff diff = compareImages(image, readPPM(options.comparePath));
+        std::cout << "Compared with " << options.comparePath << ": RMSE " << diff.rmse
+                  << ", PSNR " << diff.psnrDb << " dB, max channel diff " << diff.maxAbsDiff << "\n";
+        if (diff.psnrDb < options.minPsnrDb) {
+            std::cerr << "Golden-image check failed: PSNR below " << options.minPsnrDb << " dB\n";
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
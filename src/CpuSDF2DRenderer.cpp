@@ -0,0 +1,254 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : Multithreaded CPU port of the 2D scene shader (reference renderer)
+ * @FilePath     : CpuSDF2DRenderer.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "CpuSDF2DRenderer.hpp"
+#include "ConeShadow2D.hpp"
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr uint32_t kTileSize = 16;
+constexpr size_t kTilePixels = kTileSize * kTileSize;
+
+bool dispatch(SimdLevel level, const ShadowScene2D& scene, const ShadowBatch2D& batch) {
+    switch (level) {
+        case SimdLevel::Scalar: return coneShadowsScalar(scene, batch);
+        case SimdLevel::SSE4: return coneShadowsSSE4(scene, batch);
+        case SimdLevel::AVX2: return coneShadowsAVX2(scene, batch);
+        case SimdLevel::AVX512: return coneShadowsAVX512(scene, batch);
+    }
+    return false;
+}
+
+// GLSL helpers with their exact definitions
+float clamp01(float x) { return std::min(std::max(x, 0.0f), 1.0f); }
+float mix(float a, float b, float t) { return a * (1.0f - t) + b * t; }
+float glslMod(float x, float y) { return x - y * std::floor(x / y); }
+
+float fillMask(float dist) { return clamp01(-dist); }
+
+float innerBorderMask(float dist, float width) {
+    return clamp01(dist + width) - clamp01(dist);
+}
+
+float AO(float dist, float radius, float intensity) {
+    float a = clamp01(dist / radius) - 1.0f;
+    return 1.0f - (std::pow(std::fabs(a), 5.0f) + 1.0f) * intensity + (1.0f - intensity);
+}
+
+uint8_t unormToByte(float c) {
+    if (!(c > 0.0f)) {
+        return 0; // also catches NaN
+    }
+    return static_cast<uint8_t>(std::lround(std::min(c, 1.0f) * 255.0f));
+}
+
+// One tile's pixels in the SoA layout the cone kernels read
+struct TilePixels {
+    alignas(64) std::array<float, kTilePixels> px, py, dist;
+    alignas(64) std::array<float, kTilePixels> r, g, b;
+    // Pixels within range of the current light
+    alignas(64) std::array<float, kTilePixels> litX, litY, visibility;
+    std::array<uint16_t, kTilePixels> litIndex;
+    size_t count = 0;
+};
+
+} // namespace
+
+ShadowScene2D makeShadowScene2D(const ShaderToyUniforms& uniforms) {
+    ShadowScene2D scene;
+    scene.circleCenter[0] = uniforms.shapeCenters[0];
+    scene.circleCenter[1] = uniforms.shapeCenters[1];
+    scene.rectCenter[0] = uniforms.shapeCenters[2];
+    scene.rectCenter[1] = uniforms.shapeCenters[3];
+    return scene;
+}
+
+void coneShadows(SimdLevel level, const ShadowScene2D& scene, const ShadowBatch2D& batch) {
+    if (!dispatch(level, scene, batch)) {
+        throw std::runtime_error(std::string("Cone shadow kernel not compiled for ") + toString(level));
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              CpuSDF2DRenderer                              */
+/* -------------------------------------------------------------------------- */
+CpuSDF2DRenderer::CpuSDF2DRenderer(WorkStealingPool& workerPool)
+    : pool(workerPool), simdLevel(detectSimdLevel()) {}
+
+void CpuSDF2DRenderer::render(const ShaderToyUniforms& u, const std::vector<Light2DGpu>& lights,
+                              uint32_t width, uint32_t height, ImageRGB8& out) {
+    out.width = width;
+    out.height = height;
+    out.pixels.resize(static_cast<size_t>(width) * height * 3);
+
+    const ShadowScene2D scene = makeShadowScene2D(u);
+    const float cx = u.iResolution[0] / 2.0f;
+    const float cy = u.iResolution[1] / 2.0f;
+    const uint32_t tilesX = (width + kTileSize - 1) / kTileSize;
+    const uint32_t tilesY = (height + kTileSize - 1) / kTileSize;
+    pool.parallelFor(static_cast<size_t>(tilesX) * tilesY, [&](size_t tile, unsigned) {
+        const uint32_t x0 = static_cast<uint32_t>(tile % tilesX) * kTileSize;
+        const uint32_t y0 = static_cast<uint32_t>(tile / tilesX) * kTileSize;
+        const uint32_t x1 = std::min(x0 + kTileSize, width);
+        const uint32_t y1 = std::min(y0 + kTileSize, height);
+
+        // main() up to the light loop: background, grid and ambient occlusion
+        TilePixels t;
+        for (uint32_t y = y0; y < y1; ++y) {
+            for (uint32_t x = x0; x < x1; ++x) {
+                const size_t i = t.count++;
+                const float px = static_cast<float>(x) + 0.5f;
+                const float py = static_cast<float>(y) + 0.5f;
+                t.px[i] = px;
+                t.py[i] = py;
+                t.dist[i] = cone_shadow::sceneDistance<cone_shadow::ScalarLanes>(scene, px, py);
+
+                const float gx = cx - px, gy = cy - py;
+                const float gradientFactor = 1.0f - std::sqrt(gx * gx + gy * gy) / (u.iResolution[0] * 0.8f);
+                const float grid = std::min(std::max(std::min(glslMod(py, 20.0f) / 20.0f,
+                                                              glslMod(px, 20.0f) / 20.0f), 0.95f), 1.0f);
+                const float ao = AO(t.dist[i], 40.0f, 0.4f);
+                t.r[i] = mix(0.08f, 0.15f, gradientFactor) * grid * ao;
+                t.g[i] = mix(0.12f, 0.18f, gradientFactor) * grid * ao;
+                t.b[i] = mix(0.2f, 0.25f, gradientFactor) * grid * ao;
+            }
+        }
+
+        // drawLight() for every light, in list order
+        const float tileMinX = static_cast<float>(x0), tileMaxX = static_cast<float>(x1);
+        const float tileMinY = static_cast<float>(y0), tileMaxY = static_cast<float>(y1);
+        for (const Light2DGpu& light : lights) {
+            const float lx = light.position[0], ly = light.position[1];
+            const float nx = std::clamp(lx, tileMinX, tileMaxX) - lx;
+            const float ny = std::clamp(ly, tileMinY, tileMaxY) - ly;
+            if (nx * nx + ny * ny > light.range * light.range) {
+                continue; // range circle misses the tile
+            }
+
+            size_t lit = 0;
+            for (size_t i = 0; i < t.count; ++i) {
+                const float dx = t.px[i] - lx, dy = t.py[i] - ly;
+                if (std::sqrt(dx * dx + dy * dy) <= light.range) {
+                    t.litX[lit] = t.px[i];
+                    t.litY[lit] = t.py[i];
+                    t.litIndex[lit] = static_cast<uint16_t>(i);
+                    ++lit;
+                }
+            }
+            if (lit == 0) {
+                continue;
+            }
+            coneShadows(simdLevel, scene,
+                        ShadowBatch2D{t.litX.data(), t.litY.data(), t.visibility.data(), lit, lx, ly, light.radius});
+
+            for (size_t k = 0; k < lit; ++k) {
+                const size_t i = t.litIndex[k];
+                const float dx = t.px[i] - lx, dy = t.py[i] - ly;
+                const float ld = std::sqrt(dx * dx + dy * dy);
+                float fall = (light.range - ld) / light.range;
+                fall *= fall;
+                const float source = fillMask(ld - light.radius);
+                const float intensity = t.visibility[k] * fall + source;
+                t.r[i] += intensity * light.color[0];
+                t.g[i] += intensity * light.color[1];
+                t.b[i] += intensity * light.color[2];
+            }
+        }
+
+        // Shape fill and outline, then the UNORM store
+        for (size_t i = 0; i < t.count; ++i) {
+            const float spatialVariation = std::sin(t.px[i] * 0.01f) * std::sin(t.py[i] * 0.01f) * 0.3f + 0.7f;
+            const float fill = fillMask(t.dist[i]);
+            const float border = innerBorderMask(t.dist[i], 2.0f);
+            const float rgb[3] = {t.r[i], t.g[i], t.b[i]};
+            const float outline[3] = {0.9f * 0.8f, 0.9f * 0.8f, 1.0f * 0.8f};
+            const uint32_t x = static_cast<uint32_t>(t.px[i]);
+            const uint32_t y = static_cast<uint32_t>(t.py[i]);
+            uint8_t* dst = &out.pixels[(static_cast<size_t>(y) * width + x) * 3];
+            for (int c = 0; c < 3; ++c) {
+                float col = mix(rgb[c], u.shapeColor[c] * spatialVariation, fill);
+                col = mix(col, outline[c], border);
+                dst[c] = unormToByte(col);
+            }
+        }
+    });
+}
+
+/* -------------------------------------------------------------------------- */
+/*                             --cpu-reference mode                           */
+/* -------------------------------------------------------------------------- */
+int runSDF2DCpuReference(const RunOptions& options) {
+    WorkStealingPool pool(options.cpuThreads);
+    CpuSDF2DRenderer renderer(pool);
+    renderer.setSimdLevel(parseSimdLevel(options.simdLevel));
+
+    const std::vector<SceneLight2D> sceneLights = makeDefaultSDF2DLights();
+    constexpr size_t kMaxLights = 256; // as SDF2D::kMaxLights
+
+    FrameStats frameStats(4096, 0);
+    ImageRGB8 image;
+    auto runStart = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < options.frameCount; ++i) {
+        SDF2DFrameInputs frame;
+        frame.time = options.fixedTime >= 0.0 ? static_cast<float>(options.fixedTime) : static_cast<float>(i) / 60.0f;
+        frame.width = options.width;
+        frame.height = options.height;
+        // Initial ball position of the GPU path; it only moves on mouse input
+        frame.ball[0] = static_cast<float>(options.width) * 0.5f;
+        frame.ball[1] = static_cast<float>(options.height) * 0.5f;
+        const ShaderToyUniforms uniforms = makeSDF2DUniforms(frame);
+        const std::vector<Light2DGpu> lights =
+            makeSDF2DLights(sceneLights, frame.time, static_cast<float>(options.width), kMaxLights);
+
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        renderer.render(uniforms, lights, options.width, options.height, image);
+        auto frameEnd = std::chrono::high_resolution_clock::now();
+        frameStats.addSample(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+    }
+    auto runEnd = std::chrono::high_resolution_clock::now();
+
+    const double totalMs = std::chrono::duration<double, std::milli>(runEnd - runStart).count();
+    const FrameStats::Summary summary = frameStats.summarize();
+    std::cout << "\nCPU Reference Statistics:\n";
+    std::cout << "Threads: " << pool.getThreadCount() << " (steals: " << pool.getStealCount() << ")\n";
+    std::cout << "Cone shadow kernel: " << toString(renderer.getSimdLevel()) << "\n";
+    printHeadlessSummary(std::cout, options, totalMs);
+    if (summary.meanMs > 0.0) {
+        // Per-thread figure for comparison with a software GPU driver (e.g. lavapipe) on the same cores
+        const double mpixels = static_cast<double>(options.width) * options.height / (summary.meanMs * 1000.0);
+        std::cout << "Throughput: " << mpixels << " Mpixel/s (" << mpixels / pool.getThreadCount()
+                  << " per thread)\n";
+    }
+    FrameStats::printSummary(std::cout, summary);
+
+    if (!options.outputPath.empty()) {
+        writePPM(options.outputPath, image);
+        std::cout << "Wrote " << options.outputPath << "\n";
+    }
+
+    if (!options.comparePath.empty()) {
+        const ImageDiff diff = compareImages(image, readPPM(options.comparePath));
+        std::cout << "Compared with " << options.comparePath << ": RMSE " << diff.rmse
+                  << ", PSNR " << diff.psnrDb << " dB, max channel diff " << diff.maxAbsDiff << "\n";
+        if (diff.psnrDb < options.minPsnrDb) {
+            std::cerr << "Golden-image check failed: PSNR below " << options.minPsnrDb << " dB\n";
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
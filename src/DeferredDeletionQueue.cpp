@@ -0,0 +1,51 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 18:00:00
+ * @Description  : Destroys GPU resources once the last frame that may use them has retired
+ * @FilePath     : DeferredDeletionQueue.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "DeferredDeletionQueue.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+void DeferredDeletionQueue::create(uint32_t framesInFlight) {
+    if (framesInFlight == 0) {
+        throw std::runtime_error("DeferredDeletionQueue needs at least one frame in flight");
+    }
+    slotSerials.assign(framesInFlight, 0);
+}
+
+void DeferredDeletionQueue::defer(std::function<void()> deleter) {
+    if (submittedSerial <= completedSerial) {
+        deleter(); // nothing in flight can reference it
+        return;
+    }
+    pending.push_back({submittedSerial, std::move(deleter)});
+}
+
+void DeferredDeletionQueue::onSubmit(uint32_t frameIndex) {
+    slotSerials.at(frameIndex) = ++submittedSerial;
+}
+
+void DeferredDeletionQueue::onFenceWaited(uint32_t frameIndex) {
+    completedSerial = std::max(completedSerial, slotSerials.at(frameIndex));
+    collect();
+}
+
+void DeferredDeletionQueue::collect() {
+    while (!pending.empty() && pending.front().lastUseSerial <= completedSerial) {
+        // Pop first: a deleter may defer() more work
+        std::function<void()> deleter = std::move(pending.front().deleter);
+        pending.pop_front();
+        deleter();
+    }
+}
+
+void DeferredDeletionQueue::flush() {
+    completedSerial = submittedSerial;
+    collect();
+}
@@ -0,0 +1,131 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 13:00:00
+ * @Description  : Bounded frame-time statistics with percentiles and background reporting
+ * @FilePath     : FrameStats.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// Nearest-rank percentile on an ascending array
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+} // namespace
+
+FrameStats::FrameStats(size_t capacity, uint32_t warmup)
+    : samples(std::max<size_t>(capacity, 1), 0.0), warmupFrames(warmup) {}
+
+FrameStats::~FrameStats() {
+    stopReporter();
+}
+
+void FrameStats::addSample(double frameMs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++totalFrames;
+    // The first frames include pipeline warm-up and would skew the statistics
+    if (totalFrames <= warmupFrames) {
+        return;
+    }
+    samples[next] = frameMs;
+    next = (next + 1) % samples.size();
+    count = std::min(count + 1, samples.size());
+}
+
+FrameStats::Summary FrameStats::summarize() const {
+    std::vector<double> window;
+    Summary summary;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        summary.totalFrames = totalFrames;
+        window.assign(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    summary.windowSize = window.size();
+    if (window.empty()) {
+        return summary;
+    }
+
+    std::sort(window.begin(), window.end());
+    double sum = 0.0;
+    for (double v : window) {
+        sum += v;
+    }
+    summary.minMs = window.front();
+    summary.maxMs = window.back();
+    summary.meanMs = sum / static_cast<double>(window.size());
+    summary.p50Ms = percentile(window, 50.0);
+    summary.p95Ms = percentile(window, 95.0);
+    summary.p99Ms = percentile(window, 99.0);
+    return summary;
+}
+
+void FrameStats::startReporter(std::chrono::milliseconds interval, std::ostream& os) {
+    stopReporter();
+    {
+        std::lock_guard<std::mutex> lock(reporterMutex);
+        reporterStop = false;
+    }
+    reporter = std::thread(&FrameStats::reporterLoop, this, interval, &os);
+}
+
+void FrameStats::stopReporter() {
+    {
+        std::lock_guard<std::mutex> lock(reporterMutex);
+        reporterStop = true;
+    }
+    reporterWake.notify_all();
+    if (reporter.joinable()) {
+        reporter.join();
+    }
+}
+
+void FrameStats::reporterLoop(std::chrono::milliseconds interval, std::ostream* os) {
+    std::unique_lock<std::mutex> lock(reporterMutex);
+    while (!reporterWake.wait_for(lock, interval, [this] { return reporterStop; })) {
+        lock.unlock();
+        printSummary(*os, summarize());
+        lock.lock();
+    }
+}
+
+void FrameStats::printSummary(std::ostream& os, const Summary& s) {
+    double fps = s.meanMs > 0.0 ? 1000.0 / s.meanMs : 0.0;
+    os << "Frame Statistics (last " << s.windowSize << " of " << s.totalFrames << " frames):\n"
+       << "Min / Mean / Max: " << s.minMs << " / " << s.meanMs << " / " << s.maxMs << " ms\n"
+       << "P50 / P95 / P99: " << s.p50Ms << " / " << s.p95Ms << " / " << s.p99Ms << " ms\n"
+       << "Average FPS: " << fps << "\n"
+       << "----------------------------------------\n";
+    os.flush();
+}
+
+void FrameStats::writeJson(const std::string& path) const {
+    Summary s = summarize();
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Failed to open " + path + " for writing");
+    }
+    file << "{\n"
+         << "  \"totalFrames\": " << s.totalFrames << ",\n"
+         << "  \"windowSize\": " << s.windowSize << ",\n"
+         << "  \"minMs\": " << s.minMs << ",\n"
+         << "  \"meanMs\": " << s.meanMs << ",\n"
+         << "  \"p50Ms\": " << s.p50Ms << ",\n"
+         << "  \"p95Ms\": " << s.p95Ms << ",\n"
+         << "  \"p99Ms\": " << s.p99Ms << ",\n"
+         << "  \"maxMs\": " << s.maxMs << "\n"
+         << "}\n";
+}
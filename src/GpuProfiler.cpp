@@ -0,0 +1,213 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 12:00:00
+ * @Description  : Timestamp-query GPU profiler with named scopes
+ * @FilePath     : GpuProfiler.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "GpuProfiler.hpp"
+#include "imgui.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void GpuProfiler::create(ev::VulkanDevice* vulkanDevice, uint32_t framesInFlight, uint32_t maxScopesPerFrame) {
+    device = vulkanDevice;
+    maxQueries = maxScopesPerFrame * 2;
+
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(device->getPhysicalDevice(), &props);
+    timestampPeriodNs = static_cast<double>(props.limits.timestampPeriod);
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device->getPhysicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device->getPhysicalDevice(), &familyCount, families.data());
+    uint32_t validBits = 0;
+    if (device->getGraphicsQueueFamily() < familyCount) {
+        validBits = families[device->getGraphicsQueueFamily()].timestampValidBits;
+    }
+    // Queues without timestamp support report 0 valid bits; profiling is then a no-op
+    enabled = validBits > 0 && timestampPeriodNs > 0.0;
+    if (!enabled) {
+        return;
+    }
+    timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1ull);
+
+    slots.resize(framesInFlight);
+    for (auto& slot : slots) {
+        VkQueryPoolCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        info.queryCount = maxQueries;
+        if (vkCreateQueryPool(device->getLogicalDevice(), &info, nullptr, &slot.pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+    }
+}
+
+void GpuProfiler::destroy() {
+    if (!device) {
+        return;
+    }
+    for (auto& slot : slots) {
+        if (slot.pool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device->getLogicalDevice(), slot.pool, nullptr);
+            slot.pool = VK_NULL_HANDLE;
+        }
+    }
+    slots.clear();
+    currentSlot = nullptr;
+    if (csv.is_open()) {
+        csv.close();
+    }
+}
+
+void GpuProfiler::openCsv(const std::string& path) {
+    csv.open(path, std::ios::out | std::ios::trunc);
+    if (!csv) {
+        throw std::runtime_error("Failed to open " + path + " for writing");
+    }
+    csv << "frame,scope,gpu_ms\n";
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer cmd, uint32_t frameIndex) {
+    if (!enabled) {
+        return;
+    }
+    FrameSlot& slot = slots[frameIndex % slots.size()];
+    if (slot.submitted) {
+        collect(slot);
+    }
+    slot.scopes.clear();
+    slot.openScopes.clear();
+    slot.queryCount = 0;
+    slot.frameSerial = frameSerial++;
+    slot.submitted = true;
+    vkCmdResetQueryPool(cmd, slot.pool, 0, maxQueries);
+    currentSlot = &slot;
+}
+
+void GpuProfiler::resolveAll() {
+    if (!enabled) {
+        return;
+    }
+    std::vector<FrameSlot*> pending;
+    for (auto& slot : slots) {
+        if (slot.submitted) {
+            pending.push_back(&slot);
+        }
+    }
+    std::sort(pending.begin(), pending.end(),
+              [](const FrameSlot* a, const FrameSlot* b) { return a->frameSerial < b->frameSerial; });
+    for (FrameSlot* slot : pending) {
+        collect(*slot);
+        slot->submitted = false;
+    }
+    if (csv.is_open()) {
+        csv.flush();
+    }
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer cmd, const char* name) {
+    if (!enabled || !currentSlot || currentSlot->queryCount + 2 > maxQueries) {
+        return;
+    }
+    PendingScope scope;
+    scope.statIndex = findOrAddScope(name);
+    scope.beginQuery = currentSlot->queryCount++;
+    scope.endQuery = currentSlot->queryCount++;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, currentSlot->pool, scope.beginQuery);
+    currentSlot->openScopes.push_back(static_cast<uint32_t>(currentSlot->scopes.size()));
+    currentSlot->scopes.push_back(scope);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer cmd) {
+    if (!enabled || !currentSlot || currentSlot->openScopes.empty()) {
+        return;
+    }
+    const PendingScope& scope = currentSlot->scopes[currentSlot->openScopes.back()];
+    currentSlot->openScopes.pop_back();
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, currentSlot->pool, scope.endQuery);
+}
+
+void GpuProfiler::collect(FrameSlot& slot) {
+    if (slot.queryCount == 0) {
+        return;
+    }
+    // Pairs of (timestamp, availability)
+    std::vector<uint64_t> results(static_cast<size_t>(slot.queryCount) * 2, 0);
+    VkResult result = vkGetQueryPoolResults(
+        device->getLogicalDevice(), slot.pool, 0, slot.queryCount,
+        results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+        return;
+    }
+
+    for (const PendingScope& scope : slot.scopes) {
+        uint64_t begin = results[scope.beginQuery * 2];
+        uint64_t end = results[scope.endQuery * 2];
+        bool available = results[scope.beginQuery * 2 + 1] != 0 && results[scope.endQuery * 2 + 1] != 0;
+        if (!available) {
+            continue;
+        }
+        uint64_t ticks = ((end & timestampMask) - (begin & timestampMask)) & timestampMask;
+        double ms = static_cast<double>(ticks) * timestampPeriodNs * 1e-6;
+
+        ScopeStats& stat = stats[scope.statIndex];
+        History& history = histories[scope.statIndex];
+        if (history.count == kHistorySize) {
+            history.sum -= history.samples[history.next];
+        } else {
+            ++history.count;
+        }
+        history.samples[history.next] = ms;
+        history.sum += ms;
+        history.next = (history.next + 1) % kHistorySize;
+
+        stat.lastMs = ms;
+        stat.averageMs = history.sum / static_cast<double>(history.count);
+
+        if (csv.is_open()) {
+            csv << slot.frameSerial << ',' << stat.name << ',' << ms << '\n';
+        }
+    }
+}
+
+uint32_t GpuProfiler::findOrAddScope(const char* name) {
+    for (size_t i = 0; i < stats.size(); ++i) {
+        if (stats[i].name == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    ScopeStats stat;
+    stat.name = name;
+    stats.push_back(stat);
+    histories.emplace_back();
+    return static_cast<uint32_t>(stats.size() - 1);
+}
+
+void GpuProfiler::drawImGui() const {
+    ImGui::Separator();
+    ImGui::Text("GPU Timings (avg of last %d frames)", static_cast<int>(kHistorySize));
+    if (!enabled) {
+        ImGui::TextDisabled("Timestamps not supported on this queue");
+        return;
+    }
+    for (const ScopeStats& stat : stats) {
+        ImGui::Text("%-8s %7.3f ms (last %.3f)", stat.name.c_str(), stat.averageMs, stat.lastMs);
+    }
+}
+
+void GpuProfiler::printSummary(std::ostream& os) const {
+    if (!enabled) {
+        os << "GPU Timings: timestamps not supported\n";
+        return;
+    }
+    os << "GPU Timings (avg of last " << kHistorySize << " frames):\n";
+    for (const ScopeStats& stat : stats) {
+        os << "  " << stat.name << ": " << stat.averageMs << " ms\n";
+    }
+}
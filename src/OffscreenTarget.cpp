@@ -0,0 +1,143 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 10:00:00
+ * @Description  : Offscreen color targets used instead of the swapchain in headless mode
+ * @FilePath     : OffscreenTarget.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "OffscreenTarget.hpp"
+#include "PPMImage.hpp"
+
+#include <EasyVulkan/Builders/ImageBuilder.hpp>
+#include <EasyVulkan/Utils/ResourceUtils.hpp>
+
+#include <iostream>
+#include <stdexcept>
+#include <GLFW/glfw3.h>
+
+void OffscreenTarget::selectHeadlessPlatform() {
+#if defined(GLFW_PLATFORM_NULL)
+    // Init hints persist until the next glfwInit, which EasyVulkan performs
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+    std::cerr << "Warning: GLFW < 3.4 has no null platform; headless mode still needs a display\n";
+#endif
+}
+
+void OffscreenTarget::create(ev::ResourceManager* resourceManager,
+                             const std::string& name,
+                             uint32_t count,
+                             uint32_t width,
+                             uint32_t height,
+                             VkFormat imageFormat) {
+    extent = {width, height};
+    format = imageFormat;
+    images.resize(count);
+    imageViews.resize(count);
+    allocations.resize(count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        auto builder = resourceManager->createImage();
+        ev::ImageInfo info = builder
+            .setFormat(format)
+            .setExtent(width, height)
+            .setUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+            .build(name + "-" + std::to_string(i), &allocations[i]);
+        images[i] = info.image;
+        imageViews[i] = info.imageView;
+    }
+}
+
+void OffscreenTarget::writePPM(ev::VulkanDevice* device, VkCommandPool commandPool,
+                               uint32_t index, const std::string& path) const {
+    if (index >= images.size()) {
+        throw std::runtime_error("Offscreen target index out of range");
+    }
+    if (format != VK_FORMAT_R8G8B8A8_UNORM && format != VK_FORMAT_R8G8B8A8_SRGB &&
+        format != VK_FORMAT_B8G8R8A8_UNORM && format != VK_FORMAT_B8G8R8A8_SRGB) {
+        throw std::runtime_error("PPM export only supports 8-bit RGBA/BGRA targets");
+    }
+
+    VkDevice logicalDevice = device->getLogicalDevice();
+    const VkDeviceSize byteSize = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+    VmaAllocation stagingAlloc = VK_NULL_HANDLE;
+    VkBuffer staging = ev::ResourceUtils::createBuffer(
+        device,
+        byteSize,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        &stagingAlloc);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    if (vkAllocateCommandBuffers(logicalDevice, &allocInfo, &cmd) != VK_SUCCESS) {
+        vmaDestroyBuffer(device->getAllocator(), staging, stagingAlloc);
+        throw std::runtime_error("failed to allocate readback command buffer!");
+    }
+
+    VkCommandBufferBeginInfo begin{};
+    begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cmd, &begin);
+
+    // The render pass already left the image in TRANSFER_SRC; only make the writes visible
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = images[index];
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkCmdCopyImageToBuffer(cmd, images[index], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, staging, 1, &region);
+    vkEndCommandBuffer(cmd);
+
+    VkSubmitInfo submit{};
+    submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers = &cmd;
+    VkResult result = vkQueueSubmit(device->getGraphicsQueue(), 1, &submit, VK_NULL_HANDLE);
+    if (result == VK_SUCCESS) {
+        vkQueueWaitIdle(device->getGraphicsQueue());
+    }
+    vkFreeCommandBuffers(logicalDevice, commandPool, 1, &cmd);
+    if (result != VK_SUCCESS) {
+        vmaDestroyBuffer(device->getAllocator(), staging, stagingAlloc);
+        throw std::runtime_error("failed to submit readback command buffer!");
+    }
+
+    void* mapped = nullptr;
+    vmaMapMemory(device->getAllocator(), stagingAlloc, &mapped);
+    const auto* pixels = static_cast<const uint8_t*>(mapped);
+    const bool bgra = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+
+    ImageRGB8 image;
+    image.width = extent.width;
+    image.height = extent.height;
+    image.pixels.resize(static_cast<size_t>(extent.width) * extent.height * 3);
+    for (size_t i = 0, n = static_cast<size_t>(extent.width) * extent.height; i < n; ++i) {
+        image.pixels[i * 3 + 0] = pixels[i * 4 + (bgra ? 2 : 0)];
+        image.pixels[i * 3 + 1] = pixels[i * 4 + 1];
+        image.pixels[i * 3 + 2] = pixels[i * 4 + (bgra ? 0 : 2)];
+    }
+    vmaUnmapMemory(device->getAllocator(), stagingAlloc);
+    vmaDestroyBuffer(device->getAllocator(), staging, stagingAlloc);
+
+    ::writePPM(path, image);
+}
@@ -0,0 +1,92 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Binary PPM (P6) read/write and image comparison for golden-image checks
+ * @FilePath     : PPMImage.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PPMImage.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Next whitespace-separated header token, skipping '#' comments
+std::string readToken(std::istream& in) {
+    std::string token;
+    char c = 0;
+    while (in.get(c)) {
+        if (c == '#') {
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        } else if (!std::isspace(static_cast<unsigned char>(c))) {
+            token.push_back(c);
+            break;
+        }
+    }
+    while (in.get(c) && !std::isspace(static_cast<unsigned char>(c))) {
+        token.push_back(c);
+    }
+    return token;
+}
+
+} // namespace
+
+void writePPM(const std::string& path, const ImageRGB8& image) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open " + path + " for writing");
+    }
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+}
+
+ImageRGB8 readPPM(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    if (readToken(file) != "P6") {
+        throw std::runtime_error(path + " is not a binary PPM (P6)");
+    }
+    ImageRGB8 image;
+    try {
+        image.width = static_cast<uint32_t>(std::stoul(readToken(file)));
+        image.height = static_cast<uint32_t>(std::stoul(readToken(file)));
+        if (std::stoul(readToken(file)) != 255) {
+            throw std::runtime_error("");
+        }
+    } catch (const std::exception&) {
+        throw std::runtime_error(path + " has an unsupported PPM header");
+    }
+    // readToken consumed the single whitespace byte that ends the header
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * 3);
+    file.read(reinterpret_cast<char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+    if (static_cast<size_t>(file.gcount()) != image.pixels.size()) {
+        throw std::runtime_error(path + " is truncated");
+    }
+    return image;
+}
+
+ImageDiff compareImages(const ImageRGB8& a, const ImageRGB8& b) {
+    if (a.width != b.width || a.height != b.height || a.pixels.size() != b.pixels.size()) {
+        throw std::runtime_error("Cannot compare images of different sizes");
+    }
+    ImageDiff diff;
+    double sumSq = 0.0;
+    for (size_t i = 0; i < a.pixels.size(); ++i) {
+        int d = std::abs(static_cast<int>(a.pixels[i]) - static_cast<int>(b.pixels[i]));
+        diff.maxAbsDiff = std::max(diff.maxAbsDiff, d);
+        sumSq += static_cast<double>(d) * d;
+    }
+    double mse = a.pixels.empty() ? 0.0 : sumSq / static_cast<double>(a.pixels.size());
+    diff.rmse = std::sqrt(mse);
+    diff.psnrDb = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+    return diff;
+}
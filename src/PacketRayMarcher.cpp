@@ -0,0 +1,268 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 16:00:00
+ * @Description  : SIMD packet sphere tracing of the Cornell scene with runtime ISA dispatch
+ * @FilePath     : PacketRayMarcher.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PacketRayMarcher.hpp"
+#include "SDFMath.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+bool cpuSupports(SimdLevel level) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    switch (level) {
+        case SimdLevel::Scalar: return true;
+        case SimdLevel::SSE4: return __builtin_cpu_supports("sse4.1");
+        case SimdLevel::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case SimdLevel::AVX512: return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    int info[4];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    // The OS must also save the YMM/ZMM state on context switches
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    const bool avx512f = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+    switch (level) {
+        case SimdLevel::Scalar: return true;
+        case SimdLevel::SSE4: return sse41;
+        case SimdLevel::AVX2: return avx2 && fma;
+        case SimdLevel::AVX512: return avx512f;
+    }
+    return false;
+#else
+    return level == SimdLevel::Scalar;
+#endif
+}
+
+bool dispatch(SimdLevel level, const PacketMarchScene& scene, const RayBatch& rays) {
+    switch (level) {
+        case SimdLevel::Scalar: return marchRaysScalar(scene, rays);
+        case SimdLevel::SSE4: return marchRaysSSE4(scene, rays);
+        case SimdLevel::AVX2: return marchRaysAVX2(scene, rays);
+        case SimdLevel::AVX512: return marchRaysAVX512(scene, rays);
+    }
+    return false;
+}
+
+constexpr SimdLevel kAllLevels[] = {SimdLevel::Scalar, SimdLevel::SSE4, SimdLevel::AVX2, SimdLevel::AVX512};
+
+} // namespace
+
+const char* toString(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE4: return "sse4";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+SimdLevel parseSimdLevel(std::string_view name) {
+    if (name == "auto") {
+        return detectSimdLevel();
+    }
+    for (SimdLevel level : kAllLevels) {
+        if (name == toString(level)) {
+            if (!isSimdLevelAvailable(level)) {
+                throw std::runtime_error(std::string("SIMD level not supported by this build or CPU: ") + std::string(name));
+            }
+            return level;
+        }
+    }
+    throw std::runtime_error("Unknown SIMD level: " + std::string(name));
+}
+
+unsigned getSimdLaneCount(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return 1;
+        case SimdLevel::SSE4: return 4;
+        case SimdLevel::AVX2: return 8;
+        case SimdLevel::AVX512: return 16;
+    }
+    return 1;
+}
+
+bool isSimdLevelAvailable(SimdLevel level) {
+    // An empty batch only reports whether the kernel was compiled in
+    return cpuSupports(level) && dispatch(level, PacketMarchScene{}, RayBatch{});
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel best = [] {
+        SimdLevel result = SimdLevel::Scalar;
+        for (SimdLevel level : kAllLevels) {
+            if (isSimdLevelAvailable(level)) {
+                result = level;
+            }
+        }
+        return result;
+    }();
+    return best;
+}
+
+PacketMarchScene makePacketMarchScene(const SDFCornellUniforms& uniforms) {
+    PacketMarchScene scene;
+    for (int i = 0; i < 3; ++i) {
+        scene.sphereCenters[0][i] = uniforms.sphereCenters[0][i];
+        scene.sphereCenters[1][i] = uniforms.sphereCenters[1][i];
+    }
+    scene.sphereRadius = uniforms.sphereCenters[0][3];
+    return scene;
+}
+
+void marchRays(SimdLevel level, const PacketMarchScene& scene, const RayBatch& rays) {
+    if (!dispatch(level, scene, rays)) {
+        throw std::runtime_error(std::string("Packet ray marcher not compiled for ") + toString(level));
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              --bench-raymarch                              */
+/* -------------------------------------------------------------------------- */
+namespace {
+
+struct RaySoA {
+    std::vector<float> ox, oy, oz, dx, dy, dz, t;
+
+    explicit RaySoA(size_t n) : ox(n), oy(n), oz(n), dx(n), dy(n), dz(n), t(n) {}
+
+    RayBatch slice(size_t begin, size_t count) {
+        return {ox.data() + begin, oy.data() + begin, oz.data() + begin,
+                dx.data() + begin, dy.data() + begin, dz.data() + begin,
+                t.data() + begin, count};
+    }
+};
+
+// Primary rays of sdf_practice.frag main()
+RaySoA makeCameraRays(uint32_t width, uint32_t height) {
+    using namespace sdf;
+    RaySoA rays(static_cast<size_t>(width) * height);
+    const Vec3 ro(0.0f, 0.0f, 5.0f);
+    const Vec3 cw = normalize(Vec3(0.0f) - ro);
+    const Vec3 cu = normalize(cross(cw, Vec3(0.0f, 1.0f, 0.0f)));
+    const Vec3 cv = normalize(cross(cu, cw));
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            Vec2 uv = (Vec2((x + 0.5f) / width, (y + 0.5f) / height) - Vec2(0.5f)) * 2.0f;
+            uv.x *= static_cast<float>(width) / static_cast<float>(height);
+            Vec3 rd = normalize(cu * uv.x + cv * uv.y + cw * 1.2f);
+            size_t i = static_cast<size_t>(y) * width + x;
+            rays.ox[i] = ro.x; rays.oy[i] = ro.y; rays.oz[i] = ro.z;
+            rays.dx[i] = rd.x; rays.dy[i] = rd.y; rays.dz[i] = rd.z;
+        }
+    }
+    return rays;
+}
+
+// Repeat `pass` for at least `minSeconds`; returns rays per second
+template <typename Pass>
+double measureRaysPerSecond(size_t rayCount, double minSeconds, Pass&& pass) {
+    pass(); // warm-up
+    size_t passes = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    double elapsed = 0.0;
+    do {
+        pass();
+        ++passes;
+        elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return static_cast<double>(rayCount) * passes / elapsed;
+}
+
+} // namespace
+
+int runRayMarchBenchmark(const RunOptions& options) {
+    constexpr size_t kChunk = 4096; // rays per work-stealing task
+    constexpr double kMinSeconds = 0.5;
+
+    SDFCornellFrameInputs frame;
+    frame.time = options.fixedTime >= 0.0 ? static_cast<float>(options.fixedTime) : 0.0f;
+    frame.width = options.width;
+    frame.height = options.height;
+    const SDFCornellUniforms uniforms = makeCornellUniforms(SDFCornellSettings{}, frame);
+    const PacketMarchScene scene = makePacketMarchScene(uniforms);
+
+    RaySoA rays = makeCameraRays(options.width, options.height);
+    const size_t rayCount = rays.t.size();
+    WorkStealingPool pool(options.cpuThreads);
+    const size_t chunks = (rayCount + kChunk - 1) / kChunk;
+
+    marchRays(SimdLevel::Scalar, scene, rays.slice(0, rayCount));
+    const std::vector<float> reference = rays.t;
+
+    std::cout << "\nPacket Ray March Benchmark:\n";
+    std::cout << "Rays: " << options.width << "x" << options.height << " primary rays, t = "
+              << uniforms.iTime << " s, " << pool.getThreadCount() << " threads\n";
+    std::cout << std::left << std::setw(8) << "Level" << std::right << std::setw(6) << "Lanes"
+              << std::setw(16) << "1 core Mray/s" << std::setw(10) << "Speedup"
+              << std::setw(16) << "All Mray/s" << std::setw(16) << "Per core" << std::setw(12) << "Mismatch" << "\n";
+
+    double scalarRate = 0.0;
+    for (SimdLevel level : kAllLevels) {
+        if (!isSimdLevelAvailable(level)) {
+            std::cout << std::left << std::setw(8) << toString(level) << std::right << "  (not available)\n";
+            continue;
+        }
+        const double single = measureRaysPerSecond(rayCount, kMinSeconds, [&] {
+            marchRays(level, scene, rays.slice(0, rayCount));
+        });
+        const double all = measureRaysPerSecond(rayCount, kMinSeconds, [&] {
+            pool.parallelFor(chunks, [&](size_t chunk, unsigned) {
+                size_t begin = chunk * kChunk;
+                marchRays(level, scene, rays.slice(begin, std::min(kChunk, rayCount - begin)));
+            });
+        });
+        if (level == SimdLevel::Scalar) {
+            scalarRate = single;
+        }
+
+        // Hits must land on the same surface as the scalar march (FMA/ordering may move t slightly)
+        size_t mismatches = 0;
+        for (size_t i = 0; i < rayCount; ++i) {
+            bool hitA = reference[i] < packet_march::MAX_DIST;
+            bool hitB = rays.t[i] < packet_march::MAX_DIST;
+            if (hitA != hitB || (hitA && std::abs(reference[i] - rays.t[i]) > 1e-2f)) {
+                ++mismatches;
+            }
+        }
+
+        std::cout << std::left << std::setw(8) << toString(level) << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(6) << getSimdLaneCount(level)
+                  << std::setw(16) << single * 1e-6
+                  << std::setw(9) << (scalarRate > 0.0 ? single / scalarRate : 0.0) << "x"
+                  << std::setw(16) << all * 1e-6
+                  << std::setw(16) << all * 1e-6 / pool.getThreadCount()
+                  << std::setw(12) << mismatches << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "Best available: " << toString(detectSimdLevel()) << "\n";
+    std::cout << "----------------------------------------\n";
+    return EXIT_SUCCESS;
+}
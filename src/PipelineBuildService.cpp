@@ -0,0 +1,91 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 22:00:00
+ * @Description  : Worker threads that build pipelines off the render thread
+ * @FilePath     : PipelineBuildService.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PipelineBuildService.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+void PipelineBuildService::create(unsigned threadCount) {
+    if (!workers.empty()) {
+        throw std::runtime_error("PipelineBuildService already running");
+    }
+    if (threadCount == 0) {
+        // Drivers often compile on threads of their own; leave the cores to the render thread
+        threadCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+    }
+    stopping = false;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+void PipelineBuildService::destroy() {
+    std::deque<Job> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        cancelled.swap(queue);
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    for (Job& job : cancelled) {
+        job.result.set_value(BuiltPipeline{});
+    }
+}
+
+std::future<BuiltPipeline> PipelineBuildService::submit(BuildFunction build, bool urgent) {
+    Job job;
+    job.build = std::move(build);
+    std::future<BuiltPipeline> future = job.result.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (workers.empty() || stopping) {
+            throw std::runtime_error("PipelineBuildService::submit called while the service is not running");
+        }
+        if (urgent) {
+            queue.push_front(std::move(job));
+        } else {
+            queue.push_back(std::move(job));
+        }
+    }
+    wake.notify_one();
+    return future;
+}
+
+size_t PipelineBuildService::getQueuedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+void PipelineBuildService::workerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return; // destroy() resolves what is left in the queue
+            }
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        try {
+            BuiltPipeline built = job.build();
+            built.buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            job.result.set_value(built);
+        } catch (...) {
+            job.result.set_exception(std::current_exception());
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 14:00:00
+ * @Description  : VkPipelineCache persisted to disk between launches
+ * @FilePath     : PipelineCache.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PipelineCache.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x43505344u; // "SDPC"
+constexpr uint32_t kFileVersion = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint32_t reserved;
+    uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+    uint64_t dataSize;
+    uint64_t dataHash;
+};
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Returns an empty string when `header`/`blob` can seed a cache on this device
+std::string validate(const FileHeader& header, const std::vector<uint8_t>& blob,
+                     const VkPhysicalDeviceProperties& props) {
+    if (header.magic != kFileMagic || header.version != kFileVersion) {
+        return "unknown file format";
+    }
+    if (header.vendorID != props.vendorID || header.deviceID != props.deviceID) {
+        return "different GPU";
+    }
+    if (header.driverVersion != props.driverVersion) {
+        return "driver version changed";
+    }
+    if (std::memcmp(header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return "pipeline cache UUID changed";
+    }
+    if (header.dataSize != blob.size() || fnv1a(blob.data(), blob.size()) != header.dataHash) {
+        return "payload is truncated or corrupt";
+    }
+
+    // The driver checks its own header too, but some drivers crash on garbage instead.
+    // Layout (VK_PIPELINE_CACHE_HEADER_VERSION_ONE): size, version, vendor, device, UUID
+    constexpr size_t kVkHeaderSize = 16 + VK_UUID_SIZE;
+    if (blob.size() < kVkHeaderSize) {
+        return "payload too small";
+    }
+    uint32_t vkHeader[4];
+    std::memcpy(vkHeader, blob.data(), sizeof(vkHeader));
+    if (vkHeader[0] < kVkHeaderSize ||
+        vkHeader[1] != static_cast<uint32_t>(VK_PIPELINE_CACHE_HEADER_VERSION_ONE) ||
+        vkHeader[2] != props.vendorID || vkHeader[3] != props.deviceID ||
+        std::memcmp(blob.data() + 16, props.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return "driver header mismatch";
+    }
+    return {};
+}
+
+} // namespace
+
+void PipelineCache::create(ev::VulkanDevice* vulkanDevice, const std::string& cachePath) {
+    device = vulkanDevice;
+    path = cachePath;
+    warm = false;
+    vkGetPhysicalDeviceProperties(device->getPhysicalDevice(), &properties);
+
+    std::vector<uint8_t> blob;
+    if (!path.empty()) {
+        std::ifstream file(path, std::ios::binary);
+        if (file) {
+            FileHeader header{};
+            std::string reason;
+            if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+                header.dataSize <= (256ull << 20)) {
+                blob.resize(static_cast<size_t>(header.dataSize));
+                file.read(reinterpret_cast<char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+                if (static_cast<size_t>(file.gcount()) != blob.size()) {
+                    blob.resize(static_cast<size_t>(file.gcount()));
+                }
+                reason = validate(header, blob, properties);
+            } else {
+                reason = "unreadable header";
+            }
+            if (!reason.empty()) {
+                std::cout << "Pipeline cache: ignoring " << path << " (" << reason << ")\n";
+                blob.clear();
+            }
+        }
+    }
+
+    VkPipelineCacheCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.initialDataSize = blob.size();
+    info.pInitialData = blob.empty() ? nullptr : blob.data();
+    VkResult result = vkCreatePipelineCache(device->getLogicalDevice(), &info, nullptr, &cache);
+    if (result != VK_SUCCESS && !blob.empty()) {
+        // Valid-looking data the driver still rejects: fall back to an empty cache
+        std::cout << "Pipeline cache: driver rejected " << path << ", starting empty\n";
+        info.initialDataSize = 0;
+        info.pInitialData = nullptr;
+        blob.clear();
+        result = vkCreatePipelineCache(device->getLogicalDevice(), &info, nullptr, &cache);
+    }
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    warm = !blob.empty();
+    if (warm) {
+        std::cout << "Pipeline cache: loaded " << blob.size() << " bytes from " << path << "\n";
+    }
+}
+
+void PipelineCache::save() const {
+    if (cache == VK_NULL_HANDLE || path.empty()) {
+        return;
+    }
+    try {
+        VkDevice logicalDevice = device->getLogicalDevice();
+        size_t size = 0;
+        if (vkGetPipelineCacheData(logicalDevice, cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+            return;
+        }
+        std::vector<uint8_t> blob(size);
+        if (vkGetPipelineCacheData(logicalDevice, cache, &size, blob.data()) != VK_SUCCESS) {
+            return;
+        }
+        blob.resize(size);
+
+        FileHeader header{};
+        header.magic = kFileMagic;
+        header.version = kFileVersion;
+        header.vendorID = properties.vendorID;
+        header.deviceID = properties.deviceID;
+        header.driverVersion = properties.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+        header.dataSize = blob.size();
+        header.dataHash = fnv1a(blob.data(), blob.size());
+
+        const std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+            if (!file.flush()) {
+                std::cerr << "Pipeline cache: failed to write " << tempPath << "\n";
+                return;
+            }
+        }
+        std::filesystem::rename(tempPath, path);
+    } catch (const std::exception& e) {
+        std::cerr << "Pipeline cache: failed to save " << path << ": " << e.what() << "\n";
+    }
+}
+
+void PipelineCache::destroy() {
+    if (cache != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(device->getLogicalDevice(), cache, nullptr);
+        cache = VK_NULL_HANDLE;
+    }
+}
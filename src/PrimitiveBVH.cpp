@@ -0,0 +1,158 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 21:00:00
+ * @Description  : SAH bounding volume hierarchy over SDF primitive bounds
+ * @FilePath     : PrimitiveBVH.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PrimitiveBVH.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+using namespace sdf;
+
+namespace {
+
+// Relative cost of visiting a child node versus evaluating one primitive
+constexpr float kTraversalCost = 1.0f;
+
+} // namespace
+
+float Aabb3::getSurfaceArea() const {
+    if (isEmpty()) {
+        return 0.0f;
+    }
+    const Vec3 e = max - min;
+    return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+float Aabb3::distanceTo(Vec3 p) const {
+    return length(sdf::max(sdf::max(min - p, p - max), Vec3(0.0f)));
+}
+
+Aabb3 PrimitiveBVH::nodeBounds(const BvhNodeGpu& node) {
+    Aabb3 bounds;
+    bounds.min = Vec3(node.boundsMin[0], node.boundsMin[1], node.boundsMin[2]);
+    bounds.max = Vec3(node.boundsMax[0], node.boundsMax[1], node.boundsMax[2]);
+    return bounds;
+}
+
+void PrimitiveBVH::setNodeBounds(BvhNodeGpu& node, const Aabb3& bounds) {
+    for (int a = 0; a < 3; ++a) {
+        node.boundsMin[a] = bounds.min[a];
+        node.boundsMax[a] = bounds.max[a];
+    }
+}
+
+Aabb3 PrimitiveBVH::getBounds() const {
+    return nodes.empty() ? Aabb3{} : nodeBounds(nodes[0]);
+}
+
+void PrimitiveBVH::build(const std::vector<Aabb3>& primitiveBounds) {
+    nodes.clear();
+    order.resize(primitiveBounds.size());
+    std::iota(order.begin(), order.end(), 0u);
+    depth = 0;
+    if (primitiveBounds.empty()) {
+        return;
+    }
+    nodes.reserve(2 * primitiveBounds.size());
+    BvhNodeGpu root{};
+    root.leftOrFirst = 0;
+    root.count = static_cast<uint32_t>(primitiveBounds.size());
+    nodes.push_back(root);
+    subdivide(0, primitiveBounds, 1);
+}
+
+void PrimitiveBVH::subdivide(uint32_t nodeIndex, const std::vector<Aabb3>& primitiveBounds, uint32_t level) {
+    depth = std::max(depth, level);
+    const uint32_t first = nodes[nodeIndex].leftOrFirst;
+    const uint32_t count = nodes[nodeIndex].count;
+    Aabb3 bounds;
+    for (uint32_t i = 0; i < count; ++i) {
+        bounds.grow(primitiveBounds[order[first + i]]);
+    }
+    setNodeBounds(nodes[nodeIndex], bounds);
+    if (count == 1) {
+        return;
+    }
+
+    // Full SAH sweep over the centroids sorted along each axis
+    const auto begin = order.begin() + first;
+    const auto end = begin + count;
+    std::vector<float> rightArea(count);
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        std::sort(begin, end, [&](uint32_t a, uint32_t b) {
+            return primitiveBounds[a].getCenter()[axis] < primitiveBounds[b].getCenter()[axis];
+        });
+        Aabb3 right;
+        for (uint32_t i = count; i-- > 1;) {
+            right.grow(primitiveBounds[order[first + i]]);
+            rightArea[i] = right.getSurfaceArea();
+        }
+        Aabb3 left;
+        for (uint32_t i = 1; i < count; ++i) {
+            left.grow(primitiveBounds[order[first + i - 1]]);
+            const float cost = left.getSurfaceArea() * static_cast<float>(i) +
+                               rightArea[i] * static_cast<float>(count - i);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i;
+            }
+        }
+    }
+
+    // Leaf when splitting does not pay off (and the leaf stays small)
+    const float area = bounds.getSurfaceArea();
+    const float splitCost = area > 0.0f ? kTraversalCost + bestCost / area : static_cast<float>(count);
+    if (count <= kMaxLeafSize && splitCost >= static_cast<float>(count)) {
+        return;
+    }
+    if (level >= kMaxDepth) {
+        throw std::runtime_error("Primitive BVH deeper than " + std::to_string(kMaxDepth) + " levels");
+    }
+
+    std::sort(begin, end, [&](uint32_t a, uint32_t b) {
+        return primitiveBounds[a].getCenter()[bestAxis] < primitiveBounds[b].getCenter()[bestAxis];
+    });
+    const uint32_t left = static_cast<uint32_t>(nodes.size());
+    BvhNodeGpu child{};
+    child.leftOrFirst = first;
+    child.count = bestSplit;
+    nodes.push_back(child);
+    child.leftOrFirst = first + bestSplit;
+    child.count = count - bestSplit;
+    nodes.push_back(child);
+    nodes[nodeIndex].leftOrFirst = left;
+    nodes[nodeIndex].count = 0;
+    subdivide(left, primitiveBounds, level + 1);
+    subdivide(left + 1, primitiveBounds, level + 1);
+}
+
+void PrimitiveBVH::refit(const std::vector<Aabb3>& primitiveBounds) {
+    if (primitiveBounds.size() != order.size()) {
+        throw std::runtime_error("Primitive BVH refit with a different primitive count; rebuild instead");
+    }
+    // Children always sit after their parent
+    for (size_t i = nodes.size(); i-- > 0;) {
+        BvhNodeGpu& node = nodes[i];
+        Aabb3 bounds;
+        if (node.count > 0) {
+            for (uint32_t k = 0; k < node.count; ++k) {
+                bounds.grow(primitiveBounds[order[node.leftOrFirst + k]]);
+            }
+        } else {
+            bounds = nodeBounds(nodes[node.leftOrFirst]);
+            bounds.grow(nodeBounds(nodes[node.leftOrFirst + 1]));
+        }
+        setNodeBounds(node, bounds);
+    }
+}
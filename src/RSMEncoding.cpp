@@ -0,0 +1,128 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 23:55:00
+ * @Description  : Storage formats of the reflective shadow map attachments
+ * @FilePath     : RSMEncoding.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "RSMEncoding.hpp"
+#include "SDFCornellScene.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using sdf::Vec2;
+using sdf::Vec3;
+
+namespace {
+
+constexpr RSMEncoding kAllEncodings[] = {RSMEncoding::Full, RSMEncoding::Compact};
+
+float quantizeUnorm16(float v) {
+    return std::round(std::clamp(v, 0.0f, 1.0f) * 65535.0f) / 65535.0f;
+}
+
+float quantizeSnorm16(float v) {
+    return std::round(std::clamp(v, -1.0f, 1.0f) * 32767.0f) / 32767.0f;
+}
+
+// Unsigned float with a 5-bit exponent and `mantissaBits` (B10G11R11: 6, 6, 5),
+// rounded to nearest; negative and NaN inputs store 0, large ones the maximum
+float quantizeSmallFloat(float v, int mantissaBits) {
+    if (!(v > 0.0f)) {
+        return 0.0f;
+    }
+    const float maxValue = (2.0f - std::ldexp(1.0f, -mantissaBits)) * 32768.0f;
+    if (v >= maxValue) {
+        return maxValue;
+    }
+    // Below 2^-14 the spacing of the denormals
+    const int exponent = std::max(static_cast<int>(std::floor(std::log2(v))), -14);
+    const float step = std::ldexp(1.0f, exponent - mantissaBits);
+    return std::round(v / step) * step;
+}
+
+// Octahedral map of the unit sphere onto [-1, 1]^2 (rsm_encoding.glsl)
+Vec2 encodeOctahedral(Vec3 n) {
+    n = n / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+    if (n.z >= 0.0f) {
+        return Vec2(n.x, n.y);
+    }
+    return Vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+}
+
+Vec3 decodeOctahedral(Vec2 e) {
+    Vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+    const float t = std::clamp(-n.z, 0.0f, 1.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+} // namespace
+
+const char* toString(RSMEncoding encoding) {
+    switch (encoding) {
+        case RSMEncoding::Full: return "full";
+        case RSMEncoding::Compact: return "compact";
+    }
+    return "unknown";
+}
+
+RSMEncoding parseRSMEncoding(std::string_view name) {
+    for (RSMEncoding encoding : kAllEncodings) {
+        if (name == toString(encoding)) {
+            return encoding;
+        }
+    }
+    throw std::runtime_error("Unknown RSM encoding: " + std::string(name));
+}
+
+uint32_t getRSMBytesPerTexel(RSMEncoding encoding) {
+    // RGBA16F x3, or R16 + RG16 + B10G11R11
+    return encoding == RSMEncoding::Compact ? 2 + 4 + 4 : 3 * 8;
+}
+
+RSMLightFrame RSMLightFrame::fromUniforms(const SDFCornellUniforms& u) {
+    RSMLightFrame frame;
+    std::copy(u.lightOrigin, u.lightOrigin + 3, frame.origin);
+    frame.origin[3] = u.lightOrthoHalfSize[2];
+    std::copy(u.lightRight, u.lightRight + 3, frame.right);
+    frame.right[3] = u.lightOrthoHalfSize[0];
+    std::copy(u.lightUp, u.lightUp + 3, frame.up);
+    frame.up[3] = u.lightOrthoHalfSize[1];
+    const Vec3 dir = normalize(Vec3(u.lightDir[0], u.lightDir[1], u.lightDir[2]));
+    frame.dir[0] = dir.x;
+    frame.dir[1] = dir.y;
+    frame.dir[2] = dir.z;
+    return frame;
+}
+
+Vec3 RSMLightFrame::positionAt(Vec2 uv, float depth) const {
+    const Vec2 ndc = uv * 2.0f - Vec2(1.0f);
+    return Vec3(origin[0], origin[1], origin[2]) + Vec3(right[0], right[1], right[2]) * (ndc.x * right[3]) +
+           Vec3(up[0], up[1], up[2]) * (ndc.y * up[3]) + Vec3(dir[0], dir[1], dir[2]) * depth;
+}
+
+void roundTripRSMTexel(const RSMLightFrame& frame, Vec2 uv, Vec3& position, Vec3& normal, Vec3& flux) {
+    if (frame.origin[3] <= 0.5f) {
+        return; // Full: 16-bit floats are exact enough to leave alone
+    }
+    const float distance = dot(position - frame.positionAt(uv, 0.0f), Vec3(frame.dir[0], frame.dir[1], frame.dir[2]));
+    if (distance >= kRSMDepthRange) {
+        // Stored as a miss, like the ray leaving the scene
+        position = Vec3(0.0f);
+        normal = Vec3(0.0f);
+        flux = Vec3(0.0f);
+        return;
+    }
+    // Hits never round down to the miss value
+    position = frame.positionAt(uv, quantizeUnorm16(std::max(distance / kRSMDepthRange, 1.0f / 65535.0f)) * kRSMDepthRange);
+    const Vec2 e = encodeOctahedral(normal);
+    normal = decodeOctahedral(Vec2(quantizeSnorm16(e.x), quantizeSnorm16(e.y)));
+    flux = Vec3(quantizeSmallFloat(flux.x, 6), quantizeSmallFloat(flux.y, 6), quantizeSmallFloat(flux.z, 5));
+}
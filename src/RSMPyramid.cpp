@@ -0,0 +1,31 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 23:00:00
+ * @Description  : Layout of the RSM flux pyramid used for hierarchical VPL sampling
+ * @FilePath     : RSMPyramid.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "RSMPyramid.hpp"
+
+#include <stdexcept>
+#include <string>
+
+RSMPyramidLayout RSMPyramidLayout::make(uint32_t rsmWidth, uint32_t rsmHeight) {
+    const bool powerOfTwo = rsmWidth != 0 && (rsmWidth & (rsmWidth - 1)) == 0;
+    if (rsmWidth != rsmHeight || !powerOfTwo || rsmWidth < 2 * kClusterSize) {
+        throw std::runtime_error("RSM pyramid needs a square power-of-two RSM of at least " +
+                                 std::to_string(2 * kClusterSize) + " texels, got " +
+                                 std::to_string(rsmWidth) + "x" + std::to_string(rsmHeight));
+    }
+    RSMPyramidLayout layout;
+    layout.rsmSize = rsmWidth;
+    layout.baseSize = rsmWidth / 2;
+    while ((layout.baseSize >> layout.levelCount) != 0) {
+        ++layout.levelCount;
+    }
+    layout.atlasWidth = layout.baseSize + layout.baseSize / 2;
+    layout.atlasHeight = layout.baseSize;
+    layout.clusterCount = rsmWidth / kClusterSize;
+    return layout;
+}
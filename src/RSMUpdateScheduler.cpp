@@ -0,0 +1,201 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 17:00:00
+ * @Description  : Dirty tracking and amortized refresh of the reflective shadow map
+ * @FilePath     : RSMUpdateScheduler.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "RSMUpdateScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr RSMUpdateMode kAllModes[] = {RSMUpdateMode::EveryFrame, RSMUpdateMode::OnChange,
+                                       RSMUpdateMode::Interval, RSMUpdateMode::Budget};
+
+// Budget mode never waits longer than this, whatever the measured cost
+constexpr uint32_t kMaxBudgetInterval = 60;
+
+RSMRect getFullRect(const RSMInputs& inputs) {
+    return {0, 0, static_cast<uint32_t>(inputs.resolution[0]), static_cast<uint32_t>(inputs.resolution[1])};
+}
+
+// Texels an RSM rendered from `before` needs re-rendered to match `after`, when the
+// two differ in the spheres only; false when anything else changed
+bool getSphereDirtyRects(const RSMInputs& before, const RSMInputs& after, std::vector<RSMRect>& rects) {
+    RSMInputs rest = after;
+    std::copy(&before.sphereCenters[0][0], &before.sphereCenters[0][0] + 8, &rest.sphereCenters[0][0]);
+    std::copy(before.sphereColor, before.sphereColor + 3, rest.sphereColor);
+    if (rest != before) {
+        return false;
+    }
+    // The colour is shared, so a new one dirties both spheres where they are
+    const bool colorChanged = !std::equal(before.sphereColor, before.sphereColor + 3, after.sphereColor);
+    rects.clear();
+    for (int i = 0; i < 2; ++i) {
+        if (colorChanged || !std::equal(before.sphereCenters[i], before.sphereCenters[i] + 4, after.sphereCenters[i])) {
+            const RSMRect dirty = getRSMSphereFootprint(before, i).merged(getRSMSphereFootprint(after, i));
+            if (dirty.isEmpty()) {
+                continue;
+            }
+            // Texels drawn twice would cost twice
+            if (!rects.empty() && rects.back().overlaps(dirty)) {
+                rects.back() = rects.back().merged(dirty);
+            } else {
+                rects.push_back(dirty);
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+const char* toString(RSMUpdateMode mode) {
+    switch (mode) {
+        case RSMUpdateMode::EveryFrame: return "every";
+        case RSMUpdateMode::OnChange: return "change";
+        case RSMUpdateMode::Interval: return "interval";
+        case RSMUpdateMode::Budget: return "budget";
+    }
+    return "unknown";
+}
+
+RSMUpdateMode parseRSMUpdateMode(std::string_view name) {
+    for (RSMUpdateMode mode : kAllModes) {
+        if (name == toString(mode)) {
+            return mode;
+        }
+    }
+    throw std::runtime_error("Unknown RSM update mode: " + std::string(name));
+}
+
+RSMInputs RSMInputs::fromUniforms(const SDFCornellUniforms& u) {
+    RSMInputs in;
+    std::copy(u.lightDir, u.lightDir + 4, in.lightDir);
+    std::copy(u.lightColors[0], u.lightColors[0] + 4, in.lightColor);
+    std::copy(u.lightRight, u.lightRight + 4, in.lightRight);
+    std::copy(u.lightUp, u.lightUp + 4, in.lightUp);
+    std::copy(u.lightOrigin, u.lightOrigin + 4, in.lightOrigin);
+    std::copy(u.lightOrthoHalfSize, u.lightOrthoHalfSize + 3, in.lightOrthoHalfSize);
+    for (int i = 0; i < 2; ++i) {
+        std::copy(u.sphereCenters[i], u.sphereCenters[i] + 4, in.sphereCenters[i]);
+    }
+    std::copy(u.sphereColor, u.sphereColor + 3, in.sphereColor);
+    std::copy(u.rsmResolution, u.rsmResolution + 2, in.resolution);
+    return in;
+}
+
+bool RSMInputs::operator==(const RSMInputs& other) const {
+    // Exact comparison: the same uniforms produce the same RSM, anything else is a change
+    return std::memcmp(this, &other, sizeof(RSMInputs)) == 0;
+}
+
+bool RSMRect::overlaps(const RSMRect& other) const {
+    return !isEmpty() && !other.isEmpty() && x < other.x + other.width && other.x < x + width &&
+           y < other.y + other.height && other.y < y + height;
+}
+
+RSMRect RSMRect::merged(const RSMRect& other) const {
+    if (isEmpty()) {
+        return other;
+    }
+    if (other.isEmpty()) {
+        return *this;
+    }
+    const uint32_t x0 = std::min(x, other.x);
+    const uint32_t y0 = std::min(y, other.y);
+    const uint32_t x1 = std::max(x + width, other.x + other.width);
+    const uint32_t y1 = std::max(y + height, other.y + other.height);
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+RSMRect getRSMSphereFootprint(const RSMInputs& inputs, int sphere) {
+    const RSMRect full = getFullRect(inputs);
+    const float halfX = inputs.lightOrthoHalfSize[0];
+    const float halfY = inputs.lightOrthoHalfSize[1];
+    if (!(halfX > 0.0f && halfY > 0.0f)) {
+        return full;
+    }
+    // Orthographic: the sphere covers a circle of its radius around its centre's
+    // projection onto the (unit) right/up axes, mapped to texels as rsm_light.frag does
+    const float* c = inputs.sphereCenters[sphere];
+    float centerX = 0.0f;
+    float centerY = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        centerX += (c[k] - inputs.lightOrigin[k]) * inputs.lightRight[k];
+        centerY += (c[k] - inputs.lightOrigin[k]) * inputs.lightUp[k];
+    }
+    const float radius = c[3] + kRSMFootprintMargin;
+    auto toTexel = [](float coord, float half, float size) { return (coord / half * 0.5f + 0.5f) * size; };
+    const float x0 = std::floor(toTexel(centerX - radius, halfX, inputs.resolution[0])) - 1.0f;
+    const float x1 = std::ceil(toTexel(centerX + radius, halfX, inputs.resolution[0])) + 1.0f;
+    const float y0 = std::floor(toTexel(centerY - radius, halfY, inputs.resolution[1])) - 1.0f;
+    const float y1 = std::ceil(toTexel(centerY + radius, halfY, inputs.resolution[1])) + 1.0f;
+    const float clippedX0 = std::clamp(x0, 0.0f, inputs.resolution[0]);
+    const float clippedX1 = std::clamp(x1, 0.0f, inputs.resolution[0]);
+    const float clippedY0 = std::clamp(y0, 0.0f, inputs.resolution[1]);
+    const float clippedY1 = std::clamp(y1, 0.0f, inputs.resolution[1]);
+    if (clippedX1 <= clippedX0 || clippedY1 <= clippedY0) {
+        return RSMRect{};
+    }
+    return {static_cast<uint32_t>(clippedX0), static_cast<uint32_t>(clippedY0),
+            static_cast<uint32_t>(clippedX1 - clippedX0), static_cast<uint32_t>(clippedY1 - clippedY0)};
+}
+
+uint32_t RSMUpdateScheduler::framesBetweenRefreshes(double lastRenderMs) const {
+    switch (mode) {
+        case RSMUpdateMode::EveryFrame:
+        case RSMUpdateMode::OnChange:
+            return 1;
+        case RSMUpdateMode::Interval:
+            return interval;
+        case RSMUpdateMode::Budget:
+            if (lastRenderMs <= 0.0 || budgetMs <= 0.0) {
+                return 1;
+            }
+            return std::clamp(static_cast<uint32_t>(std::ceil(lastRenderMs / budgetMs)), 1u, kMaxBudgetInterval);
+    }
+    return 1;
+}
+
+bool RSMUpdateScheduler::shouldRender(const SDFCornellUniforms& uniforms, double lastRenderMs) {
+    const RSMInputs current = RSMInputs::fromUniforms(uniforms);
+    ++framesSinceRefresh;
+
+    bool render = !valid || mode == RSMUpdateMode::EveryFrame;
+    if (!render && current != rendered) {
+        render = framesSinceRefresh >= framesBetweenRefreshes(lastRenderMs);
+    }
+
+    if (render) {
+        partialRender = partialUpdates && valid && mode != RSMUpdateMode::EveryFrame &&
+                        getSphereDirtyRects(rendered, current, renderRects);
+        if (!partialRender) {
+            renderRects.assign(1, getFullRect(current));
+        }
+        renderBounds = RSMRect{};
+        for (const RSMRect& rect : renderRects) {
+            renderBounds = renderBounds.merged(rect);
+        }
+        rendered = current;
+        valid = true;
+        framesSinceRefresh = 0;
+        // Spheres moving outside the RSM leave nothing to redraw
+        render = !renderBounds.isEmpty();
+    }
+    if (render) {
+        ++stats.rendered;
+        stats.partial += partialRender ? 1 : 0;
+    } else {
+        ++stats.skipped;
+    }
+    stale = current != rendered;
+    return render;
+}
@@ -0,0 +1,197 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 10:00:00
+ * @Description  : Command line options shared by all scenes
+ * @FilePath     : RunOptions.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "RunOptions.hpp"
+
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+uint32_t parseCount(std::string_view flag, const char* value, unsigned long minValue = 1) {
+    std::string text(value);
+    size_t consumed = 0;
+    unsigned long parsed = 0;
+    try {
+        parsed = std::stoul(text, &consumed);
+    } catch (const std::exception&) {
+        consumed = 0;
+    }
+    if (consumed != text.size() || parsed < minValue || parsed > 16384ul * 16384ul) {
+        throw std::runtime_error("Invalid value for " + std::string(flag) + ": " + text);
+    }
+    return static_cast<uint32_t>(parsed);
+}
+
+double parseNonNegative(std::string_view flag, const char* value) {
+    std::string text(value);
+    size_t consumed = 0;
+    double parsed = -1.0;
+    try {
+        parsed = std::stod(text, &consumed);
+    } catch (const std::exception&) {
+        consumed = 0;
+    }
+    if (consumed != text.size() || !(parsed >= 0.0)) {
+        throw std::runtime_error("Invalid value for " + std::string(flag) + ": " + text);
+    }
+    return parsed;
+}
+
+} // namespace
+
+RunOptions parseRunOptions(int argc, char** argv) {
+    RunOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        auto nextValue = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + std::string(arg));
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            options.showHelp = true;
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--width") {
+            options.width = parseCount(arg, nextValue());
+        } else if (arg == "--height") {
+            options.height = parseCount(arg, nextValue());
+        } else if (arg == "--frames") {
+            options.frameCount = parseCount(arg, nextValue());
+        } else if (arg == "--output") {
+            options.outputPath = nextValue();
+        } else if (arg == "--profile-csv") {
+            options.profileCsvPath = nextValue();
+        } else if (arg == "--stats-interval") {
+            options.statsIntervalSeconds = parseNonNegative(arg, nextValue());
+        } else if (arg == "--stats-json") {
+            options.statsJsonPath = nextValue();
+        } else if (arg == "--pipeline-cache") {
+            options.pipelineCachePath = nextValue();
+        } else if (arg == "--no-pipeline-cache") {
+            options.usePipelineCache = false;
+        } else if (arg == "--fixed-time") {
+            options.fixedTime = parseNonNegative(arg, nextValue());
+        } else if (arg == "--no-brick-map") {
+            options.brickMap = false;
+        } else if (arg == "--enable-rsm") {
+            options.enableRSM = true;
+        } else if (arg == "--rsm-update") {
+            options.rsmUpdate = nextValue();
+        } else if (arg == "--rsm-interval") {
+            options.rsmInterval = parseCount(arg, nextValue());
+        } else if (arg == "--rsm-budget") {
+            options.rsmBudgetMs = parseNonNegative(arg, nextValue());
+        } else if (arg == "--no-rsm-partial") {
+            options.rsmPartialUpdates = false;
+        } else if (arg == "--rsm-encoding") {
+            options.rsmEncoding = nextValue();
+        } else if (arg == "--vpl-clusters") {
+            options.vplClusters = parseCount(arg, nextValue(), 0);
+        } else if (arg == "--vpl-sampling") {
+            options.vplSampling = nextValue();
+        } else if (arg == "--vpl-samples") {
+            options.vplSamples = parseCount(arg, nextValue());
+        } else if (arg == "--temporal-indirect") {
+            options.temporalIndirect = true;
+        } else if (arg == "--temporal-taps") {
+            options.temporalTaps = parseCount(arg, nextValue());
+        } else if (arg == "--indirect-divisor") {
+            options.indirectDivisor = parseCount(arg, nextValue());
+            if (options.indirectDivisor != 1 && options.indirectDivisor != 2 && options.indirectDivisor != 4) {
+                throw std::runtime_error("Invalid value for --indirect-divisor: must be 1, 2 or 4");
+            }
+        } else if (arg == "--restir") {
+            options.restir = true;
+        } else if (arg == "--restir-candidates") {
+            options.restirCandidates = parseCount(arg, nextValue());
+        } else if (arg == "--restir-neighbours") {
+            options.restirNeighbours = parseCount(arg, nextValue(), 0);
+        } else if (arg == "--show-indirect") {
+            options.showIndirectOnly = true;
+        } else if (arg == "--cpu-reference") {
+            options.cpuReference = true;
+        } else if (arg == "--threads") {
+            options.cpuThreads = parseCount(arg, nextValue());
+        } else if (arg == "--compare") {
+            options.comparePath = nextValue();
+        } else if (arg == "--min-psnr") {
+            options.minPsnrDb = parseNonNegative(arg, nextValue());
+        } else if (arg == "--simd") {
+            options.simdLevel = nextValue();
+        } else if (arg == "--bench-raymarch") {
+            options.benchRayMarch = true;
+        } else {
+            throw std::runtime_error("Unknown option: " + std::string(arg));
+        }
+    }
+    return options;
+}
+
+void printRunOptionsUsage(std::ostream& os, const char* programName) {
+    os << "Usage: " << (programName ? programName : "SDF") << " [options]\n"
+       << "  --headless         Render offscreen without a window or swapchain\n"
+       << "  --width <px>       Headless render width (default 1280)\n"
+       << "  --height <px>      Headless render height (default 720)\n"
+       << "  --frames <n>       Headless frame count before exit (default 300)\n"
+       << "  --output <file>    Write the last headless frame as a binary PPM\n"
+       << "  --profile-csv <f>  Stream per-pass GPU timings as CSV\n"
+       << "  --stats-interval <s> Print frame-time statistics every s seconds (0 = at exit only, default 2)\n"
+       << "  --stats-json <f>   Write frame-time statistics as JSON at exit\n"
+       << "  --pipeline-cache <f> Pipeline cache file (default <scene>.pipelinecache)\n"
+       << "  --no-pipeline-cache Build every pipeline from scratch\n"
+       << "  --fixed-time <s>   Pin the animation time to s seconds for every frame\n"
+       << "  --no-brick-map     3D: march the analytic scene only, without the baked brick map\n"
+       << "  --enable-rsm       Cornell: start with reflective shadow maps enabled\n"
+       << "  --rsm-update <m>   Cornell: RSM refresh policy: every, change, interval, budget (default change)\n"
+       << "  --rsm-interval <n> RSM update \"interval\": refresh at most every n frames (default 4)\n"
+       << "  --rsm-budget <ms>  RSM update \"budget\": average RSM cost per frame (default 1)\n"
+       << "  --no-rsm-partial   Cornell: re-render the whole RSM when only the spheres moved\n"
+       << "  --rsm-encoding <e> Cornell: RSM attachment formats: full, compact (default full)\n"
+       << "  --vpl-clusters <n> Cornell: shade indirect light from n k-means VPL clusters (64-1024, 0 = off)\n"
+       << "  --vpl-sampling <m> Cornell: RSM VPL sampling: uniform, importance, hierarchical (default hierarchical)\n"
+       << "  --vpl-samples <n> Hierarchical sampling: VPLs per pixel (1-16, default 4)\n"
+       << "  --temporal-indirect Cornell: accumulate indirect light over frames\n"
+       << "  --temporal-taps <n> Temporal accumulation: VPL taps per pixel and frame (1-16, default 4)\n"
+       << "  --indirect-divisor <n> Cornell: render indirect light at 1/n resolution: 1, 2, 4 (default 1)\n"
+       << "  --restir           Cornell: resample VPLs through spatiotemporal reservoirs\n"
+       << "  --restir-candidates <n> ReSTIR: initial VPL candidates per pixel and frame (1-32, default 8)\n"
+       << "  --restir-neighbours <n> ReSTIR: neighbour reservoirs each pixel merges (0-8, default 4)\n"
+       << "  --show-indirect    Cornell: show indirect lighting only\n"
+       << "  --cpu-reference    2D/Cornell: render on the CPU (uses --width/--height/--frames/--output)\n"
+       << "  --threads <n>      CPU reference worker threads (default: all cores)\n"
+       << "  --compare <ppm>    CPU reference: compare the last frame with a PPM image\n"
+       << "  --min-psnr <dB>    Fail --compare below this PSNR (default 30)\n"
+       << "  --simd <level>     CPU SIMD kernel (ray march / cone shadows): auto, scalar, sse4, avx2, avx512 (default auto)\n"
+       << "  --bench-raymarch   Benchmark the CPU ray marching kernels and exit\n"
+       << "  -h, --help         Show this message\n";
+}
+
+std::string resolvePipelineCachePath(const RunOptions& options, const char* sceneName) {
+    if (!options.usePipelineCache) {
+        return {};
+    }
+    if (!options.pipelineCachePath.empty()) {
+        return options.pipelineCachePath;
+    }
+    return std::string(sceneName) + ".pipelinecache";
+}
+
+void printHeadlessSummary(std::ostream& os, const RunOptions& options, double totalMs) {
+    double average = options.frameCount > 0 ? totalMs / options.frameCount : 0.0;
+    os << "\nHeadless Run Statistics:\n";
+    os << "Resolution: " << options.width << "x" << options.height << "\n";
+    os << "Total Frames: " << options.frameCount << "\n";
+    os << "Total Time: " << totalMs << " ms\n";
+    os << "Average Frame Time: " << average << " ms\n";
+    os << "Average FPS: " << (average > 0.0 ? 1000.0 / average : 0.0) << "\n";
+    os << "----------------------------------------\n";
+}
@@ -22,9 +22,14 @@
 #include <EasyVulkan/Builders/ComputePipelineBuilder.hpp>
 #include <EasyVulkan/Builders/SamplerBuilder.hpp>
 #include <EasyVulkan/Core/ImGuiManager.hpp>
+#include "ComputePipeline.hpp"
+#include "FullscreenPipeline.hpp"
 #include "imgui.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <random>
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -53,18 +58,25 @@ bool SDF2D::initVulkan() {
 }
 
 void SDF2D::initVulkanPC() {
-    // Get primary monitor resolution for full screen
-    if (!glfwInit()) {
-        throw std::runtime_error("Failed to initialize GLFW");
+    if (runOptions.headless) {
+        // No monitor to query: render at the requested size on GLFW's null platform
+        windowWidth = static_cast<int>(runOptions.width);
+        windowHeight = static_cast<int>(runOptions.height);
+        OffscreenTarget::selectHeadlessPlatform();
+    } else {
+        // Get primary monitor resolution for full screen
+        if (!glfwInit()) {
+            throw std::runtime_error("Failed to initialize GLFW");
+        }
+
+        GLFWmonitor* primaryMonitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode* mode = glfwGetVideoMode(primaryMonitor);
+        windowWidth = mode->width;
+        windowHeight = mode->height;
+
+        glfwTerminate(); // Will be reinitialized by VulkanContext
     }
     
-    GLFWmonitor* primaryMonitor = glfwGetPrimaryMonitor();
-    const GLFWvidmode* mode = glfwGetVideoMode(primaryMonitor);
-    windowWidth = mode->width;
-    windowHeight = mode->height;
-    
-    glfwTerminate(); // Will be reinitialized by VulkanContext
-    
     // Create the Vulkan context (with validation layer = true)
     context = std::make_unique<ev::VulkanContext>(true);
 
@@ -75,8 +87,10 @@ void SDF2D::initVulkanPC() {
     context->setDeviceFeatures(features);
     context->setInstanceExtensions({"VK_KHR_get_physical_device_properties2"});
 
-    // Enable ImGui and initialize the context. This will create a GLFW window of given size
-    context->enableImGui();
+    // Enable ImGui (not in headless mode) and initialize the context. This will create a GLFW window of given size
+    if (!runOptions.headless) {
+        context->enableImGui();
+    }
     // and set up everything needed in Vulkan up to swapchain creation.
     context->initialize(windowWidth, windowHeight);
 
@@ -87,24 +101,30 @@ void SDF2D::initVulkanPC() {
     swapchainManager = context->getSwapchainManager();
     syncManager      = context->getSynchronizationManager();
 
-    // Configure the swapchain usage/format
-    swapchainManager->setPreferredColorSpace(VK_COLOR_SPACE_PASS_THROUGH_EXT); // or VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
-    swapchainManager->setImageUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-                                    VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
-
-    swapchainManager->createSwapchain();
+    if (runOptions.headless) {
+        // One offscreen image per frame in flight stands in for the swapchain
+        offscreenTarget.create(resourceManager, "sdf2d-offscreen-color", frameNum,
+                               runOptions.width, runOptions.height, VK_FORMAT_R8G8B8A8_UNORM);
+    } else {
+        // Configure the swapchain usage/format
+        swapchainManager->setPreferredColorSpace(VK_COLOR_SPACE_PASS_THROUGH_EXT); // or VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
+        swapchainManager->setImageUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+
+        swapchainManager->createSwapchain();
+    }
 
     // Create our main render pass
     createRenderPass();
 
-    // Create FBs that directly wrap the swapchain images
+    // Create FBs that directly wrap the swapchain (or offscreen) images
     createFramebuffers();
 
     // Initialize ImGui with our render pass
     if (auto* imgui = context->getImGuiManager()) {
         imgui->initialize(
             renderPass,
-            static_cast<uint32_t>(swapchainManager->getSwapchainImageViews().size()),
+            static_cast<uint32_t>(getTargetCount()),
             VK_SAMPLE_COUNT_1_BIT);
             imgui->enableResourceMonitor(true);
     }
@@ -119,9 +139,36 @@ void SDF2D::initVulkanPC() {
     createUniformBuffer();
     createDescriptorSetLayout();
     createDescriptorSets();
+    createDistanceResources();
+    createPolarShadowResources();
+    createLightResources();
+    createSceneTextureSets();
 
     // Create triangle rendering pipeline (now with descriptor sets)
-    createPipeline();
+    pipelineCache.create(device, resolvePipelineCachePath(runOptions, "SDF2D"));
+    pipelineBuilds.create();
+    auto pipelineStart = std::chrono::high_resolution_clock::now();
+    // The four pipelines compile in parallel on the build workers
+    std::future<BuiltPipeline> triangleBuild = createPipeline();
+    std::future<BuiltPipeline> distanceBuild = createDistancePipeline();
+    std::future<BuiltPipeline> polarShadowBuild = createPolarShadowPipeline();
+    std::future<BuiltPipeline> lightBinningBuild = createLightBinningPipeline();
+    BuiltPipeline built = triangleBuild.get();
+    trianglePipeline = built.pipeline;
+    trianglePipelineLayout = built.layout;
+    built = distanceBuild.get();
+    distancePipeline = built.pipeline;
+    distancePipelineLayout = built.layout;
+    built = polarShadowBuild.get();
+    polarShadowPipeline = built.pipeline;
+    polarShadowPipelineLayout = built.layout;
+    built = lightBinningBuild.get();
+    lightBinningPipeline = built.pipeline;
+    lightBinningPipelineLayout = built.layout;
+    pipelineBuilds.destroy(); // nothing is built after startup
+    std::cout << "Pipeline build: "
+              << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - pipelineStart).count()
+              << " ms (" << (pipelineCache.isWarm() ? "warm" : "cold") << " cache)\n";
 
     // Allocate command buffers (recorded each frame to include ImGui)
     createCommandBuffers();
@@ -131,50 +178,98 @@ void SDF2D::initVulkanPC() {
 
     // Setup frame synchronization (triple buffering)
     syncManager->createFrameSynchronization(frameNum);
+
+    // GPU timestamp profiler
+    gpuProfiler.create(device, frameNum);
+    if (!runOptions.profileCsvPath.empty()) {
+        gpuProfiler.openCsv(runOptions.profileCsvPath);
+    }
 }
 
 
 void SDF2D::mainLoop() {
-    int frameCount = 0;
-    double totalTime = 0.0;
-    std::vector<double> frameTimes;  // Store individual frame times
-    
+    if (runOptions.headless) {
+        mainLoopHeadless();
+        return;
+    }
+
+    startFrameStats();
     while (!glfwWindowShouldClose(device->getWindow())) {
         auto frameStart = std::chrono::high_resolution_clock::now();
         
         glfwPollEvents();
         drawFrame();
         
-        frameCount++;
+        // Fixed-size ring buffer; printing happens on the reporter thread, not here
         auto frameEnd = std::chrono::high_resolution_clock::now();
-        auto frameDuration = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
-        
-        // Store frame time
-        frameTimes.push_back(frameDuration);
-        
-        // Only add to total time after first two frames
-        if (frameCount > 2) {
-            totalTime += frameDuration;
-        }
-        
-        // Print statistics every framePauseInterval frames
-        if (frameCount % framePauseInterval == 0 && frameCount > 2) {
-            double averageFrameTime = totalTime / (frameCount - 2);  // Exclude first two frames
-            double fps = 1000.0 / averageFrameTime;
-            
-            // Current frame time
-            double currentFrameTime = frameTimes.back();
-            
-            std::cout << "Frame Statistics:\n";
-            std::cout << "Current Frame Time: " << currentFrameTime << " ms\n";
-            std::cout << "Average Frame Time (excluding first 2 frames): " << averageFrameTime << " ms\n";
-            std::cout << "Average FPS: " << fps << "\n";
-            std::cout << "Total Frames: " << frameCount << "\n";
-            std::cout << "----------------------------------------\n";
-        }
+        frameStats.addSample(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
     }
 
     vkDeviceWaitIdle(device->getLogicalDevice());
+    gpuProfiler.resolveAll();
+    finishFrameStats();
+}
+
+void SDF2D::startFrameStats() {
+    if (runOptions.statsIntervalSeconds > 0.0) {
+        frameStats.startReporter(
+            std::chrono::milliseconds(static_cast<int64_t>(runOptions.statsIntervalSeconds * 1000.0)),
+            std::cout);
+    }
+}
+
+void SDF2D::finishFrameStats() {
+    frameStats.stopReporter();
+    FrameStats::printSummary(std::cout, frameStats.summarize());
+    if (!runOptions.statsJsonPath.empty()) {
+        frameStats.writeJson(runOptions.statsJsonPath);
+    }
+}
+
+void SDF2D::mainLoopHeadless() {
+    startFrameStats();
+    auto runStart = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < runOptions.frameCount; ++i) {
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        drawFrame();
+        auto frameEnd = std::chrono::high_resolution_clock::now();
+        frameStats.addSample(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+    }
+    vkDeviceWaitIdle(device->getLogicalDevice());
+    auto runEnd = std::chrono::high_resolution_clock::now();
+    gpuProfiler.resolveAll();
+    printHeadlessSummary(std::cout, runOptions,
+                         std::chrono::duration<double, std::milli>(runEnd - runStart).count());
+    gpuProfiler.printSummary(std::cout);
+    finishFrameStats();
+
+    if (!runOptions.outputPath.empty()) {
+        uint32_t lastIndex = (currentFrame + frameNum - 1) % frameNum;
+        offscreenTarget.writePPM(device, commandPool, lastIndex, runOptions.outputPath);
+        std::cout << "Wrote last frame to " << runOptions.outputPath << "\n";
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Render Targets                               */
+/* -------------------------------------------------------------------------- */
+size_t SDF2D::getTargetCount() const {
+    return getTargetImageViews().size();
+}
+
+VkExtent2D SDF2D::getTargetExtent() const {
+    return runOptions.headless ? offscreenTarget.getExtent() : swapchainManager->getSwapchainExtent();
+}
+
+VkFormat SDF2D::getTargetFormat() const {
+    return runOptions.headless ? offscreenTarget.getFormat() : swapchainManager->getSwapchainImageFormat();
+}
+
+std::vector<VkImageView> SDF2D::getTargetImageViews() const {
+    if (runOptions.headless) {
+        return offscreenTarget.getImageViews();
+    }
+    return swapchainManager->getSwapchainImageViews();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -185,12 +280,13 @@ void SDF2D::createRenderPass() {
     auto  renderPassBuilder = resourceManager->createRenderPass();
     // One color attachment matching the swapchain format:
     renderPassBuilder.addColorAttachment(
-        swapchainManager->getSwapchainImageFormat(),
+        getTargetFormat(),
         VK_SAMPLE_COUNT_1_BIT,
         VK_ATTACHMENT_LOAD_OP_CLEAR,     // Clear at start
         VK_ATTACHMENT_STORE_OP_STORE,    // Store color so we can see it
         VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        // Headless frames are never presented; keep them ready for readback
+        runOptions.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 
     // Single subpass
     renderPassBuilder.beginSubpass()
@@ -204,8 +300,8 @@ void SDF2D::createRenderPass() {
 /*                           Swapchain Framebuffers                           */
 /* -------------------------------------------------------------------------- */
 void SDF2D::createFramebuffers() {
-    const auto& swapchainImageViews = swapchainManager->getSwapchainImageViews();
-    const auto& swapchainExtent = swapchainManager->getSwapchainExtent();
+    const auto swapchainImageViews = getTargetImageViews();
+    const auto swapchainExtent = getTargetExtent();
     
     framebuffers.resize(swapchainImageViews.size());
     
@@ -244,7 +340,7 @@ void SDF2D::createVertexBuffer() {
 /* -------------------------------------------------------------------------- */
 /*                            Triangle Pipeline Setup                          */
 /* -------------------------------------------------------------------------- */
-void SDF2D::createPipeline() {
+std::future<BuiltPipeline> SDF2D::createPipeline() {
     // Create vertex shader module
     std::string vertShaderPath = "shaders/triangle.vert.spv";
     auto vertShader = resourceManager->createShaderModule()
@@ -283,37 +379,337 @@ void SDF2D::createPipeline() {
     attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
     attributeDescriptions[2].offset = offsetof(TriangleVertex, texCoord);
 
-    // Create a basic pipeline (this would need actual shaders in a real implementation)
-    auto pipelineBuilder = resourceManager->createGraphicsPipeline();
-    trianglePipeline = pipelineBuilder
-            // Add shader stages
-            .addShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertShader)
-            .addShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragShader)
-            // Configure vertex input
-            .setVertexInputState(bindingDescription, std::vector<VkVertexInputAttributeDescription>(attributeDescriptions.begin(), attributeDescriptions.end()))
-            .setInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP)
-            .setDynamicState({VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR})
-            // Ensure the triangle is not accidentally culled and depth test is disabled (no depth attachment)
-            .setDepthStencilState(VK_FALSE, VK_FALSE, VK_COMPARE_OP_ALWAYS)
-            // Configure blending
-            .setColorBlendState(
-                {VkPipelineColorBlendAttachmentState{VK_FALSE, // blendEnable (no blending for channel extraction)
-                                                     VK_BLEND_FACTOR_ONE,  // srcColorBlendFactor
-                                                     VK_BLEND_FACTOR_ZERO, // dstColorBlendFactor
-                                                     VK_BLEND_OP_ADD,      // colorBlendOp
-                                                     VK_BLEND_FACTOR_ONE,  // srcAlphaBlendFactor
-                                                     VK_BLEND_FACTOR_ZERO, // dstAlphaBlendFactor
-                                                     VK_BLEND_OP_ADD,      // alphaBlendOp
-                                                     VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-                                                         VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT}})
-            // Set render pass
-            .setRenderPass(renderPass, 0)
-            // Set descriptor set layout
-            .setDescriptorSetLayouts({descriptorSetLayout}) // Include our uniform buffer layout
-            // Build the pipeline
-            .build("sdf-pipeline");
-
-    trianglePipelineLayout = pipelineBuilder.getPipelineLayout();
+    // Fullscreen strip, no depth, no blending; built through the persistent pipeline cache
+    FullscreenPipelineDesc desc;
+    desc.vertexShader = vertShader;
+    desc.fragmentShader = fragShader;
+    desc.vertexBinding = bindingDescription;
+    desc.vertexAttributes.assign(attributeDescriptions.begin(), attributeDescriptions.end());
+    desc.renderPass = renderPass;
+    desc.setLayouts = {descriptorSetLayout, sceneTextureLayout};
+    VkDevice logicalDevice = device->getLogicalDevice();
+    VkPipelineCache cache = pipelineCache.get();
+    return pipelineBuilds.submit([logicalDevice, cache, desc] {
+        BuiltPipeline built;
+        built.pipeline = createFullscreenPipeline(logicalDevice, cache, desc, &built.layout);
+        return built;
+    });
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Baked Scene Textures                            */
+/* -------------------------------------------------------------------------- */
+void SDF2D::createDistanceResources() {
+    // Full-resolution float field in pixel units, so the fragment shader's own
+    // pixel reads it back exactly and shadow rays bilinearly in between
+    VkExtent2D extent = getTargetExtent();
+    distanceImages.resize(frameNum);
+    distanceViews.resize(frameNum);
+    distanceAllocs.resize(frameNum);
+    auto imgBuilder = resourceManager->createImage();
+    for (int i = 0; i < frameNum; ++i) {
+        ev::ImageInfo info = imgBuilder
+            .setFormat(VK_FORMAT_R32_SFLOAT)
+            .setExtent(extent.width, extent.height)
+            .setUsage(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+            .build(std::string("sdf2d_distance_") + std::to_string(i), &distanceAllocs[i]);
+        distanceImages[i] = info.image;
+        distanceViews[i] = info.imageView;
+    }
+
+    // Filtered by hand in the shader (texelFetch), the sampler only has to exist
+    distanceSampler = resourceManager->createSampler()
+        .setMagFilter(VK_FILTER_NEAREST)
+        .setMinFilter(VK_FILTER_NEAREST)
+        .setAddressModeU(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+        .setAddressModeV(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+        .build("sdf2d_distance_sampler");
+}
+
+void SDF2D::createPolarShadowResources() {
+    // x = occluder distance along the ray, y = nearest occluder within the blocker
+    // search window; both in pixels from the light centre
+    polarShadowImages.resize(frameNum);
+    polarShadowViews.resize(frameNum);
+    polarShadowAllocs.resize(frameNum);
+    auto imgBuilder = resourceManager->createImage();
+    for (int i = 0; i < frameNum; ++i) {
+        ev::ImageInfo info = imgBuilder
+            .setFormat(VK_FORMAT_R32G32_SFLOAT)
+            .setExtent(kPolarShadowResolution, kPolarShadowRows)
+            .setUsage(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+            .build(std::string("sdf2d_polar_shadow_") + std::to_string(i), &polarShadowAllocs[i]);
+        polarShadowImages[i] = info.image;
+        polarShadowViews[i] = info.imageView;
+    }
+}
+
+void SDF2D::createSceneTextureSets() {
+    sceneTextureLayout = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+        .createLayout("sdf2d_scene_texture_layout");
+    bakeComputeLayout = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .createLayout("sdf2d_bake_compute_layout");
+
+    // All sets are indexed by frame in flight, like the UBO slices
+    sceneTextureSets.resize(frameNum);
+    distanceComputeSets.resize(frameNum);
+    polarShadowComputeSets.resize(frameNum);
+    for (int i = 0; i < frameNum; ++i) {
+        sceneTextureSets[i] = resourceManager->createDescriptorSet()
+            .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addImageDescriptor(0, distanceViews[i], distanceSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addImageDescriptor(1, polarShadowViews[i], distanceSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+            .addBufferDescriptor(2, tileLightBuffers[i], 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .build(sceneTextureLayout, std::string("sdf2d_scene_texture_set_") + std::to_string(i));
+        distanceComputeSets[i] = resourceManager->createDescriptorSet()
+            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBufferDescriptor(0, uniformRing.getBuffer(), 0, sizeof(ShaderToyUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+            .addBufferDescriptor(2, lightRing.getBuffer(), 0, lightRing.getSliceSize(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+            .addImageDescriptor(1, distanceViews[i], VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            .build(bakeComputeLayout, std::string("sdf2d_distance_compute_set_") + std::to_string(i));
+        polarShadowComputeSets[i] = resourceManager->createDescriptorSet()
+            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBufferDescriptor(0, uniformRing.getBuffer(), 0, sizeof(ShaderToyUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+            .addBufferDescriptor(2, lightRing.getBuffer(), 0, lightRing.getSliceSize(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+            .addImageDescriptor(1, polarShadowViews[i], VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            .build(bakeComputeLayout, std::string("sdf2d_polar_shadow_compute_set_") + std::to_string(i));
+    }
+}
+
+std::future<BuiltPipeline> SDF2D::submitComputePipeline(const ComputePipelineDesc& desc) {
+    VkDevice logicalDevice = device->getLogicalDevice();
+    VkPipelineCache cache = pipelineCache.get();
+    return pipelineBuilds.submit([logicalDevice, cache, desc] {
+        BuiltPipeline built;
+        built.pipeline = createComputePipeline(logicalDevice, cache, desc, &built.layout);
+        return built;
+    });
+}
+
+std::future<BuiltPipeline> SDF2D::createDistancePipeline() {
+    auto compShader = resourceManager->createShaderModule()
+                          .loadFromFile("shaders/sdf2d_distance.comp.spv")
+                          .build("sdf2d-distance-compute-shader");
+    ComputePipelineDesc desc;
+    desc.computeShader = compShader;
+    desc.setLayouts = {bakeComputeLayout};
+    return submitComputePipeline(desc);
+}
+
+std::future<BuiltPipeline> SDF2D::createPolarShadowPipeline() {
+    auto compShader = resourceManager->createShaderModule()
+                          .loadFromFile("shaders/sdf2d_polar_shadow.comp.spv")
+                          .build("sdf2d-polar-shadow-compute-shader");
+    ComputePipelineDesc desc;
+    desc.computeShader = compShader;
+    desc.setLayouts = {bakeComputeLayout};
+    return submitComputePipeline(desc);
+}
+
+void SDF2D::recordDistancePass(VkCommandBuffer cmd) {
+    // This frame slot's image was last read by the frame whose fence was just
+    // waited on, so its old contents can be discarded (oldLayout UNDEFINED)
+    VkImage image = distanceImages[currentFrame];
+    if (!useDistanceTexture) {
+        // Still bound to the fragment pass, which then calls sceneDist() directly
+        imageBarrier(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     0, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        return;
+    }
+
+    gpuProfiler.beginScope(cmd, "Distance");
+    imageBarrier(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                 0, VK_ACCESS_SHADER_WRITE_BIT,
+                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, distancePipeline);
+    uint32_t dynamicOffsets[] = {uniformRing.getDynamicOffset(currentFrame), lightRing.getDynamicOffset(currentFrame)};
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, distancePipelineLayout,
+                            0, 1, &distanceComputeSets[currentFrame], 2, dynamicOffsets);
+    VkExtent2D extent = getTargetExtent();
+    vkCmdDispatch(cmd, dispatchGroupCount(extent.width, 8), dispatchGroupCount(extent.height, 8), 1);
+
+    imageBarrier(cmd, image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                 VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    gpuProfiler.endScope(cmd);
+}
+
+void SDF2D::recordPolarShadowPass(VkCommandBuffer cmd) {
+    VkImage image = polarShadowImages[currentFrame];
+    if (!usePolarShadows || activeLightCount == 0) {
+        imageBarrier(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     0, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        return;
+    }
+
+    gpuProfiler.beginScope(cmd, "PolarShadow");
+    imageBarrier(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                 0, VK_ACCESS_SHADER_WRITE_BIT,
+                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    // One workgroup row per light, 256 angles per workgroup
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, polarShadowPipeline);
+    uint32_t dynamicOffsets[] = {uniformRing.getDynamicOffset(currentFrame), lightRing.getDynamicOffset(currentFrame)};
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, polarShadowPipelineLayout,
+                            0, 1, &polarShadowComputeSets[currentFrame], 2, dynamicOffsets);
+    vkCmdDispatch(cmd, dispatchGroupCount(kPolarShadowResolution, 256), activeLightCount, 1);
+
+    imageBarrier(cmd, image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                 VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    gpuProfiler.endScope(cmd);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              Light List & Tiles                            */
+/* -------------------------------------------------------------------------- */
+void SDF2D::createLightResources() {
+    VkExtent2D extent = getTargetExtent();
+    tileColumns = dispatchGroupCount(extent.width, kLightTileSize);
+    tileRows = dispatchGroupCount(extent.height, kLightTileSize);
+    const VkDeviceSize tileBufferSize = VkDeviceSize(tileColumns) * tileRows * kLightTileStride * sizeof(uint32_t);
+
+    lightBinningLayout = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .createLayout("sdf2d_light_binning_layout");
+
+    tileLightBuffers.resize(frameNum);
+    lightBinningSets.resize(frameNum);
+    for (int i = 0; i < frameNum; ++i) {
+        tileLightBuffers[i] = resourceManager->createBuffer()
+            .setSize(tileBufferSize)
+            .setUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+            .setMemoryProperties(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+            .build(std::string("sdf2d_tile_lights_") + std::to_string(i));
+        lightBinningSets[i] = resourceManager->createDescriptorSet()
+            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBufferDescriptor(0, uniformRing.getBuffer(), 0, sizeof(ShaderToyUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+            .addBufferDescriptor(2, lightRing.getBuffer(), 0, lightRing.getSliceSize(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+            .addBufferDescriptor(3, tileLightBuffers[i], 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .build(lightBinningLayout, std::string("sdf2d_light_binning_set_") + std::to_string(i));
+    }
+}
+
+std::future<BuiltPipeline> SDF2D::createLightBinningPipeline() {
+    auto compShader = resourceManager->createShaderModule()
+                          .loadFromFile("shaders/sdf2d_light_binning.comp.spv")
+                          .build("sdf2d-light-binning-compute-shader");
+    ComputePipelineDesc desc;
+    desc.computeShader = compShader;
+    desc.setLayouts = {lightBinningLayout};
+    return submitComputePipeline(desc);
+}
+
+void SDF2D::recordLightBinningPass(VkCommandBuffer cmd) {
+    if (!useTiledLighting) {
+        return; // the fragment shader loops over the whole list instead
+    }
+
+    // One thread per tile; the previous reader of this frame slot's buffer has retired
+    gpuProfiler.beginScope(cmd, "LightBinning");
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, lightBinningPipeline);
+    uint32_t dynamicOffsets[] = {uniformRing.getDynamicOffset(currentFrame), lightRing.getDynamicOffset(currentFrame)};
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, lightBinningPipelineLayout,
+                            0, 1, &lightBinningSets[currentFrame], 2, dynamicOffsets);
+    vkCmdDispatch(cmd, dispatchGroupCount(tileColumns, 8), dispatchGroupCount(tileRows, 8), 1);
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = tileLightBuffers[currentFrame];
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+    gpuProfiler.endScope(cmd);
+}
+
+void SDF2D::uploadLights(float time, float width) {
+    const std::vector<Light2DGpu> gpuLights = makeSDF2DLights(lights, time, width, kMaxLights);
+    activeLightCount = static_cast<uint32_t>(gpuLights.size());
+    if (!gpuLights.empty()) {
+        lightRing.write(currentFrame, gpuLights.data(), gpuLights.size() * sizeof(Light2DGpu));
+    }
+}
+
+void SDF2D::drawLightListImGui(const VkExtent2D& extent) {
+    const float width = static_cast<float>(extent.width);
+    const float height = static_cast<float>(extent.height);
+
+    ImGui::Text("Lights: %u active / %u (max %u)", activeLightCount,
+                static_cast<uint32_t>(lights.size()), kMaxLights);
+    ImGui::Checkbox("Tiled Light Culling", &useTiledLighting);
+    if (ImGui::Button("Add Light") && lights.size() < kMaxLights) {
+        SceneLight2D light;
+        light.position[0] = width * 0.5f;
+        light.position[1] = height * 0.5f;
+        lights.push_back(light);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Add 32 Random")) {
+        // Small, dim lights scattered over the screen: the case tiling is for
+        std::mt19937 rng(randomLightSeed++);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (int i = 0; i < 32 && lights.size() < kMaxLights; ++i) {
+            SceneLight2D light;
+            light.position[0] = unit(rng) * width;
+            light.position[1] = unit(rng) * height;
+            light.radius = 4.0f + unit(rng) * 8.0f;
+            light.color[0] = 0.3f + 0.7f * unit(rng);
+            light.color[1] = 0.3f + 0.7f * unit(rng);
+            light.color[2] = 0.3f + 0.7f * unit(rng);
+            light.luminance = 0.3f;
+            lights.push_back(light);
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear")) {
+        lights.clear();
+    }
+
+    for (size_t i = 0; i < lights.size(); ++i) {
+        SceneLight2D& light = lights[i];
+        ImGui::PushID(static_cast<int>(i));
+        if (ImGui::TreeNode("light", "Light %u%s", static_cast<uint32_t>(i + 1), light.enabled ? "" : " (off)")) {
+            ImGui::Checkbox("On", &light.enabled);
+            ImGui::SliderFloat("Radius", &light.radius, 0.0f, 100.0f, "%.1f");
+            ImGui::SliderFloat("X", &light.position[0], 0.0f, width, "%.1f");
+            ImGui::SliderFloat("Y", &light.position[1], 0.0f, height, "%.1f");
+            ImGui::Checkbox("Sweep X", &light.sweep);
+            ImGui::ColorEdit3("Color", light.color);
+            ImGui::SliderFloat("Luminance", &light.luminance, 0.0f, 2.0f, "%.2f");
+            const bool remove = ImGui::Button("Remove");
+            ImGui::TreePop();
+            if (remove) {
+                lights.erase(lights.begin() + static_cast<std::ptrdiff_t>(i));
+                ImGui::PopID();
+                break;
+            }
+        }
+        ImGui::PopID();
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -332,7 +728,7 @@ void SDF2D::createCommandBuffers() {
     // Allocate as many command buffers as there are swapchain images
     auto builder = resourceManager->createCommandBuffer();
     commandBuffers = builder.setCommandPool(commandPool)
-                            .setCount(swapchainManager->getSwapchainImageViews().size())
+                            .setCount(getTargetCount())
                             .buildMultiple();
 }
 
@@ -343,6 +739,12 @@ void SDF2D::recordCommandBuffer(uint32_t imageIndex) {
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
     vkBeginCommandBuffer(cmd, &beginInfo);
+    gpuProfiler.beginFrame(cmd, currentFrame);
+
+    // Bake sceneDist() and the shadow maps before the render pass (dispatches are not allowed inside one)
+    recordDistancePass(cmd);
+    recordPolarShadowPass(cmd);
+    recordLightBinningPass(cmd);
 
     VkClearValue clearColor = {{{1.0f, 1.0f, 1.0f, 1.0f}}};
     VkRenderPassBeginInfo rpInfo{};
@@ -350,15 +752,16 @@ void SDF2D::recordCommandBuffer(uint32_t imageIndex) {
     rpInfo.renderPass = renderPass;
     rpInfo.framebuffer = framebuffers[imageIndex];
     rpInfo.renderArea.offset = {0, 0};
-    rpInfo.renderArea.extent = swapchainManager->getSwapchainExtent();
+    rpInfo.renderArea.extent = getTargetExtent();
     rpInfo.clearValueCount = 1;
     rpInfo.pClearValues = &clearColor;
 
     vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // SDF rendering content
+    gpuProfiler.beginScope(cmd, "Main");
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, trianglePipeline);
-    VkExtent2D extent = swapchainManager->getSwapchainExtent();
+    VkExtent2D extent = getTargetExtent();
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
@@ -372,13 +775,17 @@ void SDF2D::recordCommandBuffer(uint32_t imageIndex) {
     scissor.extent = extent;
     vkCmdSetScissor(cmd, 0, 1, &scissor);
     
-    // Bind descriptor set for uniforms
+    // Bind descriptor set for uniforms; the dynamic offset selects this frame's UBO slice
+    uint32_t dynamicOffsets[] = {uniformRing.getDynamicOffset(currentFrame), lightRing.getDynamicOffset(currentFrame)};
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, trianglePipelineLayout,
+                           0, 1, &descriptorSets[imageIndex], 2, dynamicOffsets);
     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, trianglePipelineLayout,
-                           0, 1, &descriptorSets[imageIndex], 0, nullptr);
+                           1, 1, &sceneTextureSets[currentFrame], 0, nullptr);
     
     VkDeviceSize offsets[] = {0};
     vkCmdBindVertexBuffers(cmd, 0, 1, &triangleVertexBuffer, offsets);
     vkCmdDraw(cmd, 4, 1, 0, 0);
+    gpuProfiler.endScope(cmd);
 
     // ImGui content
     if (auto* imgui = context->getImGuiManager()) {
@@ -393,22 +800,20 @@ void SDF2D::recordCommandBuffer(uint32_t imageIndex) {
 
         ImGui::Separator();
         ImGui::Text("Lights");
-        ImGui::Checkbox("Light 1 On", &lightEnabled[0]);
-        ImGui::SliderFloat("Light 1 Radius", &lightRadii[0], 0.0f, 50.0f, "%.1f");
-        ImGui::SliderFloat("Light 1 X", &light1PositionX, 0.0f, static_cast<float>(extent.width), "%.1f");
-        ImGui::SliderFloat("Light 1 Y", &light1PositionY, 0.0f, static_cast<float>(extent.height), "%.1f");
-        ImGui::Checkbox("Light 2 On", &lightEnabled[1]);
-        ImGui::SliderFloat("Light 2 Radius", &lightRadii[1], 0.0f, 50.0f, "%.1f");
-        ImGui::Checkbox("Light 3 On", &lightEnabled[2]);
-        ImGui::SliderFloat("Light 3 Radius", &lightRadii[2], 0.0f, 50.0f, "%.1f");
+        drawLightListImGui(extent);
+        ImGui::Checkbox("Baked Distance Texture", &useDistanceTexture);
+        ImGui::Checkbox("Polar Shadow Maps", &usePolarShadows);
         ImGui::Separator();
         ImGui::Text("Circle (Mouse Controlled)");
         ImGui::Text("Mouse Position: (%.1f, %.1f)", mouseX, mouseY);
         ImGui::Text("Ball Position: (%.1f, %.1f)", ballX, ballY);
         ImGui::SliderFloat("Mouse Sensitivity", &mouseSensitivity, 0.1f, 5.0f, "%.1f");
+        gpuProfiler.drawImGui();
         ImGui::End();
         imgui->endFrame();
+        gpuProfiler.beginScope(cmd, "ImGui");
         imgui->record(cmd);
+        gpuProfiler.endScope(cmd);
     }
 
     vkCmdEndRenderPass(cmd);
@@ -423,9 +828,10 @@ void SDF2D::drawFrame() {
     VkFence inFlightFence = syncManager->getInFlightFence(currentFrame);
     vkWaitForFences(device->getLogicalDevice(), 1, &inFlightFence, VK_TRUE, UINT64_MAX);
 
-    // Acquire next swapchain image
-    uint32_t imageIndex = swapchainManager->acquireNextImage(
-        syncManager->getImageAvailableSemaphore(currentFrame));
+    // Acquire next swapchain image (headless: the offscreen image owned by this frame)
+    uint32_t imageIndex = runOptions.headless
+        ? currentFrame
+        : swapchainManager->acquireNextImage(syncManager->getImageAvailableSemaphore(currentFrame));
 
     // Reset fence for next frame and update uniforms
     vkResetFences(device->getLogicalDevice(), 1, &inFlightFence);
@@ -444,14 +850,15 @@ void SDF2D::drawFrame() {
     VkSemaphore signalSemaphores[] = {
         syncManager->getRenderFinishedSemaphore(currentFrame)};
 
+    // Headless frames have nothing to acquire or present, so no semaphores
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = runOptions.headless ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = runOptions.headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
     if (vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
@@ -459,8 +866,10 @@ void SDF2D::drawFrame() {
     }
 
     // Present the image
-    swapchainManager->presentImage(
-        imageIndex, syncManager->getRenderFinishedSemaphore(currentFrame));
+    if (!runOptions.headless) {
+        swapchainManager->presentImage(
+            imageIndex, syncManager->getRenderFinishedSemaphore(currentFrame));
+    }
 
     currentFrame = (currentFrame + 1) % frameNum;
 }
@@ -470,14 +879,11 @@ void SDF2D::drawFrame() {
 /*                          ShaderToy SDF Methods                            */
 /* -------------------------------------------------------------------------- */
 void SDF2D::createUniformBuffer() {
-    // Create uniform buffer using ResourceUtils to get VMA allocation handle
-    uniformBuffer = ev::ResourceUtils::createBuffer(
-        device,
-        sizeof(ShaderToyUniforms),
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &uniformBufferAllocation
-    );
+    // One persistently mapped slice per frame in flight so the CPU never
+    // overwrites uniforms that an earlier, still running frame reads
+    uniformRing.create(device, sizeof(ShaderToyUniforms), frameNum);
+    // Same scheme for the light list, as a storage buffer
+    lightRing.create(device, sizeof(Light2DGpu) * kMaxLights, frameNum, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 }
 
 void SDF2D::createDescriptorSetLayout() {
@@ -485,7 +891,14 @@ void SDF2D::createDescriptorSetLayout() {
     auto builder = resourceManager->createDescriptorSet();
     builder.addBinding(
         0,
-        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+        1,
+        VK_SHADER_STAGE_FRAGMENT_BIT
+    );
+    // Light list, a slice of lightRing selected like the UBO slice
+    builder.addBinding(
+        2,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
         1,
         VK_SHADER_STAGE_FRAGMENT_BIT
     );
@@ -494,14 +907,16 @@ void SDF2D::createDescriptorSetLayout() {
 
 void SDF2D::createDescriptorSets() {
     // Allocate one descriptor set per swapchain image via EasyVulkan's builder
-    size_t imageCount = swapchainManager->getSwapchainImages().size();
+    size_t imageCount = getTargetCount();
     descriptorSets.resize(imageCount);
 
     for (size_t i = 0; i < imageCount; ++i) {
         auto builder = resourceManager->createDescriptorSet();
         builder
-            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-            .addBufferDescriptor(0, uniformBuffer, 0, sizeof(ShaderToyUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBufferDescriptor(0, uniformRing.getBuffer(), 0, sizeof(ShaderToyUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+            .addBufferDescriptor(2, lightRing.getBuffer(), 0, lightRing.getSliceSize(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
 
         descriptorSets[i] = builder.build(
             descriptorSetLayout,
@@ -512,44 +927,33 @@ void SDF2D::createDescriptorSets() {
 
 void SDF2D::updateUniformBuffer(uint32_t imageIndex) {
     auto currentTime = std::chrono::high_resolution_clock::now();
-    float time = std::chrono::duration<float, std::chrono::seconds::period>
-                 (currentTime - startTime).count();
+    float time = runOptions.fixedTime >= 0.0
+                     ? static_cast<float>(runOptions.fixedTime)
+                     : std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
     // Get actual swapchain dimensions
-    VkExtent2D extent = swapchainManager->getSwapchainExtent();
-    
-    ShaderToyUniforms ubo{};
-    ubo.iTime = time;
-    ubo.iResolution[0] = static_cast<float>(extent.width);
-    ubo.iResolution[1] = static_cast<float>(extent.height);
-    // Ball position for circle movement (with sensitivity applied)
-    ubo.iMouse[0] = ballX;
-    ubo.iMouse[1] = ballY;
-    
-    // Light 1 position from ImGui sliders
-    ubo.lightPos[0] = light1PositionX;
-    ubo.lightPos[1] = light1PositionY;
-
-    // Light toggles and radii
-    ubo.lightOn[0] = lightEnabled[0] ? 1.0f : 0.0f;
-    ubo.lightOn[1] = lightEnabled[1] ? 1.0f : 0.0f;
-    ubo.lightOn[2] = lightEnabled[2] ? 1.0f : 0.0f;
-    ubo.lightOn[3] = 0.0f; // padding
-
-    ubo.lightRadius[0] = lightRadii[0];
-    ubo.lightRadius[1] = lightRadii[1];
-    ubo.lightRadius[2] = lightRadii[2];
-    ubo.lightRadius[3] = 0.0f; // padding
-
-    // Upload data to the mapped uniform buffer using ResourceUtils
-    ev::ResourceUtils::uploadDataToMappedBuffer(
-        uniformBuffer,
-        device,
-        &uniformBufferAllocation,
-        &ubo,
-        sizeof(ubo),
-        0
-    );
+    VkExtent2D extent = getTargetExtent();
+
+    SDF2DFrameInputs frame;
+    frame.time = time;
+    frame.width = extent.width;
+    frame.height = extent.height;
+    frame.ball[0] = ballX;
+    frame.ball[1] = ballY;
+    ShaderToyUniforms ubo = makeSDF2DUniforms(frame);
+
+    // Enabled lights go to this frame's slice of the light buffer
+    uploadLights(time, ubo.iResolution[0]);
+    ubo.lightInfo[0] = activeLightCount;
+    ubo.lightInfo[1] = tileColumns;
+    ubo.lightInfo[2] = tileRows;
+    ubo.lightInfo[3] = useTiledLighting ? 1u : 0u;
+
+    ubo.distanceParams[0] = useDistanceTexture ? 1.0f : 0.0f;
+    ubo.shadowParams[0] = usePolarShadows ? 1.0f : 0.0f;
+
+    // Write into this frame's slice; its fence has already been waited on
+    uniformRing.write(currentFrame, ubo);
 }
 
 void SDF2D::setupMouseCallback() {
@@ -558,7 +962,7 @@ void SDF2D::setupMouseCallback() {
     glfwSetWindowUserPointer(device->getWindow(), this);
     
     // Initialize ball position to screen center
-    VkExtent2D extent = swapchainManager->getSwapchainExtent();
+    VkExtent2D extent = getTargetExtent();
     ballX = static_cast<float>(extent.width) * 0.5f;
     ballY = static_cast<float>(extent.height) * 0.5f;
     
@@ -570,7 +974,7 @@ void SDF2D::setupMouseCallback() {
         app->mouseY = static_cast<float>(ypos);
         
         // Calculate screen center
-        VkExtent2D extent = app->swapchainManager->getSwapchainExtent();
+        VkExtent2D extent = app->getTargetExtent();
         
         // Calculate mouse delta from center
         float deltaX = app->mouseX;
@@ -591,13 +995,23 @@ SDF2D::~SDF2D() {
     // Simple cleanup - most resources are managed by EasyVulkan's ResourceManager
     if (device && device->getLogicalDevice()) {
         vkDeviceWaitIdle(device->getLogicalDevice());
-
-        // Destroy the UBO created via ResourceUtils (not tracked by ResourceManager)
-        if (uniformBuffer != VK_NULL_HANDLE && uniformBufferAllocation != VK_NULL_HANDLE) {
-            vmaDestroyBuffer(device->getAllocator(), uniformBuffer, uniformBufferAllocation);
-            uniformBuffer = VK_NULL_HANDLE;
-            uniformBufferAllocation = VK_NULL_HANDLE;
-        }
+        gpuProfiler.destroy();
+
+        // Persist the cache before tearing down the pipeline built from it
+        pipelineCache.save();
+        vkDestroyPipeline(device->getLogicalDevice(), trianglePipeline, nullptr);
+        vkDestroyPipelineLayout(device->getLogicalDevice(), trianglePipelineLayout, nullptr);
+        vkDestroyPipeline(device->getLogicalDevice(), distancePipeline, nullptr);
+        vkDestroyPipelineLayout(device->getLogicalDevice(), distancePipelineLayout, nullptr);
+        vkDestroyPipeline(device->getLogicalDevice(), polarShadowPipeline, nullptr);
+        vkDestroyPipelineLayout(device->getLogicalDevice(), polarShadowPipelineLayout, nullptr);
+        vkDestroyPipeline(device->getLogicalDevice(), lightBinningPipeline, nullptr);
+        vkDestroyPipelineLayout(device->getLogicalDevice(), lightBinningPipelineLayout, nullptr);
+        pipelineCache.destroy();
+
+        // Destroy the UBO ring created via ResourceUtils (not tracked by ResourceManager)
+        uniformRing.destroy();
+        lightRing.destroy();
 
         // Do not manually destroy descriptor resources created via ResourceManager builders.
         // They are tracked and released by ResourceManager during context cleanup.
@@ -0,0 +1,70 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : 2D scene uniform block and light list shared by the GPU and CPU renderers
+ * @FilePath     : SDF2DScene.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "SDF2DScene.hpp"
+
+#include <cmath>
+
+std::vector<SceneLight2D> makeDefaultSDF2DLights() {
+    return {
+        {true,  {400.0f, 300.0f}, 60.0f, {1.0f, 0.8f, 0.3f}, 0.6f, false, 0.0f},    // warm golden
+        {true,  {0.0f, 175.0f},   80.0f, {0.3f, 0.7f, 1.0f}, 0.7f, true, 3.1415f},  // cool blue
+        {false, {0.0f, 340.0f},   12.0f, {1.0f, 0.4f, 0.6f}, 0.5f, true, 0.0f},     // magenta accent
+    };
+}
+
+ShaderToyUniforms makeSDF2DUniforms(const SDF2DFrameInputs& frame) {
+    ShaderToyUniforms ubo{};
+    ubo.iTime = frame.time;
+    ubo.iResolution[0] = static_cast<float>(frame.width);
+    ubo.iResolution[1] = static_cast<float>(frame.height);
+    // Ball position for circle movement (with sensitivity applied)
+    ubo.iMouse[0] = frame.ball[0];
+    ubo.iMouse[1] = frame.ball[1];
+
+    // Circle follows the ball, rectangle stays at the centre of the screen
+    ubo.shapeCenters[0] = ubo.iMouse[0] * 2.0f;
+    ubo.shapeCenters[1] = ubo.iMouse[1] * 2.0f;
+    ubo.shapeCenters[2] = ubo.iResolution[0] / 2.0f;
+    ubo.shapeCenters[3] = ubo.iResolution[1] / 2.0f;
+
+    // Fill colour cycles between cyan and purple-magenta
+    const float colorPhase = std::sin(frame.time * 0.5f) * 0.5f + 0.5f;
+    const float cyan[4] = {0.2f, 0.8f, 1.0f, 1.0f};
+    const float purple[4] = {0.8f, 0.3f, 1.0f, 1.0f};
+    for (int i = 0; i < 4; ++i) {
+        ubo.shapeColor[i] = cyan[i] + (purple[i] - cyan[i]) * colorPhase;
+    }
+    return ubo;
+}
+
+std::vector<Light2DGpu> makeSDF2DLights(const std::vector<SceneLight2D>& lights, float time,
+                                        float width, size_t maxLights) {
+    std::vector<Light2DGpu> gpuLights;
+    gpuLights.reserve(lights.size());
+    for (const SceneLight2D& light : lights) {
+        if (!light.enabled || gpuLights.size() == maxLights) {
+            continue;
+        }
+        Light2DGpu g{};
+        g.position[0] = light.sweep ? width * (std::sin(time + light.sweepPhase) + 1.2f) / 2.4f : light.position[0];
+        g.position[1] = light.position[1];
+        g.radius = light.radius;
+        g.range = light.radius * kLightRangeScale;
+
+        // Scale the colour to the requested luminance (was setLuminance() per pixel)
+        const float lum = 0.2126f * light.color[0] + 0.7152f * light.color[1] + 0.0722f * light.color[2];
+        const float scale = lum > 0.0f ? light.luminance / lum : 0.0f;
+        for (int c = 0; c < 3; ++c) {
+            g.color[c] = light.color[c] * scale;
+        }
+        g.color[3] = scale;
+        gpuLights.push_back(g);
+    }
+    return gpuLights;
+}
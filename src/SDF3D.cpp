@@ -20,11 +20,25 @@
  #include <EasyVulkan/Builders/ShaderModuleBuilder.hpp>
  #include <EasyVulkan/Builders/DescriptorSetBuilder.hpp>
  #include <EasyVulkan/Core/ImGuiManager.hpp>
+ #include "FullscreenPipeline.hpp"
+ #include "SDFMath.hpp"
+ #include "WorkStealingPool.hpp"
  #include "imgui.h"
  
+ #include <algorithm>
  #include <array>
+ #include <cmath>
+ #include <iostream>
  #include <stdexcept>
  #include <GLFW/glfw3.h>
+
+ namespace {
+
+ // Below this baked distance the march switches to the analytic map(): covers the
+ // brick interpolation error and gives exact hits, materials and normals
+ constexpr float kBrickRefineVoxels = 2.0f;
+
+ } // namespace
  
  void SDF3D::run() {
      initVulkan();
@@ -37,14 +51,20 @@
  }
  
  void SDF3D::initVulkanPC() {
-     if (!glfwInit()) {
-         throw std::runtime_error("Failed to initialize GLFW");
+     int windowWidth = static_cast<int>(runOptions.width);
+     int windowHeight = static_cast<int>(runOptions.height);
+     if (runOptions.headless) {
+         OffscreenTarget::selectHeadlessPlatform();
+     } else {
+         if (!glfwInit()) {
+             throw std::runtime_error("Failed to initialize GLFW");
+         }
+         GLFWmonitor* primaryMonitor = glfwGetPrimaryMonitor();
+         const GLFWvidmode* mode = glfwGetVideoMode(primaryMonitor);
+         windowWidth = mode->width;
+         windowHeight = mode->height;
+         glfwTerminate();
      }
-     GLFWmonitor* primaryMonitor = glfwGetPrimaryMonitor();
-     const GLFWvidmode* mode = glfwGetVideoMode(primaryMonitor);
-     int windowWidth = mode->width;
-     int windowHeight = mode->height;
-     glfwTerminate();
  
      context = std::make_unique<ev::VulkanContext>(true);
      VkPhysicalDeviceFeatures features{};
@@ -52,7 +72,9 @@
      features.sampleRateShading = VK_TRUE;
      context->setDeviceFeatures(features);
      context->setInstanceExtensions({"VK_KHR_get_physical_device_properties2"});
-     context->enableImGui();
+     if (!runOptions.headless) {
+         context->enableImGui();
+     }
      context->initialize(windowWidth, windowHeight);
  
      device = context->getDevice();
@@ -61,9 +83,14 @@
      swapchainManager = context->getSwapchainManager();
      syncManager = context->getSynchronizationManager();
  
-     swapchainManager->setPreferredColorSpace(VK_COLOR_SPACE_PASS_THROUGH_EXT);
-     swapchainManager->setImageUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
-     swapchainManager->createSwapchain();
+     if (runOptions.headless) {
+         offscreenTarget.create(resourceManager, "sdf3d-offscreen-color", frameNum,
+                                runOptions.width, runOptions.height, VK_FORMAT_R8G8B8A8_UNORM);
+     } else {
+         swapchainManager->setPreferredColorSpace(VK_COLOR_SPACE_PASS_THROUGH_EXT);
+         swapchainManager->setImageUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+         swapchainManager->createSwapchain();
+     }
  
      createRenderPass();
      createFramebuffers();
@@ -71,7 +98,7 @@
      if (auto* imgui = context->getImGuiManager()) {
          imgui->initialize(
              renderPass,
-             static_cast<uint32_t>(swapchainManager->getSwapchainImageViews().size()),
+             static_cast<uint32_t>(getTargetCount()),
              VK_SAMPLE_COUNT_1_BIT);
          imgui->enableResourceMonitor(true);
      }
@@ -81,28 +108,65 @@
      createVertexBuffer();
      createUniformBuffer();
      createDescriptorSetLayout();
+     pipelineCache.create(device, resolvePipelineCachePath(runOptions, "SDF3D"));
+     // The driver compiles on a build worker while the scene and brick map are baked
+     pipelineBuilds.create(1);
+     std::future<BuiltPipeline> pipelineBuild = createPipeline();
+     createScene();
+     createBrickMap();
      createDescriptorSets();
-     createPipeline();
+     auto waitStart = std::chrono::high_resolution_clock::now();
+     BuiltPipeline built = pipelineBuild.get();
+     graphicsPipeline = built.pipeline;
+     pipelineLayout = built.layout;
+     pipelineBuilds.destroy();
+     std::cout << "Pipeline build: " << built.buildMs << " ms, "
+               << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count()
+               << " ms not hidden by the bake (" << (pipelineCache.isWarm() ? "warm" : "cold") << " cache)\n";
      createCommandBuffers();
      syncManager->createFrameSynchronization(frameNum);
+ 
+     gpuProfiler.create(device, frameNum);
+     if (!runOptions.profileCsvPath.empty()) {
+         gpuProfiler.openCsv(runOptions.profileCsvPath);
+     }
+ }
+ 
+ size_t SDF3D::getTargetCount() const {
+     return getTargetImageViews().size();
+ }
+ 
+ VkExtent2D SDF3D::getTargetExtent() const {
+     return runOptions.headless ? offscreenTarget.getExtent() : swapchainManager->getSwapchainExtent();
+ }
+ 
+ VkFormat SDF3D::getTargetFormat() const {
+     return runOptions.headless ? offscreenTarget.getFormat() : swapchainManager->getSwapchainImageFormat();
+ }
+ 
+ std::vector<VkImageView> SDF3D::getTargetImageViews() const {
+     if (runOptions.headless) {
+         return offscreenTarget.getImageViews();
+     }
+     return swapchainManager->getSwapchainImageViews();
  }
  
  void SDF3D::createRenderPass() {
      auto builder = resourceManager->createRenderPass();
      builder.addColorAttachment(
-         swapchainManager->getSwapchainImageFormat(),
+         getTargetFormat(),
          VK_SAMPLE_COUNT_1_BIT,
          VK_ATTACHMENT_LOAD_OP_CLEAR,
          VK_ATTACHMENT_STORE_OP_STORE,
          VK_IMAGE_LAYOUT_UNDEFINED,
-         VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+         runOptions.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
      builder.beginSubpass().addColorReference(0).endSubpass();
      renderPass = builder.build("sdf3d-render-pass");
  }
  
  void SDF3D::createFramebuffers() {
-     const auto& views = swapchainManager->getSwapchainImageViews();
-     const auto& extent = swapchainManager->getSwapchainExtent();
+     const auto views = getTargetImageViews();
+     const auto extent = getTargetExtent();
      framebuffers.resize(views.size());
      for (size_t i = 0; i < views.size(); ++i) {
          auto fb = resourceManager->createFramebuffer();
@@ -127,7 +191,7 @@
          .buildAndInitialize(vertices.data(), sizeof(vertices[0]) * vertices.size(), "sdf3d-vertex-buffer");
  }
  
- void SDF3D::createPipeline() {
+ std::future<BuiltPipeline> SDF3D::createPipeline() {
      std::string vertShaderPath = "shaders/triangle.vert.spv";
      std::string fragShaderPath = "shaders/sdf3d.frag.spv";
  
@@ -144,20 +208,20 @@
      attrs[1].binding = 0; attrs[1].location = 1; attrs[1].format = VK_FORMAT_R32G32B32_SFLOAT; attrs[1].offset = offsetof(SDF3DVertex, color);
      attrs[2].binding = 0; attrs[2].location = 2; attrs[2].format = VK_FORMAT_R32G32_SFLOAT; attrs[2].offset = offsetof(SDF3DVertex, texCoord);
  
-     auto pipelineBuilder = resourceManager->createGraphicsPipeline();
-     graphicsPipeline = pipelineBuilder
-         .addShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vert)
-         .addShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, frag)
-         .setVertexInputState(binding, std::vector<VkVertexInputAttributeDescription>(attrs.begin(), attrs.end()))
-         .setInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP)
-         .setDynamicState({VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR})
-         .setDepthStencilState(VK_FALSE, VK_FALSE, VK_COMPARE_OP_ALWAYS)
-         .setColorBlendState({VkPipelineColorBlendAttachmentState{VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT}})
-         .setRenderPass(renderPass, 0)
-         .setDescriptorSetLayouts({descriptorSetLayout})
-         .build("sdf3d-pipeline");
- 
-     pipelineLayout = pipelineBuilder.getPipelineLayout();
+     FullscreenPipelineDesc desc;
+     desc.vertexShader = vert;
+     desc.fragmentShader = frag;
+     desc.vertexBinding = binding;
+     desc.vertexAttributes.assign(attrs.begin(), attrs.end());
+     desc.renderPass = renderPass;
+     desc.setLayouts = {descriptorSetLayout};
+     VkDevice logicalDevice = device->getLogicalDevice();
+     VkPipelineCache cache = pipelineCache.get();
+     return pipelineBuilds.submit([logicalDevice, cache, desc] {
+         BuiltPipeline built;
+         built.pipeline = createFullscreenPipeline(logicalDevice, cache, desc, &built.layout);
+         return built;
+     });
  }
  
  void SDF3D::createCommandBuffers() {
@@ -165,29 +229,34 @@
          commandPool = cmdPoolManager->createCommandPool(device->getGraphicsQueueFamily(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
      }
      auto builder = resourceManager->createCommandBuffer();
-     commandBuffers = builder.setCommandPool(commandPool).setCount(swapchainManager->getSwapchainImageViews().size()).buildMultiple();
+     commandBuffers = builder.setCommandPool(commandPool).setCount(getTargetCount()).buildMultiple();
  }
  
  void SDF3D::recordCommandBuffer(uint32_t imageIndex) {
      VkCommandBuffer cmd = commandBuffers[imageIndex];
      VkCommandBufferBeginInfo begin{}; begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; begin.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
      vkBeginCommandBuffer(cmd, &begin);
+     gpuProfiler.beginFrame(cmd, currentFrame);
  
      VkClearValue clear = {{{0.05f, 0.07f, 0.10f, 1.0f}}};
      VkRenderPassBeginInfo rp{}; rp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; rp.renderPass = renderPass; rp.framebuffer = framebuffers[imageIndex];
-     rp.renderArea.offset = {0, 0}; rp.renderArea.extent = swapchainManager->getSwapchainExtent(); rp.clearValueCount = 1; rp.pClearValues = &clear;
+     rp.renderArea.offset = {0, 0}; rp.renderArea.extent = getTargetExtent(); rp.clearValueCount = 1; rp.pClearValues = &clear;
      vkCmdBeginRenderPass(cmd, &rp, VK_SUBPASS_CONTENTS_INLINE);
  
+     gpuProfiler.beginScope(cmd, "Main");
      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-     VkExtent2D extent = swapchainManager->getSwapchainExtent();
+     VkExtent2D extent = getTargetExtent();
      VkViewport viewport{}; viewport.x = 0.0f; viewport.y = 0.0f; viewport.width = static_cast<float>(extent.width); viewport.height = static_cast<float>(extent.height); viewport.minDepth = 0.0f; viewport.maxDepth = 1.0f;
      vkCmdSetViewport(cmd, 0, 1, &viewport);
      VkRect2D scissor{}; scissor.offset = {0, 0}; scissor.extent = extent; vkCmdSetScissor(cmd, 0, 1, &scissor);
  
-     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[imageIndex], 0, nullptr);
+     uint32_t dynamicOffsets[] = {uniformRing.getDynamicOffset(currentFrame), primitiveRing.getDynamicOffset(currentFrame),
+                                  bvhRing.getDynamicOffset(currentFrame)};
+     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[imageIndex], 3, dynamicOffsets);
      VkDeviceSize offsets[] = {0};
      vkCmdBindVertexBuffers(cmd, 0, 1, &fullscreenVertexBuffer, offsets);
      vkCmdDraw(cmd, 4, 1, 0, 0);
+     gpuProfiler.endScope(cmd);
  
      if (auto* imgui = context->getImGuiManager()) {
          imgui->beginFrame();
@@ -196,9 +265,14 @@
          ImGui::Checkbox("Enable Light 2 (Sky/Env)", &enableLight2);
          ImGui::Checkbox("Enable Light 3 (Fill)", &enableLight3);
          ImGui::Checkbox("Enable Light 4 (Rim/Fresnel)", &enableLight4);
+         ImGui::Checkbox("Baked Brick Map", &useBrickMap);
+         ImGui::Checkbox("Animate Primitives (BVH refit)", &animatePrimitives);
+         gpuProfiler.drawImGui();
          ImGui::End();
          imgui->endFrame();
+         gpuProfiler.beginScope(cmd, "ImGui");
          imgui->record(cmd);
+         gpuProfiler.endScope(cmd);
      }
  
      vkCmdEndRenderPass(cmd);
@@ -208,7 +282,9 @@
  void SDF3D::drawFrame() {
      VkFence inFlight = syncManager->getInFlightFence(currentFrame);
      vkWaitForFences(device->getLogicalDevice(), 1, &inFlight, VK_TRUE, UINT64_MAX);
-     uint32_t imageIndex = swapchainManager->acquireNextImage(syncManager->getImageAvailableSemaphore(currentFrame));
+     uint32_t imageIndex = runOptions.headless
+         ? currentFrame
+         : swapchainManager->acquireNextImage(syncManager->getImageAvailableSemaphore(currentFrame));
      vkResetFences(device->getLogicalDevice(), 1, &inFlight);
  
      updateUniformBuffer(imageIndex);
@@ -219,53 +295,274 @@
      VkSemaphore waitSemaphores[] = {syncManager->getImageAvailableSemaphore(currentFrame)};
      VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
      VkSemaphore signalSemaphores[] = {syncManager->getRenderFinishedSemaphore(currentFrame)};
-     VkSubmitInfo submit{}; submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO; submit.waitSemaphoreCount = 1; submit.pWaitSemaphores = waitSemaphores; submit.pWaitDstStageMask = waitStages; submit.commandBufferCount = 1; submit.pCommandBuffers = &commandBuffers[imageIndex]; submit.signalSemaphoreCount = 1; submit.pSignalSemaphores = signalSemaphores;
+     VkSubmitInfo submit{}; submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO; submit.waitSemaphoreCount = runOptions.headless ? 0 : 1; submit.pWaitSemaphores = waitSemaphores; submit.pWaitDstStageMask = waitStages; submit.commandBufferCount = 1; submit.pCommandBuffers = &commandBuffers[imageIndex]; submit.signalSemaphoreCount = runOptions.headless ? 0 : 1; submit.pSignalSemaphores = signalSemaphores;
      if (vkQueueSubmit(device->getGraphicsQueue(), 1, &submit, inFlight) != VK_SUCCESS) {
          throw std::runtime_error("failed to submit command buffer!");
      }
-     swapchainManager->presentImage(imageIndex, syncManager->getRenderFinishedSemaphore(currentFrame));
+     if (!runOptions.headless) {
+         swapchainManager->presentImage(imageIndex, syncManager->getRenderFinishedSemaphore(currentFrame));
+     }
      currentFrame = (currentFrame + 1) % frameNum;
      frameCounter++;
  }
  
  void SDF3D::mainLoop() {
+     if (runOptions.headless) {
+         mainLoopHeadless();
+         return;
+     }
+     startFrameStats();
      while (!glfwWindowShouldClose(device->getWindow())) {
+         auto frameStart = std::chrono::high_resolution_clock::now();
          glfwPollEvents();
          drawFrame();
+         auto frameEnd = std::chrono::high_resolution_clock::now();
+         frameStats.addSample(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+     }
+     vkDeviceWaitIdle(device->getLogicalDevice());
+     gpuProfiler.resolveAll();
+     finishFrameStats();
+ }
+ 
+ void SDF3D::startFrameStats() {
+     if (runOptions.statsIntervalSeconds > 0.0) {
+         frameStats.startReporter(
+             std::chrono::milliseconds(static_cast<int64_t>(runOptions.statsIntervalSeconds * 1000.0)),
+             std::cout);
+     }
+ }
+ 
+ void SDF3D::finishFrameStats() {
+     frameStats.stopReporter();
+     FrameStats::printSummary(std::cout, frameStats.summarize());
+     if (!runOptions.statsJsonPath.empty()) {
+         frameStats.writeJson(runOptions.statsJsonPath);
+     }
+ }
+ 
+ void SDF3D::mainLoopHeadless() {
+     startFrameStats();
+     auto runStart = std::chrono::high_resolution_clock::now();
+     for (uint32_t i = 0; i < runOptions.frameCount; ++i) {
+         auto frameStart = std::chrono::high_resolution_clock::now();
+         drawFrame();
+         auto frameEnd = std::chrono::high_resolution_clock::now();
+         frameStats.addSample(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
      }
      vkDeviceWaitIdle(device->getLogicalDevice());
+     auto runEnd = std::chrono::high_resolution_clock::now();
+     gpuProfiler.resolveAll();
+     printHeadlessSummary(std::cout, runOptions,
+                          std::chrono::duration<double, std::milli>(runEnd - runStart).count());
+     gpuProfiler.printSummary(std::cout);
+     finishFrameStats();
+ 
+     if (!runOptions.outputPath.empty()) {
+         uint32_t lastIndex = (currentFrame + frameNum - 1) % frameNum;
+         offscreenTarget.writePPM(device, commandPool, lastIndex, runOptions.outputPath);
+         std::cout << "Wrote last frame to " << runOptions.outputPath << "\n";
+     }
  }
  
  void SDF3D::createUniformBuffer() {
-     uniformBuffer = ev::ResourceUtils::createBuffer(
+     uniformRing.create(device, sizeof(ShaderToy3DUniforms), frameNum);
+ }
+ 
+ void SDF3D::createScene() {
+     scene = std::make_unique<SDF3DScene>(makeSDF3DGallery());
+     const size_t primitiveCount = scene->getPrimitives().size();
+     const size_t nodeCount = scene->getBvh().getNodes().size();
+     std::cout << "Scene: " << primitiveCount << " primitives, " << nodeCount << " BVH nodes (depth "
+               << scene->getBvh().getDepth() << ")\n";
+     restPositions.clear();
+     for (const ScenePrimitive3D& prim : scene->getPrimitives()) {
+         restPositions.push_back(prim.position);
+     }
+     primitiveRing.create(device, sizeof(Primitive3DGpu) * std::max<size_t>(primitiveCount, 1), frameNum,
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+     bvhRing.create(device, sizeof(BvhNodeGpu) * std::max<size_t>(nodeCount, 1), frameNum,
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+     sceneUploadsPending = frameNum;
+ }
+
+ void SDF3D::updateScene(float time) {
+     // "Animate Primitives" bobs every primitive and refits the BVH; turning it off
+     // puts them back at rest
+     if (animatePrimitives || primitivesDisplaced) {
+         for (size_t i = 0; i < restPositions.size(); ++i) {
+             const float offset = animatePrimitives ? 0.05f * std::sin(2.0f * time + static_cast<float>(i)) : 0.0f;
+             scene->setPosition(i, restPositions[i] + sdf::Vec3(0.0f, offset, 0.0f));
+         }
+         scene->refit();
+         primitivesDisplaced = animatePrimitives;
+         sceneUploadsPending = frameNum;
+     }
+     // Every slice has to see the change once, then the slices stay valid
+     if (sceneUploadsPending > 0) {
+         const std::vector<Primitive3DGpu> primitives = scene->packGpuPrimitives();
+         const std::vector<BvhNodeGpu>& nodes = scene->getBvh().getNodes();
+         primitiveRing.write(currentFrame, primitives.data(), primitives.size() * sizeof(Primitive3DGpu));
+         bvhRing.write(currentFrame, nodes.data(), nodes.size() * sizeof(BvhNodeGpu));
+         --sceneUploadsPending;
+     }
+ }
+
+ void SDF3D::createBrickMap() {
+     // Bake the primitives at rest once on all cores, a little larger than the box
+     // raycast() marches in so the trilinear lookups near its faces stay inside.
+     // Nothing below the ground plane is visible, so the bake stops just under it.
+     const Aabb3 sceneBounds = scene->getBounds();
+     BrickMapDesc desc;
+     desc.boundsMin = sceneBounds.min - sdf::Vec3(0.1f);
+     desc.boundsMax = sceneBounds.max + sdf::Vec3(0.1f);
+     desc.boundsMin.y = std::max(desc.boundsMin.y, -0.1f);
+     auto bakeStart = std::chrono::high_resolution_clock::now();
+     WorkStealingPool pool(runOptions.cpuThreads);
+     const BrickMap brickMap = bakeBrickMap(pool, [this](sdf::Vec3 p) { return scene->mapPrimitives(p); }, desc);
+     const double bakeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - bakeStart).count();
+
+     const VkDeviceSize indirectionBytes = brickMap.indirection.size() * sizeof(uint32_t);
+     const VkDeviceSize coarseBytes = brickMap.coarse.size() * sizeof(float);
+     const VkDeviceSize atlasBytes = brickMap.atlas.size() * sizeof(uint16_t);
+     std::cout << "Brick map bake: " << bakeMs << " ms on " << pool.getThreadCount() << " threads, "
+               << brickMap.cells[0] << "x" << brickMap.cells[1] << "x" << brickMap.cells[2] << " cells, "
+               << brickMap.brickCount << " bricks, "
+               << static_cast<double>(indirectionBytes + coarseBytes + atlasBytes) / (1024.0 * 1024.0) << " MiB\n";
+
+     brickIndirectionBuffer = resourceManager->createBuffer()
+         .setSize(indirectionBytes)
+         .setUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+         .setMemoryProperties(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+         .buildAndInitialize(brickMap.indirection.data(), indirectionBytes, "sdf3d-brick-indirection");
+     brickCoarseBuffer = resourceManager->createBuffer()
+         .setSize(coarseBytes)
+         .setUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+         .setMemoryProperties(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+         .buildAndInitialize(brickMap.coarse.data(), coarseBytes, "sdf3d-brick-coarse");
+     uploadBrickAtlas(brickMap);
+
+     // Bilinear in x/y within a z slice; bricks duplicate their border samples so
+     // the filter never mixes neighbouring bricks
+     brickAtlasSampler = resourceManager->createSampler()
+         .setMagFilter(VK_FILTER_LINEAR)
+         .setMinFilter(VK_FILTER_LINEAR)
+         .setAddressModeU(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+         .setAddressModeV(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+         .build("sdf3d-brick-atlas-sampler");
+
+     brickOrigin[0] = brickMap.origin.x;
+     brickOrigin[1] = brickMap.origin.y;
+     brickOrigin[2] = brickMap.origin.z;
+     brickOrigin[3] = brickMap.voxelSize;
+     brickGrid[0] = brickMap.cells[0];
+     brickGrid[1] = brickMap.cells[1];
+     brickGrid[2] = brickMap.cells[2];
+     brickGrid[3] = brickMap.atlasColumns;
+     useBrickMap = runOptions.brickMap;
+ }
+
+ void SDF3D::uploadBrickAtlas(const BrickMap& brickMap) {
+     auto imgBuilder = resourceManager->createImage();
+     ev::ImageInfo info = imgBuilder
+         .setFormat(VK_FORMAT_R16_SFLOAT)
+         .setExtent(brickMap.atlasWidth, brickMap.atlasHeight)
+         .setUsage(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+         .build("sdf3d-brick-atlas", &brickAtlasAlloc);
+     brickAtlasImage = info.image;
+     brickAtlasView = info.imageView;
+
+     VkDevice logicalDevice = device->getLogicalDevice();
+     const VkDeviceSize byteSize = brickMap.atlas.size() * sizeof(uint16_t);
+     VmaAllocation stagingAlloc = VK_NULL_HANDLE;
+     VkBuffer staging = ev::ResourceUtils::createBuffer(
          device,
-         sizeof(ShaderToy3DUniforms),
-         VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+         byteSize,
+         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-         &uniformBufferAllocation);
+         &stagingAlloc);
+     ev::ResourceUtils::uploadDataToMappedBuffer(staging, device, &stagingAlloc, brickMap.atlas.data(), byteSize, 0);
+
+     if (commandPool == VK_NULL_HANDLE) {
+         commandPool = cmdPoolManager->createCommandPool(device->getGraphicsQueueFamily(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+     }
+     VkCommandBufferAllocateInfo allocInfo{};
+     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+     allocInfo.commandPool = commandPool;
+     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+     allocInfo.commandBufferCount = 1;
+     VkCommandBuffer cmd = VK_NULL_HANDLE;
+     if (vkAllocateCommandBuffers(logicalDevice, &allocInfo, &cmd) != VK_SUCCESS) {
+         vmaDestroyBuffer(device->getAllocator(), staging, stagingAlloc);
+         throw std::runtime_error("failed to allocate brick atlas upload command buffer!");
+     }
+
+     VkCommandBufferBeginInfo begin{};
+     begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+     begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+     vkBeginCommandBuffer(cmd, &begin);
+     ev::ResourceUtils::transitionImageLayout(device, cmd, brickAtlasImage,
+                                              VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+     VkBufferImageCopy region{};
+     region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+     region.imageExtent = {brickMap.atlasWidth, brickMap.atlasHeight, 1};
+     vkCmdCopyBufferToImage(cmd, staging, brickAtlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+     ev::ResourceUtils::transitionImageLayout(device, cmd, brickAtlasImage,
+                                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+     vkEndCommandBuffer(cmd);
+
+     VkSubmitInfo submit{};
+     submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+     submit.commandBufferCount = 1;
+     submit.pCommandBuffers = &cmd;
+     VkResult result = vkQueueSubmit(device->getGraphicsQueue(), 1, &submit, VK_NULL_HANDLE);
+     if (result == VK_SUCCESS) {
+         vkQueueWaitIdle(device->getGraphicsQueue());
+     }
+     vkFreeCommandBuffers(logicalDevice, commandPool, 1, &cmd);
+     vmaDestroyBuffer(device->getAllocator(), staging, stagingAlloc);
+     if (result != VK_SUCCESS) {
+         throw std::runtime_error("failed to submit brick atlas upload!");
+     }
  }
- 
+
  void SDF3D::createDescriptorSetLayout() {
      auto builder = resourceManager->createDescriptorSet();
-     builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+     builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
      descriptorSetLayout = builder.createLayout("sdf3d_descriptor_layout");
  }
  
  void SDF3D::createDescriptorSets() {
-     size_t count = swapchainManager->getSwapchainImages().size();
+     size_t count = getTargetCount();
      descriptorSets.resize(count);
      for (size_t i = 0; i < count; ++i) {
          auto builder = resourceManager->createDescriptorSet();
-         builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-                .addBufferDescriptor(0, uniformBuffer, 0, sizeof(ShaderToy3DUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+         builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+                .addBufferDescriptor(0, uniformRing.getBuffer(), 0, sizeof(ShaderToy3DUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+                .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+                .addImageDescriptor(1, brickAtlasView, brickAtlasSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+                .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+                .addBufferDescriptor(2, brickIndirectionBuffer, 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+                .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+                .addBufferDescriptor(3, brickCoarseBuffer, 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+                .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+                .addBufferDescriptor(4, primitiveRing.getBuffer(), 0, primitiveRing.getSliceSize(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+                .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+                .addBufferDescriptor(5, bvhRing.getBuffer(), 0, bvhRing.getSliceSize(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
          descriptorSets[i] = builder.build(descriptorSetLayout, std::string("sdf3d_descriptor_set_") + std::to_string(i));
      }
  }
  
  void SDF3D::updateUniformBuffer(uint32_t) {
      auto now = std::chrono::high_resolution_clock::now();
-     float t = std::chrono::duration<float, std::chrono::seconds::period>(now - startTime).count();
-     VkExtent2D extent = swapchainManager->getSwapchainExtent();
+     float t = runOptions.fixedTime >= 0.0
+                   ? static_cast<float>(runOptions.fixedTime)
+                   : std::chrono::duration<float, std::chrono::seconds::period>(now - startTime).count();
+     VkExtent2D extent = getTargetExtent();
      ShaderToy3DUniforms u{};
      u.iTime = t;
      u.iResolution[0] = static_cast<float>(extent.width);
@@ -278,7 +575,42 @@
      u.enableLights[1] = enableLight2 ? 1 : 0;
      u.enableLights[2] = enableLight3 ? 1 : 0;
      u.enableLights[3] = enableLight4 ? 1 : 0;
-     ev::ResourceUtils::uploadDataToMappedBuffer(uniformBuffer, device, &uniformBufferAllocation, &u, sizeof(u), 0);
+
+     // Orbiting camera of sdf3d.frag main(): uniform-only, so built once per frame
+     // here rather than for every pixel
+     const float time = 32.0f + t * 1.5f;
+     const sdf::Vec3 ta(0.25f, -0.75f, -0.75f);
+     const sdf::Vec3 ro = ta + sdf::Vec3(4.5f * std::cos(0.1f * time), 2.2f, 4.5f * std::sin(0.1f * time));
+     const sdf::Vec3 cw = sdf::normalize(ta - ro);
+     const sdf::Vec3 cp(0.0f, 1.0f, 0.0f); // roll 0: (sin 0, cos 0, 0)
+     const sdf::Vec3 cu = sdf::normalize(sdf::cross(cw, cp));
+     const sdf::Vec3 cv = sdf::cross(cu, cw);
+     const sdf::Vec3 basis[3] = {cu, cv, cw};
+     u.cameraOrigin[0] = ro.x; u.cameraOrigin[1] = ro.y; u.cameraOrigin[2] = ro.z; u.cameraOrigin[3] = 0.0f;
+     for (int c = 0; c < 3; ++c) {
+         u.cameraBasis[c][0] = basis[c].x;
+         u.cameraBasis[c][1] = basis[c].y;
+         u.cameraBasis[c][2] = basis[c].z;
+         u.cameraBasis[c][3] = 0.0f;
+     }
+     for (int i = 0; i < 4; ++i) {
+         u.brickOrigin[i] = brickOrigin[i];
+         u.brickGrid[i] = brickGrid[i];
+     }
+     // The bake only holds the primitives at rest
+     u.brickParams[0] = useBrickMap && !animatePrimitives ? 1.0f : 0.0f;
+     u.brickParams[1] = kBrickRefineVoxels * brickOrigin[3];
+
+     updateScene(t);
+     const Aabb3 sceneBounds = scene->getBounds();
+     if (!sceneBounds.isEmpty()) {
+         for (int a = 0; a < 3; ++a) {
+             u.sceneBoundsMin[a] = sceneBounds.min[a] - 0.01f;
+             u.sceneBoundsMax[a] = sceneBounds.max[a] + 0.01f;
+         }
+     }
+     u.sceneInfo[0] = static_cast<uint32_t>(scene->getBvh().getNodes().size());
+     uniformRing.write(currentFrame, u);
  }
  
  void SDF3D::setupMouseCallback() {
@@ -295,11 +627,14 @@
  SDF3D::~SDF3D() {
      if (device && device->getLogicalDevice()) {
          vkDeviceWaitIdle(device->getLogicalDevice());
-         if (uniformBuffer != VK_NULL_HANDLE && uniformBufferAllocation != VK_NULL_HANDLE) {
-             vmaDestroyBuffer(device->getAllocator(), uniformBuffer, uniformBufferAllocation);
-             uniformBuffer = VK_NULL_HANDLE;
-             uniformBufferAllocation = VK_NULL_HANDLE;
-         }
+         gpuProfiler.destroy();
+         uniformRing.destroy();
+         primitiveRing.destroy();
+         bvhRing.destroy();
+         pipelineCache.save();
+         vkDestroyPipeline(device->getLogicalDevice(), graphicsPipeline, nullptr);
+         vkDestroyPipelineLayout(device->getLogicalDevice(), pipelineLayout, nullptr);
+         pipelineCache.destroy();
      }
  }
  
@@ -0,0 +1,489 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 20:00:00
+ * @Description  : Data-driven primitive scene of sdf3d.frag (CPU side and GPU layout)
+ * @FilePath     : SDF3DScene.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "SDF3DScene.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+using namespace sdf;
+
+namespace {
+
+// GLSL built-ins the primitives need beyond SDFMath.hpp
+inline float sign(float v) { return v > 0.0f ? 1.0f : (v < 0.0f ? -1.0f : 0.0f); }
+inline Vec2 abs(Vec2 v) { return {std::fabs(v.x), std::fabs(v.y)}; }
+inline Vec3 abs(Vec3 v) { return {std::fabs(v.x), std::fabs(v.y), std::fabs(v.z)}; }
+inline Vec2 max(Vec2 v, float s) { return {std::max(v.x, s), std::max(v.y, s)}; }
+inline Vec3 max(Vec3 v, float s) { return {std::max(v.x, s), std::max(v.y, s), std::max(v.z, s)}; }
+inline Vec2 operator-(Vec2 a, float s) { return {a.x - s, a.y - s}; }
+inline Vec3 operator-(Vec3 a, float s) { return {a.x - s, a.y - s, a.z - s}; }
+inline Vec2 xy(Vec3 v) { return {v.x, v.y}; }
+inline Vec2 xz(Vec3 v) { return {v.x, v.z}; }
+inline Vec3 xzy(Vec3 v) { return {v.x, v.z, v.y}; }
+
+inline float dot2(Vec2 v) { return dot(v, v); }
+inline float dot2(Vec3 v) { return dot(v, v); }
+inline float ndot(Vec2 a, Vec2 b) { return a.x * b.x - a.y * b.y; }
+
+/* -------------------------------------------------------------------------- */
+/*                  Primitives (same order as sdf3d.frag)                     */
+/* -------------------------------------------------------------------------- */
+float sdSphere(Vec3 p, float s) { return length(p) - s; }
+
+float sdBox(Vec3 p, Vec3 b) {
+    Vec3 d = abs(p) - b;
+    return std::min(std::max(d.x, std::max(d.y, d.z)), 0.0f) + length(max(d, 0.0f));
+}
+
+float sdBoxFrame(Vec3 p, Vec3 b, float e) {
+    p = abs(p) - b;
+    Vec3 q = abs(p + e) - e;
+    return std::min(std::min(length(max(Vec3(p.x, q.y, q.z), 0.0f)) + std::min(std::max(p.x, std::max(q.y, q.z)), 0.0f),
+                             length(max(Vec3(q.x, p.y, q.z), 0.0f)) + std::min(std::max(q.x, std::max(p.y, q.z)), 0.0f)),
+                    length(max(Vec3(q.x, q.y, p.z), 0.0f)) + std::min(std::max(q.x, std::max(q.y, p.z)), 0.0f));
+}
+
+float sdEllipsoid(Vec3 p, Vec3 r) {
+    float k0 = length(p / r);
+    float k1 = length(p / (r * r));
+    return k0 * (k0 - 1.0f) / k1;
+}
+
+float sdTorus(Vec3 p, Vec2 t) {
+    return length(Vec2(length(xz(p)) - t.x, p.y)) - t.y;
+}
+
+float sdCappedTorus(Vec3 p, Vec2 sc, float ra, float rb) {
+    p.x = std::fabs(p.x);
+    float k = (sc.y * p.x > sc.x * p.y) ? dot(xy(p), sc) : length(xy(p));
+    return std::sqrt(dot(p, p) + ra * ra - 2.0f * ra * k) - rb;
+}
+
+float sdHexPrism(Vec3 p, Vec2 h) {
+    const Vec3 k(-0.8660254f, 0.5f, 0.57735f);
+    p = abs(p);
+    Vec2 pxy = xy(p) - Vec2(k.x, k.y) * (2.0f * std::min(dot(Vec2(k.x, k.y), xy(p)), 0.0f));
+    p.x = pxy.x;
+    p.y = pxy.y;
+    Vec2 d(length(xy(p) - Vec2(clamp(p.x, -k.z * h.x, k.z * h.x), h.x)) * sign(p.y - h.x), p.z - h.y);
+    return std::min(std::max(d.x, d.y), 0.0f) + length(max(d, 0.0f));
+}
+
+float sdOctogonPrism(Vec3 p, float r, float h) {
+    const Vec3 k(-0.9238795325f, 0.3826834323f, 0.4142135623f);
+    p = abs(p);
+    Vec2 pxy = xy(p);
+    pxy = pxy - Vec2(k.x, k.y) * (2.0f * std::min(dot(Vec2(k.x, k.y), pxy), 0.0f));
+    pxy = pxy - Vec2(-k.x, k.y) * (2.0f * std::min(dot(Vec2(-k.x, k.y), pxy), 0.0f));
+    pxy = pxy - Vec2(clamp(pxy.x, -k.z * r, k.z * r), r);
+    Vec2 d(length(pxy) * sign(pxy.y), p.z - h);
+    return std::min(std::max(d.x, d.y), 0.0f) + length(max(d, 0.0f));
+}
+
+float sdCapsule(Vec3 p, Vec3 a, Vec3 b, float r) {
+    Vec3 pa = p - a, ba = b - a;
+    float h = clamp(dot(pa, ba) / dot(ba, ba), 0.0f, 1.0f);
+    return length(pa - ba * h) - r;
+}
+
+float sdRoundCone(Vec3 p, float r1, float r2, float h) {
+    Vec2 q(length(xz(p)), p.y);
+    float b = (r1 - r2) / h;
+    float a = std::sqrt(1.0f - b * b);
+    float k = dot(q, Vec2(-b, a));
+    if (k < 0.0f) {
+        return length(q) - r1;
+    }
+    if (k > a * h) {
+        return length(q - Vec2(0.0f, h)) - r2;
+    }
+    return dot(q, Vec2(a, b)) - r1;
+}
+
+float sdRoundCone(Vec3 p, Vec3 a, Vec3 b, float r1, float r2) {
+    Vec3 ba = b - a;
+    float l2 = dot(ba, ba);
+    float rr = r1 - r2;
+    float a2 = l2 - rr * rr;
+    float il2 = 1.0f / l2;
+    Vec3 pa = p - a;
+    float y = dot(pa, ba);
+    float z = y - l2;
+    float x2 = dot2(pa * l2 - ba * y);
+    float y2 = y * y * l2;
+    float z2 = z * z * l2;
+    float k = sign(rr) * rr * rr * x2;
+    if (sign(z) * a2 * z2 > k) {
+        return std::sqrt(x2 + z2) * il2 - r2;
+    }
+    if (sign(y) * a2 * y2 < k) {
+        return std::sqrt(x2 + y2) * il2 - r1;
+    }
+    return (std::sqrt(x2 * a2 * il2) + y * rr) * il2 - r1;
+}
+
+float sdTriPrism(Vec3 p, Vec2 h) {
+    const float k = std::sqrt(3.0f);
+    h.x *= 0.5f * k;
+    Vec2 pxy = xy(p) / h.x;
+    pxy.x = std::fabs(pxy.x) - 1.0f;
+    pxy.y = pxy.y + 1.0f / k;
+    if (pxy.x + k * pxy.y > 0.0f) {
+        pxy = Vec2(pxy.x - k * pxy.y, -k * pxy.x - pxy.y) / 2.0f;
+    }
+    pxy.x -= clamp(pxy.x, -2.0f, 0.0f);
+    float d1 = length(pxy) * sign(-pxy.y) * h.x;
+    float d2 = std::fabs(p.z) - h.y;
+    return length(max(Vec2(d1, d2), 0.0f)) + std::min(std::max(d1, d2), 0.0f);
+}
+
+float sdCylinder(Vec3 p, Vec2 h) {
+    Vec2 d = abs(Vec2(length(xz(p)), p.y)) - h;
+    return std::min(std::max(d.x, d.y), 0.0f) + length(max(d, 0.0f));
+}
+
+float sdCylinder(Vec3 p, Vec3 a, Vec3 b, float r) {
+    Vec3 pa = p - a, ba = b - a;
+    float baba = dot(ba, ba);
+    float paba = dot(pa, ba);
+    float x = length(pa * baba - ba * paba) - r * baba;
+    float y = std::fabs(paba - baba * 0.5f) - baba * 0.5f;
+    float x2 = x * x;
+    float y2 = y * y * baba;
+    float d = (std::max(x, y) < 0.0f) ? -std::min(x2, y2)
+                                      : (((x > 0.0f) ? x2 : 0.0f) + ((y > 0.0f) ? y2 : 0.0f));
+    return sign(d) * std::sqrt(std::fabs(d)) / baba;
+}
+
+float sdCone(Vec3 p, Vec2 c, float h) {
+    Vec2 q = Vec2(c.x, -c.y) * h / c.y;
+    Vec2 w(length(xz(p)), p.y);
+    Vec2 a = w - q * clamp(dot(w, q) / dot(q, q), 0.0f, 1.0f);
+    Vec2 b = w - q * Vec2(clamp(w.x / q.x, 0.0f, 1.0f), 1.0f);
+    float k = sign(q.y);
+    float d = std::min(dot(a, a), dot(b, b));
+    float s = std::max(k * (w.x * q.y - w.y * q.x), k * (w.y - q.y));
+    return std::sqrt(d) * sign(s);
+}
+
+float sdCappedCone(Vec3 p, float h, float r1, float r2) {
+    Vec2 q(length(xz(p)), p.y);
+    Vec2 k1(r2, h);
+    Vec2 k2(r2 - r1, 2.0f * h);
+    Vec2 ca(q.x - std::min(q.x, (q.y < 0.0f) ? r1 : r2), std::fabs(q.y) - h);
+    Vec2 cb = q - k1 + k2 * clamp(dot(k1 - q, k2) / dot2(k2), 0.0f, 1.0f);
+    float s = (cb.x < 0.0f && ca.y < 0.0f) ? -1.0f : 1.0f;
+    return s * std::sqrt(std::min(dot2(ca), dot2(cb)));
+}
+
+float sdCappedCone(Vec3 p, Vec3 a, Vec3 b, float ra, float rb) {
+    float rba = rb - ra;
+    float baba = dot(b - a, b - a);
+    float papa = dot(p - a, p - a);
+    float paba = dot(p - a, b - a) / baba;
+    float x = std::sqrt(papa - paba * paba * baba);
+    float cax = std::max(0.0f, x - ((paba < 0.5f) ? ra : rb));
+    float cay = std::fabs(paba - 0.5f) - 0.5f;
+    float k = rba * rba + baba;
+    float f = clamp((rba * (x - ra) + paba * baba) / k, 0.0f, 1.0f);
+    float cbx = x - ra - f * rba;
+    float cby = paba - f;
+    float s = (cbx < 0.0f && cay < 0.0f) ? -1.0f : 1.0f;
+    return s * std::sqrt(std::min(cax * cax + cay * cay * baba, cbx * cbx + cby * cby * baba));
+}
+
+float sdSolidAngle(Vec3 pos, Vec2 c, float ra) {
+    Vec2 p(length(xz(pos)), pos.y);
+    float l = length(p) - ra;
+    float m = length(p - c * clamp(dot(p, c), 0.0f, ra));
+    return std::max(l, m * sign(c.y * p.x - c.x * p.y));
+}
+
+float sdOctahedron(Vec3 p, float s) {
+    p = abs(p);
+    float m = p.x + p.y + p.z - s;
+    Vec3 q;
+    if (3.0f * p.x < m) {
+        q = p;
+    } else if (3.0f * p.y < m) {
+        q = Vec3(p.y, p.z, p.x);
+    } else if (3.0f * p.z < m) {
+        q = Vec3(p.z, p.x, p.y);
+    } else {
+        return m * 0.57735027f;
+    }
+    float k = clamp(0.5f * (q.z - q.y + s), 0.0f, s);
+    return length(Vec3(q.x, q.y - s + k, q.z - k));
+}
+
+float sdPyramid(Vec3 p, float h) {
+    float m2 = h * h + 0.25f;
+    p.x = std::fabs(p.x);
+    p.z = std::fabs(p.z);
+    if (p.z > p.x) {
+        std::swap(p.x, p.z);
+    }
+    p.x -= 0.5f;
+    p.z -= 0.5f;
+    Vec3 q(p.z, h * p.y - 0.5f * p.x, h * p.x + 0.5f * p.y);
+    float s = std::max(-q.x, 0.0f);
+    float t = clamp((q.y - 0.5f * p.z) / (m2 + 0.25f), 0.0f, 1.0f);
+    float a = m2 * (q.x + s) * (q.x + s) + q.y * q.y;
+    float b = m2 * (q.x + 0.5f * t) * (q.x + 0.5f * t) + (q.y - m2 * t) * (q.y - m2 * t);
+    float d2 = std::min(q.y, -q.x * m2 - q.y * 0.5f) > 0.0f ? 0.0f : std::min(a, b);
+    return std::sqrt((d2 + q.z * q.z) / m2) * sign(std::max(q.z, -p.y));
+}
+
+float sdRhombus(Vec3 p, float la, float lb, float h, float ra) {
+    p = abs(p);
+    Vec2 b(la, lb);
+    float f = clamp(ndot(b, b - xz(p) * 2.0f) / dot(b, b), -1.0f, 1.0f);
+    Vec2 q(length(xz(p) - b * Vec2(1.0f - f, 1.0f + f) * 0.5f) * sign(p.x * b.y + p.z * b.x - b.x * b.y) - ra,
+           p.y - h);
+    return std::min(std::max(q.x, q.y), 0.0f) + length(max(q, 0.0f));
+}
+
+float sdHorseshoe(Vec3 p, Vec2 c, float r, float le, Vec2 w) {
+    p.x = std::fabs(p.x);
+    float l = length(xy(p));
+    // mat2(-c.x, c.y, c.y, c.x) is column-major: columns (-c.x, c.y) and (c.y, c.x)
+    Vec2 pxy(-c.x * p.x + c.y * p.y, c.y * p.x + c.x * p.y);
+    pxy = Vec2((pxy.y > 0.0f || pxy.x > 0.0f) ? pxy.x : l * sign(-c.x), (pxy.x > 0.0f) ? pxy.y : l);
+    pxy = Vec2(pxy.x, std::fabs(pxy.y - r)) - Vec2(le, 0.0f);
+    Vec2 q(length(max(pxy, 0.0f)) + std::min(0.0f, std::max(pxy.x, pxy.y)), p.z);
+    Vec2 d = abs(q) - w;
+    return std::min(std::max(d.x, d.y), 0.0f) + length(max(d, 0.0f));
+}
+
+inline Vec2 opU(Vec2 d1, Vec2 d2) { return (d1.x < d2.x) ? d1 : d2; }
+
+Vec3 paramVec3(const float* p) { return {p[0], p[1], p[2]}; }
+
+// Local-space bounds of a primitive's surface, generous where the exact box is awkward
+void localBounds(const ScenePrimitive3D& prim, Vec3& lo, Vec3& hi) {
+    const float* p = prim.params;
+    auto symmetric = [&](Vec3 h) { lo = -h; hi = h; };
+    auto segment = [&](float ra, float rb) {
+        const Vec3 a = paramVec3(p), b = paramVec3(p + 4);
+        lo = min(a - Vec3(ra), b - Vec3(rb));
+        hi = max(a + Vec3(ra), b + Vec3(rb));
+    };
+    switch (prim.type) {
+        case PrimitiveType3D::Sphere: symmetric(Vec3(p[0])); break;
+        case PrimitiveType3D::Box:
+        case PrimitiveType3D::BoxFrame:
+        case PrimitiveType3D::Ellipsoid: symmetric(paramVec3(p)); break;
+        case PrimitiveType3D::Torus: symmetric(Vec3(p[0] + p[1], p[1], p[0] + p[1])); break;
+        case PrimitiveType3D::CappedTorus: symmetric(Vec3(p[2] + p[3])); break;
+        case PrimitiveType3D::HexPrism: symmetric(Vec3(p[0] * 1.1547005f, p[0] * 1.1547005f, p[1])); break; // circumradius
+        case PrimitiveType3D::OctogonPrism: symmetric(Vec3(p[0] * 1.0823922f, p[0] * 1.0823922f, p[1])); break;
+        case PrimitiveType3D::Capsule:
+        case PrimitiveType3D::CylinderAB: segment(p[3], p[3]); break;
+        case PrimitiveType3D::RoundConeAB:
+        case PrimitiveType3D::CappedConeAB: segment(std::max(p[3], p[7]), std::max(p[3], p[7])); break;
+        case PrimitiveType3D::RoundCone: {
+            const float r = std::max(p[0], p[1]);
+            lo = Vec3(-r, -p[0], -r);
+            hi = Vec3(r, p[2] + p[1], r);
+            break;
+        }
+        case PrimitiveType3D::TriPrism: symmetric(Vec3(p[0], p[0], p[1])); break;
+        case PrimitiveType3D::Cylinder: symmetric(Vec3(p[0], p[1], p[0])); break;
+        case PrimitiveType3D::Cone: {
+            // Apex at the origin, base circle at y = -h
+            const float r = p[2] * p[0] / p[1];
+            lo = Vec3(-r, -p[2], -r);
+            hi = Vec3(r, 0.0f, r);
+            break;
+        }
+        case PrimitiveType3D::CappedCone: {
+            const float r = std::max(p[1], p[2]);
+            symmetric(Vec3(r, p[0], r));
+            break;
+        }
+        case PrimitiveType3D::SolidAngle: symmetric(Vec3(p[2])); break;
+        case PrimitiveType3D::Octahedron: symmetric(Vec3(p[0])); break;
+        case PrimitiveType3D::Pyramid:
+            lo = Vec3(-0.5f, 0.0f, -0.5f);
+            hi = Vec3(0.5f, p[0], 0.5f);
+            break;
+        case PrimitiveType3D::Rhombus: symmetric(Vec3(p[0] + p[3], p[2], p[1] + p[3])); break;
+        case PrimitiveType3D::Horseshoe: {
+            const float r = p[2] + p[3] + p[4];
+            symmetric(Vec3(r, r, p[5]));
+            break;
+        }
+        default: throw std::runtime_error("Unknown SDF primitive type");
+    }
+}
+
+} // namespace
+
+float evaluatePrimitive(const ScenePrimitive3D& prim, Vec3 pos) {
+    const Vec3 q = prim.rotation * (pos - prim.position);
+    const float* p = prim.params;
+    switch (prim.type) {
+        case PrimitiveType3D::Sphere: return sdSphere(q, p[0]);
+        case PrimitiveType3D::Box: return sdBox(q, paramVec3(p));
+        case PrimitiveType3D::BoxFrame: return sdBoxFrame(q, paramVec3(p), p[3]);
+        case PrimitiveType3D::Ellipsoid: return sdEllipsoid(q, paramVec3(p));
+        case PrimitiveType3D::Torus: return sdTorus(q, Vec2(p[0], p[1]));
+        case PrimitiveType3D::CappedTorus: return sdCappedTorus(q, Vec2(p[0], p[1]), p[2], p[3]);
+        case PrimitiveType3D::HexPrism: return sdHexPrism(q, Vec2(p[0], p[1]));
+        case PrimitiveType3D::OctogonPrism: return sdOctogonPrism(q, p[0], p[1]);
+        case PrimitiveType3D::Capsule: return sdCapsule(q, paramVec3(p), paramVec3(p + 4), p[3]);
+        case PrimitiveType3D::RoundCone: return sdRoundCone(q, p[0], p[1], p[2]);
+        case PrimitiveType3D::RoundConeAB: return sdRoundCone(q, paramVec3(p), paramVec3(p + 4), p[3], p[7]);
+        case PrimitiveType3D::TriPrism: return sdTriPrism(q, Vec2(p[0], p[1]));
+        case PrimitiveType3D::Cylinder: return sdCylinder(q, Vec2(p[0], p[1]));
+        case PrimitiveType3D::CylinderAB: return sdCylinder(q, paramVec3(p), paramVec3(p + 4), p[3]);
+        case PrimitiveType3D::Cone: return sdCone(q, Vec2(p[0], p[1]), p[2]);
+        case PrimitiveType3D::CappedCone: return sdCappedCone(q, p[0], p[1], p[2]);
+        case PrimitiveType3D::CappedConeAB: return sdCappedCone(q, paramVec3(p), paramVec3(p + 4), p[3], p[7]);
+        case PrimitiveType3D::SolidAngle: return sdSolidAngle(q, Vec2(p[0], p[1]), p[2]);
+        case PrimitiveType3D::Octahedron: return sdOctahedron(q, p[0]);
+        case PrimitiveType3D::Pyramid: return sdPyramid(q, p[0]);
+        case PrimitiveType3D::Rhombus: return sdRhombus(q, p[0], p[1], p[2], p[3]);
+        case PrimitiveType3D::Horseshoe: return sdHorseshoe(q, Vec2(p[0], p[1]), p[2], p[3], Vec2(p[4], p[5]));
+    }
+    return 1e10f;
+}
+
+Aabb3 computePrimitiveBounds(const ScenePrimitive3D& prim) {
+    Vec3 lo, hi;
+    localBounds(prim, lo, hi);
+    // World = position + R^T * local: rotate the centre, and grow the half size by |R^T|
+    const Vec3 centre = (lo + hi) * 0.5f;
+    const Vec3 half = (hi - lo) * 0.5f;
+    const Mat3& r = prim.rotation;
+    const Vec3 rows[3] = {Vec3(r.c0.x, r.c1.x, r.c2.x), Vec3(r.c0.y, r.c1.y, r.c2.y), Vec3(r.c0.z, r.c1.z, r.c2.z)};
+    Vec3 worldCentre = prim.position;
+    Vec3 worldHalf;
+    for (int i = 0; i < 3; ++i) {
+        worldCentre += rows[i] * centre[i];
+        worldHalf += abs(rows[i]) * half[i];
+    }
+    Aabb3 box;
+    box.min = worldCentre - worldHalf;
+    box.max = worldCentre + worldHalf;
+    return box;
+}
+
+Primitive3DGpu toGpuPrimitive(const ScenePrimitive3D& prim) {
+    Primitive3DGpu gpu{};
+    gpu.position[0] = prim.position.x;
+    gpu.position[1] = prim.position.y;
+    gpu.position[2] = prim.position.z;
+    gpu.position[3] = prim.material;
+    const Mat3& r = prim.rotation;
+    const Vec3 columns[3] = {r.c0, r.c1, r.c2};
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            gpu.rotation[row][col] = columns[col][row];
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        gpu.params[i / 4][i % 4] = prim.params[i];
+    }
+    gpu.type = static_cast<uint32_t>(prim.type);
+    return gpu;
+}
+
+std::vector<ScenePrimitive3D> makeSDF3DGallery() {
+    using T = PrimitiveType3D;
+    auto make = [](T type, Vec3 position, float material, std::initializer_list<float> params,
+                   const Mat3& rotation = Mat3()) {
+        ScenePrimitive3D prim;
+        prim.type = type;
+        prim.position = position;
+        prim.rotation = rotation;
+        prim.material = material;
+        int i = 0;
+        for (float v : params) {
+            prim.params[i++] = v;
+        }
+        return prim;
+    };
+    const Mat3 swapYZ(1, 0, 0, 0, 0, 1, 0, 1, 0); // p.xzy
+    const Mat3 flipY(1, 0, 0, 0, -1, 0, 0, 0, 1); // p * vec3(1, -1, 1)
+    return {
+        make(T::Sphere, Vec3(-2.0f, 0.25f, 0.0f), 26.9f, {0.25f}),
+        make(T::Rhombus, Vec3(-2.0f, 0.25f, 1.0f), 17.0f, {0.15f, 0.25f, 0.04f, 0.08f}, swapYZ),
+
+        make(T::CappedTorus, Vec3(0.0f, 0.30f, 1.0f), 25.0f, {0.866025f, -0.5f, 0.25f, 0.05f}, flipY),
+        make(T::BoxFrame, Vec3(0.0f, 0.25f, 0.0f), 16.9f, {0.3f, 0.25f, 0.2f, 0.025f}),
+        make(T::Cone, Vec3(0.0f, 0.45f, -1.0f), 55.0f, {0.6f, 0.8f, 0.45f}),
+        make(T::CappedCone, Vec3(0.0f, 0.25f, -2.0f), 13.67f, {0.25f, 0.25f, 0.1f}),
+        make(T::SolidAngle, Vec3(0.0f, 0.00f, -3.0f), 49.13f, {0.6f, 0.8f, 0.4f}),
+
+        make(T::Torus, Vec3(1.0f, 0.30f, 1.0f), 7.1f, {0.25f, 0.05f}, swapYZ),
+        make(T::Box, Vec3(1.0f, 0.25f, 0.0f), 3.0f, {0.3f, 0.25f, 0.1f}),
+        make(T::Capsule, Vec3(1.0f, 0.00f, -1.0f), 31.9f, {-0.1f, 0.1f, -0.1f, 0.1f, 0.2f, 0.4f, 0.2f}),
+        make(T::Cylinder, Vec3(1.0f, 0.25f, -2.0f), 8.0f, {0.15f, 0.25f}),
+        make(T::HexPrism, Vec3(1.0f, 0.2f, -3.0f), 18.4f, {0.2f, 0.05f}),
+
+        make(T::Pyramid, Vec3(-1.0f, -0.6f, -3.0f), 13.56f, {1.0f}),
+        make(T::Octahedron, Vec3(-1.0f, 0.15f, -2.0f), 23.56f, {0.35f}),
+        make(T::TriPrism, Vec3(-1.0f, 0.15f, -1.0f), 43.5f, {0.3f, 0.05f}),
+        make(T::Ellipsoid, Vec3(-1.0f, 0.25f, 0.0f), 43.17f, {0.2f, 0.25f, 0.05f}),
+        make(T::Horseshoe, Vec3(-1.0f, 0.25f, 1.0f), 11.5f, {std::cos(1.3f), std::sin(1.3f), 0.2f, 0.3f, 0.03f, 0.08f}),
+
+        make(T::OctogonPrism, Vec3(2.0f, 0.2f, -3.0f), 51.8f, {0.2f, 0.05f}),
+        make(T::CylinderAB, Vec3(2.0f, 0.14f, -2.0f), 31.2f, {0.1f, -0.1f, 0.0f, 0.08f, -0.2f, 0.35f, 0.1f}),
+        make(T::CappedConeAB, Vec3(2.0f, 0.09f, -1.0f), 46.1f, {0.1f, 0.0f, 0.0f, 0.15f, -0.2f, 0.40f, 0.1f, 0.05f}),
+        make(T::RoundConeAB, Vec3(2.0f, 0.15f, 0.0f), 51.7f, {0.1f, 0.0f, 0.0f, 0.15f, -0.1f, 0.35f, 0.1f, 0.05f}),
+        make(T::RoundCone, Vec3(2.0f, 0.20f, 1.0f), 37.0f, {0.2f, 0.1f, 0.3f}),
+    };
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 SDF3DScene                                 */
+/* -------------------------------------------------------------------------- */
+SDF3DScene::SDF3DScene(std::vector<ScenePrimitive3D> scenePrimitives)
+    : primitives(std::move(scenePrimitives)) {
+    bounds.reserve(primitives.size());
+    for (const ScenePrimitive3D& prim : primitives) {
+        bounds.push_back(computePrimitiveBounds(prim));
+    }
+    bvh.build(bounds);
+}
+
+void SDF3DScene::setPosition(size_t index, Vec3 position) {
+    primitives[index].position = position;
+    bounds[index] = computePrimitiveBounds(primitives[index]);
+}
+
+void SDF3DScene::refit() {
+    bvh.refit(bounds);
+}
+
+std::vector<Primitive3DGpu> SDF3DScene::packGpuPrimitives() const {
+    std::vector<Primitive3DGpu> gpu;
+    gpu.reserve(primitives.size());
+    for (uint32_t index : bvh.getPrimitiveOrder()) {
+        gpu.push_back(toGpuPrimitive(primitives[index]));
+    }
+    return gpu;
+}
+
+Vec2 SDF3DScene::nearest(Vec3 pos, Vec2 res) const {
+    bvh.traverse(pos, res.x, [&](uint32_t index) {
+        res = opU(res, Vec2(evaluatePrimitive(primitives[index], pos), primitives[index].material));
+    });
+    return res;
+}
+
+Vec2 SDF3DScene::map(Vec3 pos) const {
+    return nearest(pos, Vec2(pos.y, 0.0f));
+}
+
+float SDF3DScene::mapPrimitives(Vec3 pos) const {
+    return nearest(pos, Vec2(1e10f, -1.0f)).x;
+}
@@ -19,11 +19,15 @@
 #include <EasyVulkan/Builders/SamplerBuilder.hpp>
 #include <EasyVulkan/Core/ImGuiManager.hpp>
 #include <EasyVulkan/Utils/ResourceUtils.hpp>
+#include "FullscreenPipeline.hpp"
+#include "ComputePipeline.hpp"
 #include "imgui.h"
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <cmath>
+#include <iostream>
 #include <stdexcept>
 #include <GLFW/glfw3.h>
 
@@ -38,6 +42,10 @@ bool SDFCornell::initVulkan() {
 }
 
 void SDFCornell::initVulkanPC() {
+    if (runOptions.headless) {
+        initVulkanHeadless();
+        return;
+    }
     if (!glfwInit()) {
         throw std::runtime_error("Failed to initialize GLFW");
     }
@@ -68,35 +76,64 @@ void SDFCornell::initVulkanPC() {
     // We only needed GLFW here for monitor info; EasyVulkan will create the actual window
     glfwTerminate();
 
+    createContext(windowWidth, windowHeight);
+
+    swapchainManager->setPreferredColorSpace(VK_COLOR_SPACE_SRGB_NONLINEAR_KHR);
+    swapchainManager->setImageUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    swapchainManager->createSwapchain();
+
+    createSceneResources();
+}
+
+void SDFCornell::initVulkanHeadless() {
+    // No monitor to query: render at the requested size on GLFW's null platform
+    OffscreenTarget::selectHeadlessPlatform();
+    createContext(static_cast<int>(runOptions.width), static_cast<int>(runOptions.height));
+
+    // sRGB storage matches the VK_COLOR_SPACE_SRGB_NONLINEAR_KHR swapchain of the windowed path
+    offscreenTarget.create(resourceManager, "SDFCornell-offscreen-color", frameNum,
+                           runOptions.width, runOptions.height, VK_FORMAT_R8G8B8A8_SRGB);
+
+    createSceneResources();
+}
+
+void SDFCornell::createContext(int width, int height) {
     context = std::make_unique<ev::VulkanContext>(true);
     VkPhysicalDeviceFeatures features{};
     features.fragmentStoresAndAtomics = VK_TRUE;
     features.sampleRateShading = VK_TRUE;
     context->setDeviceFeatures(features);
     context->setInstanceExtensions({"VK_KHR_get_physical_device_properties2"});
-    context->enableImGui();
-    context->initialize(windowWidth, windowHeight);
+    if (!runOptions.headless) {
+        context->enableImGui();
+    }
+    context->initialize(width, height);
 
     device = context->getDevice();
     resourceManager = context->getResourceManager();
     cmdPoolManager = context->getCommandPoolManager();
     swapchainManager = context->getSwapchainManager();
     syncManager = context->getSynchronizationManager();
+}
 
-    swapchainManager->setPreferredColorSpace(VK_COLOR_SPACE_SRGB_NONLINEAR_KHR);
-    swapchainManager->setImageUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
-    swapchainManager->createSwapchain();
-
+void SDFCornell::createSceneResources() {
     createRenderPass();
     createFramebuffers();
 
     // Create resources for RSM offscreen pass
+    rsmEncoding = parseRSMEncoding(runOptions.rsmEncoding);
     createRSMPassResources();
+    createIndirectPassResources();
+    applyCornellRunOptions(runOptions, settings);
+    rsmScheduler.setMode(parseRSMUpdateMode(runOptions.rsmUpdate));
+    rsmScheduler.setInterval(runOptions.rsmInterval);
+    rsmScheduler.setBudgetMs(runOptions.rsmBudgetMs);
+    rsmScheduler.setPartialUpdates(runOptions.rsmPartialUpdates);
 
     if (auto* imgui = context->getImGuiManager()) {
         imgui->initialize(
             renderPass,
-            static_cast<uint32_t>(swapchainManager->getSwapchainImageViews().size()),
+            static_cast<uint32_t>(getTargetCount()),
             VK_SAMPLE_COUNT_1_BIT);
         imgui->enableResourceMonitor(true);
     }
@@ -108,29 +145,90 @@ void SDFCornell::initVulkanPC() {
     createFlowerTexture();
     createDescriptorSetLayout();
     createDescriptorSets();
+    pipelineCache.create(device, resolvePipelineCachePath(runOptions, "SDFCornell"));
+    pipelineBuilds.create();
+    auto pipelineStart = std::chrono::high_resolution_clock::now();
+    // All startup pipelines compile in parallel on the build workers
+    std::array<std::future<BuiltPipeline>, kRSMEncodingCount> rsmBuilds;
+    for (uint32_t i = 0; i < kRSMEncodingCount; ++i) {
+        if (rsmRenderPasses[i] != VK_NULL_HANDLE) {
+            rsmBuilds[i] = createRSMPipeline(static_cast<RSMEncoding>(i));
+        }
+    }
+    std::future<BuiltPipeline> pyramidBuild = createRSMPyramidPipeline();
+    std::future<BuiltPipeline> vplClusterBuild = createVplClusterPipeline();
+    std::future<BuiltPipeline> temporalBuild = createTemporalIndirectPipeline();
     createPipeline();
-    createRSMPipeline();
+    for (uint32_t i = 0; i < kRSMEncodingCount; ++i) {
+        if (rsmBuilds[i].valid()) {
+            rsmPipelines[i] = rsmBuilds[i].get();
+        }
+    }
+    BuiltPipeline pyramid = pyramidBuild.get();
+    rsmPyramidPipeline = pyramid.pipeline;
+    rsmPyramidPipelineLayout = pyramid.layout;
+    BuiltPipeline vplCluster = vplClusterBuild.get();
+    vplClusterPipeline = vplCluster.pipeline;
+    vplClusterPipelineLayout = vplCluster.layout;
+    BuiltPipeline temporal = temporalBuild.get();
+    indirectTemporalPipeline = temporal.pipeline;
+    indirectTemporalPipelineLayout = temporal.layout;
+    PipelineVariant& startup = pipelineVariants[activeVariantKey];
+    startup.built = startup.pending.get();
+    if (usesCornellIndirectPass(activeVariantKey)) {
+        PipelineVariant& pass = pipelineVariants[makeCornellIndirectPassKey(activeVariantKey)];
+        pass.built = pass.pending.get();
+    }
+    std::cout << "Pipeline build: "
+              << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - pipelineStart).count()
+              << " ms (" << (pipelineCache.isWarm() ? "warm" : "cold") << " cache)\n";
+    precompilePipelineVariants();
     createCommandBuffers();
     setupMouseCallback();
     syncManager->createFrameSynchronization(frameNum);
+    deletionQueue.create(frameNum);
+
+    gpuProfiler.create(device, frameNum);
+    if (!runOptions.profileCsvPath.empty()) {
+        gpuProfiler.openCsv(runOptions.profileCsvPath);
+    }
+}
+
+size_t SDFCornell::getTargetCount() const {
+    return getTargetImageViews().size();
+}
+
+VkExtent2D SDFCornell::getTargetExtent() const {
+    return runOptions.headless ? offscreenTarget.getExtent() : swapchainManager->getSwapchainExtent();
+}
+
+VkFormat SDFCornell::getTargetFormat() const {
+    return runOptions.headless ? offscreenTarget.getFormat() : swapchainManager->getSwapchainImageFormat();
+}
+
+std::vector<VkImageView> SDFCornell::getTargetImageViews() const {
+    if (runOptions.headless) {
+        return offscreenTarget.getImageViews();
+    }
+    return swapchainManager->getSwapchainImageViews();
 }
 
 void SDFCornell::createRenderPass() {
     auto builder = resourceManager->createRenderPass();
     builder.addColorAttachment(
-        swapchainManager->getSwapchainImageFormat(),
+        getTargetFormat(),
         VK_SAMPLE_COUNT_1_BIT,
         VK_ATTACHMENT_LOAD_OP_CLEAR,
         VK_ATTACHMENT_STORE_OP_STORE,
         VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        runOptions.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
     builder.beginSubpass().addColorReference(0).endSubpass();
     renderPass = builder.build("SDFCornell-render-pass");
 }
 
 void SDFCornell::createFramebuffers() {
-    const auto& views = swapchainManager->getSwapchainImageViews();
-    const auto& extent = swapchainManager->getSwapchainExtent();
+    const auto views = getTargetImageViews();
+    const auto extent = getTargetExtent();
     framebuffers.resize(views.size());
     for (size_t i = 0; i < views.size(); ++i) {
         auto fb = resourceManager->createFramebuffer();
@@ -140,133 +238,338 @@ void SDFCornell::createFramebuffers() {
     }
 }
 
+namespace {
+
+// Position, normal and flux attachments of an RSMEncoding (see rsm_encoding.glsl)
+std::array<VkFormat, 3> rsmAttachmentFormats(RSMEncoding encoding) {
+    if (encoding == RSMEncoding::Compact) {
+        return {VK_FORMAT_R16_UNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_B10G11R11_UFLOAT_PACK32};
+    }
+    return {VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT};
+}
+
+} // namespace
+
 void SDFCornell::createRSMPassResources() {
-    // Create RSM images (position, normal, flux)
+    // One RSM render pass per encoding, 3 color attachments, final layout for sampling
+    VkPhysicalDevice physicalDevice = device->getPhysicalDevice();
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    compactRSMSupported = true;
+    for (VkFormat format : rsmAttachmentFormats(RSMEncoding::Compact)) {
+        VkFormatProperties props{};
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+        compactRSMSupported = compactRSMSupported && (props.optimalTilingFeatures & required) == required;
+    }
+    if (!compactRSMSupported && rsmEncoding == RSMEncoding::Compact) {
+        std::cerr << "Warning: compact RSM formats are not supported on this device, using the full encoding\n";
+        rsmEncoding = RSMEncoding::Full;
+    }
+    rsmPendingEncoding = rsmEncoding;
+    for (uint32_t i = 0; i < kRSMEncodingCount; ++i) {
+        const RSMEncoding encoding = static_cast<RSMEncoding>(i);
+        if (encoding == RSMEncoding::Compact && !compactRSMSupported) {
+            continue;
+        }
+        for (bool partial : {false, true}) {
+            auto rpBuilder = resourceManager->createRenderPass();
+            for (VkFormat format : rsmAttachmentFormats(encoding)) {
+                rpBuilder.addColorAttachment(
+                    format,
+                    VK_SAMPLE_COUNT_1_BIT,
+                    partial ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    VK_ATTACHMENT_STORE_OP_STORE,
+                    partial ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
+            rpBuilder
+                .beginSubpass()
+                    .addColorReference(0)
+                    .addColorReference(1)
+                    .addColorReference(2)
+                .endSubpass();
+            const std::string name = std::string(partial ? "rsm-partial-render-pass-" : "rsm-render-pass-") + toString(encoding);
+            (partial ? rsmPartialRenderPasses : rsmRenderPasses)[i] = rpBuilder.build(name);
+        }
+    }
+
+    // Create sampler for sampling RSM textures
+    rsmSampler = resourceManager->createSampler()
+        .setMagFilter(VK_FILTER_LINEAR)
+        .setMinFilter(VK_FILTER_LINEAR)
+        .setAddressModeU(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+        .setAddressModeV(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+        .build("rsm-sampler");
+    rsmPyramidSampler = resourceManager->createSampler()
+        .setMagFilter(VK_FILTER_NEAREST)
+        .setMinFilter(VK_FILTER_NEAREST)
+        .setAddressModeU(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+        .setAddressModeV(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+        .build("rsm-pyramid-sampler");
+
+    // Pyramid build: reads the RSM, writes the pyramid atlas and the cluster images
+    rsmPyramidSetLayout = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .createLayout("rsm-pyramid-layout");
+
+    // Clustered VPLs: reads the RSM and its pyramid, refines the cluster list in place
+    vplClusterBuffer = resourceManager->createBuffer()
+        .setSize(sizeof(GpuVplCluster) * kMaxVplClusters)
+        .setUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+        .setMemoryProperties(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+        .build("vpl-clusters");
+    vplCellBuffer = resourceManager->createBuffer()
+        .setSize(sizeof(GpuVplCluster) * kVplClusterCellCount)
+        .setUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+        .setMemoryProperties(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+        .build("vpl-cells");
+    vplAssignmentBuffer = resourceManager->createBuffer()
+        .setSize(sizeof(uint32_t) * kVplClusterCellCount)
+        .setUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+        .setMemoryProperties(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+        .build("vpl-assignment");
+    vplClusterSetLayout = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .createLayout("vpl-cluster-layout");
+
+    createRSMAttachments();
+}
+
+std::string SDFCornell::rsmResourceName(const char* base) const {
+    // One suffix per resolution switch, so a new generation never collides with
+    // the names of one that is still waiting for deferred deletion
+    return std::string(base) + "_" + std::to_string(rsmGeneration);
+}
+
+void SDFCornell::createRSMAttachments() {
+    // Create RSM images (position, normal, flux) in the formats of the current encoding
+    const std::array<VkFormat, 3> formats = rsmAttachmentFormats(rsmEncoding);
     auto imgBuilder = resourceManager->createImage();
-    auto createAttachment = [&](const char* name, VkImage& image, VmaAllocation& alloc, VkImageView& view){
+    auto createAttachment = [&](const char* name, VkFormat format, VkImage& image, VmaAllocation& alloc, VkImageView& view){
         ev::ImageInfo info = imgBuilder
-            .setFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
+            .setFormat(format)
             .setExtent(rsmWidth, rsmHeight)
             .setUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
-            .build(name, &alloc);
+            .build(rsmResourceName(name), &alloc);
         image = info.image;
         view = info.imageView;
     };
-    createAttachment("rsm_position", rsmPositionImage, rsmPositionAlloc, rsmPositionView);
-    createAttachment("rsm_normal",   rsmNormalImage,   rsmNormalAlloc,   rsmNormalView);
-    createAttachment("rsm_flux",     rsmFluxImage,     rsmFluxAlloc,     rsmFluxView);
+    createAttachment("rsm_position", formats[0], rsmPositionImage, rsmPositionAlloc, rsmPositionView);
+    createAttachment("rsm_normal",   formats[1], rsmNormalImage,   rsmNormalAlloc,   rsmNormalView);
+    createAttachment("rsm_flux",     formats[2], rsmFluxImage,     rsmFluxAlloc,     rsmFluxView);
 
-    // Create RSM render pass with 3 color attachments, final layout for sampling
-    auto rpBuilder = resourceManager->createRenderPass();
-    rpBuilder
-        .addColorAttachment(
-            VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_SAMPLE_COUNT_1_BIT,
-            VK_ATTACHMENT_LOAD_OP_CLEAR,
-            VK_ATTACHMENT_STORE_OP_STORE,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-        .addColorAttachment(
-            VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_SAMPLE_COUNT_1_BIT,
-            VK_ATTACHMENT_LOAD_OP_CLEAR,
-            VK_ATTACHMENT_STORE_OP_STORE,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-        .addColorAttachment(
-            VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_SAMPLE_COUNT_1_BIT,
-            VK_ATTACHMENT_LOAD_OP_CLEAR,
-            VK_ATTACHMENT_STORE_OP_STORE,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-        .beginSubpass()
-            .addColorReference(0)
-            .addColorReference(1)
-            .addColorReference(2)
-        .endSubpass();
-    rsmRenderPass = rpBuilder.build("rsm-render-pass");
-
-    // Create framebuffer
+    // Create framebuffer with the encoding's render pass
     auto fb = resourceManager->createFramebuffer();
     rsmFramebuffer = fb
         .addAttachment(rsmPositionView)
         .addAttachment(rsmNormalView)
         .addAttachment(rsmFluxView)
         .setDimensions(rsmWidth, rsmHeight)
-        .build(rsmRenderPass, "rsm-fb");
-
-    // Create sampler for sampling RSM textures
-    rsmSampler = resourceManager->createSampler()
-        .setMagFilter(VK_FILTER_LINEAR)
-        .setMinFilter(VK_FILTER_LINEAR)
-        .setAddressModeU(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
-        .setAddressModeV(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
-        .build("rsm-sampler");
+        .build(rsmRenderPasses[static_cast<size_t>(rsmEncoding)], rsmResourceName("rsm-fb"));
+
+    // Pyramid atlas and cluster images; R32F / RGBA32F are mandatory storage formats
+    rsmPyramidLayout = RSMPyramidLayout::make(rsmWidth, rsmHeight);
+    auto createStorage = [&](const char* name, VkFormat format, uint32_t w, uint32_t h,
+                             VkImage& image, VmaAllocation& alloc, VkImageView& view) {
+        ev::ImageInfo info = resourceManager->createImage()
+            .setFormat(format)
+            .setExtent(w, h)
+            .setUsage(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+            .build(rsmResourceName(name), &alloc);
+        image = info.image;
+        view = info.imageView;
+    };
+    createStorage("rsm_pyramid", VK_FORMAT_R32_SFLOAT, rsmPyramidLayout.atlasWidth, rsmPyramidLayout.atlasHeight,
+                  rsmPyramidImage, rsmPyramidAlloc, rsmPyramidView);
+    const uint32_t clusters = rsmPyramidLayout.clusterCount;
+    createStorage("rsm_cluster_cone", VK_FORMAT_R32G32B32A32_SFLOAT, clusters, clusters,
+                  rsmClusterConeImage, rsmClusterConeAlloc, rsmClusterConeView);
+    createStorage("rsm_cluster_bounds", VK_FORMAT_R32G32B32A32_SFLOAT, clusters, clusters,
+                  rsmClusterBoundsImage, rsmClusterBoundsAlloc, rsmClusterBoundsView);
+
+    rsmPyramidSet = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addImageDescriptor(0, rsmPositionView, rsmPyramidSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addImageDescriptor(1, rsmNormalView, rsmPyramidSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addImageDescriptor(2, rsmFluxView, rsmPyramidSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addImageDescriptor(3, rsmPyramidView, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+        .addImageDescriptor(4, rsmClusterConeView, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+        .addImageDescriptor(5, rsmClusterBoundsView, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+        .build(rsmPyramidSetLayout, rsmResourceName("rsm-pyramid-set"));
+
+    vplClusterSet = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addImageDescriptor(0, rsmPositionView, rsmPyramidSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addImageDescriptor(1, rsmNormalView, rsmPyramidSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addImageDescriptor(2, rsmFluxView, rsmPyramidSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addImageDescriptor(3, rsmPyramidView, rsmPyramidSampler, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addBufferDescriptor(4, vplClusterBuffer, 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+        .addBufferDescriptor(5, vplCellBuffer, 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+        .addBufferDescriptor(6, vplAssignmentBuffer, 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+        .build(vplClusterSetLayout, rsmResourceName("vpl-cluster-set"));
 }
 
-void SDFCornell::recreateRSMResources(uint32_t newSize) {
-    // Ensure GPU is idle before destroying resources referenced by in-flight command buffers
-    if (device && device->getLogicalDevice() != VK_NULL_HANDLE) {
-        vkDeviceWaitIdle(device->getLogicalDevice());
+void SDFCornell::recreateRSMResources(uint32_t newSize, RSMEncoding newEncoding) {
+    // Frames still in flight may reference the current images, framebuffer and
+    // descriptor sets: hand them to the deletion queue instead of waiting for the GPU
+    std::vector<std::pair<std::string, VkObjectType>> retired = {
+        {rsmResourceName("rsm-fb"), VK_OBJECT_TYPE_FRAMEBUFFER},
+        {rsmResourceName("rsm_position"), VK_OBJECT_TYPE_IMAGE},
+        {rsmResourceName("rsm_normal"), VK_OBJECT_TYPE_IMAGE},
+        {rsmResourceName("rsm_flux"), VK_OBJECT_TYPE_IMAGE},
+        {rsmResourceName("rsm_pyramid"), VK_OBJECT_TYPE_IMAGE},
+        {rsmResourceName("rsm_cluster_cone"), VK_OBJECT_TYPE_IMAGE},
+        {rsmResourceName("rsm_cluster_bounds"), VK_OBJECT_TYPE_IMAGE},
+        {rsmResourceName("rsm-pyramid-set"), VK_OBJECT_TYPE_DESCRIPTOR_SET},
+        {rsmResourceName("vpl-cluster-set"), VK_OBJECT_TYPE_DESCRIPTOR_SET},
+    };
+    for (size_t i = 0; i < descriptorSets.size(); ++i) {
+        retired.emplace_back(descriptorSetName(i), VK_OBJECT_TYPE_DESCRIPTOR_SET);
     }
-    // Clear old RSM framebuffer and images via ResourceManager
-    resourceManager->clearResource("rsm-fb", VK_OBJECT_TYPE_FRAMEBUFFER);
-    resourceManager->clearResource("rsm_position", VK_OBJECT_TYPE_IMAGE);
-    resourceManager->clearResource("rsm_normal", VK_OBJECT_TYPE_IMAGE);
-    resourceManager->clearResource("rsm_flux", VK_OBJECT_TYPE_IMAGE);
-
-    rsmFramebuffer = VK_NULL_HANDLE;
-    rsmPositionImage = VK_NULL_HANDLE; rsmNormalImage = VK_NULL_HANDLE; rsmFluxImage = VK_NULL_HANDLE;
-    rsmPositionView = VK_NULL_HANDLE; rsmNormalView = VK_NULL_HANDLE; rsmFluxView = VK_NULL_HANDLE;
-    rsmPositionAlloc = VK_NULL_HANDLE; rsmNormalAlloc = VK_NULL_HANDLE; rsmFluxAlloc = VK_NULL_HANDLE;
+    deletionQueue.defer([rm = resourceManager, retired = std::move(retired)] {
+        for (const auto& [name, type] : retired) {
+            rm->clearResource(name, type);
+        }
+    });
 
+    // The new generation is used by the very next frame
+    ++rsmGeneration;
     rsmWidth = newSize;
     rsmHeight = newSize;
+    rsmEncoding = newEncoding;
+    rsmImagesInitialized = false;
+    rsmPyramidInitialized = false;
+    rsmScheduler.invalidate();
+    restirReservoirsValid = false; // their texel indices are of the old RSM size
+    createRSMAttachments();
+    createDescriptorSets();
+}
 
-    // Recreate images
-    auto imgBuilder = resourceManager->createImage();
-    auto recreateAttachment = [&](const char* name, VkImage& image, VmaAllocation& alloc, VkImageView& view){
-        ev::ImageInfo info = imgBuilder
+void SDFCornell::createIndirectPassResources() {
+    // rgb irradiance without albedo, a hit distance (raw) or accumulated frames;
+    // RGBA16F is a mandatory attachment and storage format
+    auto rpBuilder = resourceManager->createRenderPass();
+    rpBuilder.addColorAttachment(
+        VK_FORMAT_R16G16B16A16_SFLOAT,
+        VK_SAMPLE_COUNT_1_BIT,
+        VK_ATTACHMENT_LOAD_OP_DONT_CARE, // every pixel is written
+        VK_ATTACHMENT_STORE_OP_STORE,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    rpBuilder.beginSubpass().addColorReference(0).endSubpass();
+    indirectRenderPass = rpBuilder.build("indirect-render-pass");
+
+    // Raw taps read per texel, the history filtered (rsmSampler is linear, clamped)
+    indirectTemporalSetLayout = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .createLayout("indirect-temporal-layout");
+    createIndirectTargets();
+}
+
+std::string SDFCornell::indirectResourceName(const char* base) const {
+    // Same scheme as rsmResourceName(), one suffix per divisor switch
+    return std::string(base) + "_" + std::to_string(indirectGeneration);
+}
+
+VkExtent2D SDFCornell::getIndirectExtent() const {
+    const VkExtent2D extent = getTargetExtent();
+    return {getCornellIndirectSize(extent.width, indirectDivisor), getCornellIndirectSize(extent.height, indirectDivisor)};
+}
+
+void SDFCornell::createIndirectTargets() {
+    const VkExtent2D extent = getIndirectExtent();
+    auto createImage = [&](const char* name, VkImageUsageFlags usage, VkImage& image, VmaAllocation& alloc, VkImageView& view) {
+        ev::ImageInfo info = resourceManager->createImage()
             .setFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
-            .setExtent(rsmWidth, rsmHeight)
-            .setUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
-            .build(name, &alloc);
+            .setExtent(extent.width, extent.height)
+            .setUsage(usage)
+            .build(indirectResourceName(name), &alloc);
         image = info.image;
         view = info.imageView;
     };
-    recreateAttachment("rsm_position", rsmPositionImage, rsmPositionAlloc, rsmPositionView);
-    recreateAttachment("rsm_normal",   rsmNormalImage,   rsmNormalAlloc,   rsmNormalView);
-    recreateAttachment("rsm_flux",     rsmFluxImage,     rsmFluxAlloc,     rsmFluxView);
+    createImage("indirect_raw", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                indirectRawImage, indirectRawAlloc, indirectRawView);
+    createImage("indirect_accum", VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                indirectAccumImage, indirectAccumAlloc, indirectAccumView);
+    createImage("indirect_history", VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                indirectHistoryImage, indirectHistoryAlloc, indirectHistoryView);
 
-    // Recreate framebuffer with existing render pass
     auto fb = resourceManager->createFramebuffer();
-    rsmFramebuffer = fb
-        .addAttachment(rsmPositionView)
-        .addAttachment(rsmNormalView)
-        .addAttachment(rsmFluxView)
-        .setDimensions(rsmWidth, rsmHeight)
-        .build(rsmRenderPass, "rsm-fb");
+    indirectFramebuffer = fb
+        .addAttachment(indirectRawView)
+        .setDimensions(extent.width, extent.height)
+        .build(indirectRenderPass, indirectResourceName("indirect-fb"));
+
+    // Both halves of the reservoirs, or a placeholder for the binding without ReSTIR
+    const VkDeviceSize reservoirCount = indirectReservoirs ? 2ull * extent.width * extent.height : 1ull;
+    restirReservoirBuffer = resourceManager->createBuffer()
+        .setSize(sizeof(GpuRestirReservoir) * reservoirCount)
+        .setUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+        .setMemoryProperties(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+        .build(indirectResourceName("restir-reservoirs"));
+    restirReservoirsValid = false;
+
+    indirectTemporalSet = resourceManager->createDescriptorSet()
+        .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addImageDescriptor(0, indirectRawView, rsmPyramidSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addImageDescriptor(1, indirectHistoryView, rsmSampler, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        .addImageDescriptor(2, indirectAccumView, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+        .build(indirectTemporalSetLayout, indirectResourceName("indirect-temporal-set"));
+}
 
-    // Recreate and rebind descriptor sets to updated image views
-    size_t count = swapchainManager->getSwapchainImages().size();
-    descriptorSets.resize(count);
-    for (size_t i = 0; i < count; ++i) {
-        std::string dsName = std::string("SDFCornell_descriptor_set_") + std::to_string(i);
-        resourceManager->clearResource(dsName, VK_OBJECT_TYPE_DESCRIPTOR_SET);
-        auto builder = resourceManager->createDescriptorSet();
-        builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-               .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-               .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-               .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-               .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-               .addBufferDescriptor(0, uniformBuffer, 0, sizeof(SDFCornellUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
-               .addImageDescriptor(1, rsmPositionView, rsmSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-               .addImageDescriptor(2, rsmNormalView, rsmSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-               .addImageDescriptor(3, rsmFluxView, rsmSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-               .addImageDescriptor(4, flowerTextureView, flowerTextureSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-        descriptorSets[i] = builder.build(descriptorSetLayout, dsName);
+void SDFCornell::recreateIndirectTargets(uint32_t newDivisor, bool withReservoirs) {
+    // As recreateRSMResources(): frames in flight keep the old targets until they retire
+    std::vector<std::pair<std::string, VkObjectType>> retired = {
+        {indirectResourceName("indirect-fb"), VK_OBJECT_TYPE_FRAMEBUFFER},
+        {indirectResourceName("indirect_raw"), VK_OBJECT_TYPE_IMAGE},
+        {indirectResourceName("indirect_accum"), VK_OBJECT_TYPE_IMAGE},
+        {indirectResourceName("indirect_history"), VK_OBJECT_TYPE_IMAGE},
+        {indirectResourceName("indirect-temporal-set"), VK_OBJECT_TYPE_DESCRIPTOR_SET},
+        {indirectResourceName("restir-reservoirs"), VK_OBJECT_TYPE_BUFFER},
+    };
+    for (size_t i = 0; i < descriptorSets.size(); ++i) {
+        retired.emplace_back(descriptorSetName(i), VK_OBJECT_TYPE_DESCRIPTOR_SET);
     }
+    deletionQueue.defer([rm = resourceManager, retired = std::move(retired)] {
+        for (const auto& [name, type] : retired) {
+            rm->clearResource(name, type);
+        }
+    });
+
+    ++indirectGeneration;
+    indirectDivisor = newDivisor;
+    indirectReservoirs = withReservoirs;
+    indirectImagesInitialized = false;
+    indirectHistoryKey = 0;
+    createIndirectTargets();
+    createDescriptorSets();
 }
 
 void SDFCornell::createVertexBuffer() {
@@ -305,75 +608,390 @@ void SDFCornell::createFlowerTexture() {
         .build("flower-sampler");
 }
 
-void SDFCornell::createPipeline() {
-    std::string vertShaderPath = "shaders/triangle.vert.spv";
-    std::string fragShaderPath = "shaders/sdf_practice.frag.spv";
-
-    auto vert = resourceManager->createShaderModule().loadFromFile(vertShaderPath).build("SDFCornell-vert");
-    auto frag = resourceManager->createShaderModule().loadFromFile(fragShaderPath).build("SDFCornell-frag");
+namespace {
 
+VkVertexInputBindingDescription cornellVertexBinding() {
     VkVertexInputBindingDescription binding{};
     binding.binding = 0;
     binding.stride = sizeof(SDFCornellVertex);
     binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    return binding;
+}
 
-    std::array<VkVertexInputAttributeDescription, 3> attrs{};
+std::vector<VkVertexInputAttributeDescription> cornellVertexAttributes() {
+    std::vector<VkVertexInputAttributeDescription> attrs(3);
     attrs[0].binding = 0; attrs[0].location = 0; attrs[0].format = VK_FORMAT_R32G32_SFLOAT; attrs[0].offset = offsetof(SDFCornellVertex, pos);
     attrs[1].binding = 0; attrs[1].location = 1; attrs[1].format = VK_FORMAT_R32G32B32_SFLOAT; attrs[1].offset = offsetof(SDFCornellVertex, color);
     attrs[2].binding = 0; attrs[2].location = 2; attrs[2].format = VK_FORMAT_R32G32_SFLOAT; attrs[2].offset = offsetof(SDFCornellVertex, texCoord);
+    return attrs;
+}
+
+} // namespace
+
+void SDFCornell::createPipeline() {
+    mainVertShader = resourceManager->createShaderModule().loadFromFile("shaders/triangle.vert.spv").build("SDFCornell-vert");
+    mainFragShader = resourceManager->createShaderModule().loadFromFile("shaders/sdf_practice.frag.spv").build("SDFCornell-frag");
+    // The startup variant is part of the timed pipeline build; the rest follow the UI
+    activeVariantKey = makeCornellVariantKey(settings);
+    requestPipelineVariant(activeVariantKey, true);
+}
+
+void SDFCornell::requestPipelineVariant(uint32_t key, bool urgent) {
+    if (usesCornellIndirectPass(key)) {
+        // Useless without the pass that renders its input
+        requestPipelineVariant(makeCornellIndirectPassKey(key), urgent);
+    }
+    if (pipelineVariants.count(key)) {
+        return;
+    }
+    // Only handles fixed after init are captured, so the build may run on any worker
+    pipelineVariants[key].pending = pipelineBuilds.submit([this, key] { return buildPipelineVariant(key); }, urgent);
+}
 
-    auto pipelineBuilder = resourceManager->createGraphicsPipeline();
-    pipeline = pipelineBuilder
-        .addShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vert)
-        .addShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, frag)
-        .setVertexInputState(binding, std::vector<VkVertexInputAttributeDescription>(attrs.begin(), attrs.end()))
-        .setInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP)
-        .setDynamicState({VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR})
-        .setDepthStencilState(VK_FALSE, VK_FALSE, VK_COMPARE_OP_ALWAYS)
-        .setColorBlendState({VkPipelineColorBlendAttachmentState{VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT}})
-        .setRenderPass(renderPass, 0)
-        .setDescriptorSetLayouts({descriptorSetLayout})
-        .build("SDFCornell-pipeline");
+BuiltPipeline SDFCornell::buildPipelineVariant(uint32_t key) const {
+    // constant_id 0..15 are the key bits, then MAX_STEPS and SOFT_SHADOW_STEPS
+    std::array<uint32_t, kCornellVariantFlagCount + 2> constants{};
+    std::array<VkSpecializationMapEntry, kCornellVariantFlagCount + 2> entries{};
+    for (uint32_t i = 0; i < kCornellVariantFlagCount; ++i) {
+        constants[i] = (key >> i) & 1u ? VK_TRUE : VK_FALSE;
+    }
+    constants[kCornellVariantFlagCount] = static_cast<uint32_t>(kMaxSteps);
+    constants[kCornellVariantFlagCount + 1] = static_cast<uint32_t>(kSoftShadowSteps);
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        entries[i].constantID = i;
+        entries[i].offset = i * sizeof(uint32_t);
+        entries[i].size = sizeof(uint32_t);
+    }
+    VkSpecializationInfo specialization{};
+    specialization.mapEntryCount = static_cast<uint32_t>(entries.size());
+    specialization.pMapEntries = entries.data();
+    specialization.dataSize = sizeof(constants);
+    specialization.pData = constants.data();
+
+    FullscreenPipelineDesc desc;
+    desc.vertexShader = mainVertShader;
+    desc.fragmentShader = mainFragShader;
+    desc.vertexBinding = cornellVertexBinding();
+    desc.vertexAttributes = cornellVertexAttributes();
+    desc.renderPass = (key & kCornellVariantIndirectPass) ? indirectRenderPass : renderPass;
+    desc.setLayouts = {descriptorSetLayout};
+    desc.fragmentSpecialization = &specialization;
+
+    BuiltPipeline built;
+    built.pipeline = createFullscreenPipeline(device->getLogicalDevice(), pipelineCache.get(), desc, &built.layout);
+    return built;
+}
+
+void SDFCornell::precompilePipelineVariants() {
+    // Every setting one checkbox away from the startup state
+    bool SDFCornellSettings::*toggles[] = {
+        &SDFCornellSettings::enableKey, &SDFCornellSettings::enableFill, &SDFCornellSettings::enableRim,
+        &SDFCornellSettings::enableEnv, &SDFCornellSettings::enableRSM, &SDFCornellSettings::enableIndirectLighting,
+        &SDFCornellSettings::enableImportanceSampling, &SDFCornellSettings::enableHierarchicalSampling,
+        &SDFCornellSettings::enableVplClustering, &SDFCornellSettings::enableTemporalIndirect, &SDFCornellSettings::enableRestir,
+        &SDFCornellSettings::enablePBR,
+        &SDFCornellSettings::showRSMOnly, &SDFCornellSettings::showIndirectOnly,
+    };
+    for (bool SDFCornellSettings::*toggle : toggles) {
+        SDFCornellSettings neighbour = settings;
+        neighbour.*toggle = !(neighbour.*toggle);
+        requestPipelineVariant(makeCornellVariantKey(neighbour), false);
+    }
+    // Every reduced indirect resolution shares one variant
+    SDFCornellSettings reduced = settings;
+    reduced.indirectResolutionDivisor = settings.indirectResolutionDivisor > 1 ? 1 : 2;
+    requestPipelineVariant(makeCornellVariantKey(reduced), false);
+}
 
-    pipelineLayout = pipelineBuilder.getPipelineLayout();
+const BuiltPipeline& SDFCornell::selectPipelineVariant(uint32_t key) {
+    requestPipelineVariant(key, true);
+    // Collect whatever finished, so the panel reports precompiled variants too
+    for (auto& entry : pipelineVariants) {
+        PipelineVariant& variant = entry.second;
+        if (PipelineBuildService::isReady(variant.pending)) {
+            variant.built = variant.pending.get();
+            lastVariantBuildMs = variant.built.buildMs;
+        }
+    }
+    // Until the wanted variant (and its indirect pass) is compiled, keep drawing with the last one
+    const bool passReady = !usesCornellIndirectPass(key) ||
+                           pipelineVariants[makeCornellIndirectPassKey(key)].built.pipeline != VK_NULL_HANDLE;
+    if (pipelineVariants[key].built.pipeline != VK_NULL_HANDLE && passReady) {
+        activeVariantKey = key;
+    }
+    return pipelineVariants[activeVariantKey].built;
 }
 
-void SDFCornell::createRSMPipeline() {
+std::future<BuiltPipeline> SDFCornell::createRSMPipeline(RSMEncoding encoding) {
     // Fullscreen quad vertex + RSM light frag
     std::string vertShaderPath = "shaders/triangle.vert.spv";
     std::string fragShaderPath = "shaders/rsm_light.frag.spv";
 
-    auto vert = resourceManager->createShaderModule().loadFromFile(vertShaderPath).build("rsm-vert");
-    auto frag = resourceManager->createShaderModule().loadFromFile(fragShaderPath).build("rsm-frag");
+    const std::string suffix = toString(encoding);
+    auto vert = resourceManager->createShaderModule().loadFromFile(vertShaderPath).build("rsm-vert-" + suffix);
+    auto frag = resourceManager->createShaderModule().loadFromFile(fragShaderPath).build("rsm-frag-" + suffix);
+
+    // Position / normal / flux MRT; the shader picks the encoding from the uniforms
+    FullscreenPipelineDesc desc;
+    desc.vertexShader = vert;
+    desc.fragmentShader = frag;
+    desc.vertexBinding = cornellVertexBinding();
+    desc.vertexAttributes = cornellVertexAttributes();
+    desc.renderPass = rsmRenderPasses[static_cast<size_t>(encoding)];
+    desc.colorAttachmentCount = 3;
+    desc.setLayouts = {descriptorSetLayout};
+    VkDevice logicalDevice = device->getLogicalDevice();
+    VkPipelineCache cache = pipelineCache.get();
+    return pipelineBuilds.submit([logicalDevice, cache, desc] {
+        BuiltPipeline built;
+        built.pipeline = createFullscreenPipeline(logicalDevice, cache, desc, &built.layout);
+        return built;
+    }, true);
+}
 
-    VkVertexInputBindingDescription binding{};
-    binding.binding = 0;
-    binding.stride = sizeof(SDFCornellVertex);
-    binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+std::future<BuiltPipeline> SDFCornell::createRSMPyramidPipeline() {
+    auto comp = resourceManager->createShaderModule().loadFromFile("shaders/rsm_pyramid.comp.spv").build("rsm-pyramid-comp");
+
+    // RSMLightFrame, mode, level
+    VkPushConstantRange range{};
+    range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    range.offset = 0;
+    range.size = sizeof(RSMLightFrame) + 2 * sizeof(int32_t);
+    ComputePipelineDesc desc;
+    desc.computeShader = comp;
+    desc.setLayouts = {rsmPyramidSetLayout};
+    desc.pushConstantRanges = {range};
+    VkDevice logicalDevice = device->getLogicalDevice();
+    VkPipelineCache cache = pipelineCache.get();
+    return pipelineBuilds.submit([logicalDevice, cache, desc] {
+        BuiltPipeline built;
+        built.pipeline = createComputePipeline(logicalDevice, cache, desc, &built.layout);
+        return built;
+    }, true);
+}
 
-    std::array<VkVertexInputAttributeDescription, 3> attrs{};
-    attrs[0].binding = 0; attrs[0].location = 0; attrs[0].format = VK_FORMAT_R32G32_SFLOAT; attrs[0].offset = offsetof(SDFCornellVertex, pos);
-    attrs[1].binding = 0; attrs[1].location = 1; attrs[1].format = VK_FORMAT_R32G32B32_SFLOAT; attrs[1].offset = offsetof(SDFCornellVertex, color);
-    attrs[2].binding = 0; attrs[2].location = 2; attrs[2].format = VK_FORMAT_R32G32_SFLOAT; attrs[2].offset = offsetof(SDFCornellVertex, texCoord);
+void SDFCornell::recordRSMPyramidPass(VkCommandBuffer cmd) {
+    // Runs right after the RSM pass (whose barrier already covers compute reads);
+    // the previous build's fragment readers must finish before it is overwritten
+    VkMemoryBarrier barrier{}; barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0; barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    gpuProfiler.beginScope(cmd, "RSM Pyramid");
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, rsmPyramidPipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, rsmPyramidPipelineLayout, 0, 1, &rsmPyramidSet, 0, nullptr);
+    vkCmdPushConstants(cmd, rsmPyramidPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(RSMLightFrame), &rsmLightFrame);
+    auto dispatch = [&](int32_t mode, int32_t level, uint32_t groupsX, uint32_t groupsY) {
+        const int32_t pushConstants[2] = {mode, level};
+        vkCmdPushConstants(cmd, rsmPyramidPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(RSMLightFrame),
+                           sizeof(pushConstants), pushConstants);
+        vkCmdDispatch(cmd, groupsX, groupsY, 1);
+    };
+    // Level 0 and the clusters only read the RSM; every further level reads the one below
+    const uint32_t baseGroups = dispatchGroupCount(rsmPyramidLayout.baseSize, 16);
+    dispatch(0, 0, baseGroups, baseGroups);
+    dispatch(2, 0, rsmPyramidLayout.clusterCount, rsmPyramidLayout.clusterCount);
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT; barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    for (uint32_t level = 1; level < rsmPyramidLayout.levelCount; ++level) {
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+        const uint32_t groups = dispatchGroupCount(rsmPyramidLayout.getLevelSize(level), 16);
+        dispatch(1, static_cast<int32_t>(level), groups, groups);
+    }
+    // Read by the main pass and, for clustered VPLs, by vpl_cluster.comp
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    gpuProfiler.endScope(cmd);
+}
+
+std::future<BuiltPipeline> SDFCornell::createVplClusterPipeline() {
+    auto comp = resourceManager->createShaderModule().loadFromFile("shaders/vpl_cluster.comp.spv").build("vpl-cluster-comp");
+
+    // RSMLightFrame, mode, clusterCount, iteration
+    VkPushConstantRange range{};
+    range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    range.offset = 0;
+    range.size = sizeof(RSMLightFrame) + 3 * sizeof(int32_t);
+    ComputePipelineDesc desc;
+    desc.computeShader = comp;
+    desc.setLayouts = {vplClusterSetLayout};
+    desc.pushConstantRanges = {range};
+    VkDevice logicalDevice = device->getLogicalDevice();
+    VkPipelineCache cache = pipelineCache.get();
+    return pipelineBuilds.submit([logicalDevice, cache, desc] {
+        BuiltPipeline built;
+        built.pipeline = createComputePipeline(logicalDevice, cache, desc, &built.layout);
+        return built;
+    }, true);
+}
+
+void SDFCornell::recordVplClusterPass(VkCommandBuffer cmd, uint32_t clusterCount) {
+    // The RSM and its pyramid are already visible to compute (their barriers, this or
+    // an earlier frame); earlier frames' fragment shaders must be done with the list
+    VkMemoryBarrier barrier{}; barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0; barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    gpuProfiler.beginScope(cmd, "VPL Clusters");
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, vplClusterPipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, vplClusterPipelineLayout, 0, 1, &vplClusterSet, 0, nullptr);
+    vkCmdPushConstants(cmd, vplClusterPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(RSMLightFrame), &rsmLightFrame);
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    auto dispatch = [&](int32_t mode, int32_t iteration, uint32_t groups) {
+        const int32_t pushConstants[3] = {mode, static_cast<int32_t>(clusterCount), iteration};
+        vkCmdPushConstants(cmd, vplClusterPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(RSMLightFrame),
+                           sizeof(pushConstants), pushConstants);
+        vkCmdDispatch(cmd, groups, 1, 1);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    };
+    dispatch(0, 0, kVplClusterCellCount / 256);
+    if (vplClusterSeededCount != clusterCount) {
+        dispatch(1, 0, dispatchGroupCount(clusterCount, 256));
+        vplClusterSeededCount = clusterCount;
+    }
+    // Lloyd steps: assign every cell, then one workgroup per centroid
+    for (uint32_t iteration = 0; iteration < kVplClusterIterations; ++iteration) {
+        dispatch(2, static_cast<int32_t>(iteration), kVplClusterCellCount / 256);
+        dispatch(3, static_cast<int32_t>(iteration), clusterCount);
+    }
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    gpuProfiler.endScope(cmd);
+    vplClustersStale = false;
+}
+
+namespace {
+
+// indirect_temporal.comp push constants
+struct TemporalIndirectPushConstants {
+    float sphereCenters[2][4];     // this frame, w radius
+    float prevSphereCenters[2][4]; // when the history was written
+    float params[4];               // x aspect, y max frames, z 1: drop the history
+};
+
+} // namespace
+
+std::future<BuiltPipeline> SDFCornell::createTemporalIndirectPipeline() {
+    auto comp = resourceManager->createShaderModule().loadFromFile("shaders/indirect_temporal.comp.spv").build("indirect-temporal-comp");
+
+    VkPushConstantRange range{};
+    range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    range.offset = 0;
+    range.size = sizeof(TemporalIndirectPushConstants);
+    ComputePipelineDesc desc;
+    desc.computeShader = comp;
+    desc.setLayouts = {indirectTemporalSetLayout};
+    desc.pushConstantRanges = {range};
+    VkDevice logicalDevice = device->getLogicalDevice();
+    VkPipelineCache cache = pipelineCache.get();
+    return pipelineBuilds.submit([logicalDevice, cache, desc] {
+        BuiltPipeline built;
+        built.pipeline = createComputePipeline(logicalDevice, cache, desc, &built.layout);
+        return built;
+    }, true);
+}
+
+void SDFCornell::recordIndirectPass(VkCommandBuffer cmd, uint32_t imageIndex, uint32_t uniformOffset) {
+    const uint32_t passKey = makeCornellIndirectPassKey(activeVariantKey);
+    const BuiltPipeline& pass = pipelineVariants[passKey].built;
+    const VkExtent2D extent = getIndirectExtent();
+    const VkExtent2D targetExtent = getTargetExtent();
+
+    const bool restir = (activeVariantKey & kCornellVariantRestir) != 0;
+
+    // The previous frame's resolve or upsampling main pass may still read the raw
+    // output; its pass wrote the reservoirs this one reads, its main pass read the
+    // half this one writes
+    VkMemoryBarrier reservoirBarrier{}; reservoirBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    reservoirBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    reservoirBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 1, &reservoirBarrier, 0, nullptr, 0, nullptr);
+    if (restir && !restirReservoirsValid) {
+        // Surface distance 0 everywhere: the pass finds nothing to reuse
+        vkCmdFillBuffer(cmd, restirReservoirBuffer, 0, VK_WHOLE_SIZE, 0);
+        reservoirBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 1, &reservoirBarrier, 0, nullptr, 0, nullptr);
+    }
+    gpuProfiler.beginScope(cmd, "Indirect");
+    VkRenderPassBeginInfo rp{}; rp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; rp.renderPass = indirectRenderPass; rp.framebuffer = indirectFramebuffer;
+    rp.renderArea.offset = {0, 0}; rp.renderArea.extent = extent;
+    vkCmdBeginRenderPass(cmd, &rp, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pass.pipeline);
+    VkViewport viewport{}; viewport.width = static_cast<float>(extent.width); viewport.height = static_cast<float>(extent.height); viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+    VkRect2D scissor{}; scissor.extent = extent; vkCmdSetScissor(cmd, 0, 1, &scissor);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pass.layout, 0, 1, &descriptorSets[imageIndex], 1, &uniformOffset);
+    VkDeviceSize offsets[] = {0};
+    vkCmdBindVertexBuffers(cmd, 0, 1, &fullscreenVertexBuffer, offsets);
+    vkCmdDraw(cmd, 4, 1, 0, 0);
+    vkCmdEndRenderPass(cmd);
+    gpuProfiler.endScope(cmd);
+
+    if (restir) {
+        // The main pass reads this half; the next frame's pass reuses it
+        restirHalf ^= 1u;
+        restirReservoirsValid = true;
+        std::copy(&frameUniforms.sphereCenters[0][0], &frameUniforms.sphereCenters[0][0] + 8, &restirSphereCenters[0][0]);
+    } else {
+        restirReservoirsValid = false;
+    }
+
+    VkMemoryBarrier barrier{}; barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    if (!(activeVariantKey & kCornellVariantTemporalIndirect)) {
+        // Upsampled or resampled by the main pass as it is
+        barrier.srcAccessMask |= VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        indirectHistoryKey = 0;
+        return;
+    }
 
-    auto builder = resourceManager->createGraphicsPipeline();
-    rsmPipeline = builder
-        .addShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vert)
-        .addShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, frag)
-        .setVertexInputState(binding, std::vector<VkVertexInputAttributeDescription>(attrs.begin(), attrs.end()))
-        .setInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP)
-        .setDynamicState({VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR})
-        .setDepthStencilState(VK_FALSE, VK_FALSE, VK_COMPARE_OP_ALWAYS)
-        .setColorBlendState({
-            VkPipelineColorBlendAttachmentState{VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_COLOR_COMPONENT_R_BIT|VK_COLOR_COMPONENT_G_BIT|VK_COLOR_COMPONENT_B_BIT|VK_COLOR_COMPONENT_A_BIT},
-            VkPipelineColorBlendAttachmentState{VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_COLOR_COMPONENT_R_BIT|VK_COLOR_COMPONENT_G_BIT|VK_COLOR_COMPONENT_B_BIT|VK_COLOR_COMPONENT_A_BIT},
-            VkPipelineColorBlendAttachmentState{VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_COLOR_COMPONENT_R_BIT|VK_COLOR_COMPONENT_G_BIT|VK_COLOR_COMPONENT_B_BIT|VK_COLOR_COMPONENT_A_BIT}
-        })
-        .setRenderPass(rsmRenderPass, 0)
-        .setDescriptorSetLayouts({descriptorSetLayout})
-        .build("rsm-pipeline");
-
-    rsmPipelineLayout = builder.getPipelineLayout();
+    // Raw taps to the resolve; the previous main pass must be done reading the output
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    gpuProfiler.beginScope(cmd, "Indirect Resolve");
+    TemporalIndirectPushConstants push{};
+    std::copy(&frameUniforms.sphereCenters[0][0], &frameUniforms.sphereCenters[0][0] + 8, &push.sphereCenters[0][0]);
+    std::copy(&indirectHistorySphereCenters[0][0], &indirectHistorySphereCenters[0][0] + 8, &push.prevSphereCenters[0][0]);
+    // The pass rendered its rays with the aspect of the full target
+    push.params[0] = static_cast<float>(targetExtent.width) / static_cast<float>(targetExtent.height);
+    push.params[1] = kTemporalIndirectMaxFrames;
+    // Nothing to reproject after a frame without the pass or with another sampling pattern
+    push.params[2] = indirectHistoryKey == passKey ? 0.0f : 1.0f;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, indirectTemporalPipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, indirectTemporalPipelineLayout, 0, 1, &indirectTemporalSet, 0, nullptr);
+    vkCmdPushConstants(cmd, indirectTemporalPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+    vkCmdDispatch(cmd, dispatchGroupCount(extent.width, 8), dispatchGroupCount(extent.height, 8), 1);
+
+    // Output to the main pass and to the copy, which also has to wait for the history reads
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT; barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    VkImageCopy region{};
+    region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.extent = {extent.width, extent.height, 1};
+    vkCmdCopyImage(cmd, indirectAccumImage, VK_IMAGE_LAYOUT_GENERAL, indirectHistoryImage, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+    // History to the next frame's resolve
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT; barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    gpuProfiler.endScope(cmd);
+
+    indirectHistoryKey = passKey;
+    std::copy(&frameUniforms.sphereCenters[0][0], &frameUniforms.sphereCenters[0][0] + 8, &indirectHistorySphereCenters[0][0]);
 }
 
 void SDFCornell::createCommandBuffers() {
@@ -381,89 +999,226 @@ void SDFCornell::createCommandBuffers() {
         commandPool = cmdPoolManager->createCommandPool(device->getGraphicsQueueFamily(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
     }
     auto builder = resourceManager->createCommandBuffer();
-    commandBuffers = builder.setCommandPool(commandPool).setCount(swapchainManager->getSwapchainImageViews().size()).buildMultiple();
+    commandBuffers = builder.setCommandPool(commandPool).setCount(getTargetCount()).buildMultiple();
 }
 
 void SDFCornell::recordCommandBuffer(uint32_t imageIndex) {
     VkCommandBuffer cmd = commandBuffers[imageIndex];
     VkCommandBufferBeginInfo begin{}; begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; begin.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
     vkBeginCommandBuffer(cmd, &begin);
-
-    // RSM pass (offscreen)
-    if (enableRSM) {
+    gpuProfiler.beginFrame(cmd, currentFrame);
+
+    // Both passes read the UBO slice written for this frame in flight
+    uint32_t uniformOffset = uniformRing.getDynamicOffset(currentFrame);
+
+    if (!rsmPyramidInitialized) {
+        // Written only by the pyramid pass, but bound by every frame
+        for (VkImage image : {rsmPyramidImage, rsmClusterConeImage, rsmClusterBoundsImage}) {
+            imageBarrier(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                         0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+        rsmPyramidInitialized = true;
+    }
+    // RSM pass (offscreen), skipped while the previous contents are still current
+    if (rsmRenderThisFrame) {
+        gpuProfiler.beginScope(cmd, "RSM");
         VkClearValue clears[3];
         clears[0].color = {{0,0,0,0}};
         clears[1].color = {{0,0,0,0}};
         clears[2].color = {{0,0,0,0}};
-        VkRenderPassBeginInfo rsmRp{}; rsmRp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; rsmRp.renderPass = rsmRenderPass; rsmRp.framebuffer = rsmFramebuffer;
-        rsmRp.renderArea.offset = {0, 0}; rsmRp.renderArea.extent = {rsmWidth, rsmHeight}; rsmRp.clearValueCount = 3; rsmRp.pClearValues = clears;
+        // Only the spheres moved: redraw their footprints over the previous contents
+        const bool partial = rsmScheduler.isPartialRender();
+        // Clipped to the RSM by the scheduler
+        auto toVkRect = [](const RSMRect& rect) {
+            VkRect2D r{};
+            r.offset = {static_cast<int32_t>(rect.x), static_cast<int32_t>(rect.y)};
+            r.extent = {rect.width, rect.height};
+            return r;
+        };
+        if (partial) {
+            // The previous frames' passes may still read the texels about to be overwritten
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+        }
+        VkRenderPassBeginInfo rsmRp{}; rsmRp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; rsmRp.framebuffer = rsmFramebuffer;
+        rsmRp.renderPass = (partial ? rsmPartialRenderPasses : rsmRenderPasses)[static_cast<size_t>(rsmEncoding)];
+        rsmRp.renderArea = toVkRect(rsmScheduler.getRenderBounds()); rsmRp.clearValueCount = 3; rsmRp.pClearValues = clears;
         vkCmdBeginRenderPass(cmd, &rsmRp, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, rsmPipeline);
+        const BuiltPipeline& rsm = rsmPipelines[static_cast<size_t>(rsmEncoding)];
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, rsm.pipeline);
+        // Full viewport so fragTexCoord still spans the RSM; the scissors do the culling
         VkViewport vp{}; vp.x = 0.0f; vp.y = 0.0f; vp.width = (float)rsmWidth; vp.height = (float)rsmHeight; vp.minDepth = 0.0f; vp.maxDepth = 1.0f;
         vkCmdSetViewport(cmd, 0, 1, &vp);
-        VkRect2D sc{}; sc.offset = {0,0}; sc.extent = {rsmWidth, rsmHeight}; vkCmdSetScissor(cmd, 0, 1, &sc);
-        // Use same descriptor set (binding 0 UBO)
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, rsmPipelineLayout, 0, 1, &descriptorSets[imageIndex], 0, nullptr);
+        // Use same descriptor set (binding 0 UBO, this frame's slice)
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, rsm.layout, 0, 1, &descriptorSets[imageIndex], 1, &uniformOffset);
         VkDeviceSize offsets[] = {0};
         vkCmdBindVertexBuffers(cmd, 0, 1, &fullscreenVertexBuffer, offsets);
-        vkCmdDraw(cmd, 4, 1, 0, 0);
+        for (const RSMRect& rect : rsmScheduler.getRenderRects()) {
+            const VkRect2D scissor = toVkRect(rect);
+            vkCmdSetScissor(cmd, 0, 1, &scissor);
+            vkCmdDraw(cmd, 4, 1, 0, 0);
+        }
         vkCmdEndRenderPass(cmd);
-    }else{
+        // Make the attachments visible to the pyramid build and to this and all later
+        // frames' fragment shaders, since skipped frames sample them without re-rendering
+        VkMemoryBarrier rsmBarrier{}; rsmBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        rsmBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; rsmBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 1, &rsmBarrier, 0, nullptr, 0, nullptr);
+        gpuProfiler.endScope(cmd);
+        rsmImagesInitialized = true;
+        // Rebuilt with every RSM, hierarchical sampling on or off, so toggling it never reads a stale pyramid
+        recordRSMPyramidPass(cmd);
+        vplClustersStale = true;
+    } else if (!rsmImagesInitialized) {
+        // Never rendered (RSM off): the shader still binds the images, so give them a valid layout once
         ev::ResourceUtils::transitionImageLayout(
             device, cmd, rsmPositionImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
         ev::ResourceUtils::transitionImageLayout(
             device, cmd, rsmNormalImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
         ev::ResourceUtils::transitionImageLayout(
             device, cmd, rsmFluxImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        rsmImagesInitialized = true;
+    }
+
+    const BuiltPipeline& variant = pipelineVariants[activeVariantKey].built; // picked in drawFrame
+    if (activeVariantKey & kCornellVariantVplClusters) {
+        // Only while the list is drawn: refine after RSM updates, reseed on a new count
+        const uint32_t clusterCount = static_cast<uint32_t>(std::clamp(settings.vplClusterCount, kMinVplClusters, kMaxVplClusters));
+        if (vplClustersStale || clusterCount != vplClusterSeededCount) {
+            recordVplClusterPass(cmd, clusterCount);
+        }
+    }
+    if (!indirectImagesInitialized) {
+        // The main pass binds the output every frame, temporal accumulation on or off
+        imageBarrier(cmd, indirectAccumImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                     0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        imageBarrier(cmd, indirectHistoryImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                     0, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        indirectImagesInitialized = true;
+    }
+    if (usesCornellIndirectPass(activeVariantKey)) {
+        recordIndirectPass(cmd, imageIndex, uniformOffset);
+    } else {
+        indirectHistoryKey = 0; // stale once a frame goes by without the pass
+        restirReservoirsValid = false;
     }
 
     VkClearValue clear = {{{0.03f, 0.05f, 0.09f, 1.0f}}};
     VkRenderPassBeginInfo rp{}; rp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; rp.renderPass = renderPass; rp.framebuffer = framebuffers[imageIndex];
-    rp.renderArea.offset = {0, 0}; rp.renderArea.extent = swapchainManager->getSwapchainExtent(); rp.clearValueCount = 1; rp.pClearValues = &clear;
+    rp.renderArea.offset = {0, 0}; rp.renderArea.extent = getTargetExtent(); rp.clearValueCount = 1; rp.pClearValues = &clear;
     vkCmdBeginRenderPass(cmd, &rp, VK_SUBPASS_CONTENTS_INLINE);
 
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-    VkExtent2D extent = swapchainManager->getSwapchainExtent();
+    gpuProfiler.beginScope(cmd, "Main");
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, variant.pipeline);
+    VkExtent2D extent = getTargetExtent();
     VkViewport viewport{}; viewport.x = 0.0f; viewport.y = 0.0f; viewport.width = static_cast<float>(extent.width); viewport.height = static_cast<float>(extent.height); viewport.minDepth = 0.0f; viewport.maxDepth = 1.0f;
     vkCmdSetViewport(cmd, 0, 1, &viewport);
     VkRect2D scissor{}; scissor.offset = {0, 0}; scissor.extent = extent; vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[imageIndex], 0, nullptr);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, variant.layout, 0, 1, &descriptorSets[imageIndex], 1, &uniformOffset);
     VkDeviceSize offsets[] = {0};
     vkCmdBindVertexBuffers(cmd, 0, 1, &fullscreenVertexBuffer, offsets);
     vkCmdDraw(cmd, 4, 1, 0, 0);
+    gpuProfiler.endScope(cmd);
 
     if (auto* imgui = context->getImGuiManager()) {
         imgui->beginFrame();
         ImGui::Begin("SDF Practice Controls");
 
         ImGui::Text("Sphere Rotation");
-        ImGui::SliderFloat3("Euler (rad)", rotationEuler, -3.14159f, 3.14159f, "%.3f");
+        ImGui::SliderFloat3("Euler (rad)", settings.rotationEuler, -3.14159f, 3.14159f, "%.3f");
         ImGui::SliderFloat2("Virtual Joystick", virtualStick, -1.0f, 1.0f, "%.2f");
-        ImGui::SliderFloat("Anim Speed", &rotationAnimSpeed, 0.0f, 3.0f, "%.2f");
-        if (ImGui::Button("Reset Rotation")) { rotationEuler[0] = rotationEuler[1] = rotationEuler[2] = 0.0f; }
+        ImGui::SliderFloat("Anim Speed", &settings.rotationAnimSpeed, 0.0f, 3.0f, "%.2f");
+        if (ImGui::Button("Reset Rotation")) { settings.rotationEuler[0] = settings.rotationEuler[1] = settings.rotationEuler[2] = 0.0f; }
         ImGui::SameLine();
         if (ImGui::Button("Zero Stick")) { virtualStick[0] = virtualStick[1] = 0.0f; }
 
         ImGui::Separator();
         ImGui::Text("Sphere Color");
-        ImGui::ColorEdit3("Color", sphereColor);
+        ImGui::ColorEdit3("Color", settings.sphereColor);
 
         ImGui::Separator();
         ImGui::Text("Lighting");
-        ImGui::Checkbox("Key", &enableKey); ImGui::SameLine();
-        ImGui::Checkbox("Fill", &enableFill); ImGui::SameLine();
-        ImGui::Checkbox("Rim", &enableRim); ImGui::SameLine();
-        ImGui::Checkbox("Env", &enableEnv);
-        ImGui::Checkbox("Enable RSM", &enableRSM);
-        if (enableRSM) {
+        ImGui::Checkbox("Key", &settings.enableKey); ImGui::SameLine();
+        ImGui::Checkbox("Fill", &settings.enableFill); ImGui::SameLine();
+        ImGui::Checkbox("Rim", &settings.enableRim); ImGui::SameLine();
+        ImGui::Checkbox("Env", &settings.enableEnv);
+        ImGui::Checkbox("Enable RSM", &settings.enableRSM);
+        if (settings.enableRSM) {
             ImGui::SameLine();
-            ImGui::Checkbox("Indirect Lighting", &enableIndirectLighting);
-            ImGui::Checkbox("Importance Sampling", &enableImportanceSampling);
-            ImGui::SliderFloat("Indirect Intensity", &indirectIntensity, 0.0f, 2.0f, "%.2f");
+            ImGui::Checkbox("Indirect Lighting", &settings.enableIndirectLighting);
+            ImGui::Checkbox("Clustered VPLs", &settings.enableVplClustering);
+            if (settings.enableVplClustering) {
+                ImGui::SliderInt("VPL Clusters", &settings.vplClusterCount, kMinVplClusters, kMaxVplClusters);
+            } else {
+                ImGui::Checkbox("Hierarchical VPL Sampling", &settings.enableHierarchicalSampling);
+                if (settings.enableHierarchicalSampling) {
+                    ImGui::SliderInt("VPL Samples", &settings.vplSamples, 1, 16);
+                } else {
+                    ImGui::Checkbox("Importance Sampling", &settings.enableImportanceSampling);
+                }
+                ImGui::Checkbox("ReSTIR Reservoirs", &settings.enableRestir);
+                if (settings.enableRestir) {
+                    ImGui::SliderInt("Candidates", &settings.restirCandidates, 1, 32);
+                    ImGui::SliderInt("Spatial Neighbours", &settings.restirSpatialNeighbours, 0, 8);
+                } else {
+                    ImGui::Checkbox("Temporal Accumulation", &settings.enableTemporalIndirect);
+                    if (settings.enableTemporalIndirect) {
+                        ImGui::SliderInt("Taps per Frame", &settings.temporalTaps, 1, 16);
+                    }
+                }
+            }
+            const char* indirectResolutionItems[] = {"Full", "Half", "Quarter"};
+            int indirectResolutionIndex = clampCornellIndirectDivisor(settings.indirectResolutionDivisor) == 4 ? 2
+                                        : (settings.indirectResolutionDivisor >= 2 ? 1 : 0);
+            if (ImGui::Combo("Indirect Resolution", &indirectResolutionIndex, indirectResolutionItems, 3)) {
+                settings.indirectResolutionDivisor = 1 << indirectResolutionIndex;
+            }
+            ImGui::SliderFloat("Indirect Intensity", &settings.indirectIntensity, 0.0f, 2.0f, "%.2f");
+
+            const char* updateItems[] = {"Every Frame", "On Change", "Interval", "Budget"};
+            int updateIndex = static_cast<int>(rsmScheduler.getMode());
+            if (ImGui::Combo("RSM Update", &updateIndex, updateItems, 4)) {
+                rsmScheduler.setMode(static_cast<RSMUpdateMode>(updateIndex));
+            }
+            if (rsmScheduler.getMode() == RSMUpdateMode::Interval) {
+                int interval = static_cast<int>(rsmScheduler.getInterval());
+                if (ImGui::SliderInt("Refresh Interval", &interval, 1, 30)) {
+                    rsmScheduler.setInterval(static_cast<uint32_t>(interval));
+                }
+            } else if (rsmScheduler.getMode() == RSMUpdateMode::Budget) {
+                float budget = static_cast<float>(rsmScheduler.getBudgetMs());
+                if (ImGui::SliderFloat("RSM Budget (ms)", &budget, 0.1f, 5.0f, "%.2f")) {
+                    rsmScheduler.setBudgetMs(budget);
+                }
+            }
+            bool partialUpdates = rsmScheduler.getPartialUpdates();
+            if (ImGui::Checkbox("Partial RSM Updates", &partialUpdates)) {
+                rsmScheduler.setPartialUpdates(partialUpdates);
+            }
+            const RSMUpdateScheduler::Stats& rsmStats = rsmScheduler.getStats();
+            double lastTexels = 0.0;
+            for (const RSMRect& rect : rsmScheduler.getRenderRects()) {
+                lastTexels += static_cast<double>(rect.width) * rect.height;
+            }
+            ImGui::Text("RSM rendered %llu (%llu partial, last %.0f%%), reused %llu%s",
+                        static_cast<unsigned long long>(rsmStats.rendered),
+                        static_cast<unsigned long long>(rsmStats.partial),
+                        100.0 * lastTexels / (static_cast<double>(rsmWidth) * rsmHeight),
+                        static_cast<unsigned long long>(rsmStats.skipped),
+                        rsmScheduler.isStale() ? " (stale)" : "");
         }
-        ImGui::Checkbox("Show RSM Only", &showRSMOnly);
-        ImGui::Checkbox("Show Indirect Only", &showIndirectOnly);
+        ImGui::Checkbox("Show RSM Only", &settings.showRSMOnly);
+        ImGui::Checkbox("Show Indirect Only", &settings.showIndirectOnly);
+        ImGui::Text("Pipeline variants: %zu, %zu queued (drawing 0x%03x, last compile %.0f ms)",
+                    pipelineVariants.size(), pipelineBuilds.getQueuedCount(), activeVariantKey, lastVariantBuildMs);
         {
             const char* rsmItems[] = {"512", "1024", "2048", "4096"};
             int prevIndex = rsmResolutionIndex;
@@ -481,8 +1236,18 @@ void SDFCornell::recordCommandBuffer(uint32_t imageIndex) {
                     rsmRecreatePending = true;
                 }
             }
+            const char* encodingItems[] = {"Full (RGBA16F x3)", "Compact (depth + oct normal + R11G11B10)"};
+            int encodingIndex = static_cast<int>(rsmPendingEncoding);
+            if (!compactRSMSupported) {
+                ImGui::TextDisabled("Compact RSM encoding not supported on this device");
+            } else if (ImGui::Combo("RSM Encoding", &encodingIndex, encodingItems, 2)) {
+                rsmPendingEncoding = static_cast<RSMEncoding>(encodingIndex);
+                rsmRecreatePending = rsmRecreatePending || rsmPendingEncoding != rsmEncoding;
+            }
+            ImGui::Text("RSM attachments: %.1f MiB", static_cast<double>(rsmWidth) * rsmHeight *
+                        getRSMBytesPerTexel(rsmEncoding) / (1024.0 * 1024.0));
         }
-        ImGui::SliderFloat("Key Intensity", &keyIntensity, 0.0f, 3.0f, "%.2f");
+        ImGui::SliderFloat("Key Intensity", &settings.keyIntensity, 0.0f, 3.0f, "%.2f");
         
         ImGui::Text("Main Light Direction");
         
@@ -498,8 +1263,8 @@ void SDFCornell::recordCommandBuffer(uint32_t imageIndex) {
         draw_list->AddCircle(circle_center, circle_radius, IM_COL32(150, 150, 150, 255), 0, 2.0f);
         
         // Calculate light direction position on circle (convert from 3D to 2D projection)
-        float light_x = circle_center.x + (lightAzimuth / 3.14f) * circle_radius * 0.8f;
-        float light_y = circle_center.y - (lightElevation / 1.57f) * circle_radius * 0.8f;
+        float light_x = circle_center.x + (settings.lightAzimuth / 3.14f) * circle_radius * 0.8f;
+        float light_y = circle_center.y - (settings.lightElevation / 1.57f) * circle_radius * 0.8f;
         
         // Draw light direction indicator
         draw_list->AddCircleFilled(ImVec2(light_x, light_y), 6.0f, IM_COL32(255, 255, 100, 255));
@@ -519,61 +1284,65 @@ void SDFCornell::recordCommandBuffer(uint32_t imageIndex) {
                 rel_y /= dist;
             }
             
-            lightAzimuth = rel_x * 3.14f;
-            lightElevation = rel_y * 1.57f;
+            settings.lightAzimuth = rel_x * 3.14f;
+            settings.lightElevation = rel_y * 1.57f;
         }
         
         // Show numerical values and reset button
-        ImGui::Text("Elevation: %.2f°", lightElevation * 180.0f / 3.14159f);
-        ImGui::Text("Azimuth: %.2f°", lightAzimuth * 180.0f / 3.14159f);
-        if (ImGui::Button("Reset Light")) { lightElevation = 0.8f; lightAzimuth = -0.7f; }
-        ImGui::SliderFloat("Ambient", &ambientStrength, 0.0f, 1.0f, "%.2f");
-        ImGui::SliderFloat("Shadow Quality", &shadowQuality, 0.1f, 2.0f, "%.2f");
-        ImGui::SliderFloat("Shadow Intensity", &shadowIntensity, 0.0f, 1.0f, "%.2f");
-        ImGui::SliderFloat("Metallic", &metallic, 0.0f, 2.0f, "%.2f");
-        ImGui::SliderFloat("Blue Tint", &blueTint, 0.0f, 2.0f, "%.2f");
+        ImGui::Text("Elevation: %.2f°", settings.lightElevation * 180.0f / 3.14159f);
+        ImGui::Text("Azimuth: %.2f°", settings.lightAzimuth * 180.0f / 3.14159f);
+        if (ImGui::Button("Reset Light")) { settings.lightElevation = 0.8f; settings.lightAzimuth = -0.7f; }
+        ImGui::SliderFloat("Ambient", &settings.ambientStrength, 0.0f, 1.0f, "%.2f");
+        ImGui::SliderFloat("Shadow Quality", &settings.shadowQuality, 0.1f, 2.0f, "%.2f");
+        ImGui::SliderFloat("Shadow Intensity", &settings.shadowIntensity, 0.0f, 1.0f, "%.2f");
+        ImGui::SliderFloat("Metallic", &settings.metallic, 0.0f, 2.0f, "%.2f");
+        ImGui::SliderFloat("Blue Tint", &settings.blueTint, 0.0f, 2.0f, "%.2f");
 
         ImGui::Separator();
         ImGui::Text("PBR (Physically Based Rendering)");
-        ImGui::Checkbox("Enable PBR", &enablePBR);
+        ImGui::Checkbox("Enable PBR", &settings.enablePBR);
         
-        if (enablePBR) {
+        if (settings.enablePBR) {
             ImGui::Text("Global Settings");
-            ImGui::SliderFloat("Global Roughness", &globalRoughness, 0.0f, 1.0f, "%.3f");
-            ImGui::SliderFloat("Global Metallic", &globalMetallic, 0.0f, 1.0f, "%.3f");
-            ImGui::SliderFloat("Base Color Intensity", &baseColorIntensity, 0.1f, 3.0f, "%.2f");
+            ImGui::SliderFloat("Global Roughness", &settings.globalRoughness, 0.0f, 1.0f, "%.3f");
+            ImGui::SliderFloat("Global Metallic", &settings.globalMetallic, 0.0f, 1.0f, "%.3f");
+            ImGui::SliderFloat("Base Color Intensity", &settings.baseColorIntensity, 0.1f, 3.0f, "%.2f");
             
             ImGui::Text("Per-Material Settings");
             const char* materialItems[] = {"Sphere 1 (Textured)", "Sphere 2 (Colored)"};
             ImGui::Combo("Material", &selectedMaterial, materialItems, 2);
             
             if (selectedMaterial == 0) {
-                ImGui::SliderFloat("Sphere1 Roughness", &sphere1Roughness, 0.0f, 1.0f, "%.3f");
-                ImGui::SliderFloat("Sphere1 Metallic", &sphere1Metallic, 0.0f, 1.0f, "%.3f");
+                ImGui::SliderFloat("Sphere1 Roughness", &settings.sphere1Roughness, 0.0f, 1.0f, "%.3f");
+                ImGui::SliderFloat("Sphere1 Metallic", &settings.sphere1Metallic, 0.0f, 1.0f, "%.3f");
             } else {
-                ImGui::SliderFloat("Sphere2 Roughness", &sphere2Roughness, 0.0f, 1.0f, "%.3f");
-                ImGui::SliderFloat("Sphere2 Metallic", &sphere2Metallic, 0.0f, 1.0f, "%.3f");
+                ImGui::SliderFloat("Sphere2 Roughness", &settings.sphere2Roughness, 0.0f, 1.0f, "%.3f");
+                ImGui::SliderFloat("Sphere2 Metallic", &settings.sphere2Metallic, 0.0f, 1.0f, "%.3f");
             }
             
             if (ImGui::Button("Reset PBR Settings")) {
-                globalRoughness = 0.5f;
-                globalMetallic = 0.0f;
-                sphere1Roughness = 0.4f;
-                sphere1Metallic = 0.1f;
-                sphere2Roughness = 0.2f;
-                sphere2Metallic = 0.8f;
-                baseColorIntensity = 1.0f;
+                settings.globalRoughness = 0.5f;
+                settings.globalMetallic = 0.0f;
+                settings.sphere1Roughness = 0.4f;
+                settings.sphere1Metallic = 0.1f;
+                settings.sphere2Roughness = 0.2f;
+                settings.sphere2Metallic = 0.8f;
+                settings.baseColorIntensity = 1.0f;
             }
         }
 
         ImGui::Separator();
         ImGui::Text("Light Orthographic Projection");
-        ImGui::SliderFloat2("Ortho Half Size", lightOrthoHalfSize, 1.0f, 20.0f, "%.1f");
-        if (ImGui::Button("Reset Ortho Size")) { lightOrthoHalfSize[0] = lightOrthoHalfSize[1] = 8.0f; }
+        ImGui::SliderFloat2("Ortho Half Size", settings.lightOrthoHalfSize, 1.0f, 20.0f, "%.1f");
+        if (ImGui::Button("Reset Ortho Size")) { settings.lightOrthoHalfSize[0] = settings.lightOrthoHalfSize[1] = 8.0f; }
+
+        gpuProfiler.drawImGui();
 
         ImGui::End();
         imgui->endFrame();
+        gpuProfiler.beginScope(cmd, "ImGui");
         imgui->record(cmd);
+        gpuProfiler.endScope(cmd);
     }
 
     vkCmdEndRenderPass(cmd);
@@ -583,11 +1352,23 @@ void SDFCornell::recordCommandBuffer(uint32_t imageIndex) {
 void SDFCornell::drawFrame() {
     VkFence inFlight = syncManager->getInFlightFence(currentFrame);
     vkWaitForFences(device->getLogicalDevice(), 1, &inFlight, VK_TRUE, UINT64_MAX);
+    deletionQueue.onFenceWaited(currentFrame);
     if (rsmRecreatePending) {
-        recreateRSMResources(rsmPendingSize);
+        recreateRSMResources(rsmPendingSize, rsmPendingEncoding);
         rsmRecreatePending = false;
     }
-    uint32_t imageIndex = swapchainManager->acquireNextImage(syncManager->getImageAvailableSemaphore(currentFrame));
+    // Before recording too: recreating the indirect targets retires the descriptor sets it binds.
+    // They follow the variant actually drawn, so none reads targets of another size
+    selectPipelineVariant(makeCornellVariantKey(settings));
+    const uint32_t indirectDivisorWanted = (activeVariantKey & kCornellVariantIndirectUpsample)
+        ? clampCornellIndirectDivisor(settings.indirectResolutionDivisor) : 1u;
+    const bool reservoirsWanted = (activeVariantKey & kCornellVariantRestir) != 0;
+    if (indirectDivisorWanted != indirectDivisor || reservoirsWanted != indirectReservoirs) {
+        recreateIndirectTargets(indirectDivisorWanted, reservoirsWanted);
+    }
+    uint32_t imageIndex = runOptions.headless
+        ? currentFrame
+        : swapchainManager->acquireNextImage(syncManager->getImageAvailableSemaphore(currentFrame));
     vkResetFences(device->getLogicalDevice(), 1, &inFlight);
 
     updateUniformBuffer(imageIndex);
@@ -598,180 +1379,195 @@ void SDFCornell::drawFrame() {
     VkSemaphore waitSemaphores[] = {syncManager->getImageAvailableSemaphore(currentFrame)};
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     VkSemaphore signalSemaphores[] = {syncManager->getRenderFinishedSemaphore(currentFrame)};
-    VkSubmitInfo submit{}; submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO; submit.waitSemaphoreCount = 1; submit.pWaitSemaphores = waitSemaphores; submit.pWaitDstStageMask = waitStages; submit.commandBufferCount = 1; submit.pCommandBuffers = &commandBuffers[imageIndex]; submit.signalSemaphoreCount = 1; submit.pSignalSemaphores = signalSemaphores;
+    VkSubmitInfo submit{}; submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO; submit.waitSemaphoreCount = runOptions.headless ? 0 : 1; submit.pWaitSemaphores = waitSemaphores; submit.pWaitDstStageMask = waitStages; submit.commandBufferCount = 1; submit.pCommandBuffers = &commandBuffers[imageIndex]; submit.signalSemaphoreCount = runOptions.headless ? 0 : 1; submit.pSignalSemaphores = signalSemaphores;
     if (vkQueueSubmit(device->getGraphicsQueue(), 1, &submit, inFlight) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit command buffer!");
     }
-    swapchainManager->presentImage(imageIndex, syncManager->getRenderFinishedSemaphore(currentFrame));
+    deletionQueue.onSubmit(currentFrame);
+    if (!runOptions.headless) {
+        swapchainManager->presentImage(imageIndex, syncManager->getRenderFinishedSemaphore(currentFrame));
+    }
     currentFrame = (currentFrame + 1) % frameNum;
     frameCounter++;
 }
 
 void SDFCornell::mainLoop() {
+    if (runOptions.headless) {
+        mainLoopHeadless();
+        return;
+    }
+    startFrameStats();
     while (!glfwWindowShouldClose(device->getWindow())) {
+        auto frameStart = std::chrono::high_resolution_clock::now();
         glfwPollEvents();
         drawFrame();
+        auto frameEnd = std::chrono::high_resolution_clock::now();
+        frameStats.addSample(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+    }
+    vkDeviceWaitIdle(device->getLogicalDevice());
+    gpuProfiler.resolveAll();
+    finishFrameStats();
+}
+
+void SDFCornell::startFrameStats() {
+    if (runOptions.statsIntervalSeconds > 0.0) {
+        frameStats.startReporter(
+            std::chrono::milliseconds(static_cast<int64_t>(runOptions.statsIntervalSeconds * 1000.0)),
+            std::cout);
+    }
+}
+
+void SDFCornell::finishFrameStats() {
+    frameStats.stopReporter();
+    FrameStats::printSummary(std::cout, frameStats.summarize());
+    if (!runOptions.statsJsonPath.empty()) {
+        frameStats.writeJson(runOptions.statsJsonPath);
+    }
+}
+
+void SDFCornell::mainLoopHeadless() {
+    startFrameStats();
+    auto runStart = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < runOptions.frameCount; ++i) {
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        drawFrame();
+        auto frameEnd = std::chrono::high_resolution_clock::now();
+        frameStats.addSample(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
     }
     vkDeviceWaitIdle(device->getLogicalDevice());
+    auto runEnd = std::chrono::high_resolution_clock::now();
+    gpuProfiler.resolveAll();
+    printHeadlessSummary(std::cout, runOptions,
+                         std::chrono::duration<double, std::milli>(runEnd - runStart).count());
+    gpuProfiler.printSummary(std::cout);
+    if (settings.enableRSM) {
+        std::cout << "RSM passes (" << toString(rsmScheduler.getMode()) << "): "
+                  << rsmScheduler.getStats().rendered << " rendered ("
+                  << rsmScheduler.getStats().partial << " partial), "
+                  << rsmScheduler.getStats().skipped << " reused\n";
+    }
+    finishFrameStats();
+
+    if (!runOptions.outputPath.empty()) {
+        uint32_t lastIndex = (currentFrame + frameNum - 1) % frameNum;
+        offscreenTarget.writePPM(device, commandPool, lastIndex, runOptions.outputPath);
+        std::cout << "Wrote last frame to " << runOptions.outputPath << "\n";
+    }
 }
 
 void SDFCornell::createUniformBuffer() {
-    uniformBuffer = ev::ResourceUtils::createBuffer(
-        device,
-        sizeof(SDFCornellUniforms),
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &uniformBufferAllocation
-    );
+    uniformRing.create(device, sizeof(SDFCornellUniforms), frameNum);
 }
 
 void SDFCornell::createDescriptorSetLayout() {
     auto builder = resourceManager->createDescriptorSet();
-    builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+    builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
            .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
            .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
            .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-           .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+           .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+           .addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+           .addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+           .addBinding(7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+           .addBinding(8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+           .addBinding(9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+           .addBinding(10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+           .addBinding(11, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
     descriptorSetLayout = builder.createLayout("SDFCornell_descriptor_layout");
 }
 
 void SDFCornell::createDescriptorSets() {
-    size_t count = swapchainManager->getSwapchainImages().size();
+    size_t count = getTargetCount();
     descriptorSets.resize(count);
     for (size_t i = 0; i < count; ++i) {
         auto builder = resourceManager->createDescriptorSet();
-        builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+        builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
                .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
                .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
                .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
                .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
-               .addBufferDescriptor(0, uniformBuffer, 0, sizeof(SDFCornellUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+               .addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+               .addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+               .addBinding(7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+               .addBinding(8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+               .addBinding(9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+               .addBinding(10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+               .addBinding(11, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+               .addBufferDescriptor(0, uniformRing.getBuffer(), 0, sizeof(SDFCornellUniforms), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
                .addImageDescriptor(1, rsmPositionView, rsmSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
                .addImageDescriptor(2, rsmNormalView, rsmSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
                .addImageDescriptor(3, rsmFluxView, rsmSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-               .addImageDescriptor(4, flowerTextureView, flowerTextureSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-        descriptorSets[i] = builder.build(descriptorSetLayout, std::string("SDFCornell_descriptor_set_") + std::to_string(i));
+               .addImageDescriptor(4, flowerTextureView, flowerTextureSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+               .addImageDescriptor(5, rsmPyramidView, rsmPyramidSampler, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+               .addImageDescriptor(6, rsmClusterConeView, rsmPyramidSampler, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+               .addImageDescriptor(7, rsmClusterBoundsView, rsmPyramidSampler, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+               .addBufferDescriptor(8, vplClusterBuffer, 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+               .addImageDescriptor(9, indirectAccumView, rsmPyramidSampler, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+               .addImageDescriptor(10, indirectRawView, rsmPyramidSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+               .addBufferDescriptor(11, restirReservoirBuffer, 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+        descriptorSets[i] = builder.build(descriptorSetLayout, descriptorSetName(i));
     }
 }
 
+std::string SDFCornell::descriptorSetName(size_t index) const {
+    // Descriptor sets point at the RSM and indirect pass views, so they follow both generations
+    return indirectResourceName(rsmResourceName("SDFCornell_descriptor_set").c_str()) + "_" + std::to_string(index);
+}
+
 void SDFCornell::updateUniformBuffer(uint32_t) {
     auto now = std::chrono::high_resolution_clock::now();
-    float t = std::chrono::duration<float, std::chrono::seconds::period>(now - startTime).count();
-    VkExtent2D extent = swapchainManager->getSwapchainExtent();
+    float t = runOptions.fixedTime >= 0.0
+                  ? static_cast<float>(runOptions.fixedTime)
+                  : std::chrono::duration<float, std::chrono::seconds::period>(now - startTime).count();
+    VkExtent2D extent = getTargetExtent();
 
     // Update rotation from virtual joystick (pitch=yaw control)
-    rotationEuler[0] += virtualStick[1] * 0.02f; // pitch
-    rotationEuler[1] += virtualStick[0] * 0.02f; // yaw
-
-    SDFCornellUniforms u{};
-    u.iTime = t;
-    u.iResolution[0] = static_cast<float>(extent.width);
-    u.iResolution[1] = static_cast<float>(extent.height);
-    u.iMouse[0] = mouseX;
-    u.iMouse[1] = mouseY;
-    u.iFrame = frameCounter;
-
-    u.sphereRotation[0] = rotationEuler[0];
-    u.sphereRotation[1] = rotationEuler[1];
-    u.sphereRotation[2] = rotationEuler[2];
-    u.sphereRotation[3] = t * rotationAnimSpeed;
-
-    // Sphere color
-    u.sphereColor[0] = sphereColor[0];
-    u.sphereColor[1] = sphereColor[1];
-    u.sphereColor[2] = sphereColor[2];
-    u.sphereColor[3] = 1.0f;
-
-    // Lighting: calculate main light direction from angles
-    // Convert spherical coordinates to Cartesian (elevation, azimuth to x,y,z)
-    float cosElevation = std::cos(lightElevation);
-    float dir[3] = {
-        cosElevation * std::sin(lightAzimuth),  // x
-        std::sin(lightElevation),               // y  
-        cosElevation * std::cos(lightAzimuth)   // z
-    };
-    // Normalize (should already be normalized, but ensure precision)
-    float len = std::sqrt(dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
-    dir[0]/=len; dir[1]/=len; dir[2]/=len;
-    u.enableLights[0] = enableKey ? 1 : 0;
-    u.enableLights[1] = enableFill ? 1 : 0;
-    u.enableLights[2] = enableRim ? 1 : 0;
-    u.enableLights[3] = enableEnv ? 1 : 0;
-    u.lightDir[0] = dir[0]; u.lightDir[1] = dir[1]; u.lightDir[2] = dir[2]; u.lightDir[3] = keyIntensity;
-    // Key, Fill, Rim colors (RGBA where A is per-light scalar)
-    u.lightColors[0][0] = 0.95f; u.lightColors[0][1] = 0.98f; u.lightColors[0][2] = 1.0f; u.lightColors[0][3] = 1.0f;
-    u.lightColors[1][0] = 0.4f;  u.lightColors[1][1] = 0.6f;  u.lightColors[1][2] = 0.9f;  u.lightColors[1][3] = 0.6f;
-    u.lightColors[2][0] = 0.6f;  u.lightColors[2][1] = 0.8f;  u.lightColors[2][2] = 1.0f;  u.lightColors[2][3] = 0.8f;
-    u.ambientColor[0] = 0.08f; u.ambientColor[1] = 0.12f; u.ambientColor[2] = 0.22f; u.ambientColor[3] = ambientStrength;
-
-    u.shadowParams[0] = shadowQuality;
-    u.shadowParams[1] = shadowIntensity;
-    u.shadowParams[2] = blueTint;
-    u.shadowParams[3] = metallic;
-
-    // Light camera basis for RSM (orthographic around scene center)
-    // Build light direction unit vector
-    float Lx = dir[0], Ly = dir[1], Lz = dir[2];
-    // Choose up vector and build right/up via Gram-Schmidt
-    float upCand[3] = {0.0f, 1.0f, 0.0f};
-    if (std::abs(Ly) > 0.95f) { upCand[0] = 1.0f; upCand[1] = 0.0f; upCand[2] = 0.0f; }
-    // right = normalize(cross(upCand, L))
-    float rx = upCand[1]*Lz - upCand[2]*Ly;
-    float ry = upCand[2]*Lx - upCand[0]*Lz;
-    float rz = upCand[0]*Ly - upCand[1]*Lx;
-    float rlen = std::sqrt(rx*rx+ry*ry+rz*rz) + 1e-8f; rx/=rlen; ry/=rlen; rz/=rlen;
-    // up = cross(L, right)
-    float ux = Ly*rz - Lz*ry;
-    float uy = Lz*rx - Lx*rz;
-    float uz = Lx*ry - Ly*rx;
-    // Fill UBO light camera params
-    u.lightRight[0]=rx; u.lightRight[1]=ry; u.lightRight[2]=rz; u.lightRight[3]=0.0f;
-    u.lightUp[0]=ux; u.lightUp[1]=uy; u.lightUp[2]=uz; u.lightUp[3]=0.0f;
-    // Place light origin so that u.lightDir points from origin toward the scene
-    float originDist = 6.0f;
-    u.lightOrigin[0] = -Lx * originDist;
-    u.lightOrigin[1] = -Ly * originDist;
-    u.lightOrigin[2] = -Lz * originDist;
-    u.lightOrigin[3] = 1.0f;
-    // Ortho half size to cover our room (controlled via ImGui)
-    u.lightOrthoHalfSize[0] = lightOrthoHalfSize[0]; u.lightOrthoHalfSize[1] = lightOrthoHalfSize[1]; u.lightOrthoHalfSize[2] = 0.0f; u.lightOrthoHalfSize[3] = 0.0f;
-    u.rsmResolution[0] = static_cast<float>(rsmWidth);
-    u.rsmResolution[1] = static_cast<float>(rsmHeight);
-    u.rsmResolution[2] = 0.0f; u.rsmResolution[3]=0.0f;
-    u.rsmParams[0] = 6.0f; // radius in texel units (balanced for quality/aliasing)
-    u.rsmParams[1] = 32.0f; // samples
-    u.rsmParams[2] = (enableRSM && enableIndirectLighting) ? 1.0f : 0.0f; // enable indirect lighting
-    u.rsmParams[3] = enableRSM ? 1.0f : 0.0f; // enable RSM
-    u.indirectParams[0] = indirectIntensity;   // indirect intensity scale
-    u.indirectParams[1] = 0.0f; u.indirectParams[2] = 0.0f; u.indirectParams[3] = 0.0f;
-
-    // Debug params
-    u.debugParams[0] = showRSMOnly ? 1.0f : 0.0f; // show RSM only
-    u.debugParams[1] = enableImportanceSampling ? 1.0f : 0.0f; // importance sampling enabled
-    u.debugParams[2] = showIndirectOnly ? 1.0f : 0.0f; // show indirect lighting only
-    u.debugParams[3] = 0.0f;
-
-    // PBR parameters
-    u.pbrParams[0] = enablePBR ? 1.0f : 0.0f;  // enable PBR flag
-    u.pbrParams[1] = globalRoughness;          // global roughness override
-    u.pbrParams[2] = globalMetallic;           // global metallic override
-    u.pbrParams[3] = 0.0f;                     // reserved
-
-    // Per-material roughness and metallic values
-    u.roughnessValues[0] = sphere1Roughness;   // sphere1 roughness
-    u.roughnessValues[1] = sphere2Roughness;   // sphere2 roughness
-    u.metallicValues[0] = sphere1Metallic;     // sphere1 metallic
-    u.metallicValues[1] = sphere2Metallic;     // sphere2 metallic
-
-    // Base color factors
-    // Shader expects rgb multiplied by alpha as global intensity.
-    // Put intensity into .a and keep rgb at 1 to avoid unintended desaturation.
-    u.baseColorFactors[0] = 1.0f;              // R factor
-    u.baseColorFactors[1] = 1.0f;              // G factor
-    u.baseColorFactors[2] = 1.0f;              // B factor
-    u.baseColorFactors[3] = baseColorIntensity; // Global intensity in alpha
-
-    ev::ResourceUtils::uploadDataToMappedBuffer(uniformBuffer, device, &uniformBufferAllocation, &u, sizeof(u), 0);
+    settings.rotationEuler[0] += virtualStick[1] * 0.02f; // pitch
+    settings.rotationEuler[1] += virtualStick[0] * 0.02f; // yaw
+
+    SDFCornellFrameInputs frame;
+    frame.time = t;
+    frame.width = extent.width;
+    frame.height = extent.height;
+    frame.frame = frameCounter;
+    frame.mouse[0] = mouseX;
+    frame.mouse[1] = mouseY;
+    frame.rsmWidth = rsmWidth;
+    frame.rsmHeight = rsmHeight;
+    frame.rsmEncoding = rsmEncoding;
+    SDFCornellUniforms u = makeCornellUniforms(settings, frame);
+    // The targets actually bound, which lag the settings while a variant compiles
+    u.pbrParams[3] = static_cast<float>(indirectDivisor);
+    // Reservoir half and sphere centres as the last indirect pass left them
+    u.restirParams[2] = static_cast<float>(restirHalf);
+    std::copy(&restirSphereCenters[0][0], &restirSphereCenters[0][0] + 8, &u.prevSphereCenters[0][0]);
+    frameUniforms = u;
+
+    if (settings.enableRSM) {
+        rsmRenderThisFrame = rsmScheduler.shouldRender(u, getLastRSMGpuMs());
+        if (rsmRenderThisFrame) {
+            // Reused RSMs keep decoding with the camera they were rendered with in the
+            // compute passes; the main pass uses this frame's (they differ only while a
+            // throttled update mode lags behind a moving light)
+            rsmLightFrame = RSMLightFrame::fromUniforms(u);
+        }
+    } else {
+        // Contents may not match whatever changes while the pass is off
+        rsmRenderThisFrame = false;
+        rsmScheduler.invalidate();
+        vplClusterSeededCount = 0; // like the CPU renderer: start over once the RSM is back
+    }
+
+    uniformRing.write(currentFrame, u);
+}
+
+double SDFCornell::getLastRSMGpuMs() const {
+    for (const GpuProfiler::ScopeStats& scope : gpuProfiler.getStats()) {
+        if (scope.name == "RSM") {
+            return scope.lastMs;
+        }
+    }
+    return 0.0;
 }
 
 void SDFCornell::setupMouseCallback() {
@@ -788,10 +1584,35 @@ void SDFCornell::setupMouseCallback() {
 SDFCornell::~SDFCornell() {
     if (device && device->getLogicalDevice()) {
         vkDeviceWaitIdle(device->getLogicalDevice());
-        if (uniformBuffer != VK_NULL_HANDLE && uniformBufferAllocation != VK_NULL_HANDLE) {
-            vmaDestroyBuffer(device->getAllocator(), uniformBuffer, uniformBufferAllocation);
-            uniformBuffer = VK_NULL_HANDLE;
-            uniformBufferAllocation = VK_NULL_HANDLE;
+        deletionQueue.flush();
+        gpuProfiler.destroy();
+        uniformRing.destroy();
+        VkDevice logicalDevice = device->getLogicalDevice();
+        // Running builds finish, queued ones resolve to null handles; the cache then holds them all
+        pipelineBuilds.destroy();
+        pipelineCache.save();
+        for (auto& entry : pipelineVariants) {
+            PipelineVariant& variant = entry.second;
+            if (variant.pending.valid()) {
+                try {
+                    variant.built = variant.pending.get();
+                } catch (const std::exception&) {
+                    // A failed build created nothing
+                }
+            }
+            vkDestroyPipeline(logicalDevice, variant.built.pipeline, nullptr);
+            vkDestroyPipelineLayout(logicalDevice, variant.built.layout, nullptr);
+        }
+        for (const BuiltPipeline& rsm : rsmPipelines) {
+            vkDestroyPipeline(logicalDevice, rsm.pipeline, nullptr);
+            vkDestroyPipelineLayout(logicalDevice, rsm.layout, nullptr);
         }
+        vkDestroyPipeline(logicalDevice, rsmPyramidPipeline, nullptr);
+        vkDestroyPipelineLayout(logicalDevice, rsmPyramidPipelineLayout, nullptr);
+        vkDestroyPipeline(logicalDevice, vplClusterPipeline, nullptr);
+        vkDestroyPipelineLayout(logicalDevice, vplClusterPipelineLayout, nullptr);
+        vkDestroyPipeline(logicalDevice, indirectTemporalPipeline, nullptr);
+        vkDestroyPipelineLayout(logicalDevice, indirectTemporalPipelineLayout, nullptr);
+        pipelineCache.destroy();
     }
 }
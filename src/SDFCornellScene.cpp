@@ -0,0 +1,250 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Cornell scene parameters and uniform block shared by the GPU and CPU renderers
+ * @FilePath     : SDFCornellScene.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "SDFCornellScene.hpp"
+#include "RunOptions.hpp"
+#include "SDFMath.hpp"
+#include "VplClusters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+uint32_t clampCornellIndirectDivisor(int divisor) {
+    return divisor >= 4 ? 4u : (divisor >= 2 ? 2u : 1u);
+}
+
+SDFCornellUniforms makeCornellUniforms(const SDFCornellSettings& s, const SDFCornellFrameInputs& frame) {
+    SDFCornellUniforms u{};
+    u.iTime = frame.time;
+    u.iResolution[0] = static_cast<float>(frame.width);
+    u.iResolution[1] = static_cast<float>(frame.height);
+    u.iMouse[0] = frame.mouse[0];
+    u.iMouse[1] = frame.mouse[1];
+    u.iFrame = frame.frame;
+
+    u.sphereRotation[0] = s.rotationEuler[0];
+    u.sphereRotation[1] = s.rotationEuler[1];
+    u.sphereRotation[2] = s.rotationEuler[2];
+    u.sphereRotation[3] = frame.time * s.rotationAnimSpeed;
+
+    // Sphere color
+    u.sphereColor[0] = s.sphereColor[0];
+    u.sphereColor[1] = s.sphereColor[1];
+    u.sphereColor[2] = s.sphereColor[2];
+    u.sphereColor[3] = 1.0f;
+
+    // Lighting: calculate main light direction from angles
+    // Convert spherical coordinates to Cartesian (elevation, azimuth to x,y,z)
+    float cosElevation = std::cos(s.lightElevation);
+    float dir[3] = {
+        cosElevation * std::sin(s.lightAzimuth),  // x
+        std::sin(s.lightElevation),               // y  
+        cosElevation * std::cos(s.lightAzimuth)   // z
+    };
+    // Normalize (should already be normalized, but ensure precision)
+    float len = std::sqrt(dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
+    dir[0]/=len; dir[1]/=len; dir[2]/=len;
+    u.enableLights[0] = s.enableKey ? 1 : 0;
+    u.enableLights[1] = s.enableFill ? 1 : 0;
+    u.enableLights[2] = s.enableRim ? 1 : 0;
+    u.enableLights[3] = s.enableEnv ? 1 : 0;
+    u.lightDir[0] = dir[0]; u.lightDir[1] = dir[1]; u.lightDir[2] = dir[2]; u.lightDir[3] = s.keyIntensity;
+    // Key, Fill, Rim colors (RGBA where A is per-light scalar)
+    u.lightColors[0][0] = 0.95f; u.lightColors[0][1] = 0.98f; u.lightColors[0][2] = 1.0f; u.lightColors[0][3] = 1.0f;
+    u.lightColors[1][0] = 0.4f;  u.lightColors[1][1] = 0.6f;  u.lightColors[1][2] = 0.9f;  u.lightColors[1][3] = 0.6f;
+    u.lightColors[2][0] = 0.6f;  u.lightColors[2][1] = 0.8f;  u.lightColors[2][2] = 1.0f;  u.lightColors[2][3] = 0.8f;
+    u.ambientColor[0] = 0.08f; u.ambientColor[1] = 0.12f; u.ambientColor[2] = 0.22f; u.ambientColor[3] = s.ambientStrength;
+
+    u.shadowParams[0] = s.shadowQuality;
+    u.shadowParams[1] = s.shadowIntensity;
+    u.shadowParams[2] = s.blueTint;
+    u.shadowParams[3] = s.metallic;
+
+    // Light camera basis for RSM (orthographic around scene center)
+    // Build light direction unit vector
+    float Lx = dir[0], Ly = dir[1], Lz = dir[2];
+    // Choose up vector and build right/up via Gram-Schmidt
+    float upCand[3] = {0.0f, 1.0f, 0.0f};
+    if (std::abs(Ly) > 0.95f) { upCand[0] = 1.0f; upCand[1] = 0.0f; upCand[2] = 0.0f; }
+    // right = normalize(cross(upCand, L))
+    float rx = upCand[1]*Lz - upCand[2]*Ly;
+    float ry = upCand[2]*Lx - upCand[0]*Lz;
+    float rz = upCand[0]*Ly - upCand[1]*Lx;
+    float rlen = std::sqrt(rx*rx+ry*ry+rz*rz) + 1e-8f; rx/=rlen; ry/=rlen; rz/=rlen;
+    // up = cross(L, right)
+    float ux = Ly*rz - Lz*ry;
+    float uy = Lz*rx - Lx*rz;
+    float uz = Lx*ry - Ly*rx;
+    // Fill UBO light camera params
+    u.lightRight[0]=rx; u.lightRight[1]=ry; u.lightRight[2]=rz; u.lightRight[3]=0.0f;
+    u.lightUp[0]=ux; u.lightUp[1]=uy; u.lightUp[2]=uz; u.lightUp[3]=0.0f;
+    // Place light origin so that u.lightDir points from origin toward the scene
+    float originDist = 6.0f;
+    u.lightOrigin[0] = -Lx * originDist;
+    u.lightOrigin[1] = -Ly * originDist;
+    u.lightOrigin[2] = -Lz * originDist;
+    u.lightOrigin[3] = 1.0f;
+    // Ortho half size to cover our room (controlled via ImGui)
+    u.lightOrthoHalfSize[0] = s.lightOrthoHalfSize[0]; u.lightOrthoHalfSize[1] = s.lightOrthoHalfSize[1]; u.lightOrthoHalfSize[3] = 0.0f;
+    u.lightOrthoHalfSize[2] = frame.rsmEncoding == RSMEncoding::Compact ? 1.0f : 0.0f; // rsm_encoding.glsl
+    u.rsmResolution[0] = static_cast<float>(frame.rsmWidth);
+    u.rsmResolution[1] = static_cast<float>(frame.rsmHeight);
+    u.rsmResolution[2] = 1.0f / std::max(u.rsmResolution[0], 1.0f);
+    u.rsmResolution[3] = 1.0f / std::max(u.rsmResolution[1], 1.0f);
+    u.rsmParams[0] = 6.0f; // radius in texel units (balanced for quality/aliasing)
+    u.rsmParams[1] = 32.0f; // samples
+    u.rsmParams[2] = (s.enableRSM && s.enableIndirectLighting) ? 1.0f : 0.0f; // enable indirect lighting
+    u.rsmParams[3] = s.enableRSM ? 1.0f : 0.0f; // enable RSM
+    u.indirectParams[0] = s.indirectIntensity;   // indirect intensity scale
+    u.indirectParams[1] = static_cast<float>(std::clamp(s.vplSamples, 1, 16)); // VPLs per pixel (hierarchical sampling)
+    u.indirectParams[2] = s.enableVplClustering // VPL clusters, 0 when the list is not used
+        ? static_cast<float>(std::clamp(s.vplClusterCount, kMinVplClusters, kMaxVplClusters)) : 0.0f;
+    // Taps per frame while temporal accumulation replaces the gather, 0 otherwise
+    const bool restir = s.enableRSM && s.enableIndirectLighting && s.enableRestir && !s.enableVplClustering;
+    u.indirectParams[3] = s.enableRSM && s.enableIndirectLighting && s.enableTemporalIndirect && !s.enableVplClustering && !restir
+        ? static_cast<float>(std::clamp(s.temporalTaps, 1, 16)) : 0.0f;
+
+    // Debug params
+    u.debugParams[0] = s.showRSMOnly ? 1.0f : 0.0f; // show RSM only
+    u.debugParams[1] = s.enableImportanceSampling ? 1.0f : 0.0f; // importance sampling enabled
+    u.debugParams[2] = s.showIndirectOnly ? 1.0f : 0.0f; // show indirect lighting only
+    u.debugParams[3] = s.enableHierarchicalSampling ? 1.0f : 0.0f; // hierarchical VPL sampling
+
+    // PBR parameters
+    u.pbrParams[0] = s.enablePBR ? 1.0f : 0.0f;  // enable PBR flag
+    u.pbrParams[1] = s.globalRoughness;          // global roughness override
+    u.pbrParams[2] = s.globalMetallic;           // global metallic override
+    // Indirect resolution divisor, 1 when indirect light is off
+    u.pbrParams[3] = s.enableRSM && s.enableIndirectLighting
+        ? static_cast<float>(clampCornellIndirectDivisor(s.indirectResolutionDivisor)) : 1.0f;
+
+    // Per-material roughness and metallic values
+    u.roughnessValues[0] = s.sphere1Roughness;   // sphere1 roughness
+    u.roughnessValues[1] = s.sphere2Roughness;   // sphere2 roughness
+    u.metallicValues[0] = s.sphere1Metallic;     // sphere1 metallic
+    u.metallicValues[1] = s.sphere2Metallic;     // sphere2 metallic
+
+    // Base color factors
+    // Shader expects rgb multiplied by alpha as global intensity.
+    // Put intensity into .a and keep rgb at 1 to avoid unintended desaturation.
+    u.baseColorFactors[0] = 1.0f;              // R factor
+    u.baseColorFactors[1] = 1.0f;              // G factor
+    u.baseColorFactors[2] = 1.0f;              // B factor
+    u.baseColorFactors[3] = s.baseColorIntensity; // Global intensity in alpha
+
+    // Sphere placement, once per frame instead of on every ray-march step,
+    // normal tap and shadow step of every pixel
+    const sdf::Mat3 zRotation = sdf::rotateZ(frame.time * 0.5f);
+    const sdf::Vec3 centers[2] = {zRotation * sdf::Vec3(2.0f, 0.0f, 0.0f),
+                                  zRotation * sdf::Vec3(-2.0f, 0.0f, 0.0f)};
+    for (int i = 0; i < 2; ++i) {
+        u.sphereCenters[i][0] = centers[i].x;
+        u.sphereCenters[i][1] = centers[i].y;
+        u.sphereCenters[i][2] = centers[i].z;
+        u.sphereCenters[i][3] = 1.0f; // radius
+    }
+    // Renderers that keep reservoirs overwrite the previous centres and the half
+    std::copy(&u.sphereCenters[0][0], &u.sphereCenters[0][0] + 8, &u.prevSphereCenters[0][0]);
+    u.restirParams[0] = restir ? static_cast<float>(std::clamp(s.restirCandidates, 1, 32)) : 0.0f;
+    u.restirParams[1] = static_cast<float>(std::clamp(s.restirSpatialNeighbours, 0, 8));
+    u.restirParams[2] = 0.0f;
+    u.restirParams[3] = 0.0f;
+    const sdf::Mat3 localRotation = sdf::rotateX(s.rotationEuler[0]) * sdf::rotateY(s.rotationEuler[1]) *
+                                    sdf::rotateZ(s.rotationEuler[2]);
+    const sdf::Vec3* columns[3] = {&localRotation.c0, &localRotation.c1, &localRotation.c2};
+    for (int c = 0; c < 3; ++c) {
+        u.sphereLocalRotation[c][0] = columns[c]->x;
+        u.sphereLocalRotation[c][1] = columns[c]->y;
+        u.sphereLocalRotation[c][2] = columns[c]->z;
+        u.sphereLocalRotation[c][3] = 0.0f;
+    }
+
+    return u;
+}
+
+void applyCornellRunOptions(const RunOptions& options, SDFCornellSettings& settings) {
+    if (options.enableRSM) {
+        settings.enableRSM = true;
+    }
+    if (options.vplClusters > 0) {
+        settings.enableVplClustering = true;
+        settings.vplClusterCount = std::clamp(static_cast<int>(options.vplClusters), kMinVplClusters, kMaxVplClusters);
+    }
+    if (options.vplSampling == "uniform" || options.vplSampling == "importance") {
+        settings.enableHierarchicalSampling = false;
+        settings.enableImportanceSampling = options.vplSampling == "importance";
+    } else if (options.vplSampling != "hierarchical") {
+        throw std::runtime_error("Unknown VPL sampling: " + options.vplSampling);
+    }
+    settings.vplSamples = static_cast<int>(std::min(options.vplSamples, 16u));
+    settings.enableTemporalIndirect = options.temporalIndirect;
+    settings.temporalTaps = static_cast<int>(std::min(options.temporalTaps, 16u));
+    settings.indirectResolutionDivisor = static_cast<int>(options.indirectDivisor);
+    settings.enableRestir = options.restir;
+    settings.restirCandidates = static_cast<int>(std::min(options.restirCandidates, 32u));
+    settings.restirSpatialNeighbours = static_cast<int>(std::min(options.restirNeighbours, 8u));
+    settings.showIndirectOnly = options.showIndirectOnly;
+}
+
+uint32_t makeCornellVariantKey(const SDFCornellSettings& s) {
+    if (s.showRSMOnly) {
+        return kCornellVariantDebugRSM;
+    }
+    uint32_t key = 0;
+    key |= s.enableKey ? kCornellVariantKeyLight : 0u;
+    key |= s.enableFill ? kCornellVariantFillLight : 0u;
+    key |= s.enableRim ? kCornellVariantRimLight : 0u;
+    key |= s.enableEnv ? kCornellVariantEnvLight : 0u;
+    key |= s.enablePBR ? kCornellVariantPBR : 0u;
+    if (s.enableRSM) {
+        key |= kCornellVariantRSM;
+        if (s.enableIndirectLighting) {
+            key |= kCornellVariantIndirect;
+            if (s.enableVplClustering) {
+                // Replaces every RSM gather, so neither sampling flag matters
+                key |= kCornellVariantVplClusters;
+            } else if (s.enableHierarchicalSampling) {
+                // Replaces both local gathers, so the importance sampling flag no longer matters
+                key |= kCornellVariantHierarchical;
+            } else {
+                key |= s.enableImportanceSampling ? kCornellVariantImportanceSampling : 0u;
+            }
+            // Clusters are deterministic: nothing to accumulate or resample. ReSTIR
+            // reuses its reservoirs over frames instead of accumulating
+            if (s.enableRestir && !s.enableVplClustering) {
+                key |= kCornellVariantRestir;
+            } else if (s.enableTemporalIndirect && !s.enableVplClustering) {
+                key |= kCornellVariantTemporalIndirect;
+            }
+            if (clampCornellIndirectDivisor(s.indirectResolutionDivisor) > 1) {
+                key |= kCornellVariantIndirectUpsample;
+            }
+        }
+    }
+    if (s.showIndirectOnly) {
+        // Only the indirect term reaches the screen
+        key &= kCornellVariantRSM | kCornellVariantIndirect | kCornellVariantImportanceSampling |
+               kCornellVariantHierarchical | kCornellVariantVplClusters | kCornellVariantTemporalIndirect |
+               kCornellVariantIndirectUpsample | kCornellVariantRestir;
+        key |= kCornellVariantDebugIndirect;
+    }
+    return key;
+}
+
+bool usesCornellIndirectPass(uint32_t key) {
+    return (key & (kCornellVariantTemporalIndirect | kCornellVariantIndirectUpsample | kCornellVariantRestir)) != 0 &&
+           (key & kCornellVariantIndirectPass) == 0;
+}
+
+uint32_t makeCornellIndirectPassKey(uint32_t key) {
+    return (key & (kCornellVariantRSM | kCornellVariantIndirect | kCornellVariantImportanceSampling |
+                   kCornellVariantHierarchical | kCornellVariantVplClusters | kCornellVariantTemporalIndirect |
+                   kCornellVariantRestir)) |
+           kCornellVariantIndirectPass;
+}
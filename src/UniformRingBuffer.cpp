@@ -0,0 +1,64 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 11:00:00
+ * @Description  : Persistently mapped uniform buffer with one slice per frame in flight
+ * @FilePath     : UniformRingBuffer.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "UniformRingBuffer.hpp"
+
+#include <EasyVulkan/Utils/ResourceUtils.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+void UniformRingBuffer::create(ev::VulkanDevice* vulkanDevice, VkDeviceSize size, uint32_t count,
+                               VkBufferUsageFlags usage) {
+    device = vulkanDevice;
+    sliceSize = size;
+    sliceCount = count;
+
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(device->getPhysicalDevice(), &props);
+    VkDeviceSize alignment = (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+                                 ? props.limits.minStorageBufferOffsetAlignment
+                                 : props.limits.minUniformBufferOffsetAlignment;
+    if (alignment == 0) {
+        alignment = 1;
+    }
+    stride = (sliceSize + alignment - 1) / alignment * alignment;
+
+    buffer = ev::ResourceUtils::createBuffer(
+        device,
+        stride * sliceCount,
+        usage,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        &allocation);
+
+    void* data = nullptr;
+    if (vmaMapMemory(device->getAllocator(), allocation, &data) != VK_SUCCESS) {
+        throw std::runtime_error("failed to map uniform ring buffer!");
+    }
+    mapped = static_cast<uint8_t*>(data);
+}
+
+void UniformRingBuffer::destroy() {
+    if (!device || buffer == VK_NULL_HANDLE) {
+        return;
+    }
+    if (mapped) {
+        vmaUnmapMemory(device->getAllocator(), allocation);
+        mapped = nullptr;
+    }
+    vmaDestroyBuffer(device->getAllocator(), buffer, allocation);
+    buffer = VK_NULL_HANDLE;
+    allocation = VK_NULL_HANDLE;
+}
+
+void UniformRingBuffer::write(uint32_t slice, const void* data, VkDeviceSize size) {
+    if (slice >= sliceCount || size > sliceSize) {
+        throw std::runtime_error("uniform ring buffer write out of range");
+    }
+    std::memcpy(mapped + slice * stride, data, static_cast<size_t>(size));
+}
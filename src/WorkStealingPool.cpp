@@ -0,0 +1,141 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 15:00:00
+ * @Description  : Fixed-size thread pool with per-worker deques and work stealing
+ * @FilePath     : WorkStealingPool.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    queues.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    // Worker 0 is whichever thread calls parallelFor()
+    threads.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t taskCount, const Task& task) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    // Deal contiguous runs so each participant starts on a compact block of tiles
+    const size_t participants = queues.size();
+    for (size_t w = 0; w < participants; ++w) {
+        size_t begin = taskCount * w / participants;
+        size_t end = taskCount * (w + 1) / participants;
+        std::lock_guard<std::mutex> lock(queues[w]->mutex);
+        for (size_t i = begin; i < end; ++i) {
+            queues[w]->tasks.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        job = &task;
+        firstError = nullptr;
+        busyWorkers = static_cast<unsigned>(threads.size());
+        ++generation;
+    }
+    jobCv.notify_all();
+
+    drain(0);
+
+    std::exception_ptr error;
+    {
+        // Workers still hold `job` until they report back; keep `task` alive until then
+        std::unique_lock<std::mutex> lock(jobMutex);
+        doneCv.wait(lock, [this] { return busyWorkers == 0; });
+        job = nullptr;
+        error = firstError;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkStealingPool::workerLoop(unsigned workerIndex) {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCv.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        drain(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            if (--busyWorkers == 0) {
+                doneCv.notify_all();
+            }
+        }
+    }
+}
+
+void WorkStealingPool::drain(unsigned workerIndex) {
+    size_t task = 0;
+    while (popLocal(workerIndex, task) || steal(workerIndex, task)) {
+        try {
+            (*job)(task, workerIndex);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            if (!firstError) {
+                firstError = std::current_exception();
+            }
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(unsigned workerIndex, size_t& task) {
+    Queue& queue = *queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned thiefIndex, size_t& task) {
+    // Tasks are only added before a batch starts, so one empty sweep means the batch is drained
+    const size_t count = queues.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Queue& victim = *queues[(thiefIndex + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
@@ -5,24 +5,47 @@
 
 #if APPIMPLEMENTATION == 1
 #include "SDF2D.hpp"
+#include "CpuSDF2DRenderer.hpp"
 using AppImplementation = SDF2D;
 #elif APPIMPLEMENTATION == 2
 #include "SDF3D.hpp"
 using AppImplementation = SDF3D;
 #elif APPIMPLEMENTATION == 3
 #include "SDFCornell.hpp"
+#include "CpuCornellRenderer.hpp"
 using AppImplementation = SDFCornell;
 #else
 #error "Invalid APPIMPLEMENTATION value."
 #endif
 
+#include "PacketRayMarcher.hpp"
+#include "RunOptions.hpp"
+
 #include <stdexcept>
 #include <iostream>
 
-int main() {
+int main(int argc, char** argv) {
     AppImplementation app;
 
     try {
+        RunOptions options = parseRunOptions(argc, argv);
+        if (options.showHelp) {
+            printRunOptionsUsage(std::cout, argc > 0 ? argv[0] : nullptr);
+            return EXIT_SUCCESS;
+        }
+        if (options.benchRayMarch) {
+            return runRayMarchBenchmark(options);
+        }
+        if (options.cpuReference) {
+#if APPIMPLEMENTATION == 1
+            return runSDF2DCpuReference(options);
+#elif APPIMPLEMENTATION == 3
+            return runCornellCpuReference(options);
+#else
+            throw std::runtime_error("--cpu-reference is only available for the 2D and Cornell scenes");
+#endif
+        }
+        app.setRunOptions(options);
         app.run();
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
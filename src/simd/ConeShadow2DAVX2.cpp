@@ -0,0 +1,57 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : 8-wide AVX2 kernel of the 2D cone shadows
+ * @FilePath     : ConeShadow2DAVX2.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "ConeShadow2D.hpp"
+
+// Same guard as the AVX2 ray marcher, so both report the same availability
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+namespace {
+
+// No fused multiply-add on purpose: results must match the scalar kernel
+struct LanesAVX2 {
+    using V = __m256;
+    using M = __m256;
+    static constexpr size_t kLanes = 8;
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float x) { return _mm256_set1_ps(x); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    static V abs(V a) { return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+    static M lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static M all() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    static M none() { return _mm256_setzero_ps(); }
+    static M maskAnd(M a, M b) { return _mm256_and_ps(a, b); }
+    static M maskOr(M a, M b) { return _mm256_or_ps(a, b); }
+    static M maskAndNot(M a, M b) { return _mm256_andnot_ps(a, b); }
+    static bool any(M m) { return _mm256_movemask_ps(m) != 0; }
+    static V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+};
+
+} // namespace
+
+bool coneShadowsAVX2(const ShadowScene2D& scene, const ShadowBatch2D& batch) {
+    cone_shadow::shadeBatch<LanesAVX2>(scene, batch);
+    return true;
+}
+
+#else
+
+bool coneShadowsAVX2(const ShadowScene2D&, const ShadowBatch2D&) {
+    return false;
+}
+
+#endif
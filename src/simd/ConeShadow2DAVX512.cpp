@@ -0,0 +1,55 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : 16-wide AVX-512 kernel of the 2D cone shadows
+ * @FilePath     : ConeShadow2DAVX512.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "ConeShadow2D.hpp"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+namespace {
+
+struct LanesAVX512 {
+    using V = __m512;
+    using M = __mmask16;
+    static constexpr size_t kLanes = 16;
+    static V load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+    static V set1(float x) { return _mm512_set1_ps(x); }
+    static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm512_div_ps(a, b); }
+    static V min(V a, V b) { return _mm512_min_ps(a, b); }
+    static V max(V a, V b) { return _mm512_max_ps(a, b); }
+    static V sqrt(V a) { return _mm512_sqrt_ps(a); }
+    static V abs(V a) { return _mm512_abs_ps(a); }
+    static M lt(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static M gt(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static M all() { return static_cast<M>(0xFFFF); }
+    static M none() { return 0; }
+    static M maskAnd(M a, M b) { return static_cast<M>(a & b); }
+    static M maskOr(M a, M b) { return static_cast<M>(a | b); }
+    static M maskAndNot(M a, M b) { return static_cast<M>(~a & b); }
+    static bool any(M m) { return m != 0; }
+    static V select(M m, V a, V b) { return _mm512_mask_blend_ps(m, b, a); }
+};
+
+} // namespace
+
+bool coneShadowsAVX512(const ShadowScene2D& scene, const ShadowBatch2D& batch) {
+    cone_shadow::shadeBatch<LanesAVX512>(scene, batch);
+    return true;
+}
+
+#else
+
+bool coneShadowsAVX512(const ShadowScene2D&, const ShadowBatch2D&) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : 4-wide SSE4.1 kernel of the 2D cone shadows
+ * @FilePath     : ConeShadow2DSSE4.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "ConeShadow2D.hpp"
+
+// MSVC has no __SSE4_1__ but always allows SSE4.1 intrinsics on x64
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && defined(_M_X64))
+#include <smmintrin.h>
+
+namespace {
+
+struct LanesSSE4 {
+    using V = __m128;
+    using M = __m128;
+    static constexpr size_t kLanes = 4;
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(float x) { return _mm_set1_ps(x); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V min(V a, V b) { return _mm_min_ps(a, b); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    static V sqrt(V a) { return _mm_sqrt_ps(a); }
+    static V abs(V a) { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+    static M lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+    static M gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+    static M all() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    static M none() { return _mm_setzero_ps(); }
+    static M maskAnd(M a, M b) { return _mm_and_ps(a, b); }
+    static M maskOr(M a, M b) { return _mm_or_ps(a, b); }
+    static M maskAndNot(M a, M b) { return _mm_andnot_ps(a, b); }
+    static bool any(M m) { return _mm_movemask_ps(m) != 0; }
+    static V select(M m, V a, V b) { return _mm_blendv_ps(b, a, m); }
+};
+
+} // namespace
+
+bool coneShadowsSSE4(const ShadowScene2D& scene, const ShadowBatch2D& batch) {
+    cone_shadow::shadeBatch<LanesSSE4>(scene, batch);
+    return true;
+}
+
+#else
+
+bool coneShadowsSSE4(const ShadowScene2D&, const ShadowBatch2D&) {
+    return false;
+}
+
+#endif
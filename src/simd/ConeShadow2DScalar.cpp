@@ -0,0 +1,14 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 19:00:00
+ * @Description  : Scalar reference kernel of the 2D cone shadows
+ * @FilePath     : ConeShadow2DScalar.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "ConeShadow2D.hpp"
+
+bool coneShadowsScalar(const ShadowScene2D& scene, const ShadowBatch2D& batch) {
+    cone_shadow::shadeBatch<cone_shadow::ScalarLanes>(scene, batch);
+    return true;
+}
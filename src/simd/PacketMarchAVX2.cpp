@@ -0,0 +1,74 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 16:00:00
+ * @Description  : 8-wide AVX2/FMA packet kernel of the ray marcher
+ * @FilePath     : PacketMarchAVX2.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PacketRayMarcher.hpp"
+
+// MSVC's /arch:AVX2 implies FMA but does not define __FMA__
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+using namespace packet_march;
+
+namespace {
+
+inline __m256 sphereDistance(__m256 px, __m256 py, __m256 pz, const float* c, __m256 radius) {
+    __m256 x = _mm256_sub_ps(px, _mm256_set1_ps(c[0]));
+    __m256 y = _mm256_sub_ps(py, _mm256_set1_ps(c[1]));
+    __m256 z = _mm256_sub_ps(pz, _mm256_set1_ps(c[2]));
+    __m256 len2 = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_mul_ps(z, z)));
+    return _mm256_sub_ps(_mm256_sqrt_ps(len2), radius);
+}
+
+inline __m256 sceneDistance(const PacketMarchScene& s, __m256 px, __m256 py, __m256 pz) {
+    const __m256 radius = _mm256_set1_ps(s.sphereRadius);
+    __m256 spheres = _mm256_min_ps(sphereDistance(px, py, pz, s.sphereCenters[0], radius),
+                                   sphereDistance(px, py, pz, s.sphereCenters[1], radius));
+    const __m256 five = _mm256_set1_ps(5.0f), fourHalf = _mm256_set1_ps(4.5f);
+    __m256 walls = _mm256_min_ps(_mm256_min_ps(_mm256_add_ps(px, five), _mm256_sub_ps(five, px)),
+                                 _mm256_min_ps(_mm256_add_ps(pz, _mm256_set1_ps(2.0f)), _mm256_sub_ps(fourHalf, py)));
+    walls = _mm256_min_ps(walls, _mm256_add_ps(py, fourHalf));
+    return _mm256_min_ps(spheres, walls);
+}
+
+void marchPacket(const PacketMarchScene& s, const float* ox, const float* oy, const float* oz,
+                 const float* dx, const float* dy, const float* dz, float* t) {
+    const __m256 rox = _mm256_loadu_ps(ox), roy = _mm256_loadu_ps(oy), roz = _mm256_loadu_ps(oz);
+    const __m256 rdx = _mm256_loadu_ps(dx), rdy = _mm256_loadu_ps(dy), rdz = _mm256_loadu_ps(dz);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 surfDist = _mm256_set1_ps(SURF_DIST), maxDist = _mm256_set1_ps(MAX_DIST);
+    const __m256 minStep = _mm256_set1_ps(MIN_STEP);
+
+    __m256 dO = _mm256_setzero_ps();
+    __m256 active = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int i = 0; i < MAX_STEPS; i++) {
+        __m256 dS = sceneDistance(s, _mm256_fmadd_ps(rdx, dO, rox),
+                                  _mm256_fmadd_ps(rdy, dO, roy),
+                                  _mm256_fmadd_ps(rdz, dO, roz));
+        __m256 done = _mm256_or_ps(_mm256_cmp_ps(_mm256_and_ps(dS, absMask), surfDist, _CMP_LT_OQ),
+                                   _mm256_cmp_ps(dO, maxDist, _CMP_GT_OQ));
+        active = _mm256_andnot_ps(done, active);
+        if (_mm256_movemask_ps(active) == 0) break;
+        dO = _mm256_add_ps(dO, _mm256_and_ps(active, _mm256_max_ps(dS, minStep)));
+    }
+    _mm256_storeu_ps(t, dO);
+}
+
+} // namespace
+
+bool marchRaysAVX2(const PacketMarchScene& scene, const RayBatch& rays) {
+    forEachPacket<8>(rays, [&](auto... args) { marchPacket(scene, args...); });
+    return true;
+}
+
+#else
+
+bool marchRaysAVX2(const PacketMarchScene&, const RayBatch&) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 16:00:00
+ * @Description  : 16-wide AVX-512F packet kernel of the ray marcher
+ * @FilePath     : PacketMarchAVX512.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PacketRayMarcher.hpp"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+using namespace packet_march;
+
+namespace {
+
+inline __m512 sphereDistance(__m512 px, __m512 py, __m512 pz, const float* c, __m512 radius) {
+    __m512 x = _mm512_sub_ps(px, _mm512_set1_ps(c[0]));
+    __m512 y = _mm512_sub_ps(py, _mm512_set1_ps(c[1]));
+    __m512 z = _mm512_sub_ps(pz, _mm512_set1_ps(c[2]));
+    __m512 len2 = _mm512_fmadd_ps(x, x, _mm512_fmadd_ps(y, y, _mm512_mul_ps(z, z)));
+    return _mm512_sub_ps(_mm512_sqrt_ps(len2), radius);
+}
+
+inline __m512 sceneDistance(const PacketMarchScene& s, __m512 px, __m512 py, __m512 pz) {
+    const __m512 radius = _mm512_set1_ps(s.sphereRadius);
+    __m512 spheres = _mm512_min_ps(sphereDistance(px, py, pz, s.sphereCenters[0], radius),
+                                   sphereDistance(px, py, pz, s.sphereCenters[1], radius));
+    const __m512 five = _mm512_set1_ps(5.0f), fourHalf = _mm512_set1_ps(4.5f);
+    __m512 walls = _mm512_min_ps(_mm512_min_ps(_mm512_add_ps(px, five), _mm512_sub_ps(five, px)),
+                                 _mm512_min_ps(_mm512_add_ps(pz, _mm512_set1_ps(2.0f)), _mm512_sub_ps(fourHalf, py)));
+    walls = _mm512_min_ps(walls, _mm512_add_ps(py, fourHalf));
+    return _mm512_min_ps(spheres, walls);
+}
+
+void marchPacket(const PacketMarchScene& s, const float* ox, const float* oy, const float* oz,
+                 const float* dx, const float* dy, const float* dz, float* t) {
+    const __m512 rox = _mm512_loadu_ps(ox), roy = _mm512_loadu_ps(oy), roz = _mm512_loadu_ps(oz);
+    const __m512 rdx = _mm512_loadu_ps(dx), rdy = _mm512_loadu_ps(dy), rdz = _mm512_loadu_ps(dz);
+    const __m512 surfDist = _mm512_set1_ps(SURF_DIST), maxDist = _mm512_set1_ps(MAX_DIST);
+    const __m512 minStep = _mm512_set1_ps(MIN_STEP);
+
+    __m512 dO = _mm512_setzero_ps();
+    __mmask16 active = 0xFFFF;
+    for (int i = 0; i < MAX_STEPS; i++) {
+        __m512 dS = sceneDistance(s, _mm512_fmadd_ps(rdx, dO, rox),
+                                  _mm512_fmadd_ps(rdy, dO, roy),
+                                  _mm512_fmadd_ps(rdz, dO, roz));
+        __mmask16 done = _mm512_cmp_ps_mask(_mm512_abs_ps(dS), surfDist, _CMP_LT_OQ) |
+                         _mm512_cmp_ps_mask(dO, maxDist, _CMP_GT_OQ);
+        active = static_cast<__mmask16>(active & ~done);
+        if (active == 0) break;
+        dO = _mm512_mask_add_ps(dO, active, dO, _mm512_max_ps(dS, minStep));
+    }
+    _mm512_storeu_ps(t, dO);
+}
+
+} // namespace
+
+bool marchRaysAVX512(const PacketMarchScene& scene, const RayBatch& rays) {
+    forEachPacket<16>(rays, [&](auto... args) { marchPacket(scene, args...); });
+    return true;
+}
+
+#else
+
+bool marchRaysAVX512(const PacketMarchScene&, const RayBatch&) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 16:00:00
+ * @Description  : 4-wide SSE4.1 packet kernel of the ray marcher
+ * @FilePath     : PacketMarchSSE4.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PacketRayMarcher.hpp"
+
+// MSVC has no __SSE4_1__ but always allows SSE4.1 intrinsics on x64
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && defined(_M_X64))
+#include <smmintrin.h>
+
+using namespace packet_march;
+
+namespace {
+
+inline __m128 sphereDistance(__m128 px, __m128 py, __m128 pz, const float* c, __m128 radius) {
+    __m128 x = _mm_sub_ps(px, _mm_set1_ps(c[0]));
+    __m128 y = _mm_sub_ps(py, _mm_set1_ps(c[1]));
+    __m128 z = _mm_sub_ps(pz, _mm_set1_ps(c[2]));
+    __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    return _mm_sub_ps(_mm_sqrt_ps(len2), radius);
+}
+
+inline __m128 sceneDistance(const PacketMarchScene& s, __m128 px, __m128 py, __m128 pz) {
+    const __m128 radius = _mm_set1_ps(s.sphereRadius);
+    __m128 spheres = _mm_min_ps(sphereDistance(px, py, pz, s.sphereCenters[0], radius),
+                                sphereDistance(px, py, pz, s.sphereCenters[1], radius));
+    const __m128 five = _mm_set1_ps(5.0f), fourHalf = _mm_set1_ps(4.5f);
+    __m128 walls = _mm_min_ps(_mm_min_ps(_mm_add_ps(px, five), _mm_sub_ps(five, px)),
+                              _mm_min_ps(_mm_add_ps(pz, _mm_set1_ps(2.0f)), _mm_sub_ps(fourHalf, py)));
+    walls = _mm_min_ps(walls, _mm_add_ps(py, fourHalf));
+    return _mm_min_ps(spheres, walls);
+}
+
+void marchPacket(const PacketMarchScene& s, const float* ox, const float* oy, const float* oz,
+                 const float* dx, const float* dy, const float* dz, float* t) {
+    const __m128 rox = _mm_loadu_ps(ox), roy = _mm_loadu_ps(oy), roz = _mm_loadu_ps(oz);
+    const __m128 rdx = _mm_loadu_ps(dx), rdy = _mm_loadu_ps(dy), rdz = _mm_loadu_ps(dz);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 surfDist = _mm_set1_ps(SURF_DIST), maxDist = _mm_set1_ps(MAX_DIST);
+    const __m128 minStep = _mm_set1_ps(MIN_STEP);
+
+    __m128 dO = _mm_setzero_ps();
+    __m128 active = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int i = 0; i < MAX_STEPS; i++) {
+        __m128 dS = sceneDistance(s, _mm_add_ps(rox, _mm_mul_ps(rdx, dO)),
+                                  _mm_add_ps(roy, _mm_mul_ps(rdy, dO)),
+                                  _mm_add_ps(roz, _mm_mul_ps(rdz, dO)));
+        __m128 done = _mm_or_ps(_mm_cmplt_ps(_mm_and_ps(dS, absMask), surfDist), _mm_cmpgt_ps(dO, maxDist));
+        active = _mm_andnot_ps(done, active);
+        if (_mm_movemask_ps(active) == 0) break;
+        dO = _mm_add_ps(dO, _mm_and_ps(active, _mm_max_ps(dS, minStep)));
+    }
+    _mm_storeu_ps(t, dO);
+}
+
+} // namespace
+
+bool marchRaysSSE4(const PacketMarchScene& scene, const RayBatch& rays) {
+    forEachPacket<4>(rays, [&](auto... args) { marchPacket(scene, args...); });
+    return true;
+}
+
+#else
+
+bool marchRaysSSE4(const PacketMarchScene&, const RayBatch&) {
+    return false;
+}
+
+#endif
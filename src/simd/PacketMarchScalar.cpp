@@ -0,0 +1,45 @@
+/*
+ * @Author       : Calendar66 calendarsunday@163.com
+ * @Date         : 2026-10-16 16:00:00
+ * @Description  : Scalar baseline of the packet ray marcher (one ray at a time)
+ * @FilePath     : PacketMarchScalar.cpp
+ * @Version      : V1.0.0
+ * Copyright 2025 CalendarSUNDAY, All Rights Reserved.
+ */
+#include "PacketRayMarcher.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace packet_march;
+
+namespace {
+
+float sceneDistance(const PacketMarchScene& s, float px, float py, float pz) {
+    float spheres = MAX_DIST;
+    for (const auto& c : s.sphereCenters) {
+        float x = px - c[0], y = py - c[1], z = pz - c[2];
+        spheres = std::min(spheres, std::sqrt(x * x + y * y + z * z) - s.sphereRadius);
+    }
+    float walls = std::min(std::min(px + 5.0f, -px + 5.0f), std::min(pz + 2.0f, -py + 4.5f));
+    walls = std::min(walls, py + 4.5f);
+    return std::min(spheres, walls);
+}
+
+} // namespace
+
+bool marchRaysScalar(const PacketMarchScene& scene, const RayBatch& rays) {
+    for (size_t r = 0; r < rays.count; ++r) {
+        float dO = 0.0f;
+        for (int i = 0; i < MAX_STEPS; i++) {
+            float dS = sceneDistance(scene,
+                                     rays.originX[r] + rays.dirX[r] * dO,
+                                     rays.originY[r] + rays.dirY[r] * dO,
+                                     rays.originZ[r] + rays.dirZ[r] * dO);
+            if (std::abs(dS) < SURF_DIST || dO > MAX_DIST) break;
+            dO += std::max(dS, MIN_STEP);
+        }
+        rays.t[r] = dO;
+    }
+    return true;
+}